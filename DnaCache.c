@@ -0,0 +1,648 @@
+/************************************************************************/
+/*                                                                      */
+/*  DnaCache.c - SYZYGY DNA cache implementation                        */
+/*                                                                      */
+/************************************************************************/
+/*  Author: Digilent Inc.                                               */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  This source file contains the implementation of functions that can  */
+/*  be used to cache the SYZYGY DNA, PDID and calibration data of the   */
+/*  SYZYGY pods attached to each SmartVIO port.                         */
+/*                                                                      */
+/*  Each cache entry is keyed by the index of the I2C bus and the       */
+/*  SmartVIO port index. An entry is considered valid as long as the    */
+/*  port reports that a pod is present and the header CRC and serial    */
+/*  number read back from the pod match those stored in the entry.      */
+/*  Validating an entry requires a single batched read of a few bytes   */
+/*  rather than re-reading the entire DNA and calibration areas.        */
+/*                                                                      */
+/*  On Linux the cache may optionally be persisted to szDnaCacheFile so */
+/*  that it's shared between processes. Entries loaded from the file    */
+/*  are validated exactly like entries that were populated in-process.  */
+/*                                                                      */
+/*  On Linux the cache may be used by several threads at once, even for */
+/*  the same bus and port. A lookup copies the entry out of the cache   */
+/*  under the lock and validates or reads the pod into that copy        */
+/*  without holding it, so buses are read in parallel, and only the     */
+/*  copies to and from the cache and the write of the cache file are    */
+/*  serialized.                                                         */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*  10/14/2026: created                                                 */
+/*  10/14/2026: added bus index and made the cache thread safe          */
+/*  10/14/2026: calibration areas are read according to a policy and    */
+/*      their checksums are validated                                   */
+/*  10/14/2026: transaction sizes are negotiated before the strings and */
+/*      calibration areas are read                                      */
+/*  10/14/2026: added DnaCacheInvalidateAddr                            */
+/*  10/14/2026: DnaCacheLookup returns a copy of the entry              */
+/*                                                                      */
+/************************************************************************/
+
+/* ------------------------------------------------------------ */
+/*              Include File Definitions                        */
+/* ------------------------------------------------------------ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#if defined(__linux__)
+#include <pthread.h>
+#endif
+#include "stdtypes.h"
+#include "I2CHAL.h"
+#include "syzygy.h"
+#include "Zmod.h"
+#include "ZmodADC.h"
+#include "ZmodDAC.h"
+#include "ZmodDigitizer.h"
+#include "DnaCache.h"
+
+/* ------------------------------------------------------------ */
+/*              Miscellaneous Declarations                      */
+/* ------------------------------------------------------------ */
+
+/* Define the values used to identify a valid cache file.
+*/
+#define magicDnaCache		0x43414E44	// "DNAC"
+#define verDnaCache			3
+
+/* ------------------------------------------------------------ */
+/*              Local Type Definitions                          */
+/* ------------------------------------------------------------ */
+
+typedef struct {
+	DWORD	magic;
+	WORD	ver;
+	WORD	centry;
+	DWORD	cbEntry;
+} DnaCacheFileHeader;
+
+/* ------------------------------------------------------------ */
+/*              Global Variables                                */
+/* ------------------------------------------------------------ */
+
+extern I2CHALThreadLocal BOOL	dpmutilfVerbose;
+
+/* ------------------------------------------------------------ */
+/*              Local Variables                                 */
+/* ------------------------------------------------------------ */
+
+static DnaCacheEntry	rgentryDnaCache[cDnaCacheBusMax][cDnaCachePortMax];
+static BOOL				fDnaCachePersist = fFalse;
+static BOOL				fDnaCacheLoaded = fFalse;
+static BYTE				calpolDnaCache = zcalpolBoth;
+#if defined(__linux__)
+static pthread_mutex_t	mtxDnaCache = PTHREAD_MUTEX_INITIALIZER;
+#define DnaCacheLock()		pthread_mutex_lock(&mtxDnaCache)
+#define DnaCacheUnlock()	pthread_mutex_unlock(&mtxDnaCache)
+#else
+#define DnaCacheLock()
+#define DnaCacheUnlock()
+#endif
+
+/* ------------------------------------------------------------ */
+/*              Forward Declarations                            */
+/* ------------------------------------------------------------ */
+
+static BOOL	FDnaCacheValidate(int fdI2cDev, DnaCacheEntry* pentry);
+static BOOL	FDnaCacheFill(int fdI2cDev, BYTE i2cAddr, BOOL fCheckCrc, BYTE calpol, DnaCacheEntry* pentry);
+static void	DnaCacheLoad();
+static void	DnaCacheSave();
+
+/* ------------------------------------------------------------ */
+/*              Procedure Definitions                           */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/***    DnaCacheLookup
+**
+**  Parameters:
+**  	fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      ibus            - index of the I2C bus that fdI2cDev is attached to
+**      iport           - index of the SmartVIO port
+**      i2cAddr         - I2C bus address of the SYZYGY pod on the port
+**      fCheckCrc       - fTrue to check the header CRC, fFalse to skip check
+**      fRefresh        - fTrue to re-read the pod even if the entry is valid
+**      pentry          - pointer to variable to receive a copy of the
+**                        cache entry
+**
+**  Return Value:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function returns the cache entry for the SYZYGY pod on the
+**      specified port. The caller must have already verified that the
+**      port reports a pod as being present. If the cached entry is
+**      still valid then only the header CRC and serial number are read
+**      from the pod. Otherwise the standard firmware registers, DNA
+**      header, DNA strings, PDID and calibration areas are read from
+**      the pod and stored in the cache.
+**
+**      The entry is copied out of the cache under its lock, so lookups
+**      may be performed by different threads at the same time, for the
+**      same port or different ones. The pod is accessed without holding
+**      the lock, so that lookups on different buses run in parallel.
+*/
+BOOL
+DnaCacheLookup(int fdI2cDev, BYTE ibus, BYTE iport, BYTE i2cAddr, BOOL fCheckCrc, BOOL fRefresh, DnaCacheEntry* pentry) {
+
+	BYTE	calpol;
+	BOOL	fValid;
+
+	if (( cDnaCacheBusMax <= ibus ) || ( cDnaCachePortMax <= iport ) || ( NULL == pentry )) {
+		return fFalse;
+	}
+
+	DnaCacheLock();
+	if ( ! fDnaCacheLoaded ) {
+		DnaCacheLoad();
+	}
+	memcpy(pentry, &rgentryDnaCache[ibus][iport], sizeof(DnaCacheEntry));
+	calpol = calpolDnaCache;
+	DnaCacheUnlock();
+
+	if (( pentry->fValid ) &&
+		( ! fRefresh ) &&
+		( i2cAddr == pentry->i2cAddr ) &&
+		(( ! fCheckCrc ) ||
+		 ( 0 == SyzygyComputeCRC((BYTE*)&pentry->szgdnahdr, cbSyzygyDnaHeader) )) &&
+		( FDnaCacheValidate(fdI2cDev, pentry) )) {
+		return fTrue;
+	}
+
+	fValid = FDnaCacheFill(fdI2cDev, i2cAddr, fCheckCrc, calpol, pentry);
+	pentry->fValid = fValid;
+
+	DnaCacheLock();
+	if ( fValid ) {
+		memcpy(&rgentryDnaCache[ibus][iport], pentry, sizeof(DnaCacheEntry));
+	}
+	else {
+		rgentryDnaCache[ibus][iport].fValid = fFalse;
+	}
+
+	if ( fDnaCachePersist ) {
+		DnaCacheSave();
+	}
+	DnaCacheUnlock();
+
+	return fValid;
+}
+
+/* ------------------------------------------------------------ */
+/***    DnaCacheInvalidate
+**
+**  Parameters:
+**      ibus            - index of the I2C bus, ibusDnaCacheAll to
+**                        invalidate the entries of all buses
+**      iport           - index of the SmartVIO port, iportDnaCacheAll
+**                        to invalidate the entries of all ports
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function invalidates the cache entry of the specified port
+**      so that the DNA is re-read from the pod by the next lookup. It
+**      should be called whenever a port reports that no pod is present.
+*/
+void
+DnaCacheInvalidate(BYTE ibus, BYTE iport) {
+
+	BYTE	ibusCur;
+	BYTE	iportCur;
+	BOOL	fChanged;
+
+	DnaCacheLock();
+	if ( ! fDnaCacheLoaded ) {
+		DnaCacheLoad();
+	}
+
+	fChanged = fFalse;
+	for ( ibusCur = 0; ibusCur < cDnaCacheBusMax; ibusCur++ ) {
+		if (( ibusDnaCacheAll != ibus ) && ( ibusCur != ibus )) {
+			continue;
+		}
+		for ( iportCur = 0; iportCur < cDnaCachePortMax; iportCur++ ) {
+			if (( iportDnaCacheAll == iport ) || ( iportCur == iport )) {
+				if ( rgentryDnaCache[ibusCur][iportCur].fValid ) {
+					rgentryDnaCache[ibusCur][iportCur].fValid = fFalse;
+					fChanged = fTrue;
+				}
+			}
+		}
+	}
+
+	if (( fChanged ) && ( fDnaCachePersist )) {
+		DnaCacheSave();
+	}
+	DnaCacheUnlock();
+}
+
+/* ------------------------------------------------------------ */
+/***    DnaCacheInvalidateAddr
+**
+**  Parameters:
+**      i2cAddr         - I2C bus address of the SYZYGY pod
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function invalidates the cache entries of every port, on
+**      every bus, whose pod is at the specified address. It's used
+**      after the DNA or calibration of a pod has been programmed by a
+**      caller that only knows the address of the pod. Entries of other
+**      buses with a pod at the same address are read again needlessly,
+**      which only costs the time of one lookup.
+*/
+void
+DnaCacheInvalidateAddr(BYTE i2cAddr) {
+
+	BYTE	ibus;
+	BYTE	iport;
+	BOOL	fChanged;
+
+	DnaCacheLock();
+	if ( ! fDnaCacheLoaded ) {
+		DnaCacheLoad();
+	}
+
+	fChanged = fFalse;
+	for ( ibus = 0; ibus < cDnaCacheBusMax; ibus++ ) {
+		for ( iport = 0; iport < cDnaCachePortMax; iport++ ) {
+			if (( rgentryDnaCache[ibus][iport].fValid ) &&
+				( i2cAddr == rgentryDnaCache[ibus][iport].i2cAddr )) {
+				rgentryDnaCache[ibus][iport].fValid = fFalse;
+				fChanged = fTrue;
+			}
+		}
+	}
+
+	if (( fChanged ) && ( fDnaCachePersist )) {
+		DnaCacheSave();
+	}
+	DnaCacheUnlock();
+}
+
+/* ------------------------------------------------------------ */
+/***    DnaCacheSetPersist
+**
+**  Parameters:
+**      fPersist        - fTrue to persist the cache to szDnaCacheFile
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function enables or disables persisting the cache to a
+**      file. When enabled, entries are loaded from the file the next
+**      time the cache is accessed and the file is rewritten whenever
+**      an entry changes. Persistence is only supported on Linux.
+*/
+void
+DnaCacheSetPersist(BOOL fPersist) {
+
+#if defined(__linux__)
+	DnaCacheLock();
+	if (( fPersist ) && ( ! fDnaCachePersist )) {
+		fDnaCacheLoaded = fFalse;
+	}
+	fDnaCachePersist = fPersist;
+	DnaCacheUnlock();
+#endif
+}
+
+/* ------------------------------------------------------------ */
+/***    DnaCacheSetCalPolicy
+**
+**  Parameters:
+**      calpol          - zcalpol* policy selecting which calibration
+**                        areas to read when an entry is populated
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function sets the policy passed to FZmodLoadCal when a cache
+**      entry is populated. The default is zcalpolBoth. Changing the
+**      policy invalidates every entry that has calibration data, since
+**      it may lack an area the new policy requires.
+*/
+void
+DnaCacheSetCalPolicy(BYTE calpol) {
+
+	BYTE	ibus;
+	BYTE	iport;
+
+	DnaCacheLock();
+	if ( ! fDnaCacheLoaded ) {
+		DnaCacheLoad();
+	}
+
+	if ( calpol != calpolDnaCache ) {
+		calpolDnaCache = calpol;
+		for ( ibus = 0; ibus < cDnaCacheBusMax; ibus++ ) {
+			for ( iport = 0; iport < cDnaCachePortMax; iport++ ) {
+				if ( rgentryDnaCache[ibus][iport].fCal ) {
+					rgentryDnaCache[ibus][iport].fValid = fFalse;
+				}
+			}
+		}
+		if ( fDnaCachePersist ) {
+			DnaCacheSave();
+		}
+	}
+	DnaCacheUnlock();
+}
+
+/* ------------------------------------------------------------ */
+/***    DnaCacheGetStrings
+**
+**  Parameters:
+**      pentry          - pointer to a valid cache entry
+**      pszgdnastrings  - pointer to SYZYGY DNA Strings structure
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function points the fields of the specified SzgDnaStrings
+**      structure at the strings stored in the cache entry. The strings
+**      remain owned by the cache and must not be freed by calling
+**      SyzygyFreeDNAStrings.
+*/
+void
+DnaCacheGetStrings(DnaCacheEntry* pentry, SzgDnaStrings* pszgdnastrings) {
+
+	pszgdnastrings->szManufacturerName = pentry->szManufacturerName;
+	pszgdnastrings->szProductName = pentry->szProductName;
+	pszgdnastrings->szProductModel = pentry->szProductModel;
+	pszgdnastrings->szProductVersion = pentry->szProductVersion;
+	pszgdnastrings->szSerialNumber = pentry->szSerialNumber;
+}
+
+/* ------------------------------------------------------------ */
+/***    FDnaCacheValidate
+**
+**  Parameters:
+**  	fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      pentry          - pointer to the cache entry to validate
+**
+**  Return Value:
+**      fTrue if the pod still matches the cache entry, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function reads the header CRC and serial number from the
+**      pod using a single batch and compares them to the values stored
+**      in the cache entry. A pod that was swapped for a different pod
+**      of the same model has an identical header, and therefore CRC,
+**      which is why the serial number is checked as well.
+*/
+static BOOL
+FDnaCacheValidate(int fdI2cDev, DnaCacheEntry* pentry) {
+
+	I2cBatch	batch;
+	BYTE		rgbCrc[2];
+	char		szSerialNumber[cchDnaCacheStringMax+1];
+	WORD		addrSerialNumber;
+
+	addrSerialNumber = addrDnaStart + pentry->szgdnahdr.cbDnaHeader +
+						pentry->szgdnahdr.cbManufacturerName +
+						pentry->szgdnahdr.cbProductName +
+						pentry->szgdnahdr.cbProductModel +
+						pentry->szgdnahdr.cbProductVersion;
+
+	I2CHALBatchBegin(&batch, fdI2cDev);
+	SyzygyBatchAddRead(&batch, pentry->i2cAddr, addrDnaStart + offsetof(SzgDnaHeader, crcHigh), rgbCrc, 2);
+	if ( 0 != pentry->szgdnahdr.cbSerialNumber ) {
+		SyzygyBatchAddRead(&batch, pentry->i2cAddr, addrSerialNumber, (BYTE*)szSerialNumber, pentry->szgdnahdr.cbSerialNumber);
+	}
+
+	if ( ! I2CHALBatchSubmit(&batch) ) {
+		return fFalse;
+	}
+
+	if (( rgbCrc[0] != pentry->szgdnahdr.crcHigh ) ||
+		( rgbCrc[1] != pentry->szgdnahdr.crcLow )) {
+		return fFalse;
+	}
+
+	if ( 0 != memcmp(szSerialNumber, pentry->szSerialNumber, pentry->szgdnahdr.cbSerialNumber) ) {
+		return fFalse;
+	}
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    FDnaCacheFill
+**
+**  Parameters:
+**  	fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      i2cAddr         - I2C bus address of the SYZYGY pod
+**      fCheckCrc       - fTrue to check the header CRC, fFalse to skip check
+**      pentry          - pointer to the cache entry to populate
+**
+**  Return Value:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function reads the standard firmware registers, DNA header
+**      and DNA strings from the specified pod. If the pod was
+**      manufactured by Digilent then its PDID is read as well, along
+**      with the factory and user calibration areas when the PDID
+**      identifies a Zmod family that has them.
+*/
+static BOOL
+FDnaCacheFill(int fdI2cDev, BYTE i2cAddr, BOOL fCheckCrc, BYTE calpol, DnaCacheEntry* pentry) {
+
+	SzgDnaStrings	szgdnaStrings;
+	char			rgchStrings[cbSyzygyDnaStringsMax];
+	ZMOD_FAMILY		family;
+	WORD			addrFactCal;
+	WORD			addrUserCal;
+	WORD			cbCal;
+
+	memset(pentry, 0, sizeof(DnaCacheEntry));
+	pentry->i2cAddr = i2cAddr;
+
+	if ( ! SyzygyReadStdFwRegisters(fdI2cDev, i2cAddr, &pentry->szgfwregs) ) {
+		if(dpmutilfVerbose)printf("ERROR: failed to retrieve SYZYGY standard fw registers from 0x%02X\n", i2cAddr);
+		return fFalse;
+	}
+
+	if ( ! SyzygyReadDNAHeader(fdI2cDev, i2cAddr, &pentry->szgdnahdr, fCheckCrc) ) {
+		if(dpmutilfVerbose)printf("ERROR: failed to retrieve SYZYGY DNA header from 0x%02X\n", i2cAddr);
+		return fFalse;
+	}
+
+	/* Read the strings and calibration areas with the largest transfers
+	** the pod supports. The default transfers are used if they can't
+	** be negotiated.
+	*/
+	SyzygyNegotiateXfer(fdI2cDev, i2cAddr, &pentry->szgfwregs, &pentry->szgdnahdr);
+
+	if ( ! SyzygyReadDNAStringsBuf(fdI2cDev, i2cAddr, &pentry->szgdnahdr, rgchStrings, sizeof(rgchStrings), &szgdnaStrings) ) {
+		if(dpmutilfVerbose)printf("Error: failed to retrieve SYZYGY DNA strings from 0x%02X\n", i2cAddr);
+		return fFalse;
+	}
+
+	strcpy(pentry->szManufacturerName, szgdnaStrings.szManufacturerName);
+	strcpy(pentry->szProductName, szgdnaStrings.szProductName);
+	strcpy(pentry->szProductModel, szgdnaStrings.szProductModel);
+	strcpy(pentry->szProductVersion, szgdnaStrings.szProductVersion);
+	strcpy(pentry->szSerialNumber, szgdnaStrings.szSerialNumber);
+
+	if ( 0 != strncmp(pentry->szManufacturerName, "Digilent", strlen("Digilent")) ) {
+		return fTrue;
+	}
+
+	if ( ! FZmodReadPdid(fdI2cDev, i2cAddr, &pentry->pdid) ) {
+		if(dpmutilfVerbose)printf("Error: failed to read PDID from 0x%02X\n", i2cAddr);
+		return fFalse;
+	}
+	pentry->fPdid = fTrue;
+
+	/* Read the calibration areas required by the policy, if this
+	** family of Zmod has any.
+	*/
+	if (( ! FGetZmodFamily(pentry->pdid, &family) ) ||
+		( ! FZmodGetCalLayout(family, &addrFactCal, &addrUserCal, &cbCal) ) ||
+		( cbDnaCacheCalMax < cbCal )) {
+		return fTrue;
+	}
+
+	if ( ! FZmodLoadCal(fdI2cDev, i2cAddr, family, calpol, pentry->rgbFactCal, pentry->rgbUserCal, &pentry->fsCal) ) {
+		return fFalse;
+	}
+	pentry->fCal = fTrue;
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    DnaCacheLoad
+**
+**  Parameters:
+**      none
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function loads the cache from szDnaCacheFile when
+**      persistence is enabled. A missing or incompatible file leaves
+**      the cache empty. The caller must hold the cache lock.
+*/
+static void
+DnaCacheLoad() {
+
+#if defined(__linux__)
+	FILE*				pfile;
+	DnaCacheFileHeader	hdr;
+	static DnaCacheEntry	rgentry[cDnaCacheBusMax][cDnaCachePortMax];
+#endif
+
+	fDnaCacheLoaded = fTrue;
+
+#if defined(__linux__)
+	if ( ! fDnaCachePersist ) {
+		return;
+	}
+
+	pfile = fopen(szDnaCacheFile, "rbe");
+	if ( NULL == pfile ) {
+		return;
+	}
+
+	if (( 1 == fread(&hdr, sizeof(hdr), 1, pfile) ) &&
+		( magicDnaCache == hdr.magic ) &&
+		( verDnaCache == hdr.ver ) &&
+		( cDnaCacheBusMax * cDnaCachePortMax == hdr.centry ) &&
+		( sizeof(DnaCacheEntry) == hdr.cbEntry ) &&
+		( hdr.centry == fread(rgentry, sizeof(DnaCacheEntry), hdr.centry, pfile) )) {
+		memcpy(rgentryDnaCache, rgentry, sizeof(rgentryDnaCache));
+	}
+
+	fclose(pfile);
+#endif
+}
+
+/* ------------------------------------------------------------ */
+/***    DnaCacheSave
+**
+**  Parameters:
+**      none
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function writes the cache to szDnaCacheFile. Failing to
+**      write the file isn't considered an error since the cache is
+**      still valid in-process. The caller must hold the cache lock.
+*/
+static void
+DnaCacheSave() {
+
+#if defined(__linux__)
+	FILE*				pfile;
+	DnaCacheFileHeader	hdr;
+
+	pfile = fopen(szDnaCacheFile, "wbe");
+	if ( NULL == pfile ) {
+		if ( dpmutilfVerbose ) {
+			printf("WARNING: failed to open \"%s\" for writing\n", szDnaCacheFile);
+		}
+		return;
+	}
+
+	hdr.magic = magicDnaCache;
+	hdr.ver = verDnaCache;
+	hdr.centry = cDnaCacheBusMax * cDnaCachePortMax;
+	hdr.cbEntry = sizeof(DnaCacheEntry);
+
+	fwrite(&hdr, sizeof(hdr), 1, pfile);
+	fwrite(rgentryDnaCache, sizeof(DnaCacheEntry), hdr.centry, pfile);
+
+	fclose(pfile);
+#endif
+}
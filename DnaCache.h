@@ -0,0 +1,102 @@
+/************************************************************************/
+/*                                                                      */
+/*  DnaCache.h - SYZYGY DNA cache declarations                          */
+/*                                                                      */
+/************************************************************************/
+/*  Author: Digilent Inc.                                               */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  This header file contains the declarations for functions that can   */
+/*  be used to cache the SYZYGY DNA, PDID and calibration data of the   */
+/*  SYZYGY pods attached to each SmartVIO port so that they don't need  */
+/*  to be read from the pod's flash every time the ports are            */
+/*  enumerated.                                                         */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*  10/14/2026: created                                                 */
+/*  10/14/2026: entries are now keyed by I2C bus index as well as port  */
+/*  10/14/2026: added the calibration policy and fsCal                  */
+/*  10/14/2026: added DnaCacheInvalidateAddr                            */
+/*  10/14/2026: DnaCacheLookup returns a copy of the entry              */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef DNACACHE_H_
+#define DNACACHE_H_
+
+#include "../dpmutil/syzygy.h"
+
+/* ------------------------------------------------------------ */
+/*                  Miscellaneous Declarations                  */
+/* ------------------------------------------------------------ */
+
+/* Define the number of I2C buses, and SmartVIO ports per bus, that may
+** be cached.
+*/
+#define cDnaCacheBusMax			8
+#define cDnaCachePortMax		8
+
+/* Specify this port index to DnaCacheInvalidate to invalidate the
+** entries of all ports of a bus, or this bus index to invalidate the
+** entries of all buses.
+*/
+#define ibusDnaCacheAll			0xFF
+#define iportDnaCacheAll		0xFF
+
+/* Define the maximum length of a DNA string. The length of each
+** string is stored in a single byte of the DNA header.
+*/
+#define cchDnaCacheStringMax	255
+
+/* Define the maximum size of a calibration area.
+*/
+#define cbDnaCacheCalMax		128
+
+/* Define the file used to persist the cache between processes.
+*/
+#define szDnaCacheFile			"/var/cache/dpmutil.dna"
+
+/* ------------------------------------------------------------ */
+/*                  General Type Declarations                   */
+/* ------------------------------------------------------------ */
+
+typedef struct {
+	BOOL			fValid;
+	BYTE			i2cAddr;
+	SzgStdFwRegs	szgfwregs;
+	SzgDnaHeader	szgdnahdr;
+	char			szManufacturerName[cchDnaCacheStringMax+1];
+	char			szProductName[cchDnaCacheStringMax+1];
+	char			szProductModel[cchDnaCacheStringMax+1];
+	char			szProductVersion[cchDnaCacheStringMax+1];
+	char			szSerialNumber[cchDnaCacheStringMax+1];
+	BOOL			fPdid;		// fTrue if pdid was read (Digilent pods only)
+	DWORD			pdid;
+	BOOL			fCal;		// fTrue if the calibration areas required by the policy were read
+	BYTE			fsCal;		// fsZmodCal* flags, areas that were read and are valid
+	BYTE			rgbFactCal[cbDnaCacheCalMax];
+	BYTE			rgbUserCal[cbDnaCacheCalMax];
+} DnaCacheEntry;
+
+/* ------------------------------------------------------------ */
+/*                  Variable Declarations                       */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*                  Procedure Declarations                      */
+/* ------------------------------------------------------------ */
+
+BOOL	DnaCacheLookup(int fdI2cDev, BYTE ibus, BYTE iport, BYTE i2cAddr, BOOL fCheckCrc, BOOL fRefresh, DnaCacheEntry* pentry);
+void	DnaCacheInvalidate(BYTE ibus, BYTE iport);
+void	DnaCacheInvalidateAddr(BYTE i2cAddr);
+void	DnaCacheSetPersist(BOOL fPersist);
+void	DnaCacheSetCalPolicy(BYTE calpol);
+void	DnaCacheGetStrings(DnaCacheEntry* pentry, SzgDnaStrings* pszgdnastrings);
+
+/* ------------------------------------------------------------ */
+
+#endif /* DNACACHE_H_ */
@@ -0,0 +1,665 @@
+/************************************************************************/
+/*                                                                      */
+/*  DnaProgram.c - SYZYGY DNA programming pipeline implementation       */
+/*                                                                      */
+/************************************************************************/
+/*  Author: Digilent Inc.                                               */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  This source file contains the implementation of functions that can */
+/*  be used to program the DNA and calibration areas of the SYZYGY pods */
+/*  on a carrier.                                                       */
+/*                                                                      */
+/*  Each job programs a list of page aligned regions of one pod. Every  */
+/*  page is read back first and only written if its contents differ,   */
+/*  then read back again once the pod acknowledges its address to       */
+/*  verify it. Once every page of a region has been verified the whole  */
+/*  region is read again and its incremental CRC compared with the CRC  */
+/*  of the intended contents, which also catches a page disturbed by    */
+/*  the erase or write of a later one.                                  */
+/*                                                                      */
+/*  DnaPgmRun advances the jobs of several pods in turn. While one pod  */
+/*  is busy writing a page to its flash, and doesn't acknowledge its    */
+/*  address, the pages of the other pods are compared and written, so   */
+/*  the time the pods take to write their flash overlaps instead of     */
+/*  adding up.                                                          */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*  10/14/2026: created                                                 */
+/*  10/14/2026: the flash is locked again when a job ends, and a pod is */
+/*      given a fixed time rather than a number of probes to settle     */
+/*                                                                      */
+/************************************************************************/
+
+/* ------------------------------------------------------------ */
+/*              Include File Definitions                        */
+/* ------------------------------------------------------------ */
+
+#include <stdio.h>
+#include <string.h>
+#if defined(__linux__)
+#include <time.h>
+#endif
+#include "stdtypes.h"
+#include "I2CHAL.h"
+#include "syzygy.h"
+#include "DnaCache.h"
+#include "DnaProgram.h"
+
+/* ------------------------------------------------------------ */
+/*              Miscellaneous Declarations                      */
+/* ------------------------------------------------------------ */
+
+/* Define the phases of the page being programmed by a job.
+*/
+#define dpgphCompare		0	// read the page and write it if it differs
+#define dpgphSettle			1	// wait for the pod to finish writing the page
+#define dpgphVerify			2	// check the CRC of the whole region
+
+/* Define the delay between rounds of DnaPgmRun in which every pod was
+** busy, and the time after writing a page at which a pod that still
+** doesn't acknowledge its address is considered to have failed, enough
+** for a page erase followed by a flash write.
+*/
+#define usDnaPgmPoll		250
+#define usDnaPgmSettleMax	50000
+
+/* Define the number of times a page is written before a job fails,
+** the number of times a region may fail its CRC check, and the size of
+** the chunks that the region is read in for the check.
+*/
+#define cDnaPgmWriteMax		3
+#define cDnaPgmVerifyMax	2
+#define cbDnaPgmVerifyChunk	256
+
+/* ------------------------------------------------------------ */
+/*              Local Type Definitions                          */
+/* ------------------------------------------------------------ */
+
+
+/* ------------------------------------------------------------ */
+/*              Global Variables                                */
+/* ------------------------------------------------------------ */
+
+extern I2CHALThreadLocal BOOL	dpmutilfVerbose;
+
+/* ------------------------------------------------------------ */
+/*              Local Variables                                 */
+/* ------------------------------------------------------------ */
+
+
+/* ------------------------------------------------------------ */
+/*              Forward Declarations                            */
+/* ------------------------------------------------------------ */
+
+static BOOL	FDnaPgmStep(int fdI2cDev, DnaPgmJob* pjob, UINT64 usNow);
+static BOOL	FDnaPgmCompare(int fdI2cDev, DnaPgmJob* pjob, UINT64 usNow);
+static BOOL	FDnaPgmVerify(int fdI2cDev, DnaPgmJob* pjob);
+static void	DnaPgmLock(int fdI2cDev, DnaPgmJob* pjob);
+static void	DnaPgmFail(DnaPgmJob* pjob, const char* szErr);
+#if defined(__linux__)
+static UINT64	UsDnaPgmNow();
+#endif
+
+/* ------------------------------------------------------------ */
+/*              Procedure Definitions                           */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/***    DnaPgmJobInit
+**
+**  Parameters:
+**      pjob            - job to initialize
+**      i2cAddr         - I2C bus address of the SYZYGY pod to program
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function initializes a job that programs no regions and
+**      doesn't unlock or lock the flash of the pod.
+*/
+void
+DnaPgmJobInit(DnaPgmJob* pjob, BYTE i2cAddr) {
+
+	memset(pjob, 0, sizeof(DnaPgmJob));
+	pjob->i2cAddr = i2cAddr;
+	pjob->dpgst = dpgstActive;
+	pjob->dpgph = dpgphCompare;
+}
+
+/* ------------------------------------------------------------ */
+/***    DnaPgmJobSetUnlock
+**
+**  Parameters:
+**      pjob            - job
+**      pbUnlock        - bytes to write to addrFlashMagic
+**      cbUnlock        - number of bytes, 0 to not unlock the flash
+**
+**  Return Value:
+**      fTrue for success, fFalse if cbUnlock exceeds cbDnaPgmUnlockMax
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function sets the magic number written to addrFlashMagic
+**      of the pod, using acknowledge polling, before the first page that
+**      differs is written. The value depends on the pMCU firmware of
+**      the pod, so it's supplied by the caller.
+*/
+BOOL
+DnaPgmJobSetUnlock(DnaPgmJob* pjob, const BYTE* pbUnlock, BYTE cbUnlock) {
+
+	if ( cbDnaPgmUnlockMax < cbUnlock ) {
+		return fFalse;
+	}
+
+	memcpy(pjob->rgbUnlock, pbUnlock, cbUnlock);
+	pjob->cbUnlock = cbUnlock;
+	pjob->fUnlocked = fFalse;
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    DnaPgmJobSetLock
+**
+**  Parameters:
+**      pjob            - job
+**      pbLock          - bytes to write to addrFlashMagic
+**      cbLock          - number of bytes, 0 to leave the flash unlocked
+**
+**  Return Value:
+**      fTrue for success, fFalse if cbLock exceeds cbDnaPgmUnlockMax
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function sets the magic number written to addrFlashMagic
+**      of the pod when the job is done or fails, if the flash was
+**      unlocked by the job, so that the pod isn't left writable.
+*/
+BOOL
+DnaPgmJobSetLock(DnaPgmJob* pjob, const BYTE* pbLock, BYTE cbLock) {
+
+	if ( cbDnaPgmUnlockMax < cbLock ) {
+		return fFalse;
+	}
+
+	memcpy(pjob->rgbLock, pbLock, cbLock);
+	pjob->cbLock = cbLock;
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    DnaPgmJobAddRegion
+**
+**  Parameters:
+**      pjob            - job
+**      addr            - first address of the region
+**      pb              - contents to program
+**      cb              - number of bytes to program
+**
+**  Return Value:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      Returns fFalse if addr isn't a multiple of cbDnaPgmPage, the
+**      region is empty or extends past the end of the address space, or
+**      the job already has cDnaPgmRegionMax regions.
+**
+**  Description:
+**      This function adds a region, such as the DNA at addrDnaStart or
+**      the user calibration area of a Zmod, to the regions programmed
+**      by the job. Regions are programmed in the order they're added.
+**      The contents must remain valid until the job is done.
+*/
+BOOL
+DnaPgmJobAddRegion(DnaPgmJob* pjob, WORD addr, const BYTE* pb, WORD cb) {
+
+	DnaPgmRegion*	prgn;
+
+	if (( 0 != (addr % cbDnaPgmPage) ) || ( NULL == pb ) || ( 0 == cb ) ||
+		( 0x10000 < (DWORD)addr + cb ) || ( cDnaPgmRegionMax <= pjob->crgn )) {
+		return fFalse;
+	}
+
+	prgn = &pjob->rgrgn[pjob->crgn];
+	prgn->addr = addr;
+	prgn->pb = pb;
+	prgn->cb = cb;
+	pjob->crgn++;
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    DnaPgmRun
+**
+**  Parameters:
+**  	fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      rgjob           - jobs of the pods on the carrier, each with a
+**                        different I2C address
+**      cjob            - number of jobs
+**
+**  Return Value:
+**      fTrue if every job is done, fFalse otherwise
+**
+**  Errors:
+**      Returns fFalse if any job failed. The dpgst field of each job
+**      indicates whether it's done or failed.
+**
+**  Description:
+**      This function programs the pods of the specified jobs. Each job
+**      performs one step in turn: a page is compared and written, or
+**      a pod that's writing a page is probed, or a region is verified.
+**      The function returns once every job is done or has failed. The
+**      flash of a pod that was unlocked is locked again as soon as its
+**      job is done or fails.
+**
+**      Calling the function again with a job that failed resumes it
+**      from the page that failed, unlocking the flash again before the
+**      next write. Pages that were verified aren't read again until the
+**      CRC of the whole region is checked, and jobs that are done
+**      aren't touched.
+**
+**      The DNA cache entries of the pod of every job that wrote a page
+**      or failed, and may have written part of one, are invalidated
+**      once the jobs end, so that the next enumeration reads the new
+**      DNA and calibration from the pod.
+**
+**      A pod that doesn't acknowledge its address usDnaPgmSettleMax
+**      after a page was written fails. There's no time base available
+**      on bare metal, so there the time is the sum of the delays of the
+**      rounds in which every pod was busy. This ignores the time spent
+**      on the bus and therefore errs on the side of waiting longer.
+*/
+BOOL
+DnaPgmRun(int fdI2cDev, DnaPgmJob* rgjob, BYTE cjob) {
+
+	BYTE	ijob;
+	BYTE	cjobActive;
+	BOOL	fProgress;
+	BOOL	fRet;
+	UINT64	usNow;
+
+	/* A failed job is resumed with its flash locked, as it was left
+	** when it failed, unless locking it is what failed after every
+	** region was verified, in which case the lock is written again.
+	** A job that failed while verifying a region has ipg past the end
+	** of the region and is resumed by verifying it again.
+	*/
+	for ( ijob = 0; ijob < cjob; ijob++ ) {
+		if ( dpgstFailed == rgjob[ijob].dpgst ) {
+			rgjob[ijob].dpgst = dpgstActive;
+			rgjob[ijob].dpgph = dpgphCompare;
+			rgjob[ijob].cwrite = 0;
+			rgjob[ijob].cverify = 0;
+			if ( rgjob[ijob].irgn < rgjob[ijob].crgn ) {
+				rgjob[ijob].fUnlocked = fFalse;
+				if ( rgjob[ijob].rgrgn[rgjob[ijob].irgn].cb <= (DWORD)rgjob[ijob].ipg * cbDnaPgmPage ) {
+					rgjob[ijob].dpgph = dpgphVerify;
+				}
+			}
+		}
+		if (( dpgstActive == rgjob[ijob].dpgst ) && ( rgjob[ijob].irgn >= rgjob[ijob].crgn )) {
+			rgjob[ijob].dpgst = dpgstDone;
+			DnaPgmLock(fdI2cDev, &rgjob[ijob]);
+		}
+	}
+
+#if defined(__linux__)
+	usNow = UsDnaPgmNow();
+#else
+	usNow = 0;
+#endif
+
+	do {
+		cjobActive = 0;
+		fProgress = fFalse;
+		for ( ijob = 0; ijob < cjob; ijob++ ) {
+			if ( dpgstActive != rgjob[ijob].dpgst ) {
+				continue;
+			}
+			if ( FDnaPgmStep(fdI2cDev, &rgjob[ijob], usNow) ) {
+				fProgress = fTrue;
+			}
+			if ( dpgstActive == rgjob[ijob].dpgst ) {
+				cjobActive++;
+			}
+			else {
+				DnaPgmLock(fdI2cDev, &rgjob[ijob]);
+			}
+		}
+
+		/* Every pod that still has pages to program is busy, wait
+		** before probing them again.
+		*/
+		if (( 0 < cjobActive ) && ( ! fProgress )) {
+			I2CHALDelay(fdI2cDev, usDnaPgmPoll);
+#if !defined(__linux__)
+			usNow += usDnaPgmPoll;
+#endif
+		}
+#if defined(__linux__)
+		usNow = UsDnaPgmNow();
+#endif
+	} while ( 0 < cjobActive );
+
+	fRet = fTrue;
+	for ( ijob = 0; ijob < cjob; ijob++ ) {
+		if (( 0 < rgjob[ijob].cpgWritten ) || ( dpgstFailed == rgjob[ijob].dpgst )) {
+			DnaCacheInvalidateAddr(rgjob[ijob].i2cAddr);
+		}
+		if ( dpgstDone != rgjob[ijob].dpgst ) {
+			fRet = fFalse;
+		}
+	}
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/*          Local Functions                                     */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/***    FDnaPgmStep
+**
+**  Parameters:
+**  	fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      pjob            - active job
+**      usNow           - current time of DnaPgmRun, in microseconds
+**
+**  Return Value:
+**      fTrue if the job did anything other than probe a busy pod
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function performs the next step of a job.
+*/
+static BOOL
+FDnaPgmStep(int fdI2cDev, DnaPgmJob* pjob, UINT64 usNow) {
+
+	switch ( pjob->dpgph ) {
+		case dpgphSettle:
+			if ( ! I2CHALProbe(fdI2cDev, pjob->i2cAddr) ) {
+				if ( usDnaPgmSettleMax <= usNow - pjob->usWrite ) {
+					DnaPgmFail(pjob, "pod didn't acknowledge after writing a page");
+					return fTrue;
+				}
+				return fFalse;
+			}
+			pjob->dpgph = dpgphCompare;
+			return FDnaPgmCompare(fdI2cDev, pjob, usNow);
+
+		case dpgphVerify:
+			return FDnaPgmVerify(fdI2cDev, pjob);
+
+		default:
+			return FDnaPgmCompare(fdI2cDev, pjob, usNow);
+	}
+}
+
+/* ------------------------------------------------------------ */
+/***    FDnaPgmCompare
+**
+**  Parameters:
+**  	fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      pjob            - active job
+**      usNow           - current time of DnaPgmRun, in microseconds
+**
+**  Return Value:
+**      fTrue
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function reads the current page of a job. If it holds its
+**      intended contents the job moves on to the next page, or to
+**      verifying the region after its last page. Otherwise the page is
+**      written, in a single transaction without waiting for the pod to
+**      finish, and the job waits for the pod to acknowledge its
+**      address before reading the page back.
+*/
+static BOOL
+FDnaPgmCompare(int fdI2cDev, DnaPgmJob* pjob, UINT64 usNow) {
+
+	const DnaPgmRegion*	prgn;
+	BYTE				rgbPage[cbDnaPgmPage];
+	const BYTE*			pbPage;
+	WORD				addrPage;
+	DWORD				ibPage;
+	WORD				cbPage;
+
+	/* A page past the end of the region, such as one restored by the
+	** caller, means that every page has been programmed and the region
+	** only remains to be verified.
+	*/
+	prgn = &pjob->rgrgn[pjob->irgn];
+	ibPage = (DWORD)pjob->ipg * cbDnaPgmPage;
+	if ( prgn->cb <= ibPage ) {
+		pjob->dpgph = dpgphVerify;
+		return fTrue;
+	}
+	addrPage = prgn->addr + ibPage;
+	pbPage = prgn->pb + ibPage;
+	cbPage = prgn->cb - ibPage;
+	if ( cbDnaPgmPage < cbPage ) {
+		cbPage = cbDnaPgmPage;
+	}
+
+	if ( ! SyzygyI2cRead(fdI2cDev, pjob->i2cAddr, addrPage, rgbPage, cbPage, NULL) ) {
+		DnaPgmFail(pjob, "failed to read a page");
+		return fTrue;
+	}
+
+	if ( 0 == memcmp(rgbPage, pbPage, cbPage) ) {
+		if ( 0 == pjob->cwrite ) {
+			pjob->cpgSkipped++;
+		}
+		pjob->cwrite = 0;
+		pjob->ipg++;
+		if ( prgn->cb <= (DWORD)pjob->ipg * cbDnaPgmPage ) {
+			pjob->dpgph = dpgphVerify;
+		}
+		return fTrue;
+	}
+
+	if ( cDnaPgmWriteMax <= pjob->cwrite ) {
+		DnaPgmFail(pjob, "page doesn't match after writing it");
+		return fTrue;
+	}
+
+	if (( 0 < pjob->cbUnlock ) && ( ! pjob->fUnlocked )) {
+		if ( ! SyzygyI2cWrite(fdI2cDev, pjob->i2cAddr, addrFlashMagic, pjob->rgbUnlock, pjob->cbUnlock, NULL) ) {
+			DnaPgmFail(pjob, "failed to unlock the flash");
+			return fTrue;
+		}
+		pjob->fUnlocked = fTrue;
+	}
+
+	if ( ! I2CHALWrite(fdI2cDev, pjob->i2cAddr, addrPage, (BYTE*)pbPage, cbPage, 2 + cbDnaPgmPage, NULL, 0, 0) ) {
+		DnaPgmFail(pjob, "failed to write a page");
+		return fTrue;
+	}
+
+	if ( 0 == pjob->cwrite ) {
+		pjob->cpgWritten++;
+	}
+	pjob->cwrite++;
+	pjob->usWrite = usNow;
+	pjob->dpgph = dpgphSettle;
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    FDnaPgmVerify
+**
+**  Parameters:
+**  	fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      pjob            - active job whose current region has been programmed
+**
+**  Return Value:
+**      fTrue
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function reads the current region of a job through an
+**      incremental CRC and compares it with the CRC of the intended
+**      contents. If they match the job moves on to the next region, or
+**      is done after the last one. Otherwise the region is programmed
+**      again from its first page, which only writes the pages that
+**      differ, up to cDnaPgmVerifyMax times.
+*/
+static BOOL
+FDnaPgmVerify(int fdI2cDev, DnaPgmJob* pjob) {
+
+	const DnaPgmRegion*	prgn;
+	BYTE				rgbChunk[cbDnaPgmVerifyChunk];
+	SzgCrc				crc;
+	WORD				ib;
+	WORD				cbChunk;
+
+	prgn = &pjob->rgrgn[pjob->irgn];
+
+	SyzygyCrcInit(&crc);
+	for ( ib = 0; ib < prgn->cb; ib += cbChunk ) {
+		cbChunk = prgn->cb - ib;
+		if ( cbDnaPgmVerifyChunk < cbChunk ) {
+			cbChunk = cbDnaPgmVerifyChunk;
+		}
+		if ( ! SyzygyI2cRead(fdI2cDev, pjob->i2cAddr, prgn->addr + ib, rgbChunk, cbChunk, NULL) ) {
+			DnaPgmFail(pjob, "failed to read the region back");
+			return fTrue;
+		}
+		SyzygyCrcUpdate(&crc, rgbChunk, cbChunk);
+	}
+
+	if ( SyzygyComputeCRC(prgn->pb, prgn->cb) != SyzygyCrcFinal(&crc) ) {
+		pjob->cverify++;
+		pjob->ipg = 0;
+		pjob->dpgph = dpgphCompare;
+		if ( cDnaPgmVerifyMax <= pjob->cverify ) {
+			DnaPgmFail(pjob, "CRC of the region doesn't match");
+		}
+		return fTrue;
+	}
+
+	pjob->irgn++;
+	pjob->ipg = 0;
+	pjob->cverify = 0;
+	pjob->dpgph = dpgphCompare;
+	if ( pjob->crgn <= pjob->irgn ) {
+		pjob->dpgst = dpgstDone;
+	}
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    DnaPgmLock
+**
+**  Parameters:
+**  	fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      pjob            - job that is done or failed
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      A job that is done fails if the lock bytes can't be written, and
+**      locking is attempted again when it's resumed.
+**
+**  Description:
+**      This function writes the lock bytes of a job to addrFlashMagic
+**      if the job unlocked the flash of its pod. A job that already
+**      failed is left failed whether or not the lock was written, since
+**      resuming it unlocks the flash again.
+*/
+static void
+DnaPgmLock(int fdI2cDev, DnaPgmJob* pjob) {
+
+	if ( ! pjob->fUnlocked ) {
+		return;
+	}
+
+	if (( 0 < pjob->cbLock ) &&
+		( ! SyzygyI2cWrite(fdI2cDev, pjob->i2cAddr, addrFlashMagic, pjob->rgbLock, pjob->cbLock, NULL) )) {
+		if ( dpgstDone == pjob->dpgst ) {
+			DnaPgmFail(pjob, "failed to lock the flash");
+			return;
+		}
+		if(dpmutilfVerbose)printf("ERROR: DnaPgmRun - failed to lock the flash, pod 0x%02X\n", pjob->i2cAddr);
+	}
+
+	pjob->fUnlocked = fFalse;
+}
+
+/* ------------------------------------------------------------ */
+/***    DnaPgmFail
+**
+**  Parameters:
+**      pjob            - job that failed
+**      szErr           - description of the failure
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function marks a job as failed, leaving irgn and ipg at the
+**      page to resume from.
+*/
+static void
+DnaPgmFail(DnaPgmJob* pjob, const char* szErr) {
+
+	pjob->dpgst = dpgstFailed;
+	if(dpmutilfVerbose)printf("ERROR: DnaPgmRun - %s, pod 0x%02X region %d page %d\n", szErr, pjob->i2cAddr, pjob->irgn, pjob->ipg);
+}
+
+#if defined(__linux__)
+/* ------------------------------------------------------------ */
+/***    UsDnaPgmNow
+**
+**  Parameters:
+**      none
+**
+**  Return Value:
+**      current value of CLOCK_MONOTONIC in microseconds
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function returns the time used to measure how long a pod
+**      takes to write a page.
+*/
+static UINT64
+UsDnaPgmNow() {
+
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((UINT64)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+#endif
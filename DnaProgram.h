@@ -0,0 +1,111 @@
+/************************************************************************/
+/*                                                                      */
+/*  DnaProgram.h - SYZYGY DNA programming pipeline declarations         */
+/*                                                                      */
+/************************************************************************/
+/*  Author: Digilent Inc.                                               */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  This header file contains the declarations for functions that can   */
+/*  be used to program the DNA and calibration areas of the SYZYGY pods */
+/*  on a carrier. Only the pages whose contents differ are written,     */
+/*  each region is verified with a CRC once it has been programmed, and */
+/*  a job that fails can be resumed from its last verified page. The    */
+/*  pods of several jobs are written in turn so that one pod is written */
+/*  while the others complete their previous flash write.               */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*  10/14/2026: created                                                 */
+/*  10/14/2026: added DnaPgmJobSetLock, the settle timeout is in time   */
+/*      rather than probes                                              */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef DNAPROGRAM_H_
+#define DNAPROGRAM_H_
+
+#include "../dpmutil/syzygy.h"
+
+/* ------------------------------------------------------------ */
+/*                  Miscellaneous Declarations                  */
+/* ------------------------------------------------------------ */
+
+/* Define the size of a page, the flash page buffered by the pMCU
+** firmware before it's written, the maximum number of regions that may
+** be programmed by a single job, and the maximum number of bytes that
+** may be written to addrFlashMagic to unlock or lock the flash.
+*/
+#define cbDnaPgmPage			32
+#define cDnaPgmRegionMax		4
+#define cbDnaPgmUnlockMax		4
+
+/* Define the states of a job.
+*/
+#define dpgstActive				0	// pages remain to be programmed
+#define dpgstDone				1	// every region has been programmed and verified
+#define dpgstFailed				2	// a page couldn't be programmed, see irgn and ipg
+
+/* ------------------------------------------------------------ */
+/*                  General Type Declarations                   */
+/* ------------------------------------------------------------ */
+
+typedef struct {
+	WORD		addr;		// first address, a multiple of cbDnaPgmPage
+	const BYTE*	pb;			// contents to program
+	WORD		cb;
+} DnaPgmRegion;
+
+typedef struct {
+	BYTE			i2cAddr;
+	BYTE			rgbUnlock[cbDnaPgmUnlockMax];
+	BYTE			cbUnlock;		// bytes written to addrFlashMagic before the first page, 0 for none
+	BYTE			rgbLock[cbDnaPgmUnlockMax];
+	BYTE			cbLock;			// bytes written to addrFlashMagic once the job ends, 0 for none
+	DnaPgmRegion	rgrgn[cDnaPgmRegionMax];
+	BYTE			crgn;
+
+	/* Progress of the job. Every page before page ipg of region irgn
+	** has been verified, as has every region before irgn. These may be
+	** saved and copied into a new job with the same regions to resume
+	** programming in another process.
+	*/
+	BYTE			dpgst;
+	BYTE			irgn;
+	WORD			ipg;
+
+	/* State of the page being programmed.
+	*/
+	BYTE			dpgph;
+	BYTE			cwrite;			// writes of the page
+	UINT64			usWrite;		// time of the last write, see DnaPgmRun
+	BYTE			cverify;		// verifications of the region that failed
+	BOOL			fUnlocked;		// the unlock bytes were written and the lock bytes weren't
+
+	/* Number of pages that already held their contents and number of
+	** pages that were written.
+	*/
+	WORD			cpgSkipped;
+	WORD			cpgWritten;
+} DnaPgmJob;
+
+/* ------------------------------------------------------------ */
+/*                  Variable Declarations                       */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*                  Procedure Declarations                      */
+/* ------------------------------------------------------------ */
+
+void	DnaPgmJobInit(DnaPgmJob* pjob, BYTE i2cAddr);
+BOOL	DnaPgmJobSetUnlock(DnaPgmJob* pjob, const BYTE* pbUnlock, BYTE cbUnlock);
+BOOL	DnaPgmJobSetLock(DnaPgmJob* pjob, const BYTE* pbLock, BYTE cbLock);
+BOOL	DnaPgmJobAddRegion(DnaPgmJob* pjob, WORD addr, const BYTE* pb, WORD cb);
+BOOL	DnaPgmRun(int fdI2cDev, DnaPgmJob* rgjob, BYTE cjob);
+
+/* ------------------------------------------------------------ */
+
+#endif /* DNAPROGRAM_H_ */
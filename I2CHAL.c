@@ -18,6 +18,31 @@
 /*	08/22/2019 (MIchaelA): rewrote PmcuI2cWrite based to work within	*/
 /*      the limitations of the PMCU firmware                            */
 /*	05/04/2020 (ThomasK): changed to I2CHAL. added baremetal support. 	*/
+/*	10/14/2026: added I2CHALEnumI2cControllers and						*/
+/*		I2CHALOpenI2cControllerPath for boards with several PMCU buses	*/
+/*	10/14/2026: added per controller locking, I2CHALLock/I2CHALUnlock	*/
+/*		and per thread error state. Controllers are opened O_CLOEXEC	*/
+/*	10/14/2026: added transfer statistics, collected when built with	*/
+/*		DPMUTIL_STATS defined											*/
+/*	10/14/2026: added pluggable backends, I2CHALOpenBackend, and		*/
+/*		I2CHALDelay														*/
+/*	10/14/2026: I2CHALOpenI2cController opens the controller named by	*/
+/*		I2CHALSetControllerPath or DPMUTIL_I2C_DEV, or the one found by	*/
+/*		the last search, before searching sysfs							*/
+/*	10/14/2026: added interrupt driven transfers on bare metal. All		*/
+/*		bare metal transfers go through FIicSend and FIicRecv			*/
+/*	10/14/2026: added per slave timing profiles, I2CHALSetClockRate and	*/
+/*		I2CHALGetClockRate. The Linux split read waits uWait instead of	*/
+/*		a fixed 50us													*/
+/*	10/14/2026: I2CHALRead and I2CHALWrite take size_t lengths and		*/
+/*		profiles may raise the transaction sizes above 32 bytes, added	*/
+/*		I2CHALNegotiateReadMax											*/
+/*	10/14/2026: I2CHALBatchSubmit only retries the reads of a failed	*/
+/*		I2C_RDWR, its writes are reported as failed						*/
+/*	10/14/2026: interrupt driven transfers time out and are aborted		*/
+/*	10/14/2026: the lock is shared by the descriptors of a controller	*/
+/*		and I2CHALLock fails when no lock can be allocated				*/
+/*	10/14/2026: the default backend is read under mtxI2cBusTable		*/
 /*                                                                      */
 /************************************************************************/
 
@@ -31,10 +56,17 @@
 #include <unistd.h>
 #include <stdio.h>
 #include <string.h>
+#include <linux/i2c.h>
 #include <linux/i2c-dev.h>
+#include <sys/ioctl.h>
 #include <time.h>
 #include <sys/types.h>
 #include <dirent.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
 const char  szI2cDeviceName[] = "pmcu-i2c";
 const char	szI2cDeviceNameDefault[] = "/dev/i2c-0";
 #else
@@ -43,6 +75,7 @@ static BOOL Iic_Init=fFalse;
 #include "sleep.h"
 #endif
 #include <stdio.h>
+#include <string.h>
 
 
 /* ------------------------------------------------------------ */
@@ -50,30 +83,257 @@ static BOOL Iic_Init=fFalse;
 /* ------------------------------------------------------------ */
 
 /*
- * PS I2C Clock Rate
+ * PS I2C Clock Rate, used unless I2CHALSetClockRate is called
  */
 #define IIC_SCLK_RATE 		400000
 
+/* Define the number of reads performed at each delay tried by
+** I2CHALCalibrateReadTiming.
+*/
+#define cI2cCalibrateIter	8
+
+/* Define the largest range that I2CHALCalibrateReadTiming and
+** I2CHALNegotiateReadMax compare against.
+*/
+#define cbCalibrateRefMax	256
+
+/* Define the number of microseconds to wait between consecutive
+** acknowledge polls while a slave is busy completing a write.
+*/
+#define usAckPollInterval	250
+
+/* Define the interval at which an interrupt driven transfer checks its
+** completion flag when the application doesn't provide pfnWait.
+*/
+#define usIicIrqSpin		10
+
+/* Define the largest write transaction, including the memory address,
+** used with a slave whose timing profile doesn't specify one. The
+** buffer that holds a transaction is cbI2cWriteTransLimit bytes.
+*/
+#define cbWriteTransMax		34
+
+/* Define the maximum number of I2C controllers that may be open at
+** the same time, and the maximum number of file descriptors of those
+** controllers whose state is cached.
+*/
+#define cI2cBusMax			8
+#define cI2cFdMax			32
+
+/* Define the maximum number of bytes retrieved by a single read
+** message from a slave whose timing profile doesn't specify one and
+** the maximum number of messages that may be passed to a single
+** I2C_RDWR ioctl.
+*/
+#define cbReadTransMax		32
+#if defined(__linux__)
+#define cI2cRdwrMsgMax		I2C_RDWR_IOCTL_MAX_MSGS
+#endif
+
+/* Define the file descriptors returned by I2CHALOpenBackend. They start
+** well above any file descriptor returned by the kernel so that the two
+** can't collide.
+*/
+#define fdI2cBackendBase	0x40000000
+#define cI2cBackendMax		8
+
 /* ------------------------------------------------------------ */
 /*              Local Type Definitions                          */
 /* ------------------------------------------------------------ */
 
+#if defined(__linux__)
+/* State shared by every open file descriptor of an I2C controller, or
+** of a backend context. A controller is identified by the device number
+** of its device node, so descriptors opened separately, such as those
+** of two sessions, share the lock.
+*/
+typedef struct {
+	int		cfd;		// file descriptors referencing the entry, 0 if it's free
+	dev_t	rdev;		// device number of the controller, 0 for a backend
+	void*	pvBackend;	// context of the backend, NULL for a controller
+	BOOL	fMtxInit;	// mtx has been initialized, it's kept when the entry is reused
+	pthread_mutex_t	mtx;	// serializes transfers on this controller, recursive
+} I2cCtrlState;
+
+/* State cached for each open I2C controller file descriptor.
+*/
+typedef struct {
+	BOOL	fInUse;
+	int		fdI2cDev;
+	int		addrSlave;	// slave address last set with I2C_SLAVE, -1 if unknown
+	BOOL	fFuncsValid;	// fTrue once I2C_FUNCS has been queried
+	BOOL	fRdwr;		// adapter supports combined I2C_RDWR transactions
+	I2cCtrlState*	pctrl;	// state of the controller, NULL if none could be allocated
+#if defined(DPMUTIL_STATS)
+	int		istat;		// index of the statistics of the controller, -1 if not assigned
+#endif
+} I2cBusState;
+
+/* State of a file descriptor returned by I2CHALOpenBackend.
+*/
+typedef struct {
+	BOOL				fInUse;
+	const I2cBackend*	pbe;
+	void*				pvContext;
+	BYTE				addrSlave;	// slave addressed by CbI2cRead and CbI2cWrite
+} I2cBackendState;
+#endif
+
+#if defined(DPMUTIL_STATS)
+/* Statistics of the I2CHAL call being performed by a thread. Calls made
+** by another I2CHAL call, such as the acknowledge polling performed by
+** a write, are accounted to the outermost call.
+*/
+typedef struct {
+	BYTE	cdepth;		// nesting of the I2CHAL calls in progress
+	UINT32	cchunk;
+	UINT32	cretry;
+	UINT64	usSleep;
+	UINT64	usStart;
+} I2cStatCall;
+#endif
 
 /* ------------------------------------------------------------ */
 /*              Global Variables                                */
 /* ------------------------------------------------------------ */
 
-extern BOOL	dpmutilfVerbose;
+extern I2CHALThreadLocal BOOL	dpmutilfVerbose;
 
 /* ------------------------------------------------------------ */
 /*              Local Variables                                 */
 /* ------------------------------------------------------------ */
 
+#if defined(__linux__)
+/* Each entry is only used by the thread that owns its file descriptor
+** but the table itself is shared, so allocating and releasing entries
+** is serialized.
+*/
+static I2cBusState		rgbusI2c[cI2cFdMax];
+static I2cCtrlState		rgctrlI2c[cI2cBusMax];
+static pthread_mutex_t	mtxI2cBusTable = PTHREAD_MUTEX_INITIALIZER;
+
+/* Backends are allocated and released under mtxI2cBusTable. The backend
+** opened by I2CHALOpenI2cController, if any, is set by
+** I2CHALSetDefaultBackend and is also protected by mtxI2cBusTable.
+*/
+static I2cBackendState		rgbeI2c[cI2cBackendMax];
+static const I2cBackend*	pbeI2cDefault = NULL;
+static void*				pvI2cDefault = NULL;
+
+/* Device node set by I2CHALSetControllerPath, also protected by
+** mtxI2cBusTable. An empty string if none has been set.
+*/
+static char					szI2cDevPathSet[cchI2cDevPathMax+1] = "";
+#endif
+
+/* Timing profiles, keyed by slave address. Profiles apply to every
+** controller.
+*/
+static I2cTimingProfile		rgprofI2c[cI2cTimingProfileMax];
+static BYTE					cprofI2c = 0;
+#if defined(__linux__)
+static pthread_mutex_t		mtxI2cTiming = PTHREAD_MUTEX_INITIALIZER;
+#elif defined(PLATFORM_ZYNQ)
+static UINT32				hzIicScl = IIC_SCLK_RATE;
+#endif
+
+#if !defined(__linux__)
+/* State of the interrupt driven transfer mode. The completion flags are
+** written by the interrupt handler.
+*/
+static BOOL				fIicIrq = fFalse;
+static I2cIrqHooks		hooksIic;
+static volatile BOOL	fIicIrqDone;
+static volatile BOOL	fIicIrqError;
+#endif
+
+/* Result of the last I2CHAL transfer performed by the calling thread.
+*/
+static I2CHALThreadLocal int	errI2cLast = 0;
+
+#if defined(DPMUTIL_STATS)
+/* Statistics are kept per controller rather than per file descriptor so
+** that they accumulate across the open and close performed by each of
+** the dpmutilF functions. On Linux controllers are identified by their
+** device number.
+*/
+static I2cStats							statsI2c;
+static I2CHALThreadLocal I2cStatCall	statcallI2c;
+#if defined(__linux__)
+static dev_t							rgrdevStat[cI2cStatBusMax];
+static pthread_mutex_t					mtxI2cStats = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+#define I2cStatBegin()							StatBegin()
+#define I2cStatEnd(fd, addr, call, cbR, cbW, f)	StatEnd(fd, addr, call, cbR, cbW, f)
+#define I2cStatEndBatch(pbatch, cop, f)			StatEndBatch(pbatch, cop, f)
+#define I2cStatChunk()							(statcallI2c.cchunk++)
+#define I2cStatRetry(cop)						(statcallI2c.cretry += (cop))
+#else
+#define I2cStatBegin()
+#define I2cStatEnd(fd, addr, call, cbR, cbW, f)
+#define I2cStatEndBatch(pbatch, cop, f)
+#define I2cStatChunk()
+#define I2cStatRetry(cop)
+#endif
 
 /* ------------------------------------------------------------ */
 /*              Forward Declarations                            */
 /* ------------------------------------------------------------ */
 
+#if defined(__linux__)
+static I2cBusState*	PbusFromFd(int fdI2cDev, BOOL fCreate);
+static void			I2cBusRelease(int fdI2cDev);
+static I2cCtrlState*	PctrlAcquire(int fdI2cDev);
+static int			FCompareDevPath(const void* pv1, const void* pv2);
+static BOOL			FI2cGetCachePath(char* szCachePath);
+static BOOL			FI2cSysfsNameIno(const char* szDevPath, ino_t* pino);
+static BOOL			FI2cReadCache(const char* szCachePath, char* szDevPath);
+static void			I2cWriteCache(const char* szCachePath, const char* szDevPath);
+static BOOL			FI2cSetSlave(int fdI2cDev, BYTE slaveAddr);
+static BOOL			FI2cRdwrSupported(int fdI2cDev);
+static BOOL			FI2cBatchSubmitRdwr(I2cBatch* pbatch, BYTE iopFirst, BYTE iopLast);
+static I2cBackendState*	PbeFromFd(int fdI2cDev);
+static ssize_t		CbI2cRead(int fdI2cDev, BYTE* pb, size_t cb);
+static ssize_t		CbI2cWrite(int fdI2cDev, const BYTE* pb, size_t cb);
+static BOOL			FI2cRdwr(int fdI2cDev, struct i2c_rdwr_ioctl_data* prdwr);
+static WORD			CbI2cReadMax(BYTE slaveAddr);
+#endif
+static BOOL			FI2cBatchSubmitOp(I2cBatch* pbatch, BYTE iop);
+static BOOL			FI2cProbeUnlocked(int fdI2cDev, BYTE slaveAddr);
+static BOOL			FI2cWaitAckUnlocked(int fdI2cDev, BYTE slaveAddr, UINT32 uTimeout);
+static BOOL			FI2cReadUnlocked(int fdI2cDev, BYTE slaveAddr, WORD addrRead, BYTE* pbRead, size_t cbRead, size_t* pcbRead, UINT32 uWait, WORD cbTransMax);
+static BOOL			FI2cWriteUnlocked(int fdI2cDev, BYTE slaveAddr, WORD addrWrite, BYTE* pbWrite, size_t cbWrite, INT32 cbDevRxMax, size_t* pcbWritten, INT32 uWait, UINT32 uAckTimeout);
+static BOOL			FI2cBatchSubmitUnlocked(I2cBatch* pbatch);
+#if defined(__linux__)
+static void			I2cBatchRetryReads(I2cBatch* pbatch, BYTE iopFirst, BYTE iopLast);
+#endif
+static void			SetLastError(BOOL fSuccess);
+static void			I2cResolveTiming(I2cTimingProfile* ptmg);
+static BOOL			FI2cCalibrateRead(int fdI2cDev, BYTE slaveAddr, WORD addrRead, WORD cbRead, const BYTE* pbRef, UINT32 usPreRead, WORD cbTransMax, BYTE citer);
+#if defined(__linux__)
+static void			I2cNanosleep(int fdI2cDev, const struct timespec* pts);
+#else
+static void			I2cUsleep(UINT32 us);
+static BOOL			FIicSend(BYTE slaveAddr, BYTE* pbSnd, WORD cbSnd);
+static BOOL			FIicRecv(BYTE slaveAddr, BYTE* pbRecv, WORD cbRecv);
+static BOOL			FIicIrqWait();
+static void			IicIrqAbort();
+#if defined(PLATFORM_ZYNQ)
+static void			IicIrqStatusHandler(void* pvCallBackRef, u32 evt);
+#else
+static void			IicIrqXferHandler(void* pvCallBackRef, int cbRemaining);
+static void			IicIrqStatusHandler(void* pvCallBackRef, int evt);
+#endif
+#endif
+#if defined(DPMUTIL_STATS)
+static UINT64			UsStatNow();
+static void			StatBegin();
+static void			StatEnd(int fdI2cDev, BYTE slaveAddr, BYTE icall, UINT32 cbRead, UINT32 cbWrite, BOOL fSuccess);
+static void			StatEndBatch(I2cBatch* pbatch, BYTE cop, BOOL fSuccess);
+static I2cBusStats*	PbusstatFromFd(int fdI2cDev);
+static void			StatAdd(I2cStatCounters* pcnt, BYTE icall, BOOL fSuccess, UINT32 cbRead, UINT32 cbWrite, const I2cStatCall* pcall, INT64 usElapsed);
+#endif
 
 /* ------------------------------------------------------------ */
 /*              Procedure Definitions                           */
@@ -97,15 +357,179 @@ extern BOOL	dpmutilfVerbose;
 **  Description:
 **      This function opens a file descriptor to the I2C controller
 **      that's connected to I2C bus shared by the Platform MCU and
-**      SmartVIO ports.
+**      SmartVIO ports. If more than one such controller exists then
+**      the first one returned by I2CHALEnumI2cControllers is opened.
+**      If a default backend has been set with I2CHALSetDefaultBackend
+**      then it's opened instead.
+**
+**      Searching sysfs reads the device tree node name of every I2C
+**      adapter in the system, which dominates the run time of short
+**      lived programs on systems with many adapters, so the search is
+**      avoided when possible:
+**
+**      1. the device node set by I2CHALSetControllerPath, or else the
+**         one named by the DPMUTIL_I2C_DEV environment variable, is
+**         opened without any validation
+**      2. the device node found by the last search is read from the
+**         cache file and opened if it's still the same character
+**         device and its sysfs "device-name" file is still the same
+**         inode, which means the adapters haven't been renumbered
+**      3. otherwise sysfs is searched and the result is cached
 **
 **  Notes:
 **      It is the callers responsibility to close the file descriptor
-**      when he/she is done using it by calling the close() function.
+**      when he/she is done using it by calling I2CHALCloseI2cController.
 */
 int
 I2CHALOpenI2cController() {
 
+	char	rgszDevPath[cI2cBusMax][cchI2cDevPathMax+1];
+	char	szCachePath[cchI2cCachePathMax+1];
+	char*	szEnv;
+	BOOL	fCache;
+	int		fdI2cDev;
+	const I2cBackend*	pbe;
+	void*	pvContext;
+
+	pthread_mutex_lock(&mtxI2cBusTable);
+	pbe = pbeI2cDefault;
+	pvContext = pvI2cDefault;
+	strcpy(rgszDevPath[0], szI2cDevPathSet);
+	pthread_mutex_unlock(&mtxI2cBusTable);
+
+	if ( NULL != pbe ) {
+		return I2CHALOpenBackend(pbe, pvContext);
+	}
+
+	if ( '\0' != rgszDevPath[0][0] ) {
+		return I2CHALOpenI2cControllerPath(rgszDevPath[0]);
+	}
+
+	szEnv = getenv(szI2cDevEnv);
+	if (( NULL != szEnv ) && ( '\0' != szEnv[0] )) {
+		return I2CHALOpenI2cControllerPath(szEnv);
+	}
+
+	fCache = FI2cGetCachePath(szCachePath);
+	if (( fCache ) && ( FI2cReadCache(szCachePath, rgszDevPath[0]) )) {
+		fdI2cDev = I2CHALOpenI2cControllerPath(rgszDevPath[0]);
+		if ( 0 <= fdI2cDev ) {
+			return fdI2cDev;
+		}
+	}
+
+	if ( 0 >= I2CHALEnumI2cControllers(rgszDevPath, cI2cBusMax) ) {
+		if(dpmutilfVerbose)printf("WARNING: no \"%s\" I2C controller found, using \"%s\"\n", szI2cDeviceName, szI2cDeviceNameDefault);
+		strcpy(rgszDevPath[0], szI2cDeviceNameDefault);
+	}
+	else if ( fCache ) {
+		I2cWriteCache(szCachePath, rgszDevPath[0]);
+	}
+
+	return I2CHALOpenI2cControllerPath(rgszDevPath[0]);
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALOpenI2cControllerPath
+**
+**  Parameters:
+**      szDevPath       - path of the I2C controller device node
+**
+**  Return Values:
+**      file descriptor for the specified I2C controller
+**
+**  Errors:
+**      Any value less than zero should be considered an indication
+**      that we failed to open a file descriptor for the I2C controller
+**
+**  Description:
+**      This function opens a file descriptor to the I2C controller with
+**      the specified device node, such as one of the paths returned by
+**      I2CHALEnumI2cControllers.
+**
+**  Notes:
+**      It is the callers responsibility to close the file descriptor
+**      when he/she is done using it by calling I2CHALCloseI2cController.
+*/
+int
+I2CHALOpenI2cControllerPath(const char* szDevPath) {
+
+	int				fdI2cDev;
+
+	fdI2cDev = open(szDevPath, O_RDWR | O_CLOEXEC);
+	if ( 0 > fdI2cDev ) {
+		return fdI2cDev;
+	}
+
+	/* The descriptor may have been reused after an earlier close() so
+	** discard any state cached for it, including the controller it was
+	** opened for.
+	*/
+	I2cBusRelease(fdI2cDev);
+	PbusFromFd(fdI2cDev, fTrue);
+
+	return fdI2cDev;
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALSetControllerPath
+**
+**  Parameters:
+**      szDevPath       - path of the I2C controller device node, NULL or
+**                        an empty string to search for the controller
+**
+**  Return Values:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function sets the device node that I2CHALOpenI2cController,
+**      and therefore every dpmutil function that doesn't take a session,
+**      opens. It takes precedence over the DPMUTIL_I2C_DEV environment
+**      variable. Paths longer than cchI2cDevPathMax are ignored.
+*/
+void
+I2CHALSetControllerPath(const char* szDevPath) {
+
+	pthread_mutex_lock(&mtxI2cBusTable);
+
+	if (( NULL == szDevPath ) || ( cchI2cDevPathMax < strlen(szDevPath) )) {
+		szI2cDevPathSet[0] = '\0';
+	}
+	else {
+		strcpy(szI2cDevPathSet, szDevPath);
+	}
+
+	pthread_mutex_unlock(&mtxI2cBusTable);
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALEnumI2cControllers
+**
+**  Parameters:
+**      rgszDevPath     - array of buffers to receive the device node paths
+**      cpathMax        - number of entries in rgszDevPath
+**
+**  Return Values:
+**      number of I2C controllers found, -1 if the sysfs I2C device
+**      directory couldn't be read
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function searches the "/sys/bus/i2c/devices" directory for
+**      all devices whose "device-name" is "pmcu-i2c", which are the I2C
+**      controllers of the Platform MCU / SYZYGY I2C buses, and returns
+**      the paths of their device nodes. The paths are sorted so that a
+**      given controller has the same index every time the controllers
+**      are enumerated. At most cpathMax paths are returned.
+*/
+int
+I2CHALEnumI2cControllers(char rgszDevPath[][cchI2cDevPathMax+1], int cpathMax) {
+
 	DIR*			pdir;
 	struct dirent*	pdirent;
 	FILE*			pfile;
@@ -113,32 +537,35 @@ I2CHALOpenI2cController() {
 	char			szDevName[cchDeviceNameMax+1];
 	int				ch;
 	WORD			cchRead;
+	int				cpath;
 
 	pdir = opendir("/sys/bus/i2c/devices/");
 	if ( NULL == pdir ) {
-		printf("ERROR: opendir failed to open \"/sys/bus/i2c/devices/\"");
+		if(dpmutilfVerbose)printf("ERROR: opendir failed to open \"/sys/bus/i2c/devices/\"");
 		return -1;
 	}
 
-	/* Determine the name of the device node that corresponds to the I2C
-	** controller that's attached to the I2C bus of the Platform MCU.
+	/* Find the device nodes that correspond to the I2C controllers that
+	** are attached to the I2C bus of a Platform MCU.
 	*/
+	cpath = 0;
 	pdirent = readdir(pdir);
-	while ( NULL != pdirent ) {
+	while (( NULL != pdirent ) && ( cpathMax > cpath )) {
 		/* Skip entries that correspond to current directory or the parent
-		** directory.
+		** directory, and entries whose node path wouldn't fit.
 		*/
 		if (( 0 == strcmp(pdirent->d_name, ".")) ||
-			( 0 == strcmp(pdirent->d_name, "..") )) {
+			( 0 == strcmp(pdirent->d_name, "..") ) ||
+			( cchI2cDevPathMax < strlen("/dev/") + strlen(pdirent->d_name) )) {
 			pdirent = readdir(pdir);
 			continue;
 		}
 
 		/* Attempt to open the "device-name" file, if it exists.
 		*/
-		sprintf(szFilePath, "/sys/bus/i2c/devices/%s/of_node/device-name", pdirent->d_name);
+		snprintf(szFilePath, sizeof(szFilePath), "/sys/bus/i2c/devices/%s/of_node/device-name", pdirent->d_name);
 
-		pfile = fopen(szFilePath, "r");
+		pfile = fopen(szFilePath, "re");
 		if ( NULL == pfile ) {
 			pdirent = readdir(pdir);
 			continue;
@@ -159,151 +586,1977 @@ I2CHALOpenI2cController() {
 		fclose(pfile);
 
 		if ( 0 == strcmp(szI2cDeviceName, szDevName) ) {
-			break;
+			sprintf(rgszDevPath[cpath], "/dev/%s", pdirent->d_name);
+			cpath++;
 		}
 
 		pdirent = readdir(pdir);
 	}
 
-	if ( NULL != pdirent ) {
-		sprintf(szFilePath, "/dev/%s", pdirent->d_name);
-	}
-	else {
-		strcpy(szFilePath, szI2cDeviceNameDefault);
+	closedir(pdir);
+
+	/* readdir doesn't return entries in any particular order.
+	*/
+	qsort(rgszDevPath, cpath, cchI2cDevPathMax+1, FCompareDevPath);
+
+	return cpath;
+}
+
+/* ------------------------------------------------------------ */
+/***    FCompareDevPath
+**
+**  Parameters:
+**      pv1, pv2        - pointers to the device node paths to compare
+**
+**  Return Values:
+**      negative, zero, or positive as required by qsort
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function orders device node paths such that "/dev/i2c-2"
+**      sorts before "/dev/i2c-10".
+*/
+static int
+FCompareDevPath(const void* pv1, const void* pv2) {
+
+	const char*	sz1 = (const char*)pv1;
+	const char*	sz2 = (const char*)pv2;
+	size_t		cch1 = strlen(sz1);
+	size_t		cch2 = strlen(sz2);
+
+	if ( cch1 != cch2 ) {
+		return ( cch1 < cch2 ) ? -1 : 1;
 	}
 
-	closedir(pdir);
-	return open(szFilePath, O_RDWR);
+	return strcmp(sz1, sz2);
 }
-#else
 
 /* ------------------------------------------------------------ */
-/***    I2CHALInit
+/***    FI2cGetCachePath
 **
 **  Parameters:
-**      deviceID			-	deviceID of the I2C device to initialize
+**      szCachePath     - buffer of cchI2cCachePathMax+1 characters to
+**                        receive the path of the cache file
 **
-**  Return Value:
-**      fTrue for success, fFalse otherwise
+**  Return Values:
+**      fTrue if the cache is enabled, fFalse otherwise
 **
 **  Errors:
 **      none
 **
 **  Description:
-**      This function initializes the I2C device on Zynq and Microblaze
-**      devices running baremetal. This can be called before any other
-**      dpmutil function to specify a different deviceID besides 0.
-**      If not called, the dpmutil functions will initialize the I2C device
-**      with deviceID 0 if it exists.
+**      This function returns the path of the file that caches the device
+**      node found by the last search, which is the value of the
+**      DPMUTIL_I2C_CACHE environment variable if it's set.
 */
-BOOL
-I2CHALInit(UINT32 deviceID){
-	Iic_Config *pCfgPtr;
-	XStatus status;
+static BOOL
+FI2cGetCachePath(char* szCachePath) {
 
-	if(Iic_Init){
+	char*	szEnv;
+
+	szEnv = getenv(szI2cCacheEnv);
+	if ( NULL == szEnv ) {
+		snprintf(szCachePath, cchI2cCachePathMax+1, szI2cCachePathFormat, (unsigned)geteuid());
 		return fTrue;
 	}
-	pCfgPtr = Iic_LookupConfig(deviceID);
-	if(pCfgPtr==NULL)return fFalse;
-	status = Iic_CfgInitialize(&IicDev, pCfgPtr, pCfgPtr->BaseAddress);
-	if(status != XST_SUCCESS)return fFalse;
 
-#ifdef PLATFORM_ZYNQ
-	XIicPs_SetSClk(&IicDev, IIC_SCLK_RATE);
-#endif
+	if (( '\0' == szEnv[0] ) || ( cchI2cCachePathMax < strlen(szEnv) )) {
+		return fFalse;
+	}
 
-	Iic_Init=fTrue;
-	return fTrue;
+	strcpy(szCachePath, szEnv);
 
+	return fTrue;
 }
-#endif
 
 /* ------------------------------------------------------------ */
-/***    PmcuI2cRead
+/***    FI2cSysfsNameIno
 **
 **  Parameters:
-**  	fdI2cDev        - open file descriptor for underlying I2C device (linux only)
-**      slaveAddr		- slave address of the device
-**      addrRead        - memory address to read
-**      pbRead          - pointer to a buffer to receive data
-**      cbRead          - number of bytes to read
-**      pcbRead         - pointer to variable to receive count of bytes
-**                        read
-**      uWait			- number of microseconds to wait between reads
+**      szDevPath       - path of the I2C controller device node
+**      pino            - pointer to a variable to receive the inode
 **
-**  Return Value:
-**      fTrue for success, fFalse otherwise
+**  Return Values:
+**      fTrue for success, fFalse if the controller has no device tree
+**      node name
 **
 **  Errors:
 **      none
 **
 **  Description:
-**      This function reads the specified number of bytes from the
-**      Platform MCU starting at the specified address. Read operations
-**      may be split into multiple transactions with a maximum of
-**      cbPmcuTxMax bytes being retrieved during a single read operation.
+**      This function returns the inode of the sysfs "device-name" file
+**      of the adapter with the specified device node. The inode
+**      identifies the device tree node the adapter was created for.
 */
-BOOL
-I2CHALRead(int fdI2cDev, BYTE slaveAddr, WORD addrRead, BYTE* pbRead, BYTE cbRead, WORD* pcbRead, UINT32 uWait) {
-
-	ssize_t			cbTrans;
-	ssize_t			cb;
-	BYTE			cbRecv;
-	BYTE			rgbSnd[2];
-	char			szErr[64];
-	char			szErrDesc[128];
+static BOOL
+FI2cSysfsNameIno(const char* szDevPath, ino_t* pino) {
 
-//
+	const char*	szName;
+	char		szFilePath[512];
+	struct stat	st;
 
-	cbRecv = 0;
-	strcpy(szErr, "ERROR: PmcuI2cRead - ");
-	szErrDesc[0] = '\0';
+	szName = strrchr(szDevPath, '/');
+	szName = ( NULL != szName ) ? szName + 1 : szDevPath;
 
-	/* Inform the I2C driver of the slave address.
-	*/
-#if defined(__linux__)
-	struct timespec	tsWait;
-	if ( 0 > ioctl(fdI2cDev, I2C_SLAVE, slaveAddr) ) {
-		sprintf(szErrDesc, "failed to set I2C slave address");
-		goto lErrorExit;
+	snprintf(szFilePath, sizeof(szFilePath), "/sys/bus/i2c/devices/%s/of_node/device-name", szName);
+	if ( 0 != stat(szFilePath, &st) ) {
+		return fFalse;
 	}
-	tsWait.tv_sec = 0;
-	tsWait.tv_nsec = 50000;
-#endif
 
-	while ( cbRecv < cbRead ) {
+	*pino = st.st_ino;
 
-		/* Transmit the memory address to the slave.
-		*/
-		rgbSnd[0] = (addrRead  >> 8);
-		rgbSnd[1] = addrRead & 0xFF;
+	return fTrue;
+}
 
-#if defined(__linux__)
-		if ( 2 != write(fdI2cDev, rgbSnd, 2) ) {
-			sprintf(szErrDesc, "failed to write memory address");
-			goto lErrorExit;
-		}
-#elif defined(PLATFORM_ZYNQ)
-		// Send the read address
-		if(XST_SUCCESS != XIicPs_MasterSendPolled(&IicDev, rgbSnd, 2, slaveAddr)){
-			strcpy(szErrDesc, "failed to write memory address");
-			goto lErrorExit;
-		}
-		while (XIicPs_BusIsBusy(&IicDev)) {}
-#else
-		if(2 != XIic_Send(IicDev.BaseAddress, slaveAddr, rgbSnd, 2, XIIC_STOP)){
-			strcpy(szErrDesc, "failed to write memory address");
-			goto lErrorExit;
-		}
-#endif
+/* ------------------------------------------------------------ */
+/***    FI2cReadCache
+**
+**  Parameters:
+**      szCachePath     - path of the cache file
+**      szDevPath       - buffer of cchI2cDevPathMax+1 characters to
+**                        receive the path of the device node
+**
+**  Return Values:
+**      fTrue if the cache holds a device node that's still valid,
+**      fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function reads the device node found by the last search
+**      from the cache file. The file must be a regular file owned by
+**      the effective user that only its owner can write. The entry is
+**      valid if the device node is still the same character device and
+**      the inode of its sysfs "device-name" file hasn't changed.
+*/
+static BOOL
+FI2cReadCache(const char* szCachePath, char* szDevPath) {
+
+	int					fd;
+	struct stat			st;
+	char				rgchCache[cchI2cDevPathMax + 64];
+	ssize_t				cch;
+	unsigned int		mjr;
+	unsigned int		mnr;
+	unsigned long long	ino;
+	ino_t				inoSysfs;
+
+	fd = open(szCachePath, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+	if ( 0 > fd ) {
+		return fFalse;
+	}
 
+	if (( 0 != fstat(fd, &st) ) ||
+		( ! S_ISREG(st.st_mode) ) ||
+		( geteuid() != st.st_uid ) ||
+		( 0 != (st.st_mode & (S_IWGRP | S_IWOTH)) )) {
+		close(fd);
+		return fFalse;
+	}
 
+	cch = read(fd, rgchCache, sizeof(rgchCache) - 1);
+	close(fd);
+	if ( 0 >= cch ) {
+		return fFalse;
+	}
 
-		cbTrans = cbRead - cbRecv;
-		if ( 32 < cbTrans ) {
-			cbTrans = 32;
-		}
+	rgchCache[cch] = '\0';
+	if ( 4 != sscanf(rgchCache, "%63s %u %u %llu", szDevPath, &mjr, &mnr, &ino) ) {
+		return fFalse;
+	}
+
+	if (( 0 != stat(szDevPath, &st) ) ||
+		( ! S_ISCHR(st.st_mode) ) ||
+		( makedev(mjr, mnr) != st.st_rdev ) ||
+		( ! FI2cSysfsNameIno(szDevPath, &inoSysfs) ) ||
+		( ino != (unsigned long long)inoSysfs )) {
+		if(dpmutilfVerbose)printf("WARNING: cached I2C controller \"%s\" is stale\n", szDevPath);
+		return fFalse;
+	}
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    I2cWriteCache
+**
+**  Parameters:
+**      szCachePath     - path of the cache file
+**      szDevPath       - path of the device node found by the search
+**
+**  Return Values:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function stores the result of a search in the cache file.
+**      The file is written under a temporary name and renamed, so that
+**      a concurrent reader never sees a partial entry. Failures are
+**      ignored, the next call will simply search again.
+*/
+static void
+I2cWriteCache(const char* szCachePath, const char* szDevPath) {
+
+	char		szTmpPath[cchI2cCachePathMax + 16];
+	char		rgchCache[cchI2cDevPathMax + 64];
+	struct stat	st;
+	ino_t		inoSysfs;
+	int			fd;
+	int			cch;
+	BOOL		fOk;
+
+	if (( 0 != stat(szDevPath, &st) ) ||
+		( ! S_ISCHR(st.st_mode) ) ||
+		( ! FI2cSysfsNameIno(szDevPath, &inoSysfs) )) {
+		return;
+	}
+
+	cch = snprintf(rgchCache, sizeof(rgchCache), "%s %u %u %llu\n", szDevPath,
+				   major(st.st_rdev), minor(st.st_rdev), (unsigned long long)inoSysfs);
+	snprintf(szTmpPath, sizeof(szTmpPath), "%s.%d", szCachePath, (int)getpid());
+
+	fd = open(szTmpPath, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0644);
+	if ( 0 > fd ) {
+		return;
+	}
+
+	fOk = ( cch == write(fd, rgchCache, cch) );
+	close(fd);
+
+	if (( ! fOk ) || ( 0 != rename(szTmpPath, szCachePath) )) {
+		if(dpmutilfVerbose)printf("WARNING: failed to write the I2C controller cache \"%s\"\n", szCachePath);
+		unlink(szTmpPath);
+	}
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALCloseI2cController
+**
+**  Parameters:
+**      fdI2cDev        - file descriptor returned by I2CHALOpenI2cController
+**
+**  Return Values:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function discards any state that has been cached for the
+**      specified I2C controller and then closes its file descriptor.
+*/
+void
+I2CHALCloseI2cController(int fdI2cDev) {
+
+	I2cBackendState*	pbest;
+
+	if ( 0 > fdI2cDev ) {
+		return;
+	}
+
+	I2cBusRelease(fdI2cDev);
+
+	pbest = PbeFromFd(fdI2cDev);
+	if ( NULL != pbest ) {
+		if ( NULL != pbest->pbe->pfnClose ) {
+			pbest->pbe->pfnClose(pbest->pvContext);
+		}
+		pthread_mutex_lock(&mtxI2cBusTable);
+		pbest->fInUse = fFalse;
+		pthread_mutex_unlock(&mtxI2cBusTable);
+		return;
+	}
+
+	close(fdI2cDev);
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALOpenBackend
+**
+**  Parameters:
+**      pbe             - functions that perform the transfers
+**      pvContext       - context passed to the functions of the backend
+**
+**  Return Values:
+**      file descriptor that may be used in place of one returned by
+**      I2CHALOpenI2cController, less than zero if too many backends
+**      are open
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function opens a file descriptor whose transfers are
+**      performed by the specified backend rather than by an I2C
+**      controller. The transfers are split into exactly the same
+**      messages as they would be for a controller that supports
+**      combined transactions. The file descriptor must be closed with
+**      I2CHALCloseI2cController.
+*/
+int
+I2CHALOpenBackend(const I2cBackend* pbe, void* pvContext) {
+
+	int	ibe;
+
+	if (( NULL == pbe ) || ( NULL == pbe->pfnXfer )) {
+		return -1;
+	}
+
+	pthread_mutex_lock(&mtxI2cBusTable);
+	for ( ibe = 0; ibe < cI2cBackendMax; ibe++ ) {
+		if ( ! rgbeI2c[ibe].fInUse ) {
+			rgbeI2c[ibe].fInUse = fTrue;
+			rgbeI2c[ibe].pbe = pbe;
+			rgbeI2c[ibe].pvContext = pvContext;
+			rgbeI2c[ibe].addrSlave = 0;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&mtxI2cBusTable);
+
+	return ( ibe < cI2cBackendMax ) ? fdI2cBackendBase + ibe : -1;
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALSetDefaultBackend
+**
+**  Parameters:
+**      pbe             - functions that perform the transfers, NULL to
+**                        open the I2C controller again
+**      pvContext       - context passed to the functions of the backend
+**
+**  Return Values:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function selects a backend that I2CHALOpenI2cController
+**      opens in place of the I2C controller, so that the dpmutilF
+**      functions, which open and close the controller themselves, can
+**      be run against it. File descriptors that are already open are
+**      unaffected.
+*/
+void
+I2CHALSetDefaultBackend(const I2cBackend* pbe, void* pvContext) {
+
+	pthread_mutex_lock(&mtxI2cBusTable);
+	pbeI2cDefault = pbe;
+	pvI2cDefault = pvContext;
+	pthread_mutex_unlock(&mtxI2cBusTable);
+}
+
+/* ------------------------------------------------------------ */
+/***    PbeFromFd
+**
+**  Parameters:
+**      fdI2cDev        - file descriptor
+**
+**  Return Values:
+**      pointer to the state of the backend, NULL if the file descriptor
+**      wasn't returned by I2CHALOpenBackend
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function looks up the backend of a file descriptor. The
+**      entry is only modified by the open and close of the file
+**      descriptor, so no lock is required.
+*/
+static I2cBackendState*
+PbeFromFd(int fdI2cDev) {
+
+	if (( fdI2cBackendBase > fdI2cDev ) || ( fdI2cBackendBase + cI2cBackendMax <= fdI2cDev )) {
+		return NULL;
+	}
+
+	if ( ! rgbeI2c[fdI2cDev - fdI2cBackendBase].fInUse ) {
+		return NULL;
+	}
+
+	return &rgbeI2c[fdI2cDev - fdI2cBackendBase];
+}
+
+/* ------------------------------------------------------------ */
+/***    CbI2cRead, CbI2cWrite
+**
+**  Parameters:
+**      fdI2cDev        - open file descriptor for underlying I2C device
+**      pb              - buffer to receive or containing the data
+**      cb              - number of bytes to transfer
+**
+**  Return Values:
+**      number of bytes transferred, less than zero on failure
+**
+**  Errors:
+**      errno is set when the function fails
+**
+**  Description:
+**      These functions perform a read() or write() of the slave
+**      selected with FI2cSetSlave, using the backend if the file
+**      descriptor has one.
+*/
+static ssize_t
+CbI2cRead(int fdI2cDev, BYTE* pb, size_t cb) {
+
+	I2cBackendState*	pbest;
+	I2cBackendMsg		msg;
+
+	pbest = PbeFromFd(fdI2cDev);
+	if ( NULL == pbest ) {
+		return read(fdI2cDev, pb, cb);
+	}
+
+	msg.slaveAddr = pbest->addrSlave;
+	msg.fRead = fTrue;
+	msg.cb = cb;
+	msg.pb = pb;
+	if ( ! pbest->pbe->pfnXfer(pbest->pvContext, &msg, 1) ) {
+		errno = ENXIO;
+		return -1;
+	}
+
+	return cb;
+}
+
+static ssize_t
+CbI2cWrite(int fdI2cDev, const BYTE* pb, size_t cb) {
+
+	I2cBackendState*	pbest;
+	I2cBackendMsg		msg;
+
+	pbest = PbeFromFd(fdI2cDev);
+	if ( NULL == pbest ) {
+		return write(fdI2cDev, pb, cb);
+	}
+
+	msg.slaveAddr = pbest->addrSlave;
+	msg.fRead = fFalse;
+	msg.cb = cb;
+	msg.pb = (BYTE*)pb;
+	if ( ! pbest->pbe->pfnXfer(pbest->pvContext, &msg, 1) ) {
+		errno = ENXIO;
+		return -1;
+	}
+
+	return cb;
+}
+
+/* ------------------------------------------------------------ */
+/***    FI2cRdwr
+**
+**  Parameters:
+**      fdI2cDev        - open file descriptor for underlying I2C device
+**      prdwr           - messages of the combined transaction
+**
+**  Return Values:
+**      fTrue if every message was transferred, fFalse otherwise
+**
+**  Errors:
+**      errno is set when the function fails
+**
+**  Description:
+**      This function performs a combined transaction with the I2C_RDWR
+**      ioctl, or with the backend if the file descriptor has one.
+*/
+static BOOL
+FI2cRdwr(int fdI2cDev, struct i2c_rdwr_ioctl_data* prdwr) {
+
+	I2cBackendState*	pbest;
+	I2cBackendMsg		rgmsg[cI2cRdwrMsgMax];
+	WORD				imsg;
+
+	pbest = PbeFromFd(fdI2cDev);
+	if ( NULL == pbest ) {
+		return ( (int)prdwr->nmsgs == ioctl(fdI2cDev, I2C_RDWR, prdwr) ) ? fTrue : fFalse;
+	}
+
+	for ( imsg = 0; imsg < prdwr->nmsgs; imsg++ ) {
+		rgmsg[imsg].slaveAddr = prdwr->msgs[imsg].addr;
+		rgmsg[imsg].fRead = ( prdwr->msgs[imsg].flags & I2C_M_RD ) ? fTrue : fFalse;
+		rgmsg[imsg].cb = prdwr->msgs[imsg].len;
+		rgmsg[imsg].pb = prdwr->msgs[imsg].buf;
+	}
+
+	if ( ! pbest->pbe->pfnXfer(pbest->pvContext, rgmsg, prdwr->nmsgs) ) {
+		errno = ENXIO;
+		return fFalse;
+	}
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    PbusFromFd
+**
+**  Parameters:
+**      fdI2cDev        - open file descriptor for underlying I2C device
+**      fCreate         - fTrue to allocate a new entry if none exists
+**
+**  Return Values:
+**      pointer to the cached state of the I2C controller, NULL if the
+**      controller has no cached state and none could be allocated
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function looks up the state that has been cached for the
+**      I2C controller with the specified file descriptor. When fCreate
+**      is set, an entry that has no controller state, because the table
+**      of controllers was full when it was created, is given one if
+**      possible.
+*/
+static I2cBusState*
+PbusFromFd(int fdI2cDev, BOOL fCreate) {
+
+	I2cBusState*	pbusFree;
+	I2cBusState*	pbus;
+	int				ibus;
+
+	pthread_mutex_lock(&mtxI2cBusTable);
+
+	pbus = NULL;
+	pbusFree = NULL;
+	for ( ibus = 0; ibus < cI2cFdMax; ibus++ ) {
+		if ( rgbusI2c[ibus].fInUse ) {
+			if ( fdI2cDev == rgbusI2c[ibus].fdI2cDev ) {
+				pbus = &rgbusI2c[ibus];
+				break;
+			}
+		}
+		else if ( NULL == pbusFree ) {
+			pbusFree = &rgbusI2c[ibus];
+		}
+	}
+
+	if (( NULL == pbus ) && ( fCreate ) && ( NULL != pbusFree )) {
+		pbusFree->fInUse = fTrue;
+		pbusFree->fdI2cDev = fdI2cDev;
+		pbusFree->addrSlave = -1;
+		pbusFree->fFuncsValid = fFalse;
+		pbusFree->fRdwr = fFalse;
+		pbusFree->pctrl = NULL;
+#if defined(DPMUTIL_STATS)
+		pbusFree->istat = -1;
+#endif
+		pbus = pbusFree;
+	}
+
+	if (( NULL != pbus ) && ( fCreate ) && ( NULL == pbus->pctrl )) {
+		pbus->pctrl = PctrlAcquire(fdI2cDev);
+	}
+
+	pthread_mutex_unlock(&mtxI2cBusTable);
+
+	return pbus;
+}
+
+/* ------------------------------------------------------------ */
+/***    I2cBusRelease
+**
+**  Parameters:
+**      fdI2cDev        - file descriptor that's being closed or was reused
+**
+**  Return Values:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function discards the state cached for the specified file
+**      descriptor and releases its reference to the state of the
+**      controller.
+*/
+static void
+I2cBusRelease(int fdI2cDev) {
+
+	int		ibus;
+
+	pthread_mutex_lock(&mtxI2cBusTable);
+
+	for ( ibus = 0; ibus < cI2cFdMax; ibus++ ) {
+		if (( rgbusI2c[ibus].fInUse ) && ( fdI2cDev == rgbusI2c[ibus].fdI2cDev )) {
+			if ( NULL != rgbusI2c[ibus].pctrl ) {
+				rgbusI2c[ibus].pctrl->cfd--;
+				rgbusI2c[ibus].pctrl = NULL;
+			}
+			rgbusI2c[ibus].fInUse = fFalse;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&mtxI2cBusTable);
+}
+
+/* ------------------------------------------------------------ */
+/***    PctrlAcquire
+**
+**  Parameters:
+**      fdI2cDev        - open file descriptor for underlying I2C device
+**
+**  Return Values:
+**      pointer to the state of the controller that the file descriptor
+**      was opened for, NULL if it can't be identified or too many
+**      controllers are open
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function finds the state of the controller of the specified
+**      file descriptor, by the device number of its device node or by
+**      the context of its backend, and adds a reference to it. A new
+**      entry is allocated for a controller that has no other open file
+**      descriptor. It must be called with mtxI2cBusTable held.
+*/
+static I2cCtrlState*
+PctrlAcquire(int fdI2cDev) {
+
+	I2cBackendState*	pbest;
+	I2cCtrlState*		pctrlFree;
+	struct stat			st;
+	dev_t				rdev;
+	void*				pvBackend;
+	int					ictrl;
+
+	pbest = PbeFromFd(fdI2cDev);
+	if ( NULL != pbest ) {
+		rdev = 0;
+		pvBackend = pbest->pvContext;
+	}
+	else if ( 0 == fstat(fdI2cDev, &st) ) {
+		rdev = st.st_rdev;
+		pvBackend = NULL;
+	}
+	else {
+		return NULL;
+	}
+
+	pctrlFree = NULL;
+	for ( ictrl = 0; ictrl < cI2cBusMax; ictrl++ ) {
+		if ( 0 == rgctrlI2c[ictrl].cfd ) {
+			if ( NULL == pctrlFree ) {
+				pctrlFree = &rgctrlI2c[ictrl];
+			}
+		}
+		else if (( rdev == rgctrlI2c[ictrl].rdev ) && ( pvBackend == rgctrlI2c[ictrl].pvBackend )) {
+			rgctrlI2c[ictrl].cfd++;
+			return &rgctrlI2c[ictrl];
+		}
+	}
+
+	if ( NULL == pctrlFree ) {
+		return NULL;
+	}
+
+	if ( ! pctrlFree->fMtxInit ) {
+		pthread_mutexattr_t	mtxattr;
+
+		pthread_mutexattr_init(&mtxattr);
+		pthread_mutexattr_settype(&mtxattr, PTHREAD_MUTEX_RECURSIVE);
+		pthread_mutex_init(&pctrlFree->mtx, &mtxattr);
+		pthread_mutexattr_destroy(&mtxattr);
+		pctrlFree->fMtxInit = fTrue;
+	}
+	pctrlFree->cfd = 1;
+	pctrlFree->rdev = rdev;
+	pctrlFree->pvBackend = pvBackend;
+
+	return pctrlFree;
+}
+
+/* ------------------------------------------------------------ */
+/***    FI2cSetSlave
+**
+**  Parameters:
+**      fdI2cDev        - open file descriptor for underlying I2C device
+**      slaveAddr       - slave address of the device
+**
+**  Return Values:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function informs the I2C driver of the slave address to use
+**      for subsequent read() and write() calls. The ioctl is skipped when
+**      the slave address is already selected on this file descriptor.
+*/
+static BOOL
+FI2cSetSlave(int fdI2cDev, BYTE slaveAddr) {
+
+	I2cBusState*		pbus;
+	I2cBackendState*	pbest;
+
+	pbest = PbeFromFd(fdI2cDev);
+	if ( NULL != pbest ) {
+		pbest->addrSlave = slaveAddr;
+		return fTrue;
+	}
+
+	pbus = PbusFromFd(fdI2cDev, fTrue);
+	if (( NULL != pbus ) && ( slaveAddr == pbus->addrSlave )) {
+		return fTrue;
+	}
+
+	if ( 0 > ioctl(fdI2cDev, I2C_SLAVE, slaveAddr) ) {
+		if ( NULL != pbus ) {
+			pbus->addrSlave = -1;
+		}
+		return fFalse;
+	}
+
+	if ( NULL != pbus ) {
+		pbus->addrSlave = slaveAddr;
+	}
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    FI2cRdwrSupported
+**
+**  Parameters:
+**      fdI2cDev        - open file descriptor for underlying I2C device
+**
+**  Return Values:
+**      fTrue if the adapter supports combined I2C_RDWR transactions,
+**      fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function queries the functionality of the I2C adapter the
+**      first time it's called for a file descriptor and caches the
+**      result so that subsequent calls don't require an ioctl.
+*/
+static BOOL
+FI2cRdwrSupported(int fdI2cDev) {
+
+	I2cBusState*	pbus;
+	unsigned long	funcs;
+	BOOL			fRdwr;
+
+	if ( NULL != PbeFromFd(fdI2cDev) ) {
+		return fTrue;
+	}
+
+	pbus = PbusFromFd(fdI2cDev, fTrue);
+	if (( NULL != pbus ) && ( pbus->fFuncsValid )) {
+		return pbus->fRdwr;
+	}
+
+	fRdwr = fFalse;
+	if (( 0 <= ioctl(fdI2cDev, I2C_FUNCS, &funcs) ) &&
+		( 0 != (funcs & I2C_FUNC_I2C) )) {
+		fRdwr = fTrue;
+	}
+
+	if ( NULL != pbus ) {
+		pbus->fFuncsValid = fTrue;
+		pbus->fRdwr = fRdwr;
+	}
+
+	return fRdwr;
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALLock
+**
+**  Parameters:
+**      fdI2cDev        - open file descriptor for underlying I2C device
+**
+**  Return Values:
+**      fTrue for success, fFalse if the lock couldn't be allocated
+**
+**  Errors:
+**      Returns fFalse if more than cI2cBusMax controllers, or cI2cFdMax
+**      file descriptors, are open. The lock isn't held in that case and
+**      I2CHALUnlock must not be called.
+**
+**  Description:
+**      This function acquires the lock of the specified I2C controller,
+**      waiting for any other thread that holds it. The lock belongs to
+**      the controller rather than to the file descriptor, so every file
+**      descriptor opened for the same device node, or backend context,
+**      shares it. Every I2CHAL transfer
+**      function takes the lock itself, so a caller only needs to take it
+**      when a sequence of transfers, such as a read-modify-write of a
+**      register, must not be interleaved with transfers performed by
+**      other threads. The lock is recursive and each call must be
+**      matched by a call to I2CHALUnlock.
+**
+**      I2CHALProbe, I2CHALWaitAck, I2CHALRead, I2CHALWrite and
+**      I2CHALBatchSubmit hold the lock for the duration of the call, so
+**      that their transfers can't be interleaved with those of another
+**      thread using the same controller, and perform them with
+**      the corresponding FI2c*Unlocked function, which documents them.
+**      Functions that perform several transfers under one lock call
+**      the FI2c*Unlocked functions directly.
+*/
+BOOL
+I2CHALLock(int fdI2cDev) {
+
+	I2cBusState*	pbus;
+
+	pbus = PbusFromFd(fdI2cDev, fTrue);
+	if (( NULL == pbus ) || ( NULL == pbus->pctrl )) {
+		if(dpmutilfVerbose)printf("ERROR: too many I2C controllers are open to lock %d\n", fdI2cDev);
+		return fFalse;
+	}
+
+	pthread_mutex_lock(&pbus->pctrl->mtx);
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALUnlock
+**
+**  Parameters:
+**      fdI2cDev        - open file descriptor for underlying I2C device
+**
+**  Return Values:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function releases the lock acquired by I2CHALLock.
+*/
+void
+I2CHALUnlock(int fdI2cDev) {
+
+	I2cBusState*	pbus;
+
+	pbus = PbusFromFd(fdI2cDev, fFalse);
+	if (( NULL != pbus ) && ( NULL != pbus->pctrl )) {
+		pthread_mutex_unlock(&pbus->pctrl->mtx);
+	}
+}
+#else
+
+/* ------------------------------------------------------------ */
+/***    I2CHALInit
+**
+**  Parameters:
+**      deviceID			-	deviceID of the I2C device to initialize
+**
+**  Return Value:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function initializes the I2C device on Zynq and Microblaze
+**      devices running baremetal. This can be called before any other
+**      dpmutil function to specify a different deviceID besides 0.
+**      If not called, the dpmutil functions will initialize the I2C device
+**      with deviceID 0 if it exists.
+*/
+BOOL
+I2CHALInit(UINT32 deviceID){
+	Iic_Config *pCfgPtr;
+	XStatus status;
+
+	if(Iic_Init){
+		return fTrue;
+	}
+	pCfgPtr = Iic_LookupConfig(deviceID);
+	if(pCfgPtr==NULL)return fFalse;
+	status = Iic_CfgInitialize(&IicDev, pCfgPtr, pCfgPtr->BaseAddress);
+	if(status != XST_SUCCESS)return fFalse;
+
+#ifdef PLATFORM_ZYNQ
+	XIicPs_SetSClk(&IicDev, hzIicScl);
+#endif
+
+	Iic_Init=fTrue;
+	return fTrue;
+
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALLock, I2CHALUnlock
+**
+**  Description:
+**      Bare metal applications are single threaded, and the I2C device
+**      is a single shared instance, so there is nothing to lock and
+**      I2CHALLock always succeeds.
+*/
+BOOL
+I2CHALLock(int fdI2cDev) {
+
+	return fTrue;
+}
+
+void
+I2CHALUnlock(int fdI2cDev) {
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALSetInterruptMode
+**
+**  Parameters:
+**      phooks          - hooks used while waiting for a transfer to
+**                        complete, NULL to return to polled transfers
+**
+**  Return Value:
+**      fTrue for success, fFalse if the I2C device hasn't been
+**      initialized with I2CHALInit
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function selects interrupt driven transfers, which start
+**      with XIicPs_MasterSend/XIicPs_MasterRecv on Zynq and with
+**      XIic_MasterSend/XIic_MasterRecv on MicroBlaze and complete in the
+**      interrupt handler, instead of the polled transfers that occupy
+**      the CPU for every byte. The application must connect
+**      I2CHALInterruptHandler to the interrupt of the I2C controller
+**      and enable that interrupt, with XScuGic_Connect or XIntc_Connect,
+**      before calling any other I2CHAL function.
+**
+**      Neither controller has a DMA interface, so the FIFO is refilled
+**      and drained by the interrupt handler.
+*/
+BOOL
+I2CHALSetInterruptMode(const I2cIrqHooks* phooks) {
+
+	if ( ! Iic_Init ) {
+		return fFalse;
+	}
+
+	if ( NULL == phooks ) {
+#if !defined(PLATFORM_ZYNQ)
+		if ( fIicIrq ) {
+			XIic_Stop(&IicDev);
+		}
+#endif
+		fIicIrq = fFalse;
+		memset(&hooksIic, 0, sizeof(hooksIic));
+		return fTrue;
+	}
+
+	hooksIic = *phooks;
+
+#if defined(PLATFORM_ZYNQ)
+	XIicPs_SetStatusHandler(&IicDev, NULL, IicIrqStatusHandler);
+#else
+	XIic_SetSendHandler(&IicDev, NULL, IicIrqXferHandler);
+	XIic_SetRecvHandler(&IicDev, NULL, IicIrqXferHandler);
+	XIic_SetStatusHandler(&IicDev, NULL, IicIrqStatusHandler);
+	if (( ! fIicIrq ) && ( XST_SUCCESS != XIic_Start(&IicDev) )) {
+		return fFalse;
+	}
+#endif
+
+	fIicIrq = fTrue;
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALInterruptHandler
+**
+**  Parameters:
+**      pvUnused        - callback reference passed when the handler was
+**                        connected, not used
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function is the interrupt handler of the I2C controller
+**      initialized by I2CHALInit. It dispatches to the handler of the
+**      Xilinx driver, which calls the completion handlers of I2CHAL.
+*/
+void
+I2CHALInterruptHandler(void* pvUnused) {
+
+#if defined(PLATFORM_ZYNQ)
+	XIicPs_MasterInterruptHandler(&IicDev);
+#else
+	XIic_InterruptHandler(&IicDev);
+#endif
+}
+#endif
+
+/* ------------------------------------------------------------ */
+/***    I2CHALGetLastError
+**
+**  Parameters:
+**      none
+**
+**  Return Value:
+**      zero if the last I2CHAL transfer performed by the calling thread
+**      succeeded, otherwise the errno of the failure on Linux or -1 on
+**      bare metal
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function returns the result of the last I2CHALRead,
+**      I2CHALWrite, I2CHALProbe, I2CHALWaitAck or I2CHALBatchSubmit
+**      call performed by the calling thread. The result is kept per
+**      thread so threads sharing a bus don't see each other's errors.
+*/
+int
+I2CHALGetLastError() {
+
+	return errI2cLast;
+}
+
+/* ------------------------------------------------------------ */
+/***    SetLastError
+**
+**  Parameters:
+**      fSuccess        - result of the transfer that just completed
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function records the result returned by I2CHALGetLastError.
+*/
+static void
+SetLastError(BOOL fSuccess) {
+
+	if ( fSuccess ) {
+		errI2cLast = 0;
+		return;
+	}
+
+#if defined(__linux__)
+	errI2cLast = ( 0 != errno ) ? errno : EIO;
+#else
+	errI2cLast = -1;
+#endif
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALProbe
+**
+**  Description:
+**      See FI2cProbeUnlocked and I2CHALLock.
+*/
+BOOL
+I2CHALProbe(int fdI2cDev, BYTE slaveAddr) {
+
+	BOOL	fRet;
+
+	if ( ! I2CHALLock(fdI2cDev) ) {
+		SetLastError(fFalse);
+		return fFalse;
+	}
+	I2cStatBegin();
+	fRet = FI2cProbeUnlocked(fdI2cDev, slaveAddr);
+	I2cStatEnd(fdI2cDev, slaveAddr, i2cstatProbe, 0, 0, fRet);
+	SetLastError(fRet);
+	I2CHALUnlock(fdI2cDev);
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    FI2cProbeUnlocked
+**
+**  Parameters:
+**  	fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      slaveAddr		- slave address of the device
+**
+**  Return Value:
+**      fTrue if the slave acknowledged its address, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function addresses the specified slave for a single byte
+**      read and reports whether or not the slave acknowledged SLA+R.
+**      The byte that is read is discarded. A read is used rather than
+**      a write so that the probe never modifies the memory address of
+**      the slave, which would trigger a page erase when the address
+**      falls on a page boundary of a SYZYGY pMCU.
+*/
+static BOOL
+FI2cProbeUnlocked(int fdI2cDev, BYTE slaveAddr) {
+
+	BYTE	bTemp;
+
+	I2cStatChunk();
+#if defined(__linux__)
+	if ( ! FI2cSetSlave(fdI2cDev, slaveAddr) ) {
+		return fFalse;
+	}
+
+	return ( 1 == CbI2cRead(fdI2cDev, &bTemp, 1) ) ? fTrue : fFalse;
+#else
+	return FIicRecv(slaveAddr, &bTemp, 1);
+#endif
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALWaitAck
+**
+**  Description:
+**      See FI2cWaitAckUnlocked and I2CHALLock.
+*/
+BOOL
+I2CHALWaitAck(int fdI2cDev, BYTE slaveAddr, UINT32 uTimeout) {
+
+	BOOL	fRet;
+
+	if ( ! I2CHALLock(fdI2cDev) ) {
+		SetLastError(fFalse);
+		return fFalse;
+	}
+	I2cStatBegin();
+	fRet = FI2cWaitAckUnlocked(fdI2cDev, slaveAddr, uTimeout);
+	I2cStatEnd(fdI2cDev, slaveAddr, i2cstatWaitAck, 0, 0, fRet);
+	SetLastError(fRet);
+	I2CHALUnlock(fdI2cDev);
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    FI2cWaitAckUnlocked
+**
+**  Parameters:
+**  	fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      slaveAddr		- slave address of the device
+**      uTimeout		- maximum number of microseconds to wait
+**
+**  Return Value:
+**      fTrue if the slave acknowledged within the timeout, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function repeatedly probes the specified slave until it
+**      acknowledges its address or the timeout expires. Devices that
+**      stop responding on the I2C bus while they program their flash
+**      or EEPROM can be waited on this way for exactly as long as they
+**      actually need instead of a fixed worst case delay.
+*/
+static BOOL
+FI2cWaitAckUnlocked(int fdI2cDev, BYTE slaveAddr, UINT32 uTimeout) {
+
+#if defined(__linux__)
+	struct timespec	tsStart;
+	struct timespec	tsNow;
+	struct timespec	tsWait;
+	INT64			usElapsed;
+
+	tsWait.tv_sec = 0;
+	tsWait.tv_nsec = usAckPollInterval * 1000;
+
+	clock_gettime(CLOCK_MONOTONIC, &tsStart);
+	while ( ! FI2cProbeUnlocked(fdI2cDev, slaveAddr) ) {
+		clock_gettime(CLOCK_MONOTONIC, &tsNow);
+		usElapsed = ((INT64)(tsNow.tv_sec - tsStart.tv_sec) * 1000000) +
+					((tsNow.tv_nsec - tsStart.tv_nsec) / 1000);
+		if ( usElapsed >= uTimeout ) {
+			return fFalse;
+		}
+		I2cNanosleep(fdI2cDev, &tsWait);
+	}
+#else
+	UINT32	usElapsed;
+
+	usElapsed = 0;
+	while ( ! FI2cProbeUnlocked(fdI2cDev, slaveAddr) ) {
+		if ( usElapsed >= uTimeout ) {
+			return fFalse;
+		}
+		I2cUsleep(usAckPollInterval);
+		usElapsed += usAckPollInterval;
+	}
+#endif
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALDelay
+**
+**  Parameters:
+**  	fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      us				- number of microseconds to wait
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function waits for a device on the bus, for example while
+**      it writes its EEPROM. Callers use it rather than sleeping
+**      themselves so that the delay is performed by the backend of the
+**      file descriptor, if it has one.
+*/
+void
+I2CHALDelay(int fdI2cDev, UINT32 us) {
+
+#if defined(__linux__)
+	struct timespec	tsWait;
+
+	tsWait.tv_sec = us / 1000000;
+	tsWait.tv_nsec = (us % 1000000) * 1000;
+	I2cNanosleep(fdI2cDev, &tsWait);
+#else
+	I2cUsleep(us);
+#endif
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALGetClockRate
+**
+**  Parameters:
+**  	fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**
+**  Return Value:
+**      I2C clock frequency in Hz, 0 if it can't be determined
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function returns the clock frequency of the I2C controller.
+**      On Linux the frequency is read from the "clock-frequency"
+**      property of the device tree node of the adapter, because i2c-dev
+**      has no interface to query or change it. The rate of a backend
+**      isn't known.
+*/
+UINT32
+I2CHALGetClockRate(int fdI2cDev) {
+
+#if defined(__linux__)
+	struct stat	st;
+	char		szFilePath[128];
+	BYTE		rgbFreq[4];
+	int			fd;
+	ssize_t		cb;
+
+	if (( NULL != PbeFromFd(fdI2cDev) ) ||
+		( 0 != fstat(fdI2cDev, &st) ) ||
+		( ! S_ISCHR(st.st_mode) )) {
+		return 0;
+	}
+
+	/* The minor number of an i2c-dev node is the adapter number.
+	*/
+	snprintf(szFilePath, sizeof(szFilePath), "/sys/bus/i2c/devices/i2c-%u/of_node/clock-frequency", minor(st.st_rdev));
+	fd = open(szFilePath, O_RDONLY | O_CLOEXEC);
+	if ( 0 > fd ) {
+		return 0;
+	}
+
+	cb = read(fd, rgbFreq, sizeof(rgbFreq));
+	close(fd);
+	if ( sizeof(rgbFreq) != cb ) {
+		return 0;
+	}
+
+	/* Device tree cells are big endian.
+	*/
+	return ((UINT32)rgbFreq[0] << 24) | ((UINT32)rgbFreq[1] << 16) | ((UINT32)rgbFreq[2] << 8) | rgbFreq[3];
+#elif defined(PLATFORM_ZYNQ)
+	return ( Iic_Init ) ? XIicPs_GetSClk(&IicDev) : hzIicScl;
+#else
+	/* The AXI IIC clock is fixed when the IP is generated.
+	*/
+	return 0;
+#endif
+}
+
+#if !defined(__linux__)
+/* ------------------------------------------------------------ */
+/***    I2CHALSetClockRate
+**
+**  Parameters:
+**      hzScl           - I2C clock frequency in Hz
+**
+**  Return Value:
+**      fTrue for success, fFalse if the controller doesn't support the
+**      frequency or its rate can't be changed at run time
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function sets the clock frequency of the Zynq PS I2C
+**      controller, which is IIC_SCLK_RATE by default. If it's called
+**      before I2CHALInit then the frequency is applied by I2CHALInit.
+**      Boards with short traces may run at Fast-mode Plus rates. The
+**      clock rate of the AXI IIC controller used on MicroBlaze is fixed
+**      when the IP is generated.
+*/
+BOOL
+I2CHALSetClockRate(UINT32 hzScl) {
+
+#if defined(PLATFORM_ZYNQ)
+	if (( Iic_Init ) && ( XST_SUCCESS != XIicPs_SetSClk(&IicDev, hzScl) )) {
+		return fFalse;
+	}
+
+	hzIicScl = hzScl;
+
+	return fTrue;
+#else
+	return fFalse;
+#endif
+}
+#endif
+
+/* ------------------------------------------------------------ */
+/***    I2CHALInitTimingProfile
+**
+**  Parameters:
+**      slaveAddr       - slave address the profile applies to
+**      pprof           - profile to initialize
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function initializes a timing profile that leaves every
+**      value passed by the callers of I2CHALRead and I2CHALWrite in
+**      effect. Fields are then changed as required before the profile
+**      is passed to I2CHALSetTimingProfile.
+*/
+void
+I2CHALInitTimingProfile(BYTE slaveAddr, I2cTimingProfile* pprof) {
+
+	pprof->slaveAddr = slaveAddr;
+	pprof->cbReadMax = 0;
+	pprof->cbWriteMax = 0;
+	pprof->usPreRead = usI2cTimingDefault;
+	pprof->usPostWrite = usI2cTimingDefault;
+	pprof->usErase = usI2cTimingDefault;
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALSetTimingProfile
+**
+**  Parameters:
+**      pprof           - profile of the slave whose address it holds
+**
+**  Return Value:
+**      fTrue for success, fFalse if cbWriteMax is less than 3, either
+**      transaction size exceeds its limit, or the
+**      table of profiles is full
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function sets the timing used for every subsequent transfer
+**      with the slave, on every controller, replacing the slave's
+**      previous profile if it had one. The transaction sizes may exceed
+**      the defaults of 32 byte reads and 34 byte writes, up to
+**      cbI2cReadTransLimit and cbI2cWriteTransLimit, for a slave whose
+**      firmware is known to accept them.
+*/
+BOOL
+I2CHALSetTimingProfile(const I2cTimingProfile* pprof) {
+
+	BYTE	iprof;
+	BOOL	fRet;
+
+	if ((( 0 != pprof->cbWriteMax ) && ( 3 > pprof->cbWriteMax )) ||
+		( cbI2cWriteTransLimit < pprof->cbWriteMax ) ||
+		( cbI2cReadTransLimit < pprof->cbReadMax )) {
+		return fFalse;
+	}
+
+#if defined(__linux__)
+	pthread_mutex_lock(&mtxI2cTiming);
+#endif
+
+	for ( iprof = 0; iprof < cprofI2c; iprof++ ) {
+		if ( pprof->slaveAddr == rgprofI2c[iprof].slaveAddr ) {
+			break;
+		}
+	}
+
+	fRet = fFalse;
+	if ( iprof < cI2cTimingProfileMax ) {
+		rgprofI2c[iprof] = *pprof;
+		if ( iprof == cprofI2c ) {
+			cprofI2c++;
+		}
+		fRet = fTrue;
+	}
+
+#if defined(__linux__)
+	pthread_mutex_unlock(&mtxI2cTiming);
+#endif
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALGetTimingProfile
+**
+**  Parameters:
+**      slaveAddr       - slave address
+**      pprof           - pointer to a variable to receive the profile
+**
+**  Return Value:
+**      fTrue if the slave has a profile, fFalse otherwise, in which case
+**      pprof is initialized as by I2CHALInitTimingProfile
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function returns the timing profile of a slave.
+*/
+BOOL
+I2CHALGetTimingProfile(BYTE slaveAddr, I2cTimingProfile* pprof) {
+
+	BYTE	iprof;
+	BOOL	fRet;
+
+	I2CHALInitTimingProfile(slaveAddr, pprof);
+	fRet = fFalse;
+
+#if defined(__linux__)
+	pthread_mutex_lock(&mtxI2cTiming);
+#endif
+
+	for ( iprof = 0; iprof < cprofI2c; iprof++ ) {
+		if ( slaveAddr == rgprofI2c[iprof].slaveAddr ) {
+			*pprof = rgprofI2c[iprof];
+			fRet = fTrue;
+			break;
+		}
+	}
+
+#if defined(__linux__)
+	pthread_mutex_unlock(&mtxI2cTiming);
+#endif
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALClearTimingProfile
+**
+**  Parameters:
+**      slaveAddr       - slave address, 0xFF to clear every profile
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function removes the timing profile of a slave, so that the
+**      values passed by the callers of I2CHALRead and I2CHALWrite are
+**      used again.
+*/
+void
+I2CHALClearTimingProfile(BYTE slaveAddr) {
+
+	BYTE	iprof;
+
+#if defined(__linux__)
+	pthread_mutex_lock(&mtxI2cTiming);
+#endif
+
+	if ( 0xFF == slaveAddr ) {
+		cprofI2c = 0;
+	}
+
+	for ( iprof = 0; iprof < cprofI2c; iprof++ ) {
+		if ( slaveAddr == rgprofI2c[iprof].slaveAddr ) {
+			cprofI2c--;
+			rgprofI2c[iprof] = rgprofI2c[cprofI2c];
+			break;
+		}
+	}
+
+#if defined(__linux__)
+	pthread_mutex_unlock(&mtxI2cTiming);
+#endif
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALCalibrateReadTiming
+**
+**  Parameters:
+**  	fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      slaveAddr		- slave address of the device
+**      addrRead        - first address of a range whose contents don't
+**                        change while the calibration is performed, such
+**                        as the DNA of a SYZYGY pod
+**      cbRef           - number of bytes in the range
+**      usPreReadMax    - delay before each read known to work, such as
+**                        the value passed to I2CHALRead by the device layer
+**      pprof           - pointer to a variable to receive the profile
+**
+**  Return Value:
+**      fTrue for success, fFalse if the range couldn't be read with the
+**      default timing
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function measures the read timing of a slave. The range is
+**      first read with the default transaction size and usPreReadMax.
+**      The largest transaction size, up to cbRef, that returns the same
+**      data is then determined by halving, followed by the shortest
+**      delay before each read that still returns the same data
+**      cI2cCalibrateIter times in a row. The result is returned in a
+**      profile that also leaves every write value of the caller in
+**      effect, it isn't applied until it's passed to
+**      I2CHALSetTimingProfile. Writes aren't calibrated because doing so
+**      would wear the EEPROM and flash of the devices.
+*/
+BOOL
+I2CHALCalibrateReadTiming(int fdI2cDev, BYTE slaveAddr, WORD addrRead, BYTE cbRef, UINT32 usPreReadMax, I2cTimingProfile* pprof) {
+
+	BYTE	rgbRef[cbCalibrateRefMax];
+	size_t	cbDone;
+	WORD	cbTransMax;
+	UINT32	usPreRead;
+	BOOL	fRet;
+
+	I2CHALInitTimingProfile(slaveAddr, pprof);
+	if ( 0 == cbRef ) {
+		return fFalse;
+	}
+
+	if ( ! I2CHALLock(fdI2cDev) ) {
+		SetLastError(fFalse);
+		return fFalse;
+	}
+
+	fRet = FI2cReadUnlocked(fdI2cDev, slaveAddr, addrRead, rgbRef, cbRef, &cbDone, usPreReadMax, cbReadTransMax) &&
+		   ( cbRef == cbDone );
+	if ( ! fRet ) {
+		goto lExit;
+	}
+
+	cbTransMax = cbRef;
+	while (( cbReadTransMax < cbTransMax ) &&
+		   ( ! FI2cCalibrateRead(fdI2cDev, slaveAddr, addrRead, cbRef, rgbRef, usPreReadMax, cbTransMax, cI2cCalibrateIter) )) {
+		cbTransMax /= 2;
+	}
+	if ( cbReadTransMax > cbTransMax ) {
+		cbTransMax = ( cbReadTransMax < cbRef ) ? cbReadTransMax : cbRef;
+	}
+
+	usPreRead = usPreReadMax;
+	while ( 0 < usPreRead ) {
+		if ( ! FI2cCalibrateRead(fdI2cDev, slaveAddr, addrRead, cbRef, rgbRef, usPreRead / 2, cbTransMax, cI2cCalibrateIter) ) {
+			break;
+		}
+		usPreRead /= 2;
+	}
+
+	pprof->cbReadMax = cbTransMax;
+	pprof->usPreRead = usPreRead;
+
+lExit:
+
+	SetLastError(fRet);
+	I2CHALUnlock(fdI2cDev);
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALNegotiateReadMax
+**
+**  Parameters:
+**  	fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      slaveAddr		- slave address of the device
+**      addrRead        - first address of a range whose contents don't
+**                        change while the negotiation is performed
+**      cbRef           - number of bytes in the range, at most
+**                        cbCalibrateRefMax
+**      uWait           - delay before each read, as passed to I2CHALRead
+**      pcbReadMax      - pointer to a variable to receive the largest
+**                        read transaction the slave returned correctly
+**
+**  Return Value:
+**      fTrue for success, fFalse if the range couldn't be read with the
+**      default transaction size
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function determines the largest read transaction a slave
+**      supports. The range is first read with the default transaction
+**      size, which every device on the bus supports. The whole range is
+**      then read by a single transaction, and by transactions of half
+**      the size after each one that fails or returns different data,
+**      until the data matches or the default transaction size is
+**      reached. A slave that can't send that many bytes in a single
+**      transaction either fails the read or returns data that differs
+**      from the reference. Nothing is written to the slave. The result
+**      is normally placed in the cbReadMax field of the slave's timing
+**      profile.
+*/
+BOOL
+I2CHALNegotiateReadMax(int fdI2cDev, BYTE slaveAddr, WORD addrRead, WORD cbRef, UINT32 uWait, WORD* pcbReadMax) {
+
+	BYTE	rgbRef[cbCalibrateRefMax];
+	size_t	cbDone;
+	WORD	cbTransMax;
+	BOOL	fRet;
+
+	*pcbReadMax = cbReadTransMax;
+	if (( 0 == cbRef ) || ( cbCalibrateRefMax < cbRef )) {
+		return fFalse;
+	}
+
+	if ( ! I2CHALLock(fdI2cDev) ) {
+		SetLastError(fFalse);
+		return fFalse;
+	}
+
+	fRet = FI2cReadUnlocked(fdI2cDev, slaveAddr, addrRead, rgbRef, cbRef, &cbDone, uWait, cbReadTransMax) &&
+		   ( cbRef == cbDone );
+	if ( ! fRet ) {
+		goto lExit;
+	}
+
+	cbTransMax = cbRef;
+	while (( cbReadTransMax < cbTransMax ) &&
+		   ( ! FI2cCalibrateRead(fdI2cDev, slaveAddr, addrRead, cbRef, rgbRef, uWait, cbTransMax, 1) )) {
+		cbTransMax /= 2;
+	}
+	if ( cbReadTransMax < cbTransMax ) {
+		*pcbReadMax = cbTransMax;
+	}
+
+lExit:
+
+	SetLastError(fRet);
+	I2CHALUnlock(fdI2cDev);
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    FI2cCalibrateRead
+**
+**  Parameters:
+**  	fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      slaveAddr		- slave address of the device
+**      addrRead        - memory address to read
+**      cbRead          - number of bytes to read
+**      pbRef           - data read with the default timing
+**      usPreRead       - delay to try before each read
+**      cbTransMax      - transaction size to try
+**      citer           - number of times to read the range
+**
+**  Return Value:
+**      fTrue if every read returned the reference data
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function tries one combination of read timing values
+**      citer times. The caller holds the lock of the bus.
+*/
+static BOOL
+FI2cCalibrateRead(int fdI2cDev, BYTE slaveAddr, WORD addrRead, WORD cbRead, const BYTE* pbRef, UINT32 usPreRead, WORD cbTransMax, BYTE citer) {
+
+	BYTE	rgb[cbCalibrateRefMax];
+	size_t	cbDone;
+	BYTE	iiter;
+
+	for ( iiter = 0; iiter < citer; iiter++ ) {
+		if (( ! FI2cReadUnlocked(fdI2cDev, slaveAddr, addrRead, rgb, cbRead, &cbDone, usPreRead, cbTransMax) ) ||
+			( cbRead != cbDone ) ||
+			( 0 != memcmp(rgb, pbRef, cbRead) )) {
+			return fFalse;
+		}
+	}
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    I2cResolveTiming
+**
+**  Parameters:
+**      ptmg            - values passed by the caller, on input, and the
+**                        values to use, on output
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function replaces the timing values chosen by a caller for
+**      the slave in ptmg->slaveAddr with those of the slave's profile.
+*/
+static void
+I2cResolveTiming(I2cTimingProfile* ptmg) {
+
+	I2cTimingProfile	prof;
+
+	if ( ! I2CHALGetTimingProfile(ptmg->slaveAddr, &prof) ) {
+		return;
+	}
+
+	if ( 0 != prof.cbReadMax ) {
+		ptmg->cbReadMax = prof.cbReadMax;
+	}
+	if ( 0 != prof.cbWriteMax ) {
+		ptmg->cbWriteMax = prof.cbWriteMax;
+	}
+	if ( usI2cTimingDefault != prof.usPreRead ) {
+		ptmg->usPreRead = prof.usPreRead;
+	}
+	if ( usI2cTimingDefault != prof.usPostWrite ) {
+		ptmg->usPostWrite = prof.usPostWrite;
+	}
+	if ( usI2cTimingDefault != prof.usErase ) {
+		ptmg->usErase = prof.usErase;
+	}
+}
+
+#if defined(__linux__)
+/* ------------------------------------------------------------ */
+/***    CbI2cReadMax
+**
+**  Parameters:
+**      slaveAddr       - slave address
+**
+**  Return Value:
+**      maximum number of bytes read from the slave by one transaction
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function returns the read transaction size of a slave.
+*/
+static WORD
+CbI2cReadMax(BYTE slaveAddr) {
+
+	I2cTimingProfile	tmg;
+
+	I2CHALInitTimingProfile(slaveAddr, &tmg);
+	tmg.cbReadMax = cbReadTransMax;
+	I2cResolveTiming(&tmg);
+
+	return tmg.cbReadMax;
+}
+#endif
+
+/* ------------------------------------------------------------ */
+/***    I2CHALRead
+**
+**  Description:
+**      See FI2cReadUnlocked and I2CHALLock.
+**      The timing profile of the slave, if any, replaces uWait and the
+**      default transaction size.
+*/
+BOOL
+I2CHALRead(int fdI2cDev, BYTE slaveAddr, WORD addrRead, BYTE* pbRead, size_t cbRead, size_t* pcbRead, UINT32 uWait) {
+
+	I2cTimingProfile	tmg;
+	BOOL				fRet;
+	size_t				cbDone;
+
+	I2CHALInitTimingProfile(slaveAddr, &tmg);
+	tmg.cbReadMax = cbReadTransMax;
+	tmg.usPreRead = uWait;
+	I2cResolveTiming(&tmg);
+
+	if ( ! I2CHALLock(fdI2cDev) ) {
+		if ( NULL != pcbRead ) {
+			*pcbRead = 0;
+		}
+		SetLastError(fFalse);
+		return fFalse;
+	}
+	I2cStatBegin();
+	fRet = FI2cReadUnlocked(fdI2cDev, slaveAddr, addrRead, pbRead, cbRead, &cbDone, tmg.usPreRead, tmg.cbReadMax);
+	I2cStatEnd(fdI2cDev, slaveAddr, i2cstatRead, (UINT32)cbDone, 0, fRet);
+	SetLastError(fRet);
+	if ( NULL != pcbRead ) {
+		*pcbRead = cbDone;
+	}
+	I2CHALUnlock(fdI2cDev);
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    FI2cReadUnlocked
+**
+**  Parameters:
+**  	fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      slaveAddr		- slave address of the device
+**      addrRead        - memory address to read
+**      pbRead          - pointer to a buffer to receive data
+**      cbRead          - number of bytes to read
+**      pcbRead         - pointer to variable to receive count of bytes
+**                        read
+**      uWait			- number of microseconds to wait between writing the
+**                        memory address and reading the data
+**      cbTransMax		- maximum number of bytes read by one transaction
+**
+**  Return Value:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function reads the specified number of bytes from the
+**      Platform MCU starting at the specified address. Read operations
+**      may be split into multiple transactions with a maximum of
+**      cbTransMax bytes being retrieved during a single read operation.
+**
+**      On Linux, when the adapter supports it, the memory address and
+**      the data of each transaction are transferred with a single
+**      I2C_RDWR ioctl that uses a repeated start between the write and
+**      the read. No stop condition is placed on the bus between the two
+**      phases so the delay that's otherwise required before the read is
+**      not needed.
+*/
+static BOOL
+FI2cReadUnlocked(int fdI2cDev, BYTE slaveAddr, WORD addrRead, BYTE* pbRead, size_t cbRead, size_t* pcbRead, UINT32 uWait, WORD cbTransMax) {
+
+	WORD			cbTrans;
+#if defined(__linux__)
+	ssize_t			cb;
+#endif
+	size_t			cbRecv;
+	BYTE			rgbSnd[2];
+	char			szErr[64];
+	char			szErrDesc[128];
+
+//
+
+	cbRecv = 0;
+	strcpy(szErr, "ERROR: PmcuI2cRead - ");
+	szErrDesc[0] = '\0';
+
+	/* Inform the I2C driver of the slave address. This isn't required
+	** for combined transactions since each message carries the slave
+	** address.
+	*/
+#if defined(__linux__)
+	struct timespec				tsWait;
+	struct i2c_msg				rgmsg[2];
+	struct i2c_rdwr_ioctl_data	rdwr;
+	BOOL						fRdwr;
+
+	fRdwr = FI2cRdwrSupported(fdI2cDev);
+	if (( ! fRdwr ) && ( ! FI2cSetSlave(fdI2cDev, slaveAddr) )) {
+		sprintf(szErrDesc, "failed to set I2C slave address");
+		goto lErrorExit;
+	}
+	tsWait.tv_sec = uWait / 1000000;
+	tsWait.tv_nsec = (uWait % 1000000) * 1000;
+#endif
+
+	while ( cbRecv < cbRead ) {
+
+#if defined(__linux__)
+		if ( fRdwr ) {
+			cbTrans = cbTransMax;
+			if ( cbRead - cbRecv < cbTrans ) {
+				cbTrans = cbRead - cbRecv;
+			}
+
+			rgbSnd[0] = (addrRead  >> 8);
+			rgbSnd[1] = addrRead & 0xFF;
+
+			/* Write the memory address and then read the data back
+			** following a repeated start.
+			*/
+			rgmsg[0].addr = slaveAddr;
+			rgmsg[0].flags = 0;
+			rgmsg[0].len = 2;
+			rgmsg[0].buf = rgbSnd;
+			rgmsg[1].addr = slaveAddr;
+			rgmsg[1].flags = I2C_M_RD;
+			rgmsg[1].len = cbTrans;
+			rgmsg[1].buf = &(pbRead[cbRecv]);
+			rdwr.msgs = rgmsg;
+			rdwr.nmsgs = 2;
+
+			I2cStatChunk();
+			if ( ! FI2cRdwr(fdI2cDev, &rdwr) ) {
+				sprintf(szErrDesc, "read failed after %lu bytes", (unsigned long)cbRecv);
+				goto lErrorExit;
+			}
+			cbRecv += cbTrans;
+			addrRead += cbTrans;
+			continue;
+		}
+#endif
+
+		/* Transmit the memory address to the slave.
+		*/
+		rgbSnd[0] = (addrRead  >> 8);
+		rgbSnd[1] = addrRead & 0xFF;
+		I2cStatChunk();
+
+#if defined(__linux__)
+		if ( 2 != CbI2cWrite(fdI2cDev, rgbSnd, 2) ) {
+			sprintf(szErrDesc, "failed to write memory address");
+			goto lErrorExit;
+		}
+#else
+		// Send the read address
+		if ( ! FIicSend(slaveAddr, rgbSnd, 2) ) {
+			strcpy(szErrDesc, "failed to write memory address");
+			goto lErrorExit;
+		}
+#endif
+
+
+
+		cbTrans = cbTransMax;
+		if ( cbRead - cbRecv < cbTrans ) {
+			cbTrans = cbRead - cbRecv;
+		}
 
 		/* The Linux/Zynq I2C controller places the stop condition on the bus
 		** after every call to a read or write function. The I2C controller
@@ -321,183 +2574,1451 @@ I2CHALRead(int fdI2cDev, BYTE slaveAddr, WORD addrRead, BYTE* pbRead, BYTE cbRea
 		** condition and SLA+R too soon for the PMCU to respond. Therefore
 		** we must delay thread execution before calling the read function.
 		*/
-		//
+		//
+
+
+#if defined(__linux__)
+		I2cNanosleep(fdI2cDev, &tsWait);
+		cb = CbI2cRead(fdI2cDev, &(pbRead[cbRecv]), cbTrans);
+		if ( 0 >= cb ) {
+			sprintf(szErrDesc, "read failed after %lu bytes", (unsigned long)cbRecv);
+			goto lErrorExit;
+		}
+		cbRecv += cb;
+		addrRead += cb;
+#else
+		I2cUsleep(uWait);
+		// Receive function form the flash
+		if ( ! FIicRecv(slaveAddr, &(pbRead[cbRecv]), cbTrans) ) {
+			sprintf(szErrDesc, "read failed after %lu bytes", (unsigned long)cbRecv);
+			goto lErrorExit;
+		}
+		cbRecv += cbTrans;
+		addrRead += cbTrans;
+#endif
+
+	}
+
+	if ( NULL != pcbRead ) {
+		*pcbRead = cbRecv;
+	}
+
+	return fTrue;
+
+lErrorExit:
+
+	if ( NULL != pcbRead ) {
+		*pcbRead = cbRecv;
+	}
+
+	if ( dpmutilfVerbose ) {
+		printf("%s%s\n", szErr, szErrDesc);
+	}
+
+	return fFalse;
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALWrite
+**
+**  Description:
+**      See FI2cWriteUnlocked and I2CHALLock.
+**      The timing profile of the slave, if any, replaces cbDevRxMax,
+**      uWait, and uAckTimeout.
+*/
+BOOL
+I2CHALWrite(int fdI2cDev, BYTE slaveAddr, WORD addrWrite, BYTE* pbWrite, size_t cbWrite, INT32 cbDevRxMax, size_t* pcbWritten, INT32 uWait, UINT32 uAckTimeout) {
+
+	I2cTimingProfile	tmg;
+	BOOL				fRet;
+	size_t				cbDone;
+
+	I2CHALInitTimingProfile(slaveAddr, &tmg);
+	tmg.cbWriteMax = ( cbWriteTransMax < cbDevRxMax ) ? cbWriteTransMax : cbDevRxMax;
+	tmg.usPostWrite = uWait;
+	tmg.usErase = uAckTimeout;
+	I2cResolveTiming(&tmg);
+
+	if ( ! I2CHALLock(fdI2cDev) ) {
+		if ( NULL != pcbWritten ) {
+			*pcbWritten = 0;
+		}
+		SetLastError(fFalse);
+		return fFalse;
+	}
+	I2cStatBegin();
+	fRet = FI2cWriteUnlocked(fdI2cDev, slaveAddr, addrWrite, pbWrite, cbWrite, tmg.cbWriteMax, &cbDone, tmg.usPostWrite, tmg.usErase);
+	I2cStatEnd(fdI2cDev, slaveAddr, i2cstatWrite, 0, (UINT32)cbDone, fRet);
+	SetLastError(fRet);
+	if ( NULL != pcbWritten ) {
+		*pcbWritten = cbDone;
+	}
+	I2CHALUnlock(fdI2cDev);
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    FI2cWriteUnlocked
+**
+**  Parameters:
+**  	fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      addrWrite       - memory address to write
+**      pbWrite         - pointer to a buffer to containing data to transmit
+**      cbWrite         - number of bytes to write
+**      pcbWrite        - pointer to variable to receive count of bytes
+**                        written
+**      uWait			- number of microseconds to wait between writes
+**      uAckTimeout		- maximum number of microseconds to poll for an
+**                        acknowledge after each write, 0 to use uWait
+**
+**  Return Value:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function writes the specified number of bytes to the
+**      Platform MCU starting at the specified address. Write operations
+**      may be split into multiple transactions with a maximum of
+**      cbDevRxMax bytes, including the memory address, being written
+**      during a single write operation.
+**
+**      When uAckTimeout is non-zero the slave is acknowledge polled
+**      after every transaction, including the last one, so that the
+**      time between transactions is determined by how long the device
+**      actually takes to complete each write. Otherwise the function
+**      waits a fixed uWait microseconds between transactions.
+*/
+static BOOL
+FI2cWriteUnlocked(int fdI2cDev, BYTE slaveAddr, WORD addrWrite, BYTE* pbWrite, size_t cbWrite, INT32 cbDevRxMax, size_t* pcbWritten, INT32 uWait, UINT32 uAckTimeout) {
+
+#if defined(__linux__)
+	ssize_t	cb;
+#endif
+	WORD	ib;
+	WORD	cbTrans;
+	size_t	cbSent;
+	BYTE	rgbSnd[cbI2cWriteTransLimit];
+	char	szErr[64];
+	char	szErrDesc[128];
+
+	cbSent = 0;
+	strcpy(szErr, "ERROR: PmcuI2cWrite - ");
+	szErrDesc[0] = '\0';
+
+	/* Inform the I2C driver of the slave address.
+	*/
+#if defined(__linux__)
+	struct timespec tsWait;
+	if ( ! FI2cSetSlave(fdI2cDev, slaveAddr) ) {
+		sprintf(szErrDesc, "failed to set I2C slave address");
+		goto lErrorExit;
+	}
+#endif
+
+	while ( cbSent < cbWrite ) {
+		/* Determine how many bytes to transfer to the Eclypse PMCU for
+		** this transaction.
+		*/
+		cbTrans = cbI2cWriteTransLimit;
+		if ( cbDevRxMax < cbTrans ) {
+			cbTrans = cbDevRxMax;
+		}
+		if ( 2 + (cbWrite - cbSent) < cbTrans ) {
+			cbTrans = 2 + (cbWrite - cbSent);
+		}
+
+		/* Populate the buffer with the memory address to be written
+		** and any data that's being written to that address during
+		** this transfer.
+		*/
+		rgbSnd[0] = (addrWrite  >> 8);
+		rgbSnd[1] = addrWrite & 0xFF;
+		for ( ib = 2; ib < cbTrans; ib++ ) {
+			rgbSnd[ib] = *pbWrite;
+			pbWrite++;
+		}
+
+		/* Transmit the memory address and data to the slave.
+		*/
+		I2cStatChunk();
+#if defined(__linux__)
+		cb = CbI2cWrite(fdI2cDev, rgbSnd, cbTrans);
+		if (cb != cbTrans ) {
+			sprintf(szErrDesc, "write failed after %lu bytes", (unsigned long)cbSent);
+			goto lErrorExit;
+		}
+#else
+		// Send the data to the flash
+		if ( ! FIicSend(slaveAddr, rgbSnd, cbTrans) ) {
+			sprintf(szErrDesc, "write failed after %lu bytes", (unsigned long)cbSent);
+			goto lErrorExit;
+		}
+#endif
+
+
+		cbSent += (cbTrans-2);
+		addrWrite += (cbTrans-2);
+
+		if ( 0 != uAckTimeout ) {
+			/* Wait for the slave to finish processing the data that was
+			** just written. The slave will not acknowledge its address
+			** until it's ready to accept another transaction.
+			*/
+			if ( ! FI2cWaitAckUnlocked(fdI2cDev, slaveAddr, uAckTimeout) ) {
+				sprintf(szErrDesc, "timed out waiting for acknowledge after %lu bytes", (unsigned long)cbSent);
+				goto lErrorExit;
+			}
+		}
+		else if ( cbSent < cbWrite ) {
+#if defined(__linux__)
+			tsWait.tv_sec = uWait / 1000000;
+			tsWait.tv_nsec = (uWait % 1000000) * 1000;
+			I2cNanosleep(fdI2cDev, &tsWait);
+#else
+			I2cUsleep(uWait);
+#endif
+
+		}
+	}
+
+	if ( NULL != pcbWritten ) {
+		*pcbWritten = cbSent;
+	}
+
+	return fTrue;
+
+lErrorExit:
+
+	if ( NULL != pcbWritten ) {
+		*pcbWritten = cbSent;
+	}
+
+	if ( dpmutilfVerbose ) {
+		printf("%s%s\n", szErr, szErrDesc);
+	}
+
+	return fFalse;
+}
+
+/* ------------------------------------------------------------ */
+/*              Batched Transactions                            */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/***    I2CHALBatchBegin
+**
+**  Parameters:
+**      pbatch          - pointer to the batch to initialize
+**  	fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function initializes an empty batch of I2C operations that
+**      will be performed on the specified I2C controller.
+*/
+void
+I2CHALBatchBegin(I2cBatch* pbatch, int fdI2cDev) {
+
+	pbatch->fdI2cDev = fdI2cDev;
+	pbatch->cop = 0;
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALBatchAddRead
+**
+**  Parameters:
+**      pbatch          - pointer to the batch
+**      slaveAddr		- slave address of the device
+**      addrRead        - memory address to read
+**      pbRead          - pointer to a buffer to receive data
+**      cbRead          - number of bytes to read
+**      uWait			- number of microseconds to wait between the
+**                        address write and the read (bare metal only)
+**
+**  Return Value:
+**      fTrue if the read was queued, fFalse if the batch is full
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function queues a read of cbRead bytes starting at the
+**      specified memory address of the specified slave. The buffer
+**      pointed to by pbRead must remain valid until the batch has been
+**      submitted.
+*/
+BOOL
+I2CHALBatchAddRead(I2cBatch* pbatch, BYTE slaveAddr, WORD addrRead, BYTE* pbRead, BYTE cbRead, UINT32 uWait) {
+
+	I2cBatchOp*	pop;
+
+	if (( cI2cBatchOpMax <= pbatch->cop ) || ( NULL == pbRead )) {
+		return fFalse;
+	}
+
+	pop = &pbatch->rgop[pbatch->cop];
+	pop->slaveAddr = slaveAddr;
+	pop->fRead = fTrue;
+	pop->addr = addrRead;
+	pop->pbRead = pbRead;
+	pop->cb = cbRead;
+	pop->uWait = uWait;
+	pop->fSuccess = fFalse;
+
+	pbatch->cop++;
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALBatchAddWrite
+**
+**  Parameters:
+**      pbatch          - pointer to the batch
+**      slaveAddr		- slave address of the device
+**      addrWrite       - memory address to write
+**      pbWrite         - pointer to the data to write
+**      cbWrite         - number of bytes to write
+**
+**  Return Value:
+**      fTrue if the write was queued, fFalse if the batch is full or
+**      cbWrite exceeds cbI2cBatchWriteMax
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function queues a write of cbWrite bytes to the specified
+**      memory address of the specified slave. The data is copied into
+**      the batch so the caller's buffer may be reused immediately.
+**      On Linux a write may share an I2C_RDWR ioctl with the operations
+**      around it, separated from them by repeated starts rather than a
+**      stop, and the slave isn't acknowledge polled afterwards. Batched
+**      writes should therefore only be used with devices that accept
+**      back-to-back writes, and cbWrite + 2 must not exceed the receive
+**      buffer of the device. A write whose ioctl fails isn't repeated.
+*/
+BOOL
+I2CHALBatchAddWrite(I2cBatch* pbatch, BYTE slaveAddr, WORD addrWrite, const BYTE* pbWrite, BYTE cbWrite) {
+
+	I2cBatchOp*	pop;
+
+	if (( cI2cBatchOpMax <= pbatch->cop ) || ( cbI2cBatchWriteMax < cbWrite )) {
+		return fFalse;
+	}
+
+	pop = &pbatch->rgop[pbatch->cop];
+	pop->slaveAddr = slaveAddr;
+	pop->fRead = fFalse;
+	pop->addr = addrWrite;
+	pop->pbRead = NULL;
+	pop->cb = cbWrite;
+	pop->uWait = 0;
+	pop->rgbSnd[0] = (addrWrite >> 8);
+	pop->rgbSnd[1] = addrWrite & 0xFF;
+	memcpy(&pop->rgbSnd[2], pbWrite, cbWrite);
+	pop->fSuccess = fFalse;
+
+	pbatch->cop++;
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALBatchSubmit
+**
+**  Description:
+**      See FI2cBatchSubmitUnlocked and I2CHALLock.
+*/
+BOOL
+I2CHALBatchSubmit(I2cBatch* pbatch) {
+
+	BOOL	fRet;
+	BYTE	iop;
+#if defined(DPMUTIL_STATS)
+	BYTE	cop;
+
+	cop = pbatch->cop;
+#endif
+
+	if ( ! I2CHALLock(pbatch->fdI2cDev) ) {
+		for ( iop = 0; iop < pbatch->cop; iop++ ) {
+			pbatch->rgop[iop].fSuccess = fFalse;
+		}
+		SetLastError(fFalse);
+		return fFalse;
+	}
+	I2cStatBegin();
+	fRet = FI2cBatchSubmitUnlocked(pbatch);
+	I2cStatEndBatch(pbatch, cop, fRet);
+	SetLastError(fRet);
+	I2CHALUnlock(pbatch->fdI2cDev);
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    FI2cBatchSubmitUnlocked
+**
+**  Parameters:
+**      pbatch          - pointer to the batch
+**
+**  Return Value:
+**      fTrue if every queued operation succeeded, fFalse otherwise
+**
+**  Errors:
+**      The fSuccess member of each operation indicates whether or not
+**      that particular operation succeeded.
+**
+**  Description:
+**      This function performs all of the operations queued in the
+**      batch, in the order in which they were queued.
+**
+**      On Linux, when the adapter supports it, the operations are
+**      packed into as few I2C_RDWR ioctls as possible. Each read is a
+**      memory address write followed by a repeated start read, split
+**      into messages no larger than the read size of the slave's
+**      timing profile, cbReadTransMax by default. If an ioctl fails then the
+**      reads it contained are retried one at a time so that the status
+**      of each one can be determined. Its writes aren't retried, since
+**      those that preceded the failure have already been performed and
+**      repeating them would write the device again. They're reported as
+**      failed, which means that they may or may not have been performed,
+**      and it's up to the caller to decide whether to write them again.
+**
+**      On bare metal, and on adapters that don't support I2C_RDWR, the
+**      operations are performed back-to-back as individual polled
+**      transactions.
+**
+**      The batch is emptied once it has been submitted, but the status
+**      of each operation remains available until the next operation
+**      is queued.
+*/
+static BOOL
+FI2cBatchSubmitUnlocked(I2cBatch* pbatch) {
+
+	BYTE	iop;
+	BOOL	fSuccess;
+#if defined(__linux__)
+	BYTE	iopFirst;
+	WORD	cmsg;
+	WORD	cmsgOp;
+	WORD	cbTransMax;
+
+	if ( FI2cRdwrSupported(pbatch->fdI2cDev) ) {
+		iopFirst = 0;
+		cmsg = 0;
+		for ( iop = 0; iop < pbatch->cop; iop++ ) {
+			/* Determine how many messages this operation requires and
+			** submit the operations that have accumulated so far if it
+			** won't fit in the same ioctl.
+			*/
+			if ( pbatch->rgop[iop].fRead ) {
+				cbTransMax = CbI2cReadMax(pbatch->rgop[iop].slaveAddr);
+				cmsgOp = 2 * ((pbatch->rgop[iop].cb + cbTransMax - 1) / cbTransMax);
+			}
+			else {
+				cmsgOp = 1;
+			}
+
+			if ( cI2cRdwrMsgMax < (cmsg + cmsgOp) ) {
+				if ( ! FI2cBatchSubmitRdwr(pbatch, iopFirst, iop) ) {
+					I2cBatchRetryReads(pbatch, iopFirst, iop);
+				}
+				iopFirst = iop;
+				cmsg = 0;
+			}
+
+			cmsg += cmsgOp;
+		}
+
+		if (( iopFirst < pbatch->cop ) &&
+			( ! FI2cBatchSubmitRdwr(pbatch, iopFirst, pbatch->cop) )) {
+			I2cBatchRetryReads(pbatch, iopFirst, pbatch->cop);
+		}
+	}
+	else
+#endif
+	{
+		for ( iop = 0; iop < pbatch->cop; iop++ ) {
+			FI2cBatchSubmitOp(pbatch, iop);
+		}
+	}
+
+	fSuccess = fTrue;
+	for ( iop = 0; iop < pbatch->cop; iop++ ) {
+		if ( ! pbatch->rgop[iop].fSuccess ) {
+			fSuccess = fFalse;
+		}
+	}
+
+	pbatch->cop = 0;
+
+	return fSuccess;
+}
+
+#if defined(__linux__)
+/* ------------------------------------------------------------ */
+/***    FI2cBatchSubmitRdwr
+**
+**  Parameters:
+**      pbatch          - pointer to the batch
+**      iopFirst        - index of the first operation to submit
+**      iopLast         - index of the operation after the last one
+**                        to submit
+**
+**  Return Value:
+**      fTrue if the ioctl succeeded, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function performs the specified range of batch operations
+**      using a single I2C_RDWR ioctl. The caller must ensure that the
+**      operations fit within cI2cRdwrMsgMax messages.
+*/
+static BOOL
+FI2cBatchSubmitRdwr(I2cBatch* pbatch, BYTE iopFirst, BYTE iopLast) {
+
+	struct i2c_msg				rgmsg[cI2cRdwrMsgMax];
+	BYTE						rgbAddr[cI2cRdwrMsgMax][2];
+	struct i2c_rdwr_ioctl_data	rdwr;
+	I2cBatchOp*					pop;
+	WORD						cmsg;
+	BYTE						iop;
+	WORD						cbDone;
+	WORD						cbTrans;
+	WORD						addr;
+	WORD						cbTransMax;
+
+	cmsg = 0;
+	for ( iop = iopFirst; iop < iopLast; iop++ ) {
+		pop = &pbatch->rgop[iop];
+		pop->fSuccess = fFalse;
+
+		if ( ! pop->fRead ) {
+			rgmsg[cmsg].addr = pop->slaveAddr;
+			rgmsg[cmsg].flags = 0;
+			rgmsg[cmsg].len = 2 + pop->cb;
+			rgmsg[cmsg].buf = pop->rgbSnd;
+			cmsg++;
+			continue;
+		}
+
+		/* The timing profile may have changed since the messages were
+		** counted, in which case the operations are performed one at a
+		** time instead.
+		*/
+		cbTransMax = CbI2cReadMax(pop->slaveAddr);
+		cbDone = 0;
+		while ( cbDone < pop->cb ) {
+			if ( cI2cRdwrMsgMax < (cmsg + 2) ) {
+				return fFalse;
+			}
+
+			cbTrans = pop->cb - cbDone;
+			if ( cbTransMax < cbTrans ) {
+				cbTrans = cbTransMax;
+			}
+
+			addr = pop->addr + cbDone;
+			rgbAddr[cmsg][0] = (addr >> 8);
+			rgbAddr[cmsg][1] = addr & 0xFF;
+
+			rgmsg[cmsg].addr = pop->slaveAddr;
+			rgmsg[cmsg].flags = 0;
+			rgmsg[cmsg].len = 2;
+			rgmsg[cmsg].buf = rgbAddr[cmsg];
+			rgmsg[cmsg+1].addr = pop->slaveAddr;
+			rgmsg[cmsg+1].flags = I2C_M_RD;
+			rgmsg[cmsg+1].len = cbTrans;
+			rgmsg[cmsg+1].buf = &(pop->pbRead[cbDone]);
+			cmsg += 2;
+
+			cbDone += cbTrans;
+		}
+	}
+
+	if ( 0 == cmsg ) {
+		return fTrue;
+	}
+
+	rdwr.msgs = rgmsg;
+	rdwr.nmsgs = cmsg;
+	I2cStatChunk();
+	if ( ! FI2cRdwr(pbatch->fdI2cDev, &rdwr) ) {
+		if ( dpmutilfVerbose ) {
+			printf("ERROR: I2CHALBatchSubmit - I2C_RDWR of %d operations failed\n", iopLast - iopFirst);
+		}
+		return fFalse;
+	}
+
+	for ( iop = iopFirst; iop < iopLast; iop++ ) {
+		pbatch->rgop[iop].fSuccess = fTrue;
+	}
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    I2cBatchRetryReads
+**
+**  Parameters:
+**      pbatch          - pointer to the batch
+**      iopFirst        - index of the first operation of the failed ioctl
+**      iopLast         - index of the operation after the last one
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function performs the reads of an I2C_RDWR ioctl that failed
+**      one at a time. The writes are left marked as failed.
+*/
+static void
+I2cBatchRetryReads(I2cBatch* pbatch, BYTE iopFirst, BYTE iopLast) {
+
+	BYTE	iop;
+
+	for ( iop = iopFirst; iop < iopLast; iop++ ) {
+		if ( pbatch->rgop[iop].fRead ) {
+			I2cStatRetry(1);
+			FI2cBatchSubmitOp(pbatch, iop);
+		}
+	}
+}
+#endif
+
+/* ------------------------------------------------------------ */
+/***    FI2cBatchSubmitOp
+**
+**  Parameters:
+**      pbatch          - pointer to the batch
+**      iop             - index of the operation to perform
+**
+**  Return Value:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function performs a single batch operation as an individual
+**      read or write and records its status.
+*/
+static BOOL
+FI2cBatchSubmitOp(I2cBatch* pbatch, BYTE iop) {
+
+	I2cBatchOp*	pop;
+
+	pop = &pbatch->rgop[iop];
+	if ( pop->fRead ) {
+		pop->fSuccess = I2CHALRead(pbatch->fdI2cDev, pop->slaveAddr, pop->addr, pop->pbRead, pop->cb, NULL, pop->uWait);
+	}
+	else {
+		pop->fSuccess = I2CHALWrite(pbatch->fdI2cDev, pop->slaveAddr, pop->addr, &pop->rgbSnd[2], pop->cb, 2 + pop->cb, NULL, 0, 0);
+	}
+
+	return pop->fSuccess;
+}
+
+
+/* ------------------------------------------------------------ */
+/*              Transfer Statistics                             */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/***    I2CHALGetStats
+**
+**  Parameters:
+**      pstats          - pointer to a variable to receive the statistics
+**
+**  Return Value:
+**      fTrue for success, fFalse if the library was built without
+**      DPMUTIL_STATS
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function returns a snapshot of the transfer statistics
+**      accumulated since the first transfer, or since the last call to
+**      I2CHALResetStats, for every controller that has been used.
+*/
+BOOL
+I2CHALGetStats(I2cStats* pstats) {
+
+	if ( NULL == pstats ) {
+		return fFalse;
+	}
+
+#if defined(DPMUTIL_STATS)
+#if defined(__linux__)
+	pthread_mutex_lock(&mtxI2cStats);
+#endif
+	memcpy(pstats, &statsI2c, sizeof(I2cStats));
+#if defined(__linux__)
+	pthread_mutex_unlock(&mtxI2cStats);
+#endif
+
+	return fTrue;
+#else
+	memset(pstats, 0, sizeof(I2cStats));
+
+	return fFalse;
+#endif
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CHALResetStats
+**
+**  Parameters:
+**      none
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function zeroes the transfer statistics of every
+**      controller. Controllers keep their place in I2cStats.
+*/
+void
+I2CHALResetStats() {
+
+#if defined(DPMUTIL_STATS)
+	BYTE	ibus;
+
+#if defined(__linux__)
+	pthread_mutex_lock(&mtxI2cStats);
+#endif
+	for ( ibus = 0; ibus < statsI2c.cbus; ibus++ ) {
+		memset(&statsI2c.rgbus[ibus].cnt, 0, sizeof(I2cStatCounters));
+		memset(statsI2c.rgbus[ibus].rgslave, 0, sizeof(statsI2c.rgbus[ibus].rgslave));
+		statsI2c.rgbus[ibus].cslave = 0;
+	}
+#if defined(__linux__)
+	pthread_mutex_unlock(&mtxI2cStats);
+#endif
+#endif
+}
 
+#if defined(__linux__)
+/* ------------------------------------------------------------ */
+/***    I2cNanosleep
+**
+**  Parameters:
+**      fdI2cDev        - open file descriptor for underlying I2C device
+**      pts             - time to sleep
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function performs one of the delays required between
+**      transactions, accounting the time actually slept to the call
+**      in progress when statistics are collected. The delays of a
+**      backend are performed by the backend.
+*/
+static void
+I2cNanosleep(int fdI2cDev, const struct timespec* pts) {
+
+	I2cBackendState*	pbest;
+#if defined(DPMUTIL_STATS)
+	UINT64				usStart;
+
+	usStart = UsStatNow();
+#endif
+
+	pbest = PbeFromFd(fdI2cDev);
+	if ( NULL == pbest ) {
+		nanosleep(pts, NULL);
+	}
+	else if ( NULL != pbest->pbe->pfnDelay ) {
+		pbest->pbe->pfnDelay(pbest->pvContext, (pts->tv_sec * 1000000) + (pts->tv_nsec / 1000));
+	}
+
+#if defined(DPMUTIL_STATS)
+	statcallI2c.usSleep += UsStatNow() - usStart;
+#endif
+}
+#else
+/* ------------------------------------------------------------ */
+/***    I2cUsleep
+**
+**  Parameters:
+**      us              - number of microseconds to sleep
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function performs one of the delays required between
+**      transactions, accounting the requested time to the call in
+**      progress when statistics are collected.
+*/
+static void
+I2cUsleep(UINT32 us) {
+
+	if ( NULL != hooksIic.pfnDelay ) {
+		hooksIic.pfnDelay(hooksIic.pvContext, us);
+	}
+	else {
+		usleep(us);
+	}
+#if defined(DPMUTIL_STATS)
+	statcallI2c.usSleep += us;
+#endif
+}
+
+/* ------------------------------------------------------------ */
+/***    FIicSend
+**
+**  Parameters:
+**      slaveAddr       - I2C bus address for the slave
+**      pbSnd           - data to transmit
+**      cbSnd           - number of bytes to transmit
+**
+**  Return Value:
+**      fTrue if every byte was sent, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function performs a write transaction, ending with a stop
+**      condition, with the I2C device initialized by I2CHALInit. The
+**      transaction is interrupt driven if I2CHALSetInterruptMode has
+**      been called and polled otherwise.
+*/
+static BOOL
+FIicSend(BYTE slaveAddr, BYTE* pbSnd, WORD cbSnd) {
+
+#if defined(PLATFORM_ZYNQ)
+	if ( fIicIrq ) {
+		fIicIrqDone = fFalse;
+		fIicIrqError = fFalse;
+		XIicPs_MasterSend(&IicDev, pbSnd, cbSnd, slaveAddr);
+		if ( ! FIicIrqWait() ) {
+			return fFalse;
+		}
+	}
+	else if ( XST_SUCCESS != XIicPs_MasterSendPolled(&IicDev, pbSnd, cbSnd, slaveAddr) ) {
+		return fFalse;
+	}
+
+	/* The stop condition follows the last byte.
+	*/
+	while (XIicPs_BusIsBusy(&IicDev)) {}
+
+	return fTrue;
+#else
+	if ( ! fIicIrq ) {
+		return ( cbSnd == XIic_Send(IicDev.BaseAddress, slaveAddr, pbSnd, cbSnd, XIIC_STOP) ) ? fTrue : fFalse;
+	}
+
+	fIicIrqDone = fFalse;
+	fIicIrqError = fFalse;
+	XIic_SetAddress(&IicDev, XII_ADDR_TO_SEND_TYPE, slaveAddr);
+	if (( XST_SUCCESS != XIic_MasterSend(&IicDev, pbSnd, cbSnd) ) ||
+		( ! FIicIrqWait() )) {
+		return fFalse;
+	}
+
+	while (XIic_IsIicBusy(&IicDev)) {}
+
+	return fTrue;
+#endif
+}
+
+/* ------------------------------------------------------------ */
+/***    FIicRecv
+**
+**  Parameters:
+**      slaveAddr       - I2C bus address for the slave
+**      pbRecv          - buffer to receive the data
+**      cbRecv          - number of bytes to receive
+**
+**  Return Value:
+**      fTrue if every byte was received, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function performs a read transaction, ending with a stop
+**      condition, with the I2C device initialized by I2CHALInit. The
+**      transaction is interrupt driven if I2CHALSetInterruptMode has
+**      been called and polled otherwise.
+*/
+static BOOL
+FIicRecv(BYTE slaveAddr, BYTE* pbRecv, WORD cbRecv) {
+
+#if defined(PLATFORM_ZYNQ)
+	if ( fIicIrq ) {
+		fIicIrqDone = fFalse;
+		fIicIrqError = fFalse;
+		XIicPs_MasterRecv(&IicDev, pbRecv, cbRecv, slaveAddr);
+		if ( ! FIicIrqWait() ) {
+			return fFalse;
+		}
+	}
+	else if ( XST_SUCCESS != XIicPs_MasterRecvPolled(&IicDev, pbRecv, cbRecv, slaveAddr) ) {
+		return fFalse;
+	}
+
+	while (XIicPs_BusIsBusy(&IicDev)) {}
+
+	return fTrue;
+#else
+	if ( ! fIicIrq ) {
+		return ( cbRecv == XIic_Recv(IicDev.BaseAddress, slaveAddr, pbRecv, cbRecv, XIIC_STOP) ) ? fTrue : fFalse;
+	}
+
+	fIicIrqDone = fFalse;
+	fIicIrqError = fFalse;
+	XIic_SetAddress(&IicDev, XII_ADDR_TO_SEND_TYPE, slaveAddr);
+	if (( XST_SUCCESS != XIic_MasterRecv(&IicDev, pbRecv, cbRecv) ) ||
+		( ! FIicIrqWait() )) {
+		return fFalse;
+	}
+
+	while (XIic_IsIicBusy(&IicDev)) {}
+
+	return fTrue;
+#endif
+}
+
+/* ------------------------------------------------------------ */
+/***    FIicIrqWait
+**
+**  Parameters:
+**      none
+**
+**  Return Value:
+**      fTrue if the transfer completed successfully, fFalse if it was
+**      NACKed, lost arbitration, the controller reported an error, or
+**      it didn't complete within the timeout
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function waits for the interrupt handler to complete the
+**      transfer in progress, calling the pfnWait hook so that the CPU
+**      can be used for other work in the meantime. There's no time base
+**      on bare metal, so the timeout is measured by adding up the time
+**      given to pfnWait, or slept between checks of the completion flag
+**      when there's no pfnWait, and the transfer is aborted once that
+**      reaches the msTimeout of the hooks.
+*/
+static BOOL
+FIicIrqWait() {
+
+	UINT32	usTimeout;
+	UINT32	usElapsed;
+
+	usTimeout = (( 0 != hooksIic.msTimeout ) ? hooksIic.msTimeout : msI2cIrqTimeoutDefault) * 1000;
+	usElapsed = 0;
+
+	while ( ! fIicIrqDone ) {
+		if ( usTimeout <= usElapsed ) {
+			IicIrqAbort();
+			return fFalse;
+		}
+		if ( NULL != hooksIic.pfnWait ) {
+			hooksIic.pfnWait(hooksIic.pvContext, usI2cIrqWaitMax);
+			usElapsed += usI2cIrqWaitMax;
+		}
+		else {
+			usleep(usIicIrqSpin);
+			usElapsed += usIicIrqSpin;
+		}
+	}
+
+	return ! fIicIrqError;
+}
+
+/* ------------------------------------------------------------ */
+/***    IicIrqAbort
+**
+**  Parameters:
+**      none
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function abandons the interrupt driven transfer in progress
+**      by resetting the controller, which releases the bus and discards
+**      the FIFO contents, so that a late interrupt can't complete it.
+*/
+static void
+IicIrqAbort() {
 
-#if defined(__linux__)
-		nanosleep(&tsWait, NULL);
-		cb = read(fdI2cDev, &(pbRead[cbRecv]), cbTrans);
-		if ( 0 >= cb ) {
-			sprintf(szErrDesc, "read failed after %d bytes", cbRecv);
-			goto lErrorExit;
-		}
-		cbRecv += cb;
-		addrRead += cb;
-#elif defined(PLATFORM_ZYNQ)
-		usleep(uWait);
-		// Receive function form the flash
-		if(XST_SUCCESS != XIicPs_MasterRecvPolled(&IicDev, &(pbRead[cbRecv]), cbTrans, slaveAddr)){
-			sprintf(szErrDesc, "read failed after %d bytes", cbRecv);
-			goto lErrorExit;
-		}
-		while (XIicPs_BusIsBusy(&IicDev)) {}
-		cbRecv += cbTrans;
-		addrRead += cbTrans;
+#if defined(PLATFORM_ZYNQ)
+	XIicPs_Abort(&IicDev);
 #else
-		usleep(uWait);
-		cb = XIic_Recv(IicDev.BaseAddress, slaveAddr, &(pbRead[cbRecv]), cbTrans, XIIC_STOP);
-		if(0 >= cb){
-			sprintf(szErrDesc, "read failed after %d bytes", cbRecv);
-			goto lErrorExit;
-		}
-		cbRecv += cbTrans;
-		addrRead += cbTrans;
+	XIic_Reset(&IicDev);
+	XIic_Start(&IicDev);
 #endif
+}
+
+#if defined(PLATFORM_ZYNQ)
+/* ------------------------------------------------------------ */
+/***    IicIrqStatusHandler
+**
+**  Parameters:
+**      pvCallBackRef   - not used
+**      evt             - XIICPS_EVENT_* flags
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function is called by XIicPs_MasterInterruptHandler when a
+**      transfer completes or fails.
+*/
+static void
+IicIrqStatusHandler(void* pvCallBackRef, u32 evt) {
 
+	if ( 0 != (evt & (XIICPS_EVENT_NACK | XIICPS_EVENT_ARB_LOST | XIICPS_EVENT_TIME_OUT |
+					  XIICPS_EVENT_ERROR | XIICPS_EVENT_RX_OVR | XIICPS_EVENT_TX_OVR | XIICPS_EVENT_RX_UNF)) ) {
+		fIicIrqError = fTrue;
+	}
+	else if ( 0 == (evt & (XIICPS_EVENT_COMPLETE_SEND | XIICPS_EVENT_COMPLETE_RECV)) ) {
+		return;
 	}
 
-	if ( NULL != pcbRead ) {
-		*pcbRead = cbRecv;
+	fIicIrqDone = fTrue;
+	if ( NULL != hooksIic.pfnDone ) {
+		hooksIic.pfnDone(hooksIic.pvContext);
 	}
+}
+#else
+/* ------------------------------------------------------------ */
+/***    IicIrqXferHandler
+**
+**  Parameters:
+**      pvCallBackRef   - not used
+**      cbRemaining     - number of bytes that weren't transferred
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function is called by XIic_InterruptHandler when the send
+**      or receive started by FIicSend or FIicRecv completes.
+*/
+static void
+IicIrqXferHandler(void* pvCallBackRef, int cbRemaining) {
 
-	return fTrue;
+	if ( 0 != cbRemaining ) {
+		fIicIrqError = fTrue;
+	}
 
-lErrorExit:
+	fIicIrqDone = fTrue;
+	if ( NULL != hooksIic.pfnDone ) {
+		hooksIic.pfnDone(hooksIic.pvContext);
+	}
+}
 
-	if ( NULL != pcbRead ) {
-		*pcbRead = cbRecv;
+/* ------------------------------------------------------------ */
+/***    IicIrqStatusHandler
+**
+**  Parameters:
+**      pvCallBackRef   - not used
+**      evt             - XII_*_EVENT value
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function is called by XIic_InterruptHandler when the slave
+**      doesn't acknowledge or arbitration is lost, which end the
+**      transfer without calling the send or receive handler.
+*/
+static void
+IicIrqStatusHandler(void* pvCallBackRef, int evt) {
+
+	if (( XII_SLAVE_NO_ACK_EVENT != evt ) && ( XII_ARB_LOST_EVENT != evt )) {
+		return;
 	}
 
-	if ( dpmutilfVerbose ) {
-		printf("%s%s\n", szErr, szErrDesc);
+	fIicIrqError = fTrue;
+	fIicIrqDone = fTrue;
+	if ( NULL != hooksIic.pfnDone ) {
+		hooksIic.pfnDone(hooksIic.pvContext);
 	}
+}
+#endif
+#endif
 
-	return fFalse;
+#if defined(DPMUTIL_STATS)
+/* ------------------------------------------------------------ */
+/***    UsStatNow
+**
+**  Parameters:
+**      none
+**
+**  Return Value:
+**      monotonic time in microseconds, 0 on bare metal
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function returns the time used to measure the latency of
+**      calls. Bare metal has no portable time base so latencies aren't
+**      measured there.
+*/
+static UINT64
+UsStatNow() {
+
+#if defined(__linux__)
+	struct timespec	tsNow;
+
+	clock_gettime(CLOCK_MONOTONIC, &tsNow);
+
+	return ((UINT64)tsNow.tv_sec * 1000000) + (tsNow.tv_nsec / 1000);
+#else
+	return 0;
+#endif
 }
 
 /* ------------------------------------------------------------ */
-/***    PmcuI2cWrite
+/***    StatBegin
 **
 **  Parameters:
-**  	fdI2cDev        - open file descriptor for underlying I2C device (linux only)
-**      addrWrite       - memory address to write
-**      pbWrite         - pointer to a buffer to containing data to transmit
-**      cbWrite         - number of bytes to write
-**      pcbWrite        - pointer to variable to receive count of bytes
-**                        written
-**      uWait			- number of microseconds to wait between writes
+**      none
 **
 **  Return Value:
-**      fTrue for success, fFalse otherwise
+**      none
 **
 **  Errors:
 **      none
 **
 **  Description:
-**      This function writes the specified number of bytes to the
-**      Platform MCU starting at the specified address. Write operations
-**      may be split into multiple transactions with a maximum of
-**      cbPmcuRxMax bytes being written during a single write operation.
+**      This function is called by each I2CHAL call once it holds the
+**      lock of the bus. Only the outermost call on a thread starts a
+**      new measurement.
 */
-BOOL
-I2CHALWrite(int fdI2cDev, BYTE slaveAddr, WORD addrWrite, BYTE* pbWrite, BYTE cbWrite, INT32 cbDevRxMax, WORD* pcbWritten, INT32 uWait) {
+static void
+StatBegin() {
+
+	if ( 0 == statcallI2c.cdepth++ ) {
+		statcallI2c.cchunk = 0;
+		statcallI2c.cretry = 0;
+		statcallI2c.usSleep = 0;
+		statcallI2c.usStart = UsStatNow();
+	}
+}
 
-	ssize_t	cb;
-	BYTE	ib;
-	BYTE	cbTrans;
-	BYTE	cbSent;
-	BYTE	rgbSnd[32];
-	char	szErr[64];
-	char	szErrDesc[128];
+/* ------------------------------------------------------------ */
+/***    StatEnd
+**
+**  Parameters:
+**      fdI2cDev        - open file descriptor for underlying I2C device
+**      slaveAddr       - slave address of the device
+**      icall           - i2cstat type of the call
+**      cbRead          - number of bytes read
+**      cbWrite         - number of bytes written
+**      fSuccess        - result of the call
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function is called by each I2CHAL call before it releases
+**      the lock of the bus. When the outermost call on the thread
+**      completes its measurement is added to the counters of the bus
+**      and of the slave.
+*/
+static void
+StatEnd(int fdI2cDev, BYTE slaveAddr, BYTE icall, UINT32 cbRead, UINT32 cbWrite, BOOL fSuccess) {
 
-	cbSent = 0;
-	strcpy(szErr, "ERROR: PmcuI2cWrite - ");
-	szErrDesc[0] = '\0';
+	I2cBusStats*	pbusstat;
+	INT64			usElapsed;
+	BYTE			islave;
 
-	/* Inform the I2C driver of the slave address.
-	*/
-#if defined(__linux__)
-	struct timespec tsWait;
-	if ( 0 > ioctl(fdI2cDev, I2C_SLAVE, slaveAddr) ) {
-		sprintf(szErrDesc, "failed to set I2C slave address");
-		goto lErrorExit;
+	if ( 0 < --statcallI2c.cdepth ) {
+		return;
 	}
+
+	usElapsed = UsStatNow() - statcallI2c.usStart;
+
+	pbusstat = PbusstatFromFd(fdI2cDev);
+	if ( NULL == pbusstat ) {
+		return;
+	}
+
+#if defined(__linux__)
+	pthread_mutex_lock(&mtxI2cStats);
 #endif
+	StatAdd(&pbusstat->cnt, icall, fSuccess, cbRead, cbWrite, &statcallI2c, usElapsed);
 
-	while ( cbSent < cbWrite ) {
-		/* Determine how many bytes to transfer to the Eclypse PMCU for
-		** this transaction.
-		*/
-		cbTrans = 2 + (cbWrite - cbSent);
-		if ( cbDevRxMax < cbTrans ) {
-			cbTrans = cbDevRxMax;
+	for ( islave = 0; islave < pbusstat->cslave; islave++ ) {
+		if ( slaveAddr == pbusstat->rgslave[islave].slaveAddr ) {
+			break;
 		}
+	}
+	if (( islave == pbusstat->cslave ) && ( cI2cStatSlaveMax > islave )) {
+		pbusstat->rgslave[islave].slaveAddr = slaveAddr;
+		pbusstat->cslave++;
+	}
+	if ( islave < pbusstat->cslave ) {
+		StatAdd(&pbusstat->rgslave[islave].cnt, icall, fSuccess, cbRead, cbWrite, &statcallI2c, usElapsed);
+	}
+#if defined(__linux__)
+	pthread_mutex_unlock(&mtxI2cStats);
+#endif
+}
 
-		/* Populate the buffer with the memory address to be written
-		** and any data that's being written to that address during
-		** this transfer.
-		*/
-		rgbSnd[0] = (addrWrite  >> 8);
-		rgbSnd[1] = addrWrite & 0xFF;
-		for ( ib = 2; ib < cbTrans; ib++ ) {
-			rgbSnd[ib] = *pbWrite;
-			pbWrite++;
-		}
+/* ------------------------------------------------------------ */
+/***    StatEndBatch
+**
+**  Parameters:
+**      pbatch          - pointer to the batch that was submitted
+**      cop             - number of operations the batch contained
+**      fSuccess        - result of the submission
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function is called by I2CHALBatchSubmit before it releases
+**      the lock of the bus. If the batch is the outermost call on the
+**      thread its measurement is added to the counters of the bus and
+**      each of its operations is added to the counters of its slave.
+*/
+static void
+StatEndBatch(I2cBatch* pbatch, BYTE cop, BOOL fSuccess) {
+
+	I2cBusStats*	pbusstat;
+	I2cBatchOp*		pop;
+	I2cStatCall		callOp;
+	INT64			usElapsed;
+	UINT32			cbRead;
+	UINT32			cbWrite;
+	BYTE			iop;
+	BYTE			islave;
+
+	if ( 0 < --statcallI2c.cdepth ) {
+		return;
+	}
+
+	usElapsed = UsStatNow() - statcallI2c.usStart;
+
+	pbusstat = PbusstatFromFd(pbatch->fdI2cDev);
+	if ( NULL == pbusstat ) {
+		return;
+	}
+
+	memset(&callOp, 0, sizeof(callOp));
 
-		/* Transmit the memory address and data to the slave.
-		*/
 #if defined(__linux__)
-		cb = write(fdI2cDev, rgbSnd, cbTrans);
-		if (cb != cbTrans ) {
-			sprintf(szErrDesc, "write failed after %d bytes", cbSent);
-			goto lErrorExit;
+	pthread_mutex_lock(&mtxI2cStats);
+#endif
+	cbRead = 0;
+	cbWrite = 0;
+	for ( iop = 0; iop < cop; iop++ ) {
+		pop = &pbatch->rgop[iop];
+		if ( pop->fSuccess ) {
+			if ( pop->fRead ) {
+				cbRead += pop->cb;
+			}
+			else {
+				cbWrite += pop->cb;
+			}
 		}
-#elif defined(PLATFORM_ZYNQ)
-		// Send the data to the flash
-		if(XST_SUCCESS != XIicPs_MasterSendPolled(&IicDev, rgbSnd, cbTrans, slaveAddr)){
-			sprintf(szErrDesc, "write failed after %d bytes", cbSent);
-			goto lErrorExit;
+
+		for ( islave = 0; islave < pbusstat->cslave; islave++ ) {
+			if ( pop->slaveAddr == pbusstat->rgslave[islave].slaveAddr ) {
+				break;
+			}
 		}
-		while (XIicPs_BusIsBusy(&IicDev)) {}
-#else
-		cb = XIic_Send(IicDev.BaseAddress, slaveAddr, rgbSnd, cbTrans, XIIC_STOP);
-		if (cb != cbTrans ) {
-			sprintf(szErrDesc, "write failed after %d bytes", cbSent);
-			goto lErrorExit;
+		if (( islave == pbusstat->cslave ) && ( cI2cStatSlaveMax > islave )) {
+			pbusstat->rgslave[islave].slaveAddr = pop->slaveAddr;
+			pbusstat->cslave++;
 		}
-#endif
+		if ( islave < pbusstat->cslave ) {
+			StatAdd(&pbusstat->rgslave[islave].cnt,
+				pop->fRead ? i2cstatRead : i2cstatWrite, pop->fSuccess,
+				( pop->fSuccess && pop->fRead ) ? pop->cb : 0,
+				( pop->fSuccess && ! pop->fRead ) ? pop->cb : 0,
+				&callOp, -1);
+		}
+	}
 
+	StatAdd(&pbusstat->cnt, i2cstatBatch, fSuccess, cbRead, cbWrite, &statcallI2c, usElapsed);
+#if defined(__linux__)
+	pthread_mutex_unlock(&mtxI2cStats);
+#endif
+}
 
-		cbSent += (cbTrans-2);
-		addrWrite += (cbTrans-2);
+/* ------------------------------------------------------------ */
+/***    PbusstatFromFd
+**
+**  Parameters:
+**      fdI2cDev        - open file descriptor for underlying I2C device
+**
+**  Return Value:
+**      pointer to the statistics of the controller, NULL if there's no
+**      room for the statistics of another controller
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function looks up the statistics of the controller with the
+**      specified file descriptor. On Linux the index of the statistics
+**      is cached with the state of the controller so that its device
+**      number is only determined once per open.
+*/
+static I2cBusStats*
+PbusstatFromFd(int fdI2cDev) {
 
-		if ( cbSent < cbWrite ) {
 #if defined(__linux__)
-			tsWait.tv_sec = 1;
-			tsWait.tv_nsec = 0;
-			nanosleep(&tsWait, NULL);
-#else
-			usleep(uWait);
-#endif
+	I2cBusState*	pbus;
+	struct stat		st;
+	BYTE			ibus;
 
-		}
+	pbus = PbusFromFd(fdI2cDev, fFalse);
+	if ( NULL == pbus ) {
+		return NULL;
 	}
 
-	if ( NULL != pcbWritten ) {
-		*pcbWritten = cbSent;
+	if ( 0 > pbus->istat ) {
+		/* Backends don't have a device number, so each one is given
+		** a device number with the unnamed major number 0.
+		*/
+		if ( NULL != PbeFromFd(fdI2cDev) ) {
+			st.st_rdev = makedev(0, fdI2cDev - fdI2cBackendBase);
+		}
+		else if ( 0 != fstat(fdI2cDev, &st) ) {
+			return NULL;
+		}
+
+		pthread_mutex_lock(&mtxI2cStats);
+		for ( ibus = 0; ibus < statsI2c.cbus; ibus++ ) {
+			if ( st.st_rdev == rgrdevStat[ibus] ) {
+				break;
+			}
+		}
+		if (( ibus == statsI2c.cbus ) && ( cI2cStatBusMax > ibus )) {
+			rgrdevStat[ibus] = st.st_rdev;
+			statsI2c.rgbus[ibus].ibus = ( 0 == major(st.st_rdev) ) ? -1 : (int)minor(st.st_rdev);
+			statsI2c.cbus++;
+		}
+		if ( ibus < statsI2c.cbus ) {
+			pbus->istat = ibus;
+		}
+		pthread_mutex_unlock(&mtxI2cStats);
+
+		if ( 0 > pbus->istat ) {
+			return NULL;
+		}
 	}
 
-	return fTrue;
+	return &statsI2c.rgbus[pbus->istat];
+#else
+	statsI2c.cbus = 1;
 
-lErrorExit:
+	return &statsI2c.rgbus[0];
+#endif
+}
 
-	if ( NULL != pcbWritten ) {
-		*pcbWritten = cbSent;
+/* ------------------------------------------------------------ */
+/***    StatAdd
+**
+**  Parameters:
+**      pcnt            - counters to add the call to
+**      icall           - i2cstat type of the call
+**      fSuccess        - result of the call
+**      cbRead          - number of bytes read
+**      cbWrite         - number of bytes written
+**      pcall           - transactions, retries and delays of the call
+**      usElapsed       - latency of the call, less than 0 if none
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function adds a call to a set of counters. The caller must
+**      hold mtxI2cStats.
+*/
+static void
+StatAdd(I2cStatCounters* pcnt, BYTE icall, BOOL fSuccess, UINT32 cbRead, UINT32 cbWrite, const I2cStatCall* pcall, INT64 usElapsed) {
+
+	pcnt->rgccall[icall]++;
+	if ( ! fSuccess ) {
+		pcnt->cfail++;
 	}
+	pcnt->cchunk += pcall->cchunk;
+	pcnt->cretry += pcall->cretry;
+	pcnt->cbRead += cbRead;
+	pcnt->cbWrite += cbWrite;
+	pcnt->usSleep += pcall->usSleep;
 
-	if ( dpmutilfVerbose ) {
-		printf("%s%s\n", szErr, szErrDesc);
+#if defined(__linux__)
+	BYTE	ibucket;
+
+	if ( 0 > usElapsed ) {
+		return;
 	}
 
-	return fFalse;
+	pcnt->usBusy += usElapsed;
+	if ( pcnt->usMax < usElapsed ) {
+		pcnt->usMax = ( 0xFFFFFFFF < usElapsed ) ? 0xFFFFFFFF : (UINT32)usElapsed;
+	}
+
+	ibucket = 0;
+	while (( 1 < usElapsed ) && ( cI2cStatLatBucket - 1 > ibucket )) {
+		usElapsed >>= 1;
+		ibucket++;
+	}
+	pcnt->rgcLat[ibucket]++;
+#endif
 }
+#endif
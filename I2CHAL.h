@@ -17,6 +17,18 @@
 /*  Revision History:                                                   */
 /*                                                                      */
 /*  05/04/2020 (ThomasK): created                                      */
+/*  10/14/2026: added transfer statistics, I2CHALGetStats               */
+/*  10/14/2026: added pluggable backends and I2CHALDelay                */
+/*  10/14/2026: added I2CHALSetControllerPath and the controller path   */
+/*      environment variables                                           */
+/*  10/14/2026: added interrupt driven transfers on bare metal,         */
+/*      I2CHALSetInterruptMode and I2CHALInterruptHandler               */
+/*  10/14/2026: added per slave timing profiles and the clock rate      */
+/*      functions                                                       */
+/*  10/14/2026: I2CHALRead and I2CHALWrite take size_t lengths, added   */
+/*      I2CHALNegotiateReadMax                                          */
+/*  10/14/2026: added the interrupt transfer timeout to I2cIrqHooks     */
+/*  10/14/2026: I2CHALLock returns whether the lock was acquired        */
 /*                                                                      */
 /************************************************************************/
 
@@ -26,6 +38,8 @@
 
 #include "../dpmutil/stdtypes.h"
 
+#include <stddef.h>
+
 #if !defined(__linux__)
 #include "xparameters.h"
 #endif
@@ -50,18 +64,276 @@
 #define Iic_CfgInitialize XIic_CfgInitialize
 #else
 #define cchDeviceNameMax	64
+#define cchI2cDevPathMax	63
+#endif
+
+/* Variables declared with this storage class have a separate instance
+** for each thread. Bare metal applications are single threaded.
+*/
+#if defined(__linux__)
+#define I2CHALThreadLocal	__thread
+#else
+#define I2CHALThreadLocal
+#endif
+
+#if defined(__linux__)
+/* ------------------------------------------------------------ */
+/*                  Controller Selection Declarations           */
+/* ------------------------------------------------------------ */
+
+/* Define the environment variables read by I2CHALOpenI2cController.
+** DPMUTIL_I2C_DEV names the device node of the controller to open, in
+** which case sysfs isn't searched. DPMUTIL_I2C_CACHE names the file
+** used to remember the result of the last search, an empty value
+** disables the cache. By default the cache is kept in /tmp, in a file
+** whose name includes the effective user ID.
+*/
+#define szI2cDevEnv				"DPMUTIL_I2C_DEV"
+#define szI2cCacheEnv			"DPMUTIL_I2C_CACHE"
+#define szI2cCachePathFormat	"/tmp/dpmutil-i2c-%u.cache"
+#define cchI2cCachePathMax		255
+#endif
+
+#if !defined(__linux__)
+/* ------------------------------------------------------------ */
+/*                  Interrupt Declarations                      */
+/* ------------------------------------------------------------ */
+
+/* Hooks of the interrupt driven transfer mode. While a transfer is in
+** progress the calling task repeatedly calls pfnWait until the transfer
+** completes, and the interrupt handler calls pfnDone when it does. An
+** RTOS application would typically take a semaphore in pfnWait and
+** give it in pfnDone, so that other tasks run during the transfer.
+** pfnWait must return once pfnDone is called or after at most us
+** microseconds, so a semaphore should be taken with that timeout.
+** pfnDelay, if not NULL, replaces the busy waiting usleep for the
+** delays required between transactions, for example with vTaskDelay.
+** Any hook may be NULL, a NULL pfnWait polls the completion flag.
+**
+** A transfer that hasn't completed after msTimeout milliseconds, for
+** example because a slave holds SCL low, is aborted by resetting the
+** controller and fails. Each call to pfnWait counts as us microseconds
+** whether or not it returned early. A msTimeout of 0 selects
+** msI2cIrqTimeoutDefault.
+*/
+#define usI2cIrqWaitMax			1000
+#define msI2cIrqTimeoutDefault	100
+
+typedef struct {
+	void	(*pfnWait)(void* pvContext, UINT32 us);
+	void	(*pfnDone)(void* pvContext);		// called from the interrupt handler
+	void	(*pfnDelay)(void* pvContext, UINT32 us);
+	void*	pvContext;
+	UINT32	msTimeout;
+} I2cIrqHooks;
+#endif
+
+/* ------------------------------------------------------------ */
+/*                  Timing Profile Declarations                 */
+/* ------------------------------------------------------------ */
+
+/* Define the maximum number of slaves that may have a timing profile
+** and the value of a profile field that leaves the value passed by
+** the caller of I2CHALRead or I2CHALWrite in effect.
+*/
+#define cI2cTimingProfileMax	16
+#define usI2cTimingDefault		0xFFFFFFFF
+
+/* Define the largest transactions a profile may specify. Reads are
+** limited by the 8192 bytes the Linux i2c-dev driver accepts in a
+** single message, writes by the buffer that holds the memory address
+** and data of one write transaction.
+*/
+#define cbI2cReadTransLimit		8192
+#define cbI2cWriteTransLimit	258
+
+/* Timing of the transactions with one slave. The values passed to
+** I2CHALRead and I2CHALWrite by the device layers (PlatformMCU.c and
+** syzygy.c) are worst case for every board and pod, a profile replaces
+** them for a specific slave address. A cb field of 0 and a us field of
+** usI2cTimingDefault leave the caller's value in effect.
+*/
+typedef struct {
+	BYTE	slaveAddr;
+	WORD	cbReadMax;		// largest read transaction
+	WORD	cbWriteMax;		// largest write transaction, including the 2 address bytes
+	UINT32	usPreRead;		// delay between writing the address and reading the data
+	UINT32	usPostWrite;	// delay after each write when acknowledge polling isn't used
+	UINT32	usErase;		// acknowledge polling timeout after each write, 0 to
+							// wait usPostWrite instead
+} I2cTimingProfile;
+
+/* ------------------------------------------------------------ */
+/*                  Batch Declarations                          */
+/* ------------------------------------------------------------ */
+
+/* Define the maximum number of operations that may be queued in a
+** single batch and the maximum number of bytes that may be read or
+** written by a single operation.
+*/
+#define cI2cBatchOpMax		32
+#define cbI2cBatchReadMax	255
+#define cbI2cBatchWriteMax	32
+
+/* A single read or write operation queued in a batch. The memory
+** address, and for writes the data, are stored in rgbSnd so that the
+** caller's buffer doesn't need to remain valid until the batch is
+** submitted. Read data is placed directly in pbRead.
+*/
+typedef struct {
+	BYTE	slaveAddr;
+	BOOL	fRead;
+	WORD	addr;
+	BYTE*	pbRead;
+	BYTE	cb;
+	UINT32	uWait;		// bare metal: microseconds to wait before each read
+	BYTE	rgbSnd[2 + cbI2cBatchWriteMax];
+	BOOL	fSuccess;	// set by I2CHALBatchSubmit, a failed write may have been performed
+} I2cBatchOp;
+
+typedef struct {
+	int			fdI2cDev;
+	BYTE		cop;
+	I2cBatchOp	rgop[cI2cBatchOpMax];
+} I2cBatch;
+
+/* ------------------------------------------------------------ */
+/*                  Backend Declarations                        */
+/* ------------------------------------------------------------ */
+
+#if defined(__linux__)
+/* A backend performs the bus transfers of a file descriptor returned
+** by I2CHALOpenBackend in place of the I2C controller, which allows the
+** library to be run against a simulated bus. Only Linux supports
+** backends.
+**
+** pfnXfer performs a single transfer: the messages are separated by
+** repeated starts and followed by a stop. It returns fFalse if any
+** message wasn't acknowledged. pfnDelay performs the delays that the
+** library requires between transfers and may simply advance a model
+** of time. pfnClose is called when the file descriptor is closed.
+** pfnDelay and pfnClose may be NULL.
+*/
+typedef struct {
+	BYTE	slaveAddr;
+	BOOL	fRead;
+	WORD	cb;
+	BYTE*	pb;
+} I2cBackendMsg;
+
+typedef struct {
+	BOOL	(*pfnXfer)(void* pvContext, I2cBackendMsg rgmsg[], WORD cmsg);
+	void	(*pfnDelay)(void* pvContext, UINT32 us);
+	void	(*pfnClose)(void* pvContext);
+} I2cBackend;
 #endif
 
+/* ------------------------------------------------------------ */
+/*                  Statistics Declarations                     */
+/* ------------------------------------------------------------ */
+
+/* Transfer statistics are only collected when the library is built
+** with DPMUTIL_STATS defined. Otherwise the instrumentation compiles
+** to nothing and I2CHALGetStats returns fFalse.
+*/
+
+/* Define the types of calls that are counted.
+*/
+#define i2cstatRead			0
+#define i2cstatWrite		1
+#define i2cstatProbe		2
+#define i2cstatWaitAck		3
+#define i2cstatBatch		4
+#define cI2cStatCall		5
+
+/* Define the number of latency histogram buckets. Bucket i counts calls
+** that took [2^i, 2^(i+1)) microseconds, except that the first bucket
+** also counts calls that took less than a microsecond and the last
+** bucket has no upper bound.
+*/
+#define cI2cStatLatBucket	20
+
+/* Define the maximum number of buses, and of slaves on each bus, for
+** which statistics are kept. Calls to additional slaves are only
+** included in the totals of their bus.
+*/
+#define cI2cStatBusMax		8
+#define cI2cStatSlaveMax	16
+
+typedef struct {
+	UINT32	rgccall[cI2cStatCall];	// number of calls of each type
+	UINT32	cfail;			// number of calls that failed
+	UINT32	cchunk;			// bus transactions the calls were split into
+	UINT32	cretry;			// batch operations retried individually
+	UINT64	cbRead;
+	UINT64	cbWrite;
+	UINT64	usBusy;			// time spent in calls, Linux only
+	UINT64	usSleep;		// part of usBusy spent in enforced delays
+	UINT32	usMax;			// longest call, Linux only
+	UINT32	rgcLat[cI2cStatLatBucket];	// latency histogram, Linux only
+} I2cStatCounters;
+
+typedef struct {
+	BYTE			slaveAddr;
+	I2cStatCounters	cnt;
+} I2cSlaveStats;
+
+/* The bus counters count each batch as a single i2cstatBatch call. The
+** slave counters count each operation of a batch as a read or write
+** without a latency, since the operations are performed together.
+*/
+typedef struct {
+	int				ibus;		// N of /dev/i2c-N on Linux, -1 for a backend, 0 on bare metal
+	I2cStatCounters	cnt;
+	BYTE			cslave;
+	I2cSlaveStats	rgslave[cI2cStatSlaveMax];
+} I2cBusStats;
+
+typedef struct {
+	BYTE		cbus;
+	I2cBusStats	rgbus[cI2cStatBusMax];
+} I2cStats;
+
 /* ------------------------------------------------------------ */
 /*                  Procedure Declarations                      */
 /* ------------------------------------------------------------ */
 #if defined(__linux__)
 int I2CHALOpenI2cController();
+int I2CHALOpenI2cControllerPath(const char* szDevPath);
+void I2CHALSetControllerPath(const char* szDevPath);
+int I2CHALEnumI2cControllers(char rgszDevPath[][cchI2cDevPathMax+1], int cpathMax);
+void I2CHALCloseI2cController(int fdI2cDev);
+int I2CHALOpenBackend(const I2cBackend* pbe, void* pvContext);
+void I2CHALSetDefaultBackend(const I2cBackend* pbe, void* pvContext);
 #else
 BOOL I2CHALInit(UINT32 deviceID);
+BOOL I2CHALSetInterruptMode(const I2cIrqHooks* phooks);
+void I2CHALInterruptHandler(void* pvUnused);
+BOOL I2CHALSetClockRate(UINT32 hzScl);
 #endif
-BOOL I2CHALRead(int fdI2cDev, BYTE slaveAddr, WORD addrRead, BYTE* pbRead, BYTE cbRead, WORD* pcbRead, UINT32 uWait);
-BOOL I2CHALWrite(int fdI2cDev, BYTE slaveAddr, WORD addrWrite, BYTE* pbWrite, BYTE cbWrite, INT32 cbDevRxMax, WORD* pcbWritten, INT32 uWait);
+UINT32 I2CHALGetClockRate(int fdI2cDev);
+void I2CHALInitTimingProfile(BYTE slaveAddr, I2cTimingProfile* pprof);
+BOOL I2CHALSetTimingProfile(const I2cTimingProfile* pprof);
+BOOL I2CHALGetTimingProfile(BYTE slaveAddr, I2cTimingProfile* pprof);
+void I2CHALClearTimingProfile(BYTE slaveAddr);
+BOOL I2CHALCalibrateReadTiming(int fdI2cDev, BYTE slaveAddr, WORD addrRead, BYTE cbRef, UINT32 usPreReadMax, I2cTimingProfile* pprof);
+BOOL I2CHALNegotiateReadMax(int fdI2cDev, BYTE slaveAddr, WORD addrRead, WORD cbRef, UINT32 uWait, WORD* pcbReadMax);
+BOOL I2CHALLock(int fdI2cDev);
+void I2CHALUnlock(int fdI2cDev);
+int I2CHALGetLastError();
+BOOL I2CHALRead(int fdI2cDev, BYTE slaveAddr, WORD addrRead, BYTE* pbRead, size_t cbRead, size_t* pcbRead, UINT32 uWait);
+BOOL I2CHALWrite(int fdI2cDev, BYTE slaveAddr, WORD addrWrite, BYTE* pbWrite, size_t cbWrite, INT32 cbDevRxMax, size_t* pcbWritten, INT32 uWait, UINT32 uAckTimeout);
+BOOL I2CHALProbe(int fdI2cDev, BYTE slaveAddr);
+BOOL I2CHALWaitAck(int fdI2cDev, BYTE slaveAddr, UINT32 uTimeout);
+void I2CHALDelay(int fdI2cDev, UINT32 us);
+
+void I2CHALBatchBegin(I2cBatch* pbatch, int fdI2cDev);
+BOOL I2CHALBatchAddRead(I2cBatch* pbatch, BYTE slaveAddr, WORD addrRead, BYTE* pbRead, BYTE cbRead, UINT32 uWait);
+BOOL I2CHALBatchAddWrite(I2cBatch* pbatch, BYTE slaveAddr, WORD addrWrite, const BYTE* pbWrite, BYTE cbWrite);
+BOOL I2CHALBatchSubmit(I2cBatch* pbatch);
+
+BOOL I2CHALGetStats(I2cStats* pstats);
+void I2CHALResetStats();
 
 
 #endif
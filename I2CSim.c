@@ -0,0 +1,980 @@
+/************************************************************************/
+/*                                                                      */
+/*  I2CSim.c - simulated Platform MCU and SYZYGY bus implementation     */
+/*                                                                      */
+/************************************************************************/
+/*  Author: Digilent Inc.                                               */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  This source file contains the implementation of an I2CHAL backend   */
+/*  that simulates the Platform MCU and the SYZYGY pods attached to     */
+/*  its SmartVIO ports.                                                 */
+/*                                                                      */
+/*  Each device has an address pointer that's set by the first two      */
+/*  bytes of every write message and incremented by every byte that's   */
+/*  read or written afterwards, which is how the PMCU and the pMCU of   */
+/*  a pod behave. A device that has been written stays busy for the     */
+/*  time it would need to program its EEPROM or flash and doesn't       */
+/*  acknowledge its address until then.                                 */
+/*                                                                      */
+/*  Time is modelled rather than measured: every transfer advances the  */
+/*  simulated clock by the host overhead, the start condition and       */
+/*  address of each message, and the bytes transferred, and every       */
+/*  delay requested by the library advances it by the requested time.  */
+/*  When fRealTime is set the backend also sleeps until the simulated   */
+/*  time has elapsed in real time, so that the wall clock time of an    */
+/*  operation includes both the bus and the CPU time of the library.    */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*  10/14/2026: created                                                 */
+/*                                                                      */
+/************************************************************************/
+
+/* ------------------------------------------------------------ */
+/*              Include File Definitions                        */
+/* ------------------------------------------------------------ */
+
+#if defined(__linux__)
+#include <time.h>
+#include <pthread.h>
+#endif
+#include <stdio.h>
+#include <string.h>
+#include "stdtypes.h"
+#include "I2CHAL.h"
+#include "PlatformMCU.h"
+#include "syzygy.h"
+#include "Zmod.h"
+#include "ZmodADC.h"
+#include "ZmodDAC.h"
+#include "ZmodDigitizer.h"
+#include "I2CSim.h"
+
+#if defined(__linux__)
+
+/* ------------------------------------------------------------ */
+/*              Miscellaneous Declarations                      */
+/* ------------------------------------------------------------ */
+
+#define nsPerSecond				1000000000L
+
+/* Define the layout of the DNA of a simulated pod. The strings follow
+** the header and must end before the PDID.
+*/
+#define ibSimDnaStrings			cbSyzygyDnaHeader
+#define ibSimDnaPdid			0x00FC
+#define ibSimDnaFactCal			0x0100
+#define cchSimDnaStringMax		64
+
+/* Define the default timing. The host overhead is typical of a Linux
+** I2C adapter driver, and the EEPROM write time is the one documented
+** for the PMCU.
+*/
+#define usSimXferDefault		40
+#define usSimPmcuEepromByte		3300
+#define usSimPmcuReset			500000
+#define usSimFlashWrite			4000
+
+/* ------------------------------------------------------------ */
+/*              Local Type Definitions                          */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*              Global Variables                                */
+/* ------------------------------------------------------------ */
+
+extern I2CHALThreadLocal BOOL	dpmutilfVerbose;
+
+/* ------------------------------------------------------------ */
+/*              Local Variables                                 */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*              Forward Declarations                            */
+/* ------------------------------------------------------------ */
+
+static BOOL		FSimXfer(void* pvContext, I2cBackendMsg rgmsg[], WORD cmsg);
+static void		SimDelay(void* pvContext, UINT32 us);
+static void		SimSleepUntilNow(I2cSim* psim, UINT64 nsNow);
+static I2cSimPod*	PpodFromAddr(I2cSim* psim, BYTE slaveAddr);
+static BYTE		BSimPmcuRead(I2cSim* psim, WORD addr);
+static BOOL		FSimPmcuWrite(I2cSim* psim, WORD addr, BYTE b);
+static BYTE		BSimPodRead(const I2cSimPod* ppod, WORD addr);
+static BOOL		FSimPodWrite(I2cSimPod* ppod, WORD addr, BYTE b);
+static void		SimUpdatePorts(I2cSim* psim);
+static void		SimBuildCal(ZMOD_FAMILY family, BYTE* pbCal, WORD cbCal, float fltOffset);
+static BYTE		CchSimPutString(BYTE* pb, const char* sz);
+
+/* ------------------------------------------------------------ */
+/*              Procedure Definitions                           */
+/* ------------------------------------------------------------ */
+
+const I2cBackend	i2cbeSim = { FSimXfer, SimDelay, NULL };
+
+/* ------------------------------------------------------------ */
+/***    I2CSimTimingFromClock
+**
+**  Parameters:
+**      hzScl           - I2C clock frequency, such as 100000 or 400000
+**      ptiming         - timing to initialize
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function initializes the timing of a simulated bus running
+**      at the specified clock frequency. A byte takes nine clocks to
+**      transfer with its acknowledge and the start condition and slave
+**      address of each message take ten.
+*/
+void
+I2CSimTimingFromClock(DWORD hzScl, I2cSimTiming* ptiming) {
+
+	memset(ptiming, 0, sizeof(I2cSimTiming));
+
+	ptiming->hzScl = hzScl;
+	ptiming->nsByte = (UINT32)((9 * (UINT64)nsPerSecond) / hzScl);
+	ptiming->nsMsg = (UINT32)((10 * (UINT64)nsPerSecond) / hzScl);
+	ptiming->usXfer = usSimXferDefault;
+	ptiming->usPmcuEepromByte = usSimPmcuEepromByte;
+	ptiming->usPmcuReset = usSimPmcuReset;
+	ptiming->usFlashWrite = usSimFlashWrite;
+	ptiming->fRealTime = fFalse;
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CSimInit
+**
+**  Parameters:
+**      psim            - simulated bus to initialize
+**      ptiming         - timing of the bus
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function initializes a simulated bus with a Platform MCU
+**      that has one temperature probe, one fan, a 5V0 and a 3V3 group,
+**      two VADJ groups and two empty SYZYGY standard ports, like an
+**      Eclypse Z7. Pods are added with I2CSimAddPod. The simulation
+**      must be released with I2CSimTerm.
+*/
+void
+I2CSimInit(I2cSim* psim, const I2cSimTiming* ptiming) {
+
+	PMCU_CONFIG_REGS*	pcfg;
+	BYTE				iport;
+
+	memset(psim, 0, sizeof(I2cSim));
+	psim->timing = *ptiming;
+	pthread_mutex_init(&psim->mtx, NULL);
+	clock_gettime(CLOCK_MONOTONIC, &psim->tsStart);
+
+	psim->pmcu.fwregs.pdid = 0x00C0FFEE;
+	psim->pmcu.fwregs.fwver = 0x0103;
+
+	pcfg = &psim->pmcu.cfgregs;
+	pcfg->cfgver = 0x0100;
+	pcfg->platcfg.fEnforce5v0CurLimit = 1;
+	pcfg->platcfg.fEnforce3v3CurLimit = 1;
+	pcfg->platcfg.fEnforceVioCurLimit = 1;
+	pcfg->platcfg.fPerformCrcCheck = 1;
+	pcfg->cprobe = 1;
+	pcfg->cfan = 1;
+	pcfg->c5v0 = 1;
+	pcfg->c3v3 = 1;
+	pcfg->cvadj = 2;
+	pcfg->cport = 2;
+
+	pcfg->rgtemp[0].attr.fPresent = tprobePresent;
+	pcfg->rgtemp[0].attr.tlocation = tlocationFpgaCpu1;
+	pcfg->rgtemp[0].attr.tformat = tformatDegCDecimal;
+	pcfg->rgtemp[0].temp = 42;
+
+	pcfg->rgfan[0].fcap.fcapEnable = 1;
+	pcfg->rgfan[0].fcap.fcapSetSpeed = 1;
+	pcfg->rgfan[0].fcap.fcapAutoSpeed = 1;
+	pcfg->rgfan[0].fcap.fcapMeasureRpm = 1;
+	pcfg->rgfan[0].fcfg.fEnable = fancfgEnable;
+	pcfg->rgfan[0].fcfg.fspeed = fancfgAutoSpeed;
+	pcfg->rgfan[0].fcfg.tempsrc = fancfgTempProbe1;
+	pcfg->rgfan[0].rpm = 3000;
+
+	pcfg->rg5v0[0].crntAllowed = 3000;
+	pcfg->rg3v3[0].crntAllowed = 3000;
+
+	for ( iport = 0; iport < pcfg->cport; iport++ ) {
+		pcfg->rgvadj[iport].vltg = 330;
+		pcfg->rgvadj[iport].crntAllowed = 1000;
+		pcfg->rgport[iport].i2cAddr = addrI2cSimPodBase + iport;
+		pcfg->rgport[iport].group5v0 = 0;
+		pcfg->rgport[iport].group3v3 = 0;
+		pcfg->rgport[iport].groupVio = iport;
+		pcfg->rgport[iport].ptype = ptypeSyzygyStd;
+		psim->rgpod[iport].i2cAddr = addrI2cSimPodBase + iport;
+	}
+
+	SimUpdatePorts(psim);
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CSimTerm
+**
+**  Parameters:
+**      psim            - simulated bus
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function releases a simulated bus. No file descriptor may
+**      still be using it.
+*/
+void
+I2CSimTerm(I2cSim* psim) {
+
+	pthread_mutex_destroy(&psim->mtx);
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CSimAddPod
+**
+**  Parameters:
+**      psim            - simulated bus
+**      iport           - index of the SmartVIO port
+**      pdid            - product ID of the pod, which selects the format
+**                        of its calibration areas
+**      szProductName   - product name stored in the DNA
+**      szSerialNumber  - serial number stored in the DNA
+**
+**  Return Value:
+**      fTrue for success, fFalse if the port doesn't exist
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function inserts a pod into a port of the simulated board.
+**      Its DNA is built with a valid header CRC, and Zmods get a
+**      factory and a user calibration area with valid checksums. The
+**      status and supply current registers of the PMCU are updated as
+**      the PMCU would after enumerating the pod.
+*/
+BOOL
+I2CSimAddPod(I2cSim* psim, BYTE iport, DWORD pdid, const char* szProductName, const char* szSerialNumber) {
+
+	I2cSimPod*					ppod;
+	SzgDnaHeader				hdr;
+	const ZMOD_FAMILY_HANDLER*	pzfh;
+	ZMOD_FAMILY					family;
+	WORD						crc;
+	WORD						ib;
+
+	if ( psim->pmcu.cfgregs.cport <= iport ) {
+		return fFalse;
+	}
+
+	pthread_mutex_lock(&psim->mtx);
+
+	ppod = &psim->rgpod[iport];
+	memset(ppod->rgbUser, 0xFF, sizeof(ppod->rgbUser));
+	memset(ppod->rgbDna, 0xFF, sizeof(ppod->rgbDna));
+	ppod->pdid = pdid;
+	ppod->addrNext = 0;
+	ppod->nsBusy = 0;
+
+	ppod->rgbFwRegs[0] = 1;
+	ppod->rgbFwRegs[1] = 2;
+	ppod->rgbFwRegs[2] = szgverMajor;
+	ppod->rgbFwRegs[3] = szgverMinor;
+	ppod->rgbFwRegs[4] = (cbSyzygyDnaMax >> 8);
+	ppod->rgbFwRegs[5] = cbSyzygyDnaMax & 0xFF;
+
+	/* Place the strings after the header, then build the header now that
+	** their lengths are known.
+	*/
+	memset(&hdr, 0, sizeof(hdr));
+	ib = ibSimDnaStrings;
+	hdr.cbManufacturerName = CchSimPutString(&ppod->rgbDna[ib], "Digilent");
+	ib += hdr.cbManufacturerName;
+	hdr.cbProductName = CchSimPutString(&ppod->rgbDna[ib], szProductName);
+	ib += hdr.cbProductName;
+	hdr.cbProductModel = CchSimPutString(&ppod->rgbDna[ib], "SIM");
+	ib += hdr.cbProductModel;
+	hdr.cbProductVersion = CchSimPutString(&ppod->rgbDna[ib], "A");
+	ib += hdr.cbProductVersion;
+	hdr.cbSerialNumber = CchSimPutString(&ppod->rgbDna[ib], szSerialNumber);
+	ib += hdr.cbSerialNumber;
+
+	hdr.cbDna = ib;
+	hdr.cbDnaHeader = cbSyzygyDnaHeader;
+	hdr.dnaverMjr = szgverMajor;
+	hdr.dnaverMin = szgverMinor;
+	hdr.dnaverRequiredMjr = szgverMajor;
+	hdr.dnaverRequiredMin = szgverMinor;
+	hdr.crntRequired5v0 = 400;
+	hdr.crntRequired3v3 = 200;
+	hdr.crntRequiredVio = 100;
+	hdr.vltgRange1Min = 120;
+	hdr.vltgRange1Max = 330;
+
+	/* Zmods store their PDID and calibration after the strings.
+	*/
+	if ( FGetZmodFamily(pdid, &family) ) {
+		pzfh = PzfhFromZmodFamily(family);
+		memcpy(&ppod->rgbDna[ibSimDnaPdid], &pdid, sizeof(DWORD));
+		SimBuildCal(family, &ppod->rgbDna[ibSimDnaFactCal], pzfh->cbCal, 0.0);
+		SimBuildCal(family, &ppod->rgbUser[pzfh->addrUserCal - addrI2cSimPodUser], pzfh->cbCal, 0.001);
+		hdr.cbDna = ibSimDnaFactCal + pzfh->cbCal;
+	}
+
+	memcpy(ppod->rgbDna, &hdr, cbSyzygyDnaHeader - 2);
+	crc = SyzygyComputeCRC(ppod->rgbDna, cbSyzygyDnaHeader - 2);
+	ppod->rgbDna[cbSyzygyDnaHeader - 2] = (crc >> 8);
+	ppod->rgbDna[cbSyzygyDnaHeader - 1] = crc & 0xFF;
+
+	ppod->fPresent = fTrue;
+	SimUpdatePorts(psim);
+
+	pthread_mutex_unlock(&psim->mtx);
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CSimRemovePod
+**
+**  Parameters:
+**      psim            - simulated bus
+**      iport           - index of the SmartVIO port
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function removes the pod from a port of the simulated board.
+*/
+void
+I2CSimRemovePod(I2cSim* psim, BYTE iport) {
+
+	if ( cPmcuPortMax <= iport ) {
+		return;
+	}
+
+	pthread_mutex_lock(&psim->mtx);
+	psim->rgpod[iport].fPresent = fFalse;
+	SimUpdatePorts(psim);
+	pthread_mutex_unlock(&psim->mtx);
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CSimGetCounters
+**
+**  Parameters:
+**      psim            - simulated bus
+**      pcnt            - pointer to a variable to receive the counters
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function returns the number of transfers, messages and
+**      bytes seen by the simulated bus and the modelled time spent in
+**      them since I2CSimInit or the last call to I2CSimResetCounters.
+*/
+void
+I2CSimGetCounters(I2cSim* psim, I2cSimCounters* pcnt) {
+
+	pthread_mutex_lock(&psim->mtx);
+	*pcnt = psim->cnt;
+	pthread_mutex_unlock(&psim->mtx);
+}
+
+/* ------------------------------------------------------------ */
+/***    I2CSimResetCounters
+**
+**  Parameters:
+**      psim            - simulated bus
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function zeroes the counters of the simulated bus.
+*/
+void
+I2CSimResetCounters(I2cSim* psim) {
+
+	pthread_mutex_lock(&psim->mtx);
+	memset(&psim->cnt, 0, sizeof(I2cSimCounters));
+	pthread_mutex_unlock(&psim->mtx);
+}
+
+/* ------------------------------------------------------------ */
+/*          Local Functions                                     */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/***    FSimXfer
+**
+**  Parameters:
+**      pvContext       - simulated bus
+**      rgmsg           - messages of the transfer
+**      cmsg            - number of messages
+**
+**  Return Value:
+**      fTrue if every message was acknowledged, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function performs a transfer on the simulated bus. The
+**      transfer ends at the first message that isn't acknowledged. A
+**      device that was written starts programming its EEPROM or flash
+**      when the stop condition ends the transfer.
+*/
+static BOOL
+FSimXfer(void* pvContext, I2cBackendMsg rgmsg[], WORD cmsg) {
+
+	I2cSim*			psim;
+	I2cSimPod*		ppod;
+	I2cSimPod*		rgppodWritten[cPmcuPortMax];
+	BYTE			cpodWritten;
+	UINT32			cbPmcuWritten;
+	BOOL			fPmcuReset;
+	BOOL			fRet;
+	UINT64			nsStart;
+	UINT64			nsNow;
+	WORD			imsg;
+	WORD			ib;
+	BYTE			ipod;
+
+	psim = (I2cSim*)pvContext;
+	fRet = fTrue;
+	cpodWritten = 0;
+	cbPmcuWritten = 0;
+	fPmcuReset = fFalse;
+
+	pthread_mutex_lock(&psim->mtx);
+
+	nsStart = psim->nsNow;
+	psim->nsNow += (UINT64)psim->timing.usXfer * 1000;
+	psim->cnt.cxfer++;
+
+	for ( imsg = 0; imsg < cmsg; imsg++ ) {
+		psim->cnt.cmsg++;
+		psim->nsNow += psim->timing.nsMsg;
+
+		/* A device that's busy, or doesn't exist, doesn't acknowledge
+		** its address and the host ends the transfer.
+		*/
+		if ( addrPlatformMcuI2c == rgmsg[imsg].slaveAddr ) {
+			ppod = NULL;
+			if ( psim->nsNow < psim->nsPmcuBusy ) {
+				fRet = fFalse;
+			}
+		}
+		else {
+			ppod = PpodFromAddr(psim, rgmsg[imsg].slaveAddr);
+			if (( NULL == ppod ) || ( psim->nsNow < ppod->nsBusy )) {
+				fRet = fFalse;
+			}
+		}
+
+		if ( ! fRet ) {
+			psim->cnt.cnack++;
+			break;
+		}
+
+		psim->nsNow += (UINT64)psim->timing.nsByte * rgmsg[imsg].cb;
+
+		if ( rgmsg[imsg].fRead ) {
+			for ( ib = 0; ib < rgmsg[imsg].cb; ib++ ) {
+				if ( NULL == ppod ) {
+					rgmsg[imsg].pb[ib] = BSimPmcuRead(psim, psim->addrPmcuNext++);
+				}
+				else {
+					rgmsg[imsg].pb[ib] = BSimPodRead(ppod, ppod->addrNext++);
+				}
+			}
+			psim->cnt.cbRead += rgmsg[imsg].cb;
+			continue;
+		}
+
+		/* The first two bytes of a write set the address pointer and any
+		** bytes that follow are written.
+		*/
+		psim->cnt.cbWrite += rgmsg[imsg].cb;
+		for ( ib = 0; ib < rgmsg[imsg].cb; ib++ ) {
+			if ( 2 > ib ) {
+				if ( NULL == ppod ) {
+					psim->addrPmcuNext = (psim->addrPmcuNext << 8) | rgmsg[imsg].pb[ib];
+				}
+				else {
+					ppod->addrNext = (ppod->addrNext << 8) | rgmsg[imsg].pb[ib];
+				}
+			}
+			else if ( NULL == ppod ) {
+				if ( regaddrSoftwareReset == psim->addrPmcuNext ) {
+					fPmcuReset = fTrue;
+				}
+				if ( FSimPmcuWrite(psim, psim->addrPmcuNext++, rgmsg[imsg].pb[ib]) ) {
+					cbPmcuWritten++;
+				}
+			}
+			else if ( FSimPodWrite(ppod, ppod->addrNext++, rgmsg[imsg].pb[ib]) ) {
+				for ( ipod = 0; ipod < cpodWritten; ipod++ ) {
+					if ( ppod == rgppodWritten[ipod] ) {
+						break;
+					}
+				}
+				if ( ipod == cpodWritten ) {
+					rgppodWritten[cpodWritten++] = ppod;
+				}
+			}
+		}
+	}
+
+	/* The stop condition has been placed on the bus.
+	*/
+	if ( fPmcuReset ) {
+		psim->nsPmcuBusy = psim->nsNow + ((UINT64)psim->timing.usPmcuReset * 1000);
+	}
+	else if ( 0 < cbPmcuWritten ) {
+		psim->nsPmcuBusy = psim->nsNow + ((UINT64)psim->timing.usPmcuEepromByte * 1000 * cbPmcuWritten);
+	}
+	for ( ipod = 0; ipod < cpodWritten; ipod++ ) {
+		rgppodWritten[ipod]->nsBusy = psim->nsNow + ((UINT64)psim->timing.usFlashWrite * 1000);
+	}
+
+	psim->cnt.nsBus += psim->nsNow - nsStart;
+	nsNow = psim->nsNow;
+
+	pthread_mutex_unlock(&psim->mtx);
+
+	SimSleepUntilNow(psim, nsNow);
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    SimDelay
+**
+**  Parameters:
+**      pvContext       - simulated bus
+**      us              - number of microseconds to wait
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function performs a delay requested by the library.
+*/
+static void
+SimDelay(void* pvContext, UINT32 us) {
+
+	I2cSim*	psim;
+	UINT64	nsNow;
+
+	psim = (I2cSim*)pvContext;
+
+	pthread_mutex_lock(&psim->mtx);
+	psim->nsNow += (UINT64)us * 1000;
+	psim->cnt.nsDelay += (UINT64)us * 1000;
+	nsNow = psim->nsNow;
+	pthread_mutex_unlock(&psim->mtx);
+
+	SimSleepUntilNow(psim, nsNow);
+}
+
+/* ------------------------------------------------------------ */
+/***    SimSleepUntilNow
+**
+**  Parameters:
+**      psim            - simulated bus
+**      nsNow           - simulated time
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function sleeps until the specified simulated time has
+**      elapsed in real time, if the simulation runs in real time.
+*/
+static void
+SimSleepUntilNow(I2cSim* psim, UINT64 nsNow) {
+
+	struct timespec	tsUntil;
+	UINT64			ns;
+
+	if ( ! psim->timing.fRealTime ) {
+		return;
+	}
+
+	ns = (UINT64)psim->tsStart.tv_nsec + nsNow;
+	tsUntil.tv_sec = psim->tsStart.tv_sec + (ns / nsPerSecond);
+	tsUntil.tv_nsec = ns % nsPerSecond;
+
+	while ( 0 != clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &tsUntil, NULL) ) {
+	}
+}
+
+/* ------------------------------------------------------------ */
+/***    PpodFromAddr
+**
+**  Parameters:
+**      psim            - simulated bus
+**      slaveAddr       - I2C address
+**
+**  Return Value:
+**      pointer to the pod with the address, NULL if there's none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function finds the pod that responds to an I2C address.
+*/
+static I2cSimPod*
+PpodFromAddr(I2cSim* psim, BYTE slaveAddr) {
+
+	BYTE	iport;
+
+	for ( iport = 0; iport < psim->pmcu.cfgregs.cport; iport++ ) {
+		if (( psim->rgpod[iport].fPresent ) && ( slaveAddr == psim->rgpod[iport].i2cAddr )) {
+			return &psim->rgpod[iport];
+		}
+	}
+
+	return NULL;
+}
+
+/* ------------------------------------------------------------ */
+/***    BSimPmcuRead
+**
+**  Parameters:
+**      psim            - simulated bus
+**      addr            - register address
+**
+**  Return Value:
+**      value of the register byte, 0xFF for unimplemented addresses
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function reads a byte of the PMCU register map.
+*/
+static BYTE
+BSimPmcuRead(I2cSim* psim, WORD addr) {
+
+	if ( cbPmcuFirmwareRegs > addr ) {
+		return ((BYTE*)&psim->pmcu.fwregs)[addr];
+	}
+
+	if (( regaddrReserved1 <= addr ) && ( regaddrReserved1 + cbPmcuConfigRegs > addr )) {
+		return ((BYTE*)&psim->pmcu.cfgregs)[addr - regaddrReserved1];
+	}
+
+	return 0xFF;
+}
+
+/* ------------------------------------------------------------ */
+/***    FSimPmcuWrite
+**
+**  Parameters:
+**      psim            - simulated bus
+**      addr            - register address
+**      b               - value to write
+**
+**  Return Value:
+**      fTrue if a configuration register byte was written, which the
+**      PMCU stores in its EEPROM
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function writes a byte of the PMCU register map. The
+**      firmware registers are read only.
+*/
+static BOOL
+FSimPmcuWrite(I2cSim* psim, WORD addr, BYTE b) {
+
+	if (( regaddrReserved1 <= addr ) && ( regaddrReserved1 + cbPmcuConfigRegs > addr )) {
+		((BYTE*)&psim->pmcu.cfgregs)[addr - regaddrReserved1] = b;
+		return fTrue;
+	}
+
+	return fFalse;
+}
+
+/* ------------------------------------------------------------ */
+/***    BSimPodRead
+**
+**  Parameters:
+**      ppod            - simulated pod
+**      addr            - memory address
+**
+**  Return Value:
+**      value of the byte, 0xFF for unimplemented addresses
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function reads a byte of the memory of a pod.
+*/
+static BYTE
+BSimPodRead(const I2cSimPod* ppod, WORD addr) {
+
+	if ( sizeof(ppod->rgbFwRegs) > addr ) {
+		return ppod->rgbFwRegs[addr];
+	}
+
+	if (( addrI2cSimPodUser <= addr ) && ( addrI2cSimPodUser + cbI2cSimPodUser > addr )) {
+		return ppod->rgbUser[addr - addrI2cSimPodUser];
+	}
+
+	if (( addrDnaStart <= addr ) && ( addrDnaStart + cbSyzygyDnaMax > addr )) {
+		return ppod->rgbDna[addr - addrDnaStart];
+	}
+
+	return 0xFF;
+}
+
+/* ------------------------------------------------------------ */
+/***    FSimPodWrite
+**
+**  Parameters:
+**      ppod            - simulated pod
+**      addr            - memory address
+**      b               - value to write
+**
+**  Return Value:
+**      fTrue if a byte of flash was written
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function writes a byte of the memory of a pod. Write
+**      protection isn't modelled, so the magic numbers written to
+**      addrFlashMagic are accepted and ignored.
+*/
+static BOOL
+FSimPodWrite(I2cSimPod* ppod, WORD addr, BYTE b) {
+
+	if (( addrI2cSimPodUser <= addr ) && ( addrI2cSimPodUser + cbI2cSimPodUser > addr )) {
+		ppod->rgbUser[addr - addrI2cSimPodUser] = b;
+		return fTrue;
+	}
+
+	if (( addrDnaStart <= addr ) && ( addrDnaStart + cbSyzygyDnaMax > addr )) {
+		ppod->rgbDna[addr - addrDnaStart] = b;
+		return fTrue;
+	}
+
+	return fFalse;
+}
+
+/* ------------------------------------------------------------ */
+/***    SimUpdatePorts
+**
+**  Parameters:
+**      psim            - simulated bus
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function updates the port status, VADJ status and requested
+**      current registers of the PMCU from the pods that are present.
+*/
+static void
+SimUpdatePorts(I2cSim* psim) {
+
+	PMCU_CONFIG_REGS*	pcfg;
+	SzgDnaHeader		hdr;
+	BYTE				iport;
+	BYTE				ivadj;
+
+	pcfg = &psim->pmcu.cfgregs;
+	pcfg->rg5v0[0].crntRequested = 0;
+	pcfg->rg3v3[0].crntRequested = 0;
+	pcfg->vadjsts.fsEn = 0;
+	pcfg->vadjsts.fsPgood = 0;
+
+	for ( iport = 0; iport < pcfg->cport; iport++ ) {
+		ivadj = pcfg->rgport[iport].groupVio;
+		pcfg->rgvadj[ivadj].crntRequested = 0;
+		pcfg->rgport[iport].psts.fsStatus = 0;
+
+		if ( ! psim->rgpod[iport].fPresent ) {
+			continue;
+		}
+
+		memcpy(&hdr, psim->rgpod[iport].rgbDna, sizeof(hdr));
+		pcfg->rg5v0[0].crntRequested += hdr.crntRequired5v0;
+		pcfg->rg3v3[0].crntRequested += hdr.crntRequired3v3;
+		pcfg->rgvadj[ivadj].crntRequested += hdr.crntRequiredVio;
+
+		pcfg->rgport[iport].psts.fPresent = 1;
+		pcfg->rgport[iport].psts.f5v0InLimit = 1;
+		pcfg->rgport[iport].psts.f3v3InLimit = 1;
+		pcfg->rgport[iport].psts.fVioInLimit = 1;
+		pcfg->rgport[iport].psts.fAllowVioEnable = 1;
+		pcfg->vadjsts.fsEn |= (1 << ivadj);
+		pcfg->vadjsts.fsPgood |= (1 << ivadj);
+	}
+}
+
+/* ------------------------------------------------------------ */
+/***    SimBuildCal
+**
+**  Parameters:
+**      family          - Zmod family
+**      pbCal           - buffer to receive the calibration area
+**      cbCal           - size of the calibration area
+**      fltOffset       - added to every coefficient, so that the user
+**                        area differs from the factory area
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function builds a calibration area with typical gains and
+**      offsets and a valid checksum.
+*/
+static void
+SimBuildCal(ZMOD_FAMILY family, BYTE* pbCal, WORD cbCal, float fltOffset) {
+
+	ZMOD_ADC_CAL*		padcal;
+	ZMOD_DAC_CAL*		pdacal;
+	ZMOD_DIGITIZER_CAL*	pdigcal;
+	static const BYTE	rghzDigitizer[cbDigitizerCalibHzSteps] = { 0, 50, 80, 100, 110, 120, 125 };
+	BYTE				bSum;
+	WORD				ib;
+	BYTE				i;
+	BYTE				j;
+
+	memset(pbCal, 0, cbCal);
+
+	switch ( family ) {
+		case ZMOD_FAMILY_ADC:
+			padcal = (ZMOD_ADC_CAL*)pbCal;
+			padcal->id = 0xAD;
+			padcal->date = 1760400000;
+			for ( i = 0; i < 2; i++ ) {
+				for ( j = 0; j < 2; j++ ) {
+					padcal->cal[i][j][0] = 1.02 + fltOffset + (0.01 * j);
+					padcal->cal[i][j][1] = 0.004 - fltOffset;
+				}
+			}
+			break;
+
+		case ZMOD_FAMILY_DAC:
+			pdacal = (ZMOD_DAC_CAL*)pbCal;
+			pdacal->id = 0xDA;
+			pdacal->date = 1760400000;
+			for ( i = 0; i < 2; i++ ) {
+				for ( j = 0; j < 2; j++ ) {
+					pdacal->cal[i][j][0] = 0.98 + fltOffset + (0.01 * j);
+					pdacal->cal[i][j][1] = -0.003 - fltOffset;
+				}
+			}
+			break;
+
+		case ZMOD_FAMILY_DIGITIZER:
+			pdigcal = (ZMOD_DIGITIZER_CAL*)pbCal;
+			pdigcal->id = 0xDD;
+			pdigcal->date = 1760400000;
+			memcpy(pdigcal->hz, rghzDigitizer, sizeof(rghzDigitizer));
+			for ( i = 0; i < cbDigitizerCalibHzSteps; i++ ) {
+				for ( j = 0; j < 2; j++ ) {
+					pdigcal->cal[i][j][0] = 1.05 + fltOffset + (0.002 * i);
+					pdigcal->cal[i][j][1] = 0.01 - fltOffset;
+				}
+			}
+			break;
+
+		default:
+			break;
+	}
+
+	bSum = 0;
+	for ( ib = 0; ib < cbCal - 1; ib++ ) {
+		bSum += pbCal[ib];
+	}
+	pbCal[cbCal - 1] = (BYTE)(0 - bSum);
+}
+
+/* ------------------------------------------------------------ */
+/***    CchSimPutString
+**
+**  Parameters:
+**      pb              - buffer to receive the string
+**      sz              - string
+**
+**  Return Value:
+**      number of characters stored, without a terminator
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function stores a DNA string, which isn't terminated,
+**      truncating it to cchSimDnaStringMax characters so that every
+**      string fits in front of the PDID.
+*/
+static BYTE
+CchSimPutString(BYTE* pb, const char* sz) {
+
+	size_t	cch;
+
+	cch = ( NULL != sz ) ? strlen(sz) : 0;
+	if ( cchSimDnaStringMax < cch ) {
+		cch = cchSimDnaStringMax;
+	}
+
+	memcpy(pb, sz, cch);
+
+	return (BYTE)cch;
+}
+
+#endif
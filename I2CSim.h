@@ -0,0 +1,125 @@
+/************************************************************************/
+/*                                                                      */
+/*  I2CSim.h - simulated Platform MCU and SYZYGY bus declarations       */
+/*                                                                      */
+/************************************************************************/
+/*  Author: Digilent Inc.                                               */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  This header file contains the declarations for an I2CHAL backend    */
+/*  that simulates the I2C bus of a Digilent platform board: the        */
+/*  Platform MCU register map and the DNA, firmware registers and user  */
+/*  calibration area of a SYZYGY pod on each SmartVIO port. The time    */
+/*  taken by the bus, by the host for each transfer, and by the         */
+/*  devices while they write their EEPROM or flash is modelled so that  */
+/*  the library can be benchmarked without any hardware.                */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*  10/14/2026: created                                                 */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef I2CSIM_H_
+#define I2CSIM_H_
+
+#include "../dpmutil/I2CHAL.h"
+#include "../dpmutil/PlatformMCU.h"
+#include "../dpmutil/syzygy.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <time.h>
+
+/* ------------------------------------------------------------ */
+/*                  Miscellaneous Declarations                  */
+/* ------------------------------------------------------------ */
+
+/* Define the first I2C address assigned to the simulated pods. The pod
+** on port n is at addrI2cSimPodBase + n.
+*/
+#define addrI2cSimPodBase		0x30
+
+/* Define the memory of a simulated pod. The user area starts at the
+** address of the user calibration area of every Zmod family.
+*/
+#define addrI2cSimPodUser		0x7000
+#define cbI2cSimPodUser			0x1000
+
+/* ------------------------------------------------------------ */
+/*                  General Type Declarations                   */
+/* ------------------------------------------------------------ */
+
+typedef struct {
+	DWORD	hzScl;				// I2C clock frequency
+	UINT32	nsByte;				// time to clock a byte and its acknowledge
+	UINT32	nsMsg;				// start or repeated start and slave address
+	UINT32	usXfer;				// host and controller overhead of each transfer
+	UINT32	usPmcuEepromByte;	// PMCU busy time per configuration byte written
+	UINT32	usPmcuReset;		// PMCU busy time after a software reset
+	UINT32	usFlashWrite;		// pod busy time after each write to its flash
+	BOOL	fRealTime;			// fTrue to sleep until the modelled time has elapsed
+} I2cSimTiming;
+
+typedef struct {
+	UINT32	cxfer;				// transfers, each ending with a stop
+	UINT32	cmsg;				// messages, each starting with a start or repeated start
+	UINT32	cnack;				// messages that weren't acknowledged
+	UINT64	cbRead;
+	UINT64	cbWrite;
+	UINT64	nsBus;				// modelled time spent in transfers
+	UINT64	nsDelay;			// time spent in delays requested by the library
+} I2cSimCounters;
+
+typedef struct {
+	BOOL			fPresent;
+	BYTE			i2cAddr;
+	DWORD			pdid;
+	BYTE			rgbFwRegs[6];
+	BYTE			rgbUser[cbI2cSimPodUser];
+	BYTE			rgbDna[cbSyzygyDnaMax];
+	WORD			addrNext;		// address pointer, incremented by each byte
+	UINT64			nsBusy;			// NACKs every message until this time
+} I2cSimPod;
+
+typedef struct {
+	I2cSimTiming	timing;
+	PMCU_SNAPSHOT	pmcu;
+	WORD			addrPmcuNext;
+	UINT64			nsPmcuBusy;
+	I2cSimPod		rgpod[cPmcuPortMax];
+	UINT64			nsNow;			// modelled time since I2CSimInit
+	struct timespec	tsStart;		// real time of I2CSimInit, used with fRealTime
+	I2cSimCounters	cnt;
+	pthread_mutex_t	mtx;
+} I2cSim;
+
+/* ------------------------------------------------------------ */
+/*                  Variable Declarations                       */
+/* ------------------------------------------------------------ */
+
+/* Backend to pass, along with a pointer to an I2cSim, to
+** I2CHALOpenBackend or I2CHALSetDefaultBackend.
+*/
+extern const I2cBackend	i2cbeSim;
+
+/* ------------------------------------------------------------ */
+/*                  Procedure Declarations                      */
+/* ------------------------------------------------------------ */
+
+void	I2CSimTimingFromClock(DWORD hzScl, I2cSimTiming* ptiming);
+void	I2CSimInit(I2cSim* psim, const I2cSimTiming* ptiming);
+void	I2CSimTerm(I2cSim* psim);
+BOOL	I2CSimAddPod(I2cSim* psim, BYTE iport, DWORD pdid, const char* szProductName, const char* szSerialNumber);
+void	I2CSimRemovePod(I2cSim* psim, BYTE iport);
+void	I2CSimGetCounters(I2cSim* psim, I2cSimCounters* pcnt);
+void	I2CSimResetCounters(I2cSim* psim);
+
+#endif
+
+/* ------------------------------------------------------------ */
+
+#endif /* I2CSIM_H_ */
@@ -20,6 +20,12 @@
 /*      the limitations of the PMCU firmware                            */
 /*	05/04/2020 (ThomasK): added baremetal support. changed to I2CHAL	*/
 /* 		I2C calls														*/
+/*	10/14/2026: added PmcuWaitReady										*/
+/*	10/14/2026: added PmcuReadStatusRegs									*/
+/*	10/14/2026: PmcuWaitReady delays with I2CHALDelay					*/
+/*	10/14/2026: PmcuWaitReady waits before the first poll				*/
+/*	10/14/2026: named the default read and write delays					*/
+/*	10/14/2026: added PmcuNegotiateXfer									*/
 /*                                                                      */
 /************************************************************************/
 
@@ -56,11 +62,34 @@
 */
 #define cbPmcuTxMax 32
 
+/* Define the number of microseconds the PMCU firmware needs after a
+** stop condition before it acknowledges SLA+R, and the delay between
+** write transactions. These are the defaults, a timing profile set for
+** addrPlatformMcuI2c with I2CHALSetTimingProfile replaces them.
+*/
+#define usPmcuPreRead	50
+#define usPmcuPostWrite	0
+
+/* Define the range of delays used between the probes performed by
+** PmcuWaitReady. The delay starts at the minimum and doubles after each
+** probe that fails, up to the maximum.
+*/
+#define usReadyPollMin	500
+#define usReadyPollMax	32000
+
 
 /* ------------------------------------------------------------ */
 /*              Local Type Definitions                          */
 /* ------------------------------------------------------------ */
 
+/* Transaction sizes supported by PMCU firmware, starting with the
+** revision in fwver.
+*/
+typedef struct {
+	WORD	fwver;
+	WORD	cbReadMax;
+	WORD	cbWriteMax;		// including the 2 address bytes
+} PmcuXferLimits;
 
 /* ------------------------------------------------------------ */
 /*              Global Variables                                */
@@ -71,6 +100,16 @@
 /*              Local Variables                                 */
 /* ------------------------------------------------------------ */
 
+/* Transaction sizes of each range of PMCU firmware revisions, in order
+** of increasing revision. An entry is added here when a revision of
+** the firmware is released that receives or transmits more bytes per
+** transaction. The PMCU has no register block large enough whose
+** contents don't change between reads, so the sizes can't be
+** negotiated by reading.
+*/
+static const PmcuXferLimits	rgpmcuxferlim[] = {
+	{ 0x0000, cbPmcuTxMax, cbPmcuRxMax },
+};
 
 /* ------------------------------------------------------------ */
 /*              Forward Declarations                            */
@@ -107,7 +146,16 @@
 */
 BOOL
 PmcuI2cRead(int fdI2cDev, WORD addrRead, BYTE* pbRead, BYTE cbRead, WORD* pcbRead) {
-	return I2CHALRead(fdI2cDev, addrPlatformMcuI2c, addrRead, pbRead, cbRead, pcbRead, 50);
+
+	size_t	cbDone;
+	BOOL	fRet;
+
+	fRet = I2CHALRead(fdI2cDev, addrPlatformMcuI2c, addrRead, pbRead, cbRead, &cbDone, usPmcuPreRead);
+	if ( NULL != pcbRead ) {
+		*pcbRead = (WORD)cbDone;
+	}
+
+	return fRet;
 }
 
 /* ------------------------------------------------------------ */
@@ -135,5 +183,306 @@ PmcuI2cRead(int fdI2cDev, WORD addrRead, BYTE* pbRead, BYTE cbRead, WORD* pcbRea
 */
 BOOL
 PmcuI2cWrite(int fdI2cDev, WORD addrWrite, BYTE* pbWrite, BYTE cbWrite, WORD* pcbWritten) {
-	return I2CHALWrite(fdI2cDev, addrPlatformMcuI2c, addrWrite, pbWrite, cbWrite, cbPmcuRxMax, pcbWritten, 0);
+
+	size_t	cbDone;
+	BOOL	fRet;
+
+	fRet = I2CHALWrite(fdI2cDev, addrPlatformMcuI2c, addrWrite, pbWrite, cbWrite, cbPmcuRxMax, &cbDone, usPmcuPostWrite, 0);
+	if ( NULL != pcbWritten ) {
+		*pcbWritten = (WORD)cbDone;
+	}
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    PmcuNegotiateXfer
+**
+**  Parameters:
+**      fwver           - firmware version read from the PMCU
+**
+**  Return Value:
+**      fTrue for success, fFalse if the timing profile couldn't be set
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function sets the transaction sizes used by PmcuI2cRead,
+**      PmcuI2cWrite and the PMCU batch functions to the largest ones
+**      supported by the firmware revision, as listed in rgpmcuxferlim.
+**      The sizes are placed in the timing profile of addrPlatformMcuI2c,
+**      leaving its delays as they were. Sizes already present in the
+**      profile, such as those measured by I2CHALCalibrateReadTiming,
+**      are kept.
+*/
+BOOL
+PmcuNegotiateXfer(WORD fwver) {
+
+	const PmcuXferLimits*	plim;
+	I2cTimingProfile		prof;
+	BYTE					ilim;
+
+	plim = &rgpmcuxferlim[0];
+	for ( ilim = 1; ilim < sizeof(rgpmcuxferlim) / sizeof(rgpmcuxferlim[0]); ilim++ ) {
+		if ( rgpmcuxferlim[ilim].fwver <= fwver ) {
+			plim = &rgpmcuxferlim[ilim];
+		}
+	}
+
+	if ( ! I2CHALGetTimingProfile(addrPlatformMcuI2c, &prof) ) {
+		I2CHALInitTimingProfile(addrPlatformMcuI2c, &prof);
+	}
+	if ( 0 == prof.cbReadMax ) {
+		prof.cbReadMax = plim->cbReadMax;
+	}
+	if ( 0 == prof.cbWriteMax ) {
+		prof.cbWriteMax = plim->cbWriteMax;
+	}
+
+	return I2CHALSetTimingProfile(&prof);
+}
+
+/* ------------------------------------------------------------ */
+/***    PmcuBatchAddRead
+**
+**  Parameters:
+**      pbatch          - pointer to a batch started with I2CHALBatchBegin
+**      addrRead        - memory address to read
+**      pbRead          - pointer to a buffer to receive data
+**      cbRead          - number of bytes to read
+**
+**  Return Value:
+**      fTrue if the read was queued, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function queues a read of the Platform MCU registers in the
+**      specified batch. The data is retrieved when the batch is
+**      submitted with I2CHALBatchSubmit.
+*/
+BOOL
+PmcuBatchAddRead(I2cBatch* pbatch, WORD addrRead, BYTE* pbRead, BYTE cbRead) {
+	return I2CHALBatchAddRead(pbatch, addrPlatformMcuI2c, addrRead, pbRead, cbRead, usPmcuPreRead);
+}
+
+/* ------------------------------------------------------------ */
+/***    PmcuBatchAddWrite
+**
+**  Parameters:
+**      pbatch          - pointer to a batch started with I2CHALBatchBegin
+**      addrWrite       - memory address to write
+**      pbWrite         - pointer to a buffer to containing data to transmit
+**      cbWrite         - number of bytes to write
+**
+**  Return Value:
+**      fTrue if the write was queued, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function queues a write to the Platform MCU registers in the
+**      specified batch. The Platform MCU can't receive more than
+**      cbPmcuRxMax bytes in a single transaction so the write is
+**      rejected if it would need to be split.
+*/
+BOOL
+PmcuBatchAddWrite(I2cBatch* pbatch, WORD addrWrite, const BYTE* pbWrite, BYTE cbWrite) {
+
+	if ( cbPmcuRxMax < (2 + cbWrite) ) {
+		return fFalse;
+	}
+
+	return I2CHALBatchAddWrite(pbatch, addrPlatformMcuI2c, addrWrite, pbWrite, cbWrite);
+}
+
+/* ------------------------------------------------------------ */
+/***    PmcuReadConfigRegs
+**
+**  Parameters:
+**      fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      pcfgregs        - pointer to structure to receive the configuration registers
+**
+**  Return Value:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function reads the entire configuration register block of
+**      the Platform MCU, starting at regaddrReserved1 and ending with
+**      the last SmartVIO port status register. The registers are
+**      contiguous so the block is retrieved using the minimum number
+**      of cbPmcuTxMax byte transactions rather than one transaction
+**      per register.
+*/
+BOOL
+PmcuReadConfigRegs(int fdI2cDev, PMCU_CONFIG_REGS* pcfgregs) {
+
+	if ( NULL == pcfgregs ) {
+		return fFalse;
+	}
+
+	return PmcuI2cRead(fdI2cDev, regaddrReserved1, (BYTE*)pcfgregs, sizeof(PMCU_CONFIG_REGS), NULL);
+}
+
+/* ------------------------------------------------------------ */
+/***    PmcuReadStatusRegs
+**
+**  Parameters:
+**      fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      cport           - number of SmartVIO ports whose registers should be read
+**      pstsregs        - pointer to structure to receive the registers
+**
+**  Return Value:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function reads the VADJ status register and the registers
+**      of the first cport SmartVIO ports. These registers are
+**      contiguous, so they're read with a single PmcuI2cRead of at most
+**      50 bytes, which splits it into transactions of at most
+**      cbPmcuTxMax bytes. That's much less than the entire configuration
+**      register block read by PmcuReadConfigRegs.
+*/
+BOOL
+PmcuReadStatusRegs(int fdI2cDev, BYTE cport, PMCU_STATUS_REGS* pstsregs) {
+
+	if (( NULL == pstsregs ) || ( cPmcuPortMax < cport )) {
+		return fFalse;
+	}
+
+	return PmcuI2cRead(fdI2cDev, regaddrVadjStatus, (BYTE*)pstsregs, sizeof(VADJ_STATUS) + cport * sizeof(PMCU_PORT_REGS), NULL);
+}
+
+/* ------------------------------------------------------------ */
+/***    PmcuReadSnapshot
+**
+**  Parameters:
+**      fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      psnap           - pointer to structure to receive the register snapshot
+**
+**  Return Value:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function reads the firmware registers (PDID and firmware
+**      version) and the entire configuration register block of the
+**      Platform MCU into the structure pointed to by psnap. Callers can
+**      then decode any register from the snapshot without performing
+**      additional I2C transactions. Both blocks are read using a single
+**      batch.
+*/
+BOOL
+PmcuReadSnapshot(int fdI2cDev, PMCU_SNAPSHOT* psnap) {
+
+	I2cBatch	batch;
+
+	if ( NULL == psnap ) {
+		return fFalse;
+	}
+
+	I2CHALBatchBegin(&batch, fdI2cDev);
+	PmcuBatchAddRead(&batch, regaddrPDID, (BYTE*)&psnap->fwregs, sizeof(PMCU_FIRMWARE_REGS));
+	PmcuBatchAddRead(&batch, regaddrReserved1, (BYTE*)&psnap->cfgregs, sizeof(PMCU_CONFIG_REGS));
+
+	return I2CHALBatchSubmit(&batch);
+}
+
+/* ------------------------------------------------------------ */
+/***    PmcuWaitReady
+**
+**  Parameters:
+**      fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      msFirstPoll     - number of milliseconds to wait before the first poll
+**      msTimeout       - maximum number of milliseconds to wait, including msFirstPoll
+**
+**  Return Value:
+**      fTrue if the PMCU responded before the timeout expired, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function waits for the Platform MCU to respond as an I2C
+**      slave again after it has been asked to write its EEPROM or to
+**      reset. Nothing is sent on the bus for msFirstPoll milliseconds,
+**      msPmcuEepromFirstPoll after a write or msPmcuResetFirstPoll
+**      after a reset, so that the PMCU isn't addressed while it's
+**      still known to be busy. The PDID register is then read
+**      repeatedly, with the delay between reads doubling from
+**      usReadyPollMin up to usReadyPollMax, until a read succeeds or
+**      the timeout expires.
+*/
+BOOL
+PmcuWaitReady(int fdI2cDev, UINT32 msFirstPoll, UINT32 msTimeout) {
+
+	BYTE	rgbPdid[cbPDID];
+	UINT32	usDelay;
+	UINT64	usElapsed;
+#if defined(__linux__)
+	struct timespec	tsStart;
+	struct timespec	tsNow;
+
+	clock_gettime(CLOCK_MONOTONIC, &tsStart);
+#endif
+
+	usDelay = usReadyPollMin;
+	usElapsed = 0;
+
+	if ( msFirstPoll > msTimeout ) {
+		msFirstPoll = msTimeout;
+	}
+	if ( 0 != msFirstPoll ) {
+		I2CHALDelay(fdI2cDev, msFirstPoll * 1000);
+#if !defined(__linux__)
+		usElapsed = (UINT64)msFirstPoll * 1000;
+#endif
+	}
+
+	while ( ! PmcuI2cRead(fdI2cDev, regaddrPDID, rgbPdid, cbPDID, NULL) ) {
+#if defined(__linux__)
+		clock_gettime(CLOCK_MONOTONIC, &tsNow);
+		usElapsed = ((UINT64)(tsNow.tv_sec - tsStart.tv_sec) * 1000000) +
+					((tsNow.tv_nsec - tsStart.tv_nsec) / 1000);
+#endif
+		if ( usElapsed >= ((UINT64)msTimeout * 1000) ) {
+			return fFalse;
+		}
+
+		/* Don't sleep past the deadline, one final read is performed
+		** when it's reached.
+		*/
+		if ( usElapsed + usDelay > ((UINT64)msTimeout * 1000) ) {
+			usDelay = (UINT32)(((UINT64)msTimeout * 1000) - usElapsed);
+		}
+
+		I2CHALDelay(fdI2cDev, usDelay);
+#if !defined(__linux__)
+		/* There's no time base available on baremetal so the time spent
+		** sleeping is used as the elapsed time. This ignores the time
+		** spent on the bus and therefore errs on the side of waiting longer.
+		*/
+		usElapsed += usDelay;
+#endif
+
+		if ( usDelay < usReadyPollMax ) {
+			usDelay *= 2;
+			if ( usDelay > usReadyPollMax ) {
+				usDelay = usReadyPollMax;
+			}
+		}
+	}
+
+	return fTrue;
 }
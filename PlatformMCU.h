@@ -17,12 +17,15 @@
 /*                                                                      */
 /*  08/21/2019 (MichaelA): created                                      */
 /*	08/23/2019 (MichaelA): added declaration of PLATFORM_CONFIG			*/
+/*	10/14/2026: added PmcuNegotiateXfer									*/
 /*                                                                      */
 /************************************************************************/
 
 #ifndef PLATFORMMCU_H_
 #define PLATFORMMCU_H_
 
+#include "../dpmutil/I2CHAL.h"
+
 /* ------------------------------------------------------------ */
 /*                  Miscellaneous Declarations                  */
 /* ------------------------------------------------------------ */
@@ -187,6 +190,7 @@
 
 /* Define the size (in bytes) of each configuration register.
 */
+#define cbPDID                  4
 #define cbFirmwareVersion       2
 #define cbConfigurationVersion  2
 #define cbPlatformConfig        2
@@ -342,6 +346,39 @@
 #define offsetFanReg            (regaddrFan2Capabilities - regaddrFan1Capabilities)
 #define offsetTemperatureReg	(regaddrTemp2Attributes - regaddrTemp1Attributes)
 
+/* Define the maximum number of each type of register group that is
+** described by the PMCU register map.
+*/
+#define cPmcuTempProbeMax		4
+#define cPmcuFanMax				4
+#define cPmcu5v0GroupMax		4
+#define cPmcu3v3GroupMax		4
+#define cPmcuVadjGroupMax		8
+#define cPmcuPortMax			8
+
+/* Define the extent of the firmware and configuration register blocks.
+*/
+#define cbPmcuFirmwareRegs		(regaddrFirmwareVersion + cbFirmwareVersion - regaddrPDID)
+#define cbPmcuConfigRegs		(regaddrPortHStatus + cbPortHStatus - regaddrReserved1)
+
+/* Define the maximum amount of time that the PMCU may take to become
+** ready again, as seen by PmcuWaitReady. Writing a configuration register
+** results in up to 10 bytes of EEPROM being written at a typical 3.3ms
+** per byte. After a software reset the PMCU enumerates the SmartVIO
+** ports and enables the VADJ supplies before responding as a slave.
+*/
+#define msPmcuEepromWriteTimeout	250
+#define msPmcuResetTimeout			3000
+
+/* Define the time after which the PMCU is typically ready again, before
+** which it isn't polled by PmcuWaitReady or the asynchronous operations.
+** A configuration write results in up to 10 bytes of EEPROM being written.
+** After a reset the PMCU acts as an I2C master while it enumerates the
+** SmartVIO ports, and the host must stay off the bus in the meantime.
+*/
+#define msPmcuEepromFirstPoll		35
+#define msPmcuResetFirstPoll		100
+
 /* Define the different types of SmartVIO ports.
 */
 #define ptypeNone		0
@@ -477,6 +514,81 @@ typedef union {
 	BYTE fs;
 } TEMPERATURE_ATTRIBUTES;
 
+/* The following structures mirror the layout of the PMCU register map so
+** that a contiguous block of registers can be read with as few I2C
+** transactions as possible and then decoded in place.
+*/
+typedef struct {
+	DWORD					pdid;
+	WORD					fwver;
+} PMCU_FIRMWARE_REGS;
+
+typedef struct {
+	TEMPERATURE_ATTRIBUTES	attr;
+	SHORT					temp;
+} PMCU_TEMPERATURE_REGS;
+
+typedef struct {
+	FAN_CAPABILITIES		fcap;
+	FAN_CONFIGURATION		fcfg;
+	WORD					rpm;
+} PMCU_FAN_REGS;
+
+typedef struct {
+	WORD					crntAllowed;
+	WORD					crntRequested;
+} PMCU_SUPPLY_REGS;
+
+typedef struct {
+	WORD					vltg;
+	VADJ_OVERRIDE			vadjow;
+	WORD					crntAllowed;
+	WORD					crntRequested;
+} PMCU_VADJ_REGS;
+
+typedef struct {
+	BYTE					i2cAddr;
+	BYTE					group5v0;
+	BYTE					group3v3;
+	BYTE					groupVio;
+	BYTE					ptype;
+	PmcuPortStatus			psts;
+} PMCU_PORT_REGS;
+
+typedef struct {
+	WORD					rsv1;
+	WORD					cfgver;
+	PLATFORM_CONFIG			platcfg;
+	BYTE					cprobe;
+	BYTE					cfan;
+	BYTE					c5v0;
+	BYTE					c3v3;
+	BYTE					cvadj;
+	BYTE					cport;
+	PMCU_TEMPERATURE_REGS	rgtemp[cPmcuTempProbeMax];
+	PMCU_FAN_REGS			rgfan[cPmcuFanMax];
+	PMCU_SUPPLY_REGS		rg5v0[cPmcu5v0GroupMax];
+	PMCU_SUPPLY_REGS		rg3v3[cPmcu3v3GroupMax];
+	PMCU_VADJ_REGS			rgvadj[cPmcuVadjGroupMax];
+	VADJ_STATUS				vadjsts;
+	PMCU_PORT_REGS			rgport[cPmcuPortMax];
+} PMCU_CONFIG_REGS;
+
+typedef struct {
+	PMCU_FIRMWARE_REGS		fwregs;
+	PMCU_CONFIG_REGS		cfgregs;
+} PMCU_SNAPSHOT;
+
+/* The VADJ status and port registers, which are the only configuration
+** registers that change when a pod is inserted or removed or a supply
+** leaves its limits. Only the registers of the first cport ports are
+** read by PmcuReadStatusRegs.
+*/
+typedef struct {
+	VADJ_STATUS				vadjsts;
+	PMCU_PORT_REGS			rgport[cPmcuPortMax];
+} PMCU_STATUS_REGS;
+
 #pragma pack(pop)
 
 /* ------------------------------------------------------------ */
@@ -490,6 +602,13 @@ typedef union {
 
 BOOL	PmcuI2cRead(int fdI2cDev, WORD addrRead, BYTE* pbRead, BYTE cbRead, WORD* pcbRead);
 BOOL	PmcuI2cWrite(int fdI2cDev, WORD addrWrite, BYTE* pbWrite, BYTE cbWrite, WORD* pcbWritten);
+BOOL	PmcuNegotiateXfer(WORD fwver);
+BOOL	PmcuBatchAddRead(I2cBatch* pbatch, WORD addrRead, BYTE* pbRead, BYTE cbRead);
+BOOL	PmcuBatchAddWrite(I2cBatch* pbatch, WORD addrWrite, const BYTE* pbWrite, BYTE cbWrite);
+BOOL	PmcuReadSnapshot(int fdI2cDev, PMCU_SNAPSHOT* psnap);
+BOOL	PmcuReadConfigRegs(int fdI2cDev, PMCU_CONFIG_REGS* pcfgregs);
+BOOL	PmcuReadStatusRegs(int fdI2cDev, BYTE cport, PMCU_STATUS_REGS* pstsregs);
+BOOL	PmcuWaitReady(int fdI2cDev, UINT32 msFirstPoll, UINT32 msTimeout);
 
 /* ------------------------------------------------------------ */
 
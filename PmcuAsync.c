@@ -0,0 +1,927 @@
+/************************************************************************/
+/*                                                                      */
+/*  PmcuAsync.c - asynchronous Platform MCU operation implementation    */
+/*                                                                      */
+/************************************************************************/
+/*  Author: Digilent Inc.                                               */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  This source file contains the implementation of functions that can  */
+/*  be used to perform long running Platform MCU operations without     */
+/*  blocking the caller.                                                */
+/*                                                                      */
+/*  Each operation is a small state machine with two phases. In the     */
+/*  first phase the target register is read, the requested fields are   */
+/*  modified and the new value is written, just like the synchronous    */
+/*  dpmutilFSet functions do. In the second phase the register is read  */
+/*  back, which fails while the PMCU is busy writing its EEPROM or      */
+/*  restarting, until it succeeds or the timeout expires. The first     */
+/*  poll is scheduled for when the PMCU is typically ready again rather */
+/*  than after a fixed worst case delay.                                */
+/*                                                                      */
+/*  The operations are performed one at a time in the order they were   */
+/*  queued, since the PMCU doesn't accept a write until it's done with  */
+/*  the previous one.                                                   */
+/*                                                                      */
+/*  On Linux the operations are serviced by an event loop thread that   */
+/*  waits on an epoll set containing a timerfd, which is armed for the  */
+/*  next poll of the current operation, and an eventfd that's           */
+/*  signaled when an operation is queued. On bare metal the application */
+/*  drives the state machines by calling PmcuAsyncTick periodically.    */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*  10/14/2026: created                                                 */
+/*  10/14/2026: completion is signaled after the callback returns       */
+/*  10/14/2026: operations are performed one at a time and the bus      */
+/*              lock is held until a reset completes                    */
+/*                                                                      */
+/************************************************************************/
+
+/* ------------------------------------------------------------ */
+/*              Include File Definitions                        */
+/* ------------------------------------------------------------ */
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#endif
+#include <stdio.h>
+#include <string.h>
+#include "stdtypes.h"
+#include "I2CHAL.h"
+#include "PlatformMCU.h"
+#include "PmcuConfigTxn.h"
+#include "PmcuAsync.h"
+
+/* ------------------------------------------------------------ */
+/*              Miscellaneous Declarations                      */
+/* ------------------------------------------------------------ */
+
+/* Define the operation phases.
+*/
+#define phaseWrite				0
+#define phasePoll				1
+
+/* Define the timing used to poll for completion of a configuration
+** register write. The typical EEPROM write time is 3.3ms per byte and
+** a configuration write results in up to 10 bytes being written.
+*/
+#define msEepromFirstPoll		msPmcuEepromFirstPoll
+#define msEepromPollInterval	5
+#define msEepromTimeout			msPmcuEepromWriteTimeout
+
+/* Define the timing used to poll for the PMCU after a software reset.
+** The PMCU enumerates the SmartVIO ports and enables the VADJ supplies
+** as an I2C master before it responds as a slave again, which
+** typically takes several hundred milliseconds.
+*/
+#define msResetFirstPoll		msPmcuResetFirstPoll
+#define msResetPollInterval		20
+#define msResetTimeout			msPmcuResetTimeout
+
+#if defined(__linux__)
+#define AsyncLock(pasync)		pthread_mutex_lock(&(pasync)->mtx)
+#define AsyncUnlock(pasync)		pthread_mutex_unlock(&(pasync)->mtx)
+#else
+#define AsyncLock(pasync)
+#define AsyncUnlock(pasync)
+#endif
+
+/* ------------------------------------------------------------ */
+/*              Local Type Definitions                          */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*              Global Variables                                */
+/* ------------------------------------------------------------ */
+
+extern I2CHALThreadLocal BOOL	dpmutilfVerbose;
+
+/* ------------------------------------------------------------ */
+/*              Local Variables                                 */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*              Forward Declarations                            */
+/* ------------------------------------------------------------ */
+
+static BOOL		FAsyncSubmitReg(PmcuAsync* pasync, PmcuAsyncOp* pop, const PmcuTxnReg* ptreg, PFNPMCUASYNCDONE pfnDone, void* pvContext);
+static BOOL		FAsyncSubmit(PmcuAsync* pasync, PmcuAsyncOp* pop);
+static UINT64	AsyncProcess(PmcuAsync* pasync, UINT64 msNow);
+static BYTE		AsyncStep(PmcuAsync* pasync, PmcuAsyncOp* pop, UINT64 msNow);
+static void		AsyncComplete(PmcuAsync* pasync, PmcuAsyncOp* pop, BYTE ast);
+#if defined(__linux__)
+static void*	AsyncThread(void* pvAsync);
+static UINT64	MsMonotonic();
+#endif
+
+/* ------------------------------------------------------------ */
+/*              Procedure Definitions                           */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/***    PmcuAsyncInit
+**
+**  Parameters:
+**      pasync          - pointer to the event loop to initialize
+**  	fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**
+**  Return Value:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function initializes an event loop for the Platform MCU on
+**      the specified I2C controller. On Linux the event loop thread is
+**      started. The event loop must be terminated with PmcuAsyncTerm.
+*/
+BOOL
+PmcuAsyncInit(PmcuAsync* pasync, int fdI2cDev) {
+
+#if defined(__linux__)
+	struct epoll_event	ev;
+#endif
+
+	if ( NULL == pasync ) {
+		return fFalse;
+	}
+
+	memset(pasync, 0, sizeof(PmcuAsync));
+	pasync->fdI2cDev = fdI2cDev;
+
+#if defined(__linux__)
+	pasync->fdEpoll = -1;
+	pasync->fdTimer = -1;
+	pasync->fdEvent = -1;
+	pasync->fVerbose = dpmutilfVerbose;
+
+	pasync->fdEpoll = epoll_create1(EPOLL_CLOEXEC);
+	pasync->fdTimer = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+	pasync->fdEvent = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (( 0 > pasync->fdEpoll ) || ( 0 > pasync->fdTimer ) || ( 0 > pasync->fdEvent )) {
+		if(dpmutilfVerbose)printf("ERROR: failed to create PMCU event loop descriptors\n");
+		goto lErrorExit;
+	}
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.fd = pasync->fdTimer;
+	if ( 0 > epoll_ctl(pasync->fdEpoll, EPOLL_CTL_ADD, pasync->fdTimer, &ev) ) {
+		goto lErrorExit;
+	}
+
+	ev.data.fd = pasync->fdEvent;
+	if ( 0 > epoll_ctl(pasync->fdEpoll, EPOLL_CTL_ADD, pasync->fdEvent, &ev) ) {
+		goto lErrorExit;
+	}
+
+	pthread_mutex_init(&pasync->mtx, NULL);
+	pthread_cond_init(&pasync->cond, NULL);
+
+	if ( 0 != pthread_create(&pasync->thread, NULL, AsyncThread, pasync) ) {
+		if(dpmutilfVerbose)printf("ERROR: failed to start PMCU event loop thread\n");
+		pthread_cond_destroy(&pasync->cond);
+		pthread_mutex_destroy(&pasync->mtx);
+		goto lErrorExit;
+	}
+#endif
+
+	return fTrue;
+
+#if defined(__linux__)
+lErrorExit:
+	if ( 0 <= pasync->fdEpoll ) {
+		close(pasync->fdEpoll);
+	}
+	if ( 0 <= pasync->fdTimer ) {
+		close(pasync->fdTimer);
+	}
+	if ( 0 <= pasync->fdEvent ) {
+		close(pasync->fdEvent);
+	}
+
+	return fFalse;
+#endif
+}
+
+/* ------------------------------------------------------------ */
+/***    PmcuAsyncTerm
+**
+**  Parameters:
+**      pasync          - pointer to an initialized event loop
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function stops the event loop. Operations that are still
+**      pending complete with astPmcuAsyncCancelled and their callbacks
+**      are called before this function returns.
+*/
+void
+PmcuAsyncTerm(PmcuAsync* pasync) {
+
+#if defined(__linux__)
+	UINT64	cnt;
+
+	AsyncLock(pasync);
+	pasync->fStop = fTrue;
+	AsyncUnlock(pasync);
+
+	cnt = 1;
+	if ( sizeof(cnt) != write(pasync->fdEvent, &cnt, sizeof(cnt)) ) {
+		if(dpmutilfVerbose)printf("WARNING: failed to signal PMCU event loop\n");
+	}
+	pthread_join(pasync->thread, NULL);
+#endif
+
+	while ( NULL != pasync->popHead ) {
+		AsyncComplete(pasync, pasync->popHead, astPmcuAsyncCancelled);
+	}
+
+#if defined(__linux__)
+	close(pasync->fdEpoll);
+	close(pasync->fdTimer);
+	close(pasync->fdEvent);
+	pthread_cond_destroy(&pasync->cond);
+	pthread_mutex_destroy(&pasync->mtx);
+#endif
+}
+
+/* ------------------------------------------------------------ */
+/***    PmcuAsyncSetPlatformConfig
+**
+**  Parameters:
+**      pasync          - pointer to an initialized event loop
+**      pop             - pointer to storage for the operation
+**      setEnforce5v0 .. crcCheck - see dpmutilFSetPlatformConfig
+**      pfnDone         - completion callback, may be NULL
+**      pvContext       - value passed to the completion callback
+**
+**  Return Value:
+**      fTrue if the operation was queued, fFalse otherwise
+**
+**  Errors:
+**      Returns fFalse if no field was specified.
+**
+**  Description:
+**      This function queues a read-modify-write of the PLATFORM_CONFIG
+**      register and returns immediately. The operation completes once
+**      the PMCU has written its EEPROM and the register can be read
+**      back. Like dpmutilFSetPlatformConfig, the new configuration only
+**      takes effect after the PMCU is reset.
+*/
+BOOL
+PmcuAsyncSetPlatformConfig(PmcuAsync* pasync, PmcuAsyncOp* pop, BOOL setEnforce5v0, BOOL enforce5v0, BOOL setEnforce3v3, BOOL enforce3v3, BOOL setEnforceVio, BOOL enforceVio, BOOL setCrcCheck, BOOL crcCheck, PFNPMCUASYNCDONE pfnDone, void* pvContext) {
+
+	PmcuConfigTxn	txn;
+
+	PmcuTxnBegin(&txn);
+	if ( ! PmcuTxnStagePlatformConfig(&txn, setEnforce5v0, enforce5v0, setEnforce3v3, enforce3v3, setEnforceVio, enforceVio, setCrcCheck, crcCheck) ) {
+		return fFalse;
+	}
+
+	return FAsyncSubmitReg(pasync, pop, &txn.rgreg[0], pfnDone, pvContext);
+}
+
+/* ------------------------------------------------------------ */
+/***    PmcuAsyncSetVioConfig
+**
+**  Parameters:
+**      pasync          - pointer to an initialized event loop
+**      pop             - pointer to storage for the operation
+**      chanid .. voltage - see dpmutilFSetVioConfig
+**      pfnDone         - completion callback, may be NULL
+**      pvContext       - value passed to the completion callback
+**
+**  Return Value:
+**      fTrue if the operation was queued, fFalse otherwise
+**
+**  Errors:
+**      Returns fFalse if chanid is negative or no field was specified.
+**
+**  Description:
+**      This function queues a read-modify-write of the VADJ_n_OVERRIDE
+**      register of the specified supply and returns immediately. If the
+**      PMCU restricts the new settings in order to meet the requirements
+**      of the SmartVIO ports on the supply then the operation completes
+**      with astPmcuAsyncMismatch and fsRead holds the applied value.
+*/
+BOOL
+PmcuAsyncSetVioConfig(PmcuAsync* pasync, PmcuAsyncOp* pop, int chanid, BOOL setEnable, BOOL enable, BOOL setOverride, BOOL override, BOOL setVoltage, WORD voltage, PFNPMCUASYNCDONE pfnDone, void* pvContext) {
+
+	PmcuConfigTxn	txn;
+
+	PmcuTxnBegin(&txn);
+	if ( ! PmcuTxnStageVioConfig(&txn, chanid, setEnable, enable, setOverride, override, setVoltage, voltage) ) {
+		return fFalse;
+	}
+
+	return FAsyncSubmitReg(pasync, pop, &txn.rgreg[0], pfnDone, pvContext);
+}
+
+/* ------------------------------------------------------------ */
+/***    PmcuAsyncSetFanConfig
+**
+**  Parameters:
+**      pasync          - pointer to an initialized event loop
+**      pop             - pointer to storage for the operation
+**      fanid .. probe  - see dpmutilFSetFanConfig
+**      pfnDone         - completion callback, may be NULL
+**      pvContext       - value passed to the completion callback
+**
+**  Return Value:
+**      fTrue if the operation was queued, fFalse otherwise
+**
+**  Errors:
+**      Returns fFalse if fanid is negative or no field was specified.
+**
+**  Description:
+**      This function queues a read-modify-write of the
+**      FAN_n_CONFIGURATION register of the specified fan and returns
+**      immediately. If the PMCU restricts the new configuration to the
+**      capabilities of the fan then the operation completes with
+**      astPmcuAsyncMismatch and fsRead holds the applied value.
+*/
+BOOL
+PmcuAsyncSetFanConfig(PmcuAsync* pasync, PmcuAsyncOp* pop, int fanid, BOOL setEnable, BOOL enable, BOOL setSpeed, BYTE speed, BOOL setProbe, BYTE probe, PFNPMCUASYNCDONE pfnDone, void* pvContext) {
+
+	PmcuConfigTxn	txn;
+
+	PmcuTxnBegin(&txn);
+	if ( ! PmcuTxnStageFanConfig(&txn, fanid, setEnable, enable, setSpeed, speed, setProbe, probe) ) {
+		return fFalse;
+	}
+
+	return FAsyncSubmitReg(pasync, pop, &txn.rgreg[0], pfnDone, pvContext);
+}
+
+/* ------------------------------------------------------------ */
+/***    PmcuAsyncResetPMCU
+**
+**  Parameters:
+**      pasync          - pointer to an initialized event loop
+**      pop             - pointer to storage for the operation
+**      pfnDone         - completion callback, may be NULL
+**      pvContext       - value passed to the completion callback
+**
+**  Return Value:
+**      fTrue if the operation was queued, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function queues a software reset of the Platform MCU and
+**      returns immediately. The operation completes once the PMCU
+**      responds as an I2C slave again, at which point it's safe to use
+**      the I2C bus.
+*/
+BOOL
+PmcuAsyncResetPMCU(PmcuAsync* pasync, PmcuAsyncOp* pop, PFNPMCUASYNCDONE pfnDone, void* pvContext) {
+
+	memset(pop, 0, sizeof(PmcuAsyncOp));
+	pop->fReset = fTrue;
+	pop->regaddr = regaddrFirmwareVersion;
+	pop->cb = cbFirmwareVersion;
+	pop->msFirstPoll = msResetFirstPoll;
+	pop->msPollInterval = msResetPollInterval;
+	pop->msTimeout = msResetTimeout;
+	pop->pfnDone = pfnDone;
+	pop->pvContext = pvContext;
+
+	return FAsyncSubmit(pasync, pop);
+}
+
+/* ------------------------------------------------------------ */
+/***    PmcuAsyncStatus
+**
+**  Parameters:
+**      pop             - pointer to a queued operation
+**
+**  Return Value:
+**      state of the operation, astPmcuAsyncPending until it completes
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function returns the state of an operation without
+**      blocking. An operation is pending until its completion callback,
+**      if any, has returned. Once this function returns a state other
+**      than astPmcuAsyncPending the fields of the operation are final
+**      and the operation may be reused.
+*/
+BYTE
+PmcuAsyncStatus(PmcuAsyncOp* pop) {
+
+	if ( ! __atomic_load_n(&pop->fDone, __ATOMIC_ACQUIRE) ) {
+		return astPmcuAsyncPending;
+	}
+
+	return pop->ast;
+}
+
+#if defined(__linux__)
+/* ------------------------------------------------------------ */
+/***    PmcuAsyncWait
+**
+**  Parameters:
+**      pasync          - pointer to the event loop the operation was queued on
+**      pop             - pointer to a queued operation
+**
+**  Return Value:
+**      final state of the operation
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function blocks until the specified operation completes and
+**      its completion callback, if any, has returned. It must not be
+**      called from a completion callback.
+*/
+BYTE
+PmcuAsyncWait(PmcuAsync* pasync, PmcuAsyncOp* pop) {
+
+	AsyncLock(pasync);
+	while ( ! pop->fDone ) {
+		pthread_cond_wait(&pasync->cond, &pasync->mtx);
+	}
+	AsyncUnlock(pasync);
+
+	return pop->ast;
+}
+#else
+/* ------------------------------------------------------------ */
+/***    PmcuAsyncTick
+**
+**  Parameters:
+**      pasync          - pointer to an initialized event loop
+**      msNow           - current time in milliseconds
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function advances the pending operations whose next poll
+**      is due, one at a time in the order they were queued. Bare metal applications call it periodically, ideally
+**      at least every few milliseconds, from their main loop or a
+**      timer. An operation performs at most one short I2C transfer
+**      sequence per tick.
+*/
+void
+PmcuAsyncTick(PmcuAsync* pasync, UINT64 msNow) {
+
+	AsyncProcess(pasync, msNow);
+}
+#endif
+
+/* ------------------------------------------------------------ */
+/***    FAsyncSubmitReg
+**
+**  Parameters:
+**      pasync          - pointer to an initialized event loop
+**      pop             - pointer to storage for the operation
+**      ptreg           - pointer to the staged register to modify
+**      pfnDone         - completion callback, may be NULL
+**      pvContext       - value passed to the completion callback
+**
+**  Return Value:
+**      fTrue if the operation was queued, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function queues a read-modify-write of a configuration
+**      register staged with one of the PmcuTxnStage functions.
+*/
+static BOOL
+FAsyncSubmitReg(PmcuAsync* pasync, PmcuAsyncOp* pop, const PmcuTxnReg* ptreg, PFNPMCUASYNCDONE pfnDone, void* pvContext) {
+
+	memset(pop, 0, sizeof(PmcuAsyncOp));
+	pop->regaddrCount = ptreg->regaddrCount;
+	pop->iinst = ptreg->iinst;
+	pop->regaddr = ptreg->regaddr;
+	pop->cb = ptreg->cb;
+	pop->fsMask = ptreg->fsMask;
+	pop->fsBits = ptreg->fsBits;
+	pop->msFirstPoll = msEepromFirstPoll;
+	pop->msPollInterval = msEepromPollInterval;
+	pop->msTimeout = msEepromTimeout;
+	pop->pfnDone = pfnDone;
+	pop->pvContext = pvContext;
+
+	return FAsyncSubmit(pasync, pop);
+}
+
+/* ------------------------------------------------------------ */
+/***    FAsyncSubmit
+**
+**  Parameters:
+**      pasync          - pointer to an initialized event loop
+**      pop             - pointer to a prepared operation
+**
+**  Return Value:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function appends the operation to the pending list. The
+**      first phase of the operation is due immediately.
+*/
+static BOOL
+FAsyncSubmit(PmcuAsync* pasync, PmcuAsyncOp* pop) {
+
+#if defined(__linux__)
+	UINT64	cnt;
+	BOOL	fStop;
+#endif
+
+	pop->ast = astPmcuAsyncPending;
+	pop->fDone = fFalse;
+	pop->phase = phaseWrite;
+	pop->fBusLocked = fFalse;
+	pop->msNext = 0;
+	pop->popNext = NULL;
+
+	AsyncLock(pasync);
+#if defined(__linux__)
+	fStop = pasync->fStop;
+	if ( fStop ) {
+		AsyncUnlock(pasync);
+		return fFalse;
+	}
+#endif
+	if ( NULL == pasync->popTail ) {
+		pasync->popHead = pop;
+	}
+	else {
+		pasync->popTail->popNext = pop;
+	}
+	pasync->popTail = pop;
+	AsyncUnlock(pasync);
+
+#if defined(__linux__)
+	cnt = 1;
+	if ( sizeof(cnt) != write(pasync->fdEvent, &cnt, sizeof(cnt)) ) {
+		if(dpmutilfVerbose)printf("WARNING: failed to signal PMCU event loop\n");
+	}
+#endif
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    AsyncProcess
+**
+**  Parameters:
+**      pasync          - pointer to an initialized event loop
+**      msNow           - current time in milliseconds
+**
+**  Return Value:
+**      time at which the next pending operation is due, zero if no
+**      operations are pending
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function advances the operation at the head of the pending
+**      list if it's due. Operations are performed one at a time in the
+**      order they were queued, since the PMCU doesn't accept a write
+**      while it's still busy with the previous one. An operation that
+**      completes is followed immediately by the next one. The list lock
+**      isn't held while an operation performs I2C transfers, which is
+**      safe because operations are only removed from the list by this
+**      function and only appended by FAsyncSubmit.
+*/
+static UINT64
+AsyncProcess(PmcuAsync* pasync, UINT64 msNow) {
+
+	PmcuAsyncOp*	pop;
+	BYTE			ast;
+
+	while ( fTrue ) {
+		AsyncLock(pasync);
+		pop = pasync->popHead;
+		AsyncUnlock(pasync);
+
+		if ( NULL == pop ) {
+			return 0;
+		}
+
+		if ( pop->msNext > msNow ) {
+			return pop->msNext;
+		}
+
+		ast = AsyncStep(pasync, pop, msNow);
+		if ( astPmcuAsyncPending == ast ) {
+			return pop->msNext;
+		}
+
+		AsyncComplete(pasync, pop, ast);
+	}
+}
+
+/* ------------------------------------------------------------ */
+/***    AsyncStep
+**
+**  Parameters:
+**      pasync          - pointer to an initialized event loop
+**      pop             - pointer to an operation that is due
+**      msNow           - current time in milliseconds
+**
+**  Return Value:
+**      astPmcuAsyncPending if the operation must be stepped again at
+**      pop->msNext, otherwise the final state of the operation
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function performs the current phase of an operation.
+*/
+static BYTE
+AsyncStep(PmcuAsync* pasync, PmcuAsyncOp* pop, UINT64 msNow) {
+
+	int		fdI2c;
+	BYTE	cinst;
+	WORD	fs;
+	BYTE	bTemp;
+
+	fdI2c = pasync->fdI2cDev;
+
+	if ( phaseWrite == pop->phase ) {
+		if ( ! I2CHALLock(fdI2c) ) {
+			return astPmcuAsyncFailed;
+		}
+
+		if ( pop->fReset ) {
+			bTemp = 1;
+			if ( ! PmcuI2cWrite(fdI2c, regaddrSoftwareReset, &bTemp, 1, NULL) ) {
+				I2CHALUnlock(fdI2c);
+				if(dpmutilfVerbose)printf("ERROR: failed to write SOFTWARE_RESET register\n");
+				return astPmcuAsyncFailed;
+			}
+		}
+		else {
+			/* Make sure the supply or fan exists.
+			*/
+			if ( 0 != pop->regaddrCount ) {
+				if (( ! PmcuI2cRead(fdI2c, pop->regaddrCount, &cinst, 1, NULL) ) ||
+					( pop->iinst >= cinst )) {
+					I2CHALUnlock(fdI2c);
+					if(dpmutilfVerbose)printf("ERROR: instance %d is not supported by this device\n", pop->iinst);
+					return astPmcuAsyncFailed;
+				}
+			}
+
+			fs = 0;
+			if ( ! PmcuI2cRead(fdI2c, pop->regaddr, (BYTE*)&fs, pop->cb, NULL) ) {
+				I2CHALUnlock(fdI2c);
+				if(dpmutilfVerbose)printf("ERROR: failed to read register 0x%04X\n", pop->regaddr);
+				return astPmcuAsyncFailed;
+			}
+
+			pop->fsWritten = (fs & ~pop->fsMask) | (pop->fsBits & pop->fsMask);
+			if ( ! PmcuI2cWrite(fdI2c, pop->regaddr, (BYTE*)&pop->fsWritten, pop->cb, NULL) ) {
+				I2CHALUnlock(fdI2c);
+				if(dpmutilfVerbose)printf("ERROR: failed to write register 0x%04X\n", pop->regaddr);
+				return astPmcuAsyncFailed;
+			}
+		}
+
+		/* The PMCU is an I2C master until it's done enumerating the
+		** ports, so the bus lock is held after a reset until the
+		** operation completes, like dpmutilFResetPMCU does.
+		*/
+		if ( pop->fReset ) {
+			pop->fBusLocked = fTrue;
+		}
+		else {
+			I2CHALUnlock(fdI2c);
+		}
+
+		pop->phase = phasePoll;
+		pop->msStart = msNow;
+		pop->msNext = msNow + pop->msFirstPoll;
+
+		return astPmcuAsyncPending;
+	}
+
+	/* The PMCU doesn't respond while it's busy, so the first successful
+	** read of the register indicates that it's ready again.
+	*/
+	fs = 0;
+	if ( ! PmcuI2cRead(fdI2c, pop->regaddr, (BYTE*)&fs, pop->cb, NULL) ) {
+		if ( msNow - pop->msStart >= pop->msTimeout ) {
+			return astPmcuAsyncTimeout;
+		}
+		pop->msNext = msNow + pop->msPollInterval;
+		return astPmcuAsyncPending;
+	}
+
+	pop->fsRead = fs;
+	if (( ! pop->fReset ) && ( pop->fsRead != pop->fsWritten )) {
+		return astPmcuAsyncMismatch;
+	}
+
+	return astPmcuAsyncDone;
+}
+
+/* ------------------------------------------------------------ */
+/***    AsyncComplete
+**
+**  Parameters:
+**      pasync          - pointer to an initialized event loop
+**      pop             - pointer to the operation that completed
+**      ast             - final state of the operation
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function removes the operation from the pending list, sets
+**      its final state and calls its completion callback. Only once the
+**      callback has returned is the operation marked as done and any
+**      thread waiting on it woken, so that the operation isn't reused
+**      while the callback is still accessing it.
+*/
+static void
+AsyncComplete(PmcuAsync* pasync, PmcuAsyncOp* pop, BYTE ast) {
+
+	PmcuAsyncOp*	popPrev;
+	PFNPMCUASYNCDONE	pfnDone;
+	void*			pvContext;
+
+	if ( pop->fBusLocked ) {
+		I2CHALUnlock(pasync->fdI2cDev);
+		pop->fBusLocked = fFalse;
+	}
+
+	AsyncLock(pasync);
+
+	if ( pasync->popHead == pop ) {
+		pasync->popHead = pop->popNext;
+		popPrev = NULL;
+	}
+	else {
+		popPrev = pasync->popHead;
+		while ( popPrev->popNext != pop ) {
+			popPrev = popPrev->popNext;
+		}
+		popPrev->popNext = pop->popNext;
+	}
+	if ( pasync->popTail == pop ) {
+		pasync->popTail = popPrev;
+	}
+
+	pfnDone = pop->pfnDone;
+	pvContext = pop->pvContext;
+	pop->ast = ast;
+	AsyncUnlock(pasync);
+
+	if ( NULL != pfnDone ) {
+		pfnDone(pop, pvContext);
+	}
+
+	AsyncLock(pasync);
+	__atomic_store_n(&pop->fDone, fTrue, __ATOMIC_RELEASE);
+#if defined(__linux__)
+	pthread_cond_broadcast(&pasync->cond);
+#endif
+	AsyncUnlock(pasync);
+}
+
+#if defined(__linux__)
+/* ------------------------------------------------------------ */
+/***    AsyncThread
+**
+**  Parameters:
+**      pvAsync         - pointer to the event loop
+**
+**  Return Value:
+**      NULL
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      Event loop thread. The thread sleeps in epoll_wait until either
+**      an operation is queued or the timer expires, advances the
+**      operations that are due, and then arms the timer for the
+**      earliest operation that is still pending.
+*/
+static void*
+AsyncThread(void* pvAsync) {
+
+	PmcuAsync*			pasync;
+	PmcuAsyncOp*		pop;
+	struct epoll_event	rgev[2];
+	struct itimerspec	its;
+	UINT64				cnt;
+	UINT64				msNext;
+	UINT64				msNow;
+	BOOL				fStop;
+	int					cev;
+	int					iev;
+
+	pasync = (PmcuAsync*)pvAsync;
+	dpmutilfVerbose = pasync->fVerbose;
+
+	while ( fTrue ) {
+		cev = epoll_wait(pasync->fdEpoll, rgev, 2, -1);
+		for ( iev = 0; iev < cev; iev++ ) {
+			/* Both descriptors are non-blocking and only need to be
+			** drained, the count they return isn't used.
+			*/
+			if ( sizeof(cnt) != read(rgev[iev].data.fd, &cnt, sizeof(cnt)) ) {
+				continue;
+			}
+		}
+
+		AsyncLock(pasync);
+		fStop = pasync->fStop;
+		pop = pasync->popHead;
+		AsyncUnlock(pasync);
+		if ( fStop ) {
+			/* The bus lock was taken by this thread, so it must also be
+			** released by this thread rather than when PmcuAsyncTerm
+			** cancels the operation.
+			*/
+			if (( NULL != pop ) && ( pop->fBusLocked )) {
+				I2CHALUnlock(pasync->fdI2cDev);
+				pop->fBusLocked = fFalse;
+			}
+			break;
+		}
+
+		msNow = MsMonotonic();
+		msNext = AsyncProcess(pasync, msNow);
+
+		/* Operations that were queued while we were processing signal the
+		** eventfd, so it's fine if msNext doesn't account for them.
+		*/
+		memset(&its, 0, sizeof(its));
+		if ( 0 != msNext ) {
+			if ( msNext <= msNow ) {
+				msNext = msNow + 1;
+			}
+			its.it_value.tv_sec = msNext / 1000;
+			its.it_value.tv_nsec = (msNext % 1000) * 1000000;
+		}
+		timerfd_settime(pasync->fdTimer, TFD_TIMER_ABSTIME, &its, NULL);
+	}
+
+	return NULL;
+}
+
+/* ------------------------------------------------------------ */
+/***    MsMonotonic
+**
+**  Parameters:
+**      none
+**
+**  Return Value:
+**      current value of CLOCK_MONOTONIC in milliseconds
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function returns the time base used by the event loop.
+**      The timerfd uses the same clock.
+*/
+static UINT64
+MsMonotonic() {
+
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((UINT64)ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
+}
+#endif
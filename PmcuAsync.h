@@ -0,0 +1,132 @@
+/************************************************************************/
+/*                                                                      */
+/*  PmcuAsync.h - asynchronous Platform MCU operation declarations      */
+/*                                                                      */
+/************************************************************************/
+/*  Author: Digilent Inc.                                               */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  This header file contains the declarations for functions that can   */
+/*  be used to perform the Platform MCU operations that require waiting */
+/*  for the PMCU to become ready again, such as writing a configuration */
+/*  register that is stored in EEPROM or resetting the PMCU, without    */
+/*  blocking the caller. Operations are queued on an event loop and     */
+/*  completion is reported through a callback, or by polling or         */
+/*  waiting on the operation.                                           */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*  10/14/2026: created                                                 */
+/*  10/14/2026: added fBusLocked                                        */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef PMCUASYNC_H_
+#define PMCUASYNC_H_
+
+#include "../dpmutil/I2CHAL.h"
+#include "../dpmutil/PlatformMCU.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#endif
+
+/* ------------------------------------------------------------ */
+/*                  Miscellaneous Declarations                  */
+/* ------------------------------------------------------------ */
+
+/* Define the states of an asynchronous operation.
+*/
+#define astPmcuAsyncPending		0	// queued or in progress
+#define astPmcuAsyncDone		1	// completed and the register reads back as written
+#define astPmcuAsyncMismatch	2	// completed but the PMCU restricted the new value
+#define astPmcuAsyncFailed		3	// invalid parameter or I2C failure
+#define astPmcuAsyncTimeout		4	// the PMCU didn't become ready in time
+#define astPmcuAsyncCancelled	5	// the event loop was terminated first
+
+/* ------------------------------------------------------------ */
+/*                  General Type Declarations                   */
+/* ------------------------------------------------------------ */
+
+typedef struct PmcuAsyncOp PmcuAsyncOp;
+
+/* Completion callback. On Linux it's called from the event loop thread
+** and on bare metal from PmcuAsyncTick. The final state is in the ast
+** field of the operation, since PmcuAsyncStatus reports the operation as
+** pending until the callback returns. The callback must not reuse or
+** free the operation, which may be done once PmcuAsyncWait returns or
+** PmcuAsyncStatus reports that it completed.
+*/
+typedef void (*PFNPMCUASYNCDONE)(PmcuAsyncOp* pop, void* pvContext);
+
+/* An asynchronous operation. The storage is owned by the caller and must
+** remain valid until the operation completes. None of the fields should
+** be modified while the operation is pending.
+*/
+struct PmcuAsyncOp {
+	BYTE				ast;			// state, final once the callback is called
+	BOOL				fDone;			// the callback has returned, see PmcuAsyncStatus
+	BYTE				phase;
+	BOOL				fReset;
+	BOOL				fBusLocked;		// the bus lock is held until the operation completes
+	WORD				regaddrCount;	// count register used to validate iinst, 0 if none
+	BYTE				iinst;
+	WORD				regaddr;
+	BYTE				cb;
+	WORD				fsMask;			// bits of the register to modify
+	WORD				fsBits;			// new value of the bits in fsMask
+	WORD				fsWritten;		// value written to the register
+	WORD				fsRead;			// value read back once the PMCU was ready
+	UINT32				msFirstPoll;
+	UINT32				msPollInterval;
+	UINT32				msTimeout;
+	UINT64				msStart;
+	UINT64				msNext;
+	PFNPMCUASYNCDONE	pfnDone;
+	void*				pvContext;
+	PmcuAsyncOp*		popNext;
+};
+
+typedef struct {
+	int					fdI2cDev;
+	PmcuAsyncOp*		popHead;
+	PmcuAsyncOp*		popTail;
+#if defined(__linux__)
+	pthread_t			thread;
+	pthread_mutex_t		mtx;
+	pthread_cond_t		cond;
+	int					fdEpoll;
+	int					fdTimer;
+	int					fdEvent;
+	BOOL				fStop;
+	BOOL				fVerbose;		// dpmutilfVerbose of the thread that started the loop
+#endif
+} PmcuAsync;
+
+/* ------------------------------------------------------------ */
+/*                  Variable Declarations                       */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*                  Procedure Declarations                      */
+/* ------------------------------------------------------------ */
+
+BOOL	PmcuAsyncInit(PmcuAsync* pasync, int fdI2cDev);
+void	PmcuAsyncTerm(PmcuAsync* pasync);
+BOOL	PmcuAsyncSetPlatformConfig(PmcuAsync* pasync, PmcuAsyncOp* pop, BOOL setEnforce5v0, BOOL enforce5v0, BOOL setEnforce3v3, BOOL enforce3v3, BOOL setEnforceVio, BOOL enforceVio, BOOL setCrcCheck, BOOL crcCheck, PFNPMCUASYNCDONE pfnDone, void* pvContext);
+BOOL	PmcuAsyncSetVioConfig(PmcuAsync* pasync, PmcuAsyncOp* pop, int chanid, BOOL setEnable, BOOL enable, BOOL setOverride, BOOL override, BOOL setVoltage, WORD voltage, PFNPMCUASYNCDONE pfnDone, void* pvContext);
+BOOL	PmcuAsyncSetFanConfig(PmcuAsync* pasync, PmcuAsyncOp* pop, int fanid, BOOL setEnable, BOOL enable, BOOL setSpeed, BYTE speed, BOOL setProbe, BYTE probe, PFNPMCUASYNCDONE pfnDone, void* pvContext);
+BOOL	PmcuAsyncResetPMCU(PmcuAsync* pasync, PmcuAsyncOp* pop, PFNPMCUASYNCDONE pfnDone, void* pvContext);
+BYTE	PmcuAsyncStatus(PmcuAsyncOp* pop);
+#if defined(__linux__)
+BYTE	PmcuAsyncWait(PmcuAsync* pasync, PmcuAsyncOp* pop);
+#else
+void	PmcuAsyncTick(PmcuAsync* pasync, UINT64 msNow);
+#endif
+
+/* ------------------------------------------------------------ */
+
+#endif /* PMCUASYNC_H_ */
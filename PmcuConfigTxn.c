@@ -0,0 +1,472 @@
+/************************************************************************/
+/*                                                                      */
+/*  PmcuConfigTxn.c - Platform MCU configuration transaction            */
+/*                    implementation                                    */
+/*                                                                      */
+/************************************************************************/
+/*  Author: Digilent Inc.                                               */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  This source file contains the implementation of functions that can  */
+/*  be used to stage changes to several Platform MCU configuration      */
+/*  registers and commit them together.                                 */
+/*                                                                      */
+/*  A commit reads the current value of every staged register in one    */
+/*  batch, merges the staged fields, and writes only the registers      */
+/*  whose value changes. The PMCU doesn't respond while it writes its   */
+/*  EEPROM, so each register is written in its own transaction, ended  */
+/*  by a stop, and the PMCU is waited on before the next one. Every     */
+/*  register is then read back in one batch to verify the new           */
+/*  configuration.                                                      */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*  10/14/2026: created                                                 */
+/*  10/14/2026: each changed register is written and settled on its own */
+/*                                                                      */
+/************************************************************************/
+
+/* ------------------------------------------------------------ */
+/*              Include File Definitions                        */
+/* ------------------------------------------------------------ */
+
+#include <stdio.h>
+#include <string.h>
+#include "stdtypes.h"
+#include "I2CHAL.h"
+#include "PlatformMCU.h"
+#include "PmcuConfigTxn.h"
+
+/* ------------------------------------------------------------ */
+/*              Miscellaneous Declarations                      */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*              Local Type Definitions                          */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*              Global Variables                                */
+/* ------------------------------------------------------------ */
+
+extern I2CHALThreadLocal BOOL	dpmutilfVerbose;
+
+/* ------------------------------------------------------------ */
+/*              Local Variables                                 */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*              Forward Declarations                            */
+/* ------------------------------------------------------------ */
+
+static PmcuTxnReg*	PtxnregStage(PmcuConfigTxn* ptxn, WORD regaddr, BYTE cb, WORD regaddrCount, BYTE iinst);
+
+/* ------------------------------------------------------------ */
+/*              Procedure Definitions                           */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/***    PmcuTxnBegin
+**
+**  Parameters:
+**      ptxn            - pointer to the transaction to initialize
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function initializes an empty configuration transaction.
+*/
+void
+PmcuTxnBegin(PmcuConfigTxn* ptxn) {
+
+	memset(ptxn, 0, sizeof(PmcuConfigTxn));
+}
+
+/* ------------------------------------------------------------ */
+/***    PmcuTxnStagePlatformConfig
+**
+**  Parameters:
+**      ptxn            - pointer to the transaction
+**      setEnforce5v0 .. crcCheck - see dpmutilFSetPlatformConfig
+**
+**  Return Value:
+**      fTrue if the change was staged, fFalse otherwise
+**
+**  Errors:
+**      Returns fFalse if no field was specified.
+**
+**  Description:
+**      This function stages a change to the fields of the
+**      PLATFORM_CONFIG register. Fields that aren't specified keep the
+**      value they have when the transaction is committed. Like
+**      dpmutilFSetPlatformConfig, the new configuration only takes
+**      effect after the PMCU is reset.
+*/
+BOOL
+PmcuTxnStagePlatformConfig(PmcuConfigTxn* ptxn, BOOL setEnforce5v0, BOOL enforce5v0, BOOL setEnforce3v3, BOOL enforce3v3, BOOL setEnforceVio, BOOL enforceVio, BOOL setCrcCheck, BOOL crcCheck) {
+
+	PmcuTxnReg*		ptreg;
+	PLATFORM_CONFIG	platcfgMask;
+	PLATFORM_CONFIG	platcfgBits;
+
+	if (( ! setEnforce5v0 ) && ( ! setEnforce3v3 ) && ( ! setEnforceVio ) && ( ! setCrcCheck )) {
+		return fFalse;
+	}
+
+	platcfgMask.fsConfig = 0;
+	platcfgBits.fsConfig = 0;
+	if ( setEnforce5v0 ) {
+		platcfgMask.fEnforce5v0CurLimit = 1;
+		platcfgBits.fEnforce5v0CurLimit = ( enforce5v0 ) ? 1 : 0;
+	}
+	if ( setEnforce3v3 ) {
+		platcfgMask.fEnforce3v3CurLimit = 1;
+		platcfgBits.fEnforce3v3CurLimit = ( enforce3v3 ) ? 1 : 0;
+	}
+	if ( setEnforceVio ) {
+		platcfgMask.fEnforceVioCurLimit = 1;
+		platcfgBits.fEnforceVioCurLimit = ( enforceVio ) ? 1 : 0;
+	}
+	if ( setCrcCheck ) {
+		platcfgMask.fPerformCrcCheck = 1;
+		platcfgBits.fPerformCrcCheck = ( crcCheck ) ? 1 : 0;
+	}
+
+	ptreg = PtxnregStage(ptxn, regaddrPlatformConfig, cbPlatformConfig, 0, 0);
+	if ( NULL == ptreg ) {
+		return fFalse;
+	}
+
+	ptreg->fsMask |= platcfgMask.fsConfig;
+	ptreg->fsBits = (ptreg->fsBits & ~platcfgMask.fsConfig) | platcfgBits.fsConfig;
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    PmcuTxnStageVioConfig
+**
+**  Parameters:
+**      ptxn            - pointer to the transaction
+**      chanid .. voltage - see dpmutilFSetVioConfig
+**
+**  Return Value:
+**      fTrue if the change was staged, fFalse otherwise
+**
+**  Errors:
+**      Returns fFalse if chanid is out of range or no field was
+**      specified.
+**
+**  Description:
+**      This function stages a change to the fields of the
+**      VADJ_n_OVERRIDE register of the specified supply. The voltage is
+**      applied through the VOLTAGE_TO_SET field of the override
+**      register, the VADJ_n_VOLTAGE register itself is read only.
+**      Whether the supply exists is checked when the transaction is
+**      committed.
+*/
+BOOL
+PmcuTxnStageVioConfig(PmcuConfigTxn* ptxn, int chanid, BOOL setEnable, BOOL enable, BOOL setOverride, BOOL override, BOOL setVoltage, WORD voltage) {
+
+	PmcuTxnReg*		ptreg;
+	VADJ_OVERRIDE	vadjowMask;
+	VADJ_OVERRIDE	vadjowBits;
+
+	if (( 0 > chanid ) || ( cPmcuVadjGroupMax <= chanid ) ||
+		(( ! setEnable ) && ( ! setOverride ) && ( ! setVoltage ))) {
+		return fFalse;
+	}
+
+	vadjowMask.fs = 0;
+	vadjowBits.fs = 0;
+	if ( setVoltage ) {
+		vadjowMask.vltgSet = 0x3FF;
+		vadjowBits.vltgSet = voltage / 10;
+	}
+	if ( setEnable ) {
+		vadjowMask.fEnable = 1;
+		vadjowBits.fEnable = enable ? 1 : 0;
+	}
+	if ( setOverride ) {
+		vadjowMask.fOverride = 1;
+		vadjowBits.fOverride = override ? 1 : 0;
+	}
+
+	ptreg = PtxnregStage(ptxn, regaddrVadjAOverride + (offsetVadjReg * chanid), sizeof(VADJ_OVERRIDE), regaddrVadjGroupCount, (BYTE)chanid);
+	if ( NULL == ptreg ) {
+		return fFalse;
+	}
+
+	ptreg->fsMask |= vadjowMask.fs;
+	ptreg->fsBits = (ptreg->fsBits & ~vadjowMask.fs) | vadjowBits.fs;
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    PmcuTxnStageFanConfig
+**
+**  Parameters:
+**      ptxn            - pointer to the transaction
+**      fanid .. probe  - see dpmutilFSetFanConfig
+**
+**  Return Value:
+**      fTrue if the change was staged, fFalse otherwise
+**
+**  Errors:
+**      Returns fFalse if fanid is out of range or no field was
+**      specified.
+**
+**  Description:
+**      This function stages a change to the fields of the
+**      FAN_n_CONFIGURATION register of the specified fan. Whether the
+**      fan exists is checked when the transaction is committed.
+*/
+BOOL
+PmcuTxnStageFanConfig(PmcuConfigTxn* ptxn, int fanid, BOOL setEnable, BOOL enable, BOOL setSpeed, BYTE speed, BOOL setProbe, BYTE probe) {
+
+	PmcuTxnReg*			ptreg;
+	FAN_CONFIGURATION	fcfgMask;
+	FAN_CONFIGURATION	fcfgBits;
+
+	if (( 0 > fanid ) || ( cPmcuFanMax <= fanid ) ||
+		(( ! setEnable ) && ( ! setSpeed ) && ( ! setProbe ))) {
+		return fFalse;
+	}
+
+	fcfgMask.fs = 0;
+	fcfgBits.fs = 0;
+	if ( setEnable ) {
+		fcfgMask.fEnable = 1;
+		fcfgBits.fEnable = enable ? 1 : 0;
+	}
+	if ( setSpeed ) {
+		fcfgMask.fspeed = 0x3;
+		fcfgBits.fspeed = speed;
+	}
+	if ( setProbe ) {
+		fcfgMask.tempsrc = 0x7;
+		fcfgBits.tempsrc = probe;
+	}
+
+	ptreg = PtxnregStage(ptxn, regaddrFan1Config + (offsetFanReg * fanid), sizeof(FAN_CONFIGURATION), regaddrFanCount, (BYTE)fanid);
+	if ( NULL == ptreg ) {
+		return fFalse;
+	}
+
+	ptreg->fsMask |= fcfgMask.fs;
+	ptreg->fsBits = (ptreg->fsBits & ~fcfgMask.fs) | fcfgBits.fs;
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    PmcuTxnCommit
+**
+**  Parameters:
+**      fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      ptxn            - pointer to the transaction to commit
+**
+**  Return Value:
+**      fTrue if every register reads back as written, fFalse otherwise
+**
+**  Errors:
+**      Returns fFalse if a staged supply or fan doesn't exist, if an I2C
+**      transfer fails, or if the PMCU restricted one or more of the new
+**      values, in which case fMismatch is set for those registers.
+**
+**  Description:
+**      This function commits the staged changes. The bus lock is held
+**      for the entire commit so that no other thread can modify the
+**      registers in between the read and the write.
+**
+**      Each changed register is written with its own transaction and
+**      the PMCU is waited on while it writes its EEPROM before the next
+**      register is written, as the dpmutilFSet functions do. Registers
+**      whose value doesn't change aren't written, so a commit never
+**      waits more often than the equivalent sequence of dpmutilFSet
+**      calls, and the reads before and after the writes are batched.
+*/
+BOOL
+PmcuTxnCommit(int fdI2cDev, PmcuConfigTxn* ptxn) {
+
+	I2cBatch		batch;
+	PmcuTxnReg*		ptreg;
+	BYTE			rgbCount[regaddrVadjGroupCount - regaddrFanCount + 1];
+	BYTE			ireg;
+	BOOL			fCount;
+	BOOL			fMismatch;
+
+	ptxn->cwrite = 0;
+	ptxn->csettle = 0;
+
+	if ( 0 == ptxn->creg ) {
+		return fTrue;
+	}
+
+	if ( ! I2CHALLock(fdI2cDev) ) {
+		return fFalse;
+	}
+
+	/* Read the FAN_COUNT through VADJ_GROUP_COUNT registers if any
+	** supply or fan is modified, and make sure that it exists.
+	*/
+	fCount = fFalse;
+	for ( ireg = 0; ireg < ptxn->creg; ireg++ ) {
+		if ( 0 != ptxn->rgreg[ireg].regaddrCount ) {
+			fCount = fTrue;
+		}
+	}
+
+	if ( fCount ) {
+		if ( ! PmcuI2cRead(fdI2cDev, regaddrFanCount, rgbCount, sizeof(rgbCount), NULL) ) {
+			if(dpmutilfVerbose)printf("ERROR: failed to read FAN_COUNT and VADJ_GROUP_COUNT registers\n");
+			goto lErrorExit;
+		}
+
+		for ( ireg = 0; ireg < ptxn->creg; ireg++ ) {
+			ptreg = &ptxn->rgreg[ireg];
+			if (( 0 != ptreg->regaddrCount ) &&
+				( ptreg->iinst >= rgbCount[ptreg->regaddrCount - regaddrFanCount] )) {
+				if(dpmutilfVerbose){
+					printf("ERROR: device has %d %s. %s %d is not supported by this device\n",
+						rgbCount[ptreg->regaddrCount - regaddrFanCount],
+						( regaddrFanCount == ptreg->regaddrCount ) ? "fans" : "VIO supplies",
+						( regaddrFanCount == ptreg->regaddrCount ) ? "Fan" : "Channel",
+						ptreg->iinst);
+				}
+				goto lErrorExit;
+			}
+		}
+	}
+
+	/* Read the current value of every staged register.
+	*/
+	I2CHALBatchBegin(&batch, fdI2cDev);
+	for ( ireg = 0; ireg < ptxn->creg; ireg++ ) {
+		ptreg = &ptxn->rgreg[ireg];
+		ptreg->fsOld = 0;
+		PmcuBatchAddRead(&batch, ptreg->regaddr, (BYTE*)&ptreg->fsOld, ptreg->cb);
+	}
+	if ( ! I2CHALBatchSubmit(&batch) ) {
+		if(dpmutilfVerbose)printf("ERROR: failed to read configuration registers\n");
+		goto lErrorExit;
+	}
+
+	/* Merge the staged fields and write each register whose value
+	** changes, waiting for the PMCU to write its EEPROM after each one.
+	*/
+	for ( ireg = 0; ireg < ptxn->creg; ireg++ ) {
+		ptreg = &ptxn->rgreg[ireg];
+		ptreg->fsWritten = (ptreg->fsOld & ~ptreg->fsMask) | (ptreg->fsBits & ptreg->fsMask);
+		ptreg->fMismatch = fFalse;
+		if ( ptreg->fsWritten == ptreg->fsOld ) {
+			continue;
+		}
+
+		ptxn->cwrite++;
+		if ( ! PmcuI2cWrite(fdI2cDev, ptreg->regaddr, (BYTE*)&ptreg->fsWritten, ptreg->cb, NULL) ) {
+			if(dpmutilfVerbose)printf("ERROR: failed to write register 0x%04X\n", ptreg->regaddr);
+			goto lErrorExit;
+		}
+
+		ptxn->csettle++;
+		if ( ! PmcuWaitReady(fdI2cDev, msPmcuEepromFirstPoll, msPmcuEepromWriteTimeout) ) {
+			if(dpmutilfVerbose)printf("ERROR: timed out waiting for Platform MCU to write EEPROM\n");
+			goto lErrorExit;
+		}
+	}
+
+	/* Read back every staged register to verify the new configuration.
+	*/
+	I2CHALBatchBegin(&batch, fdI2cDev);
+	for ( ireg = 0; ireg < ptxn->creg; ireg++ ) {
+		ptreg = &ptxn->rgreg[ireg];
+		ptreg->fsRead = 0;
+		PmcuBatchAddRead(&batch, ptreg->regaddr, (BYTE*)&ptreg->fsRead, ptreg->cb);
+	}
+	if ( ! I2CHALBatchSubmit(&batch) ) {
+		if(dpmutilfVerbose)printf("ERROR: failed to read back configuration registers\n");
+		goto lErrorExit;
+	}
+
+	I2CHALUnlock(fdI2cDev);
+
+	fMismatch = fFalse;
+	for ( ireg = 0; ireg < ptxn->creg; ireg++ ) {
+		ptreg = &ptxn->rgreg[ireg];
+		if ( ptreg->fsRead != ptreg->fsWritten ) {
+			ptreg->fMismatch = fTrue;
+			fMismatch = fTrue;
+			if(dpmutilfVerbose){
+				printf("ERROR: register 0x%04X reads back as 0x%04X, expected 0x%04X\n",
+					ptreg->regaddr, ptreg->fsRead, ptreg->fsWritten);
+			}
+		}
+	}
+
+	return ( ! fMismatch );
+
+lErrorExit:
+	I2CHALUnlock(fdI2cDev);
+
+	return fFalse;
+}
+
+/* ------------------------------------------------------------ */
+/***    PtxnregStage
+**
+**  Parameters:
+**      ptxn            - pointer to the transaction
+**      regaddr         - address of the register
+**      cb              - size of the register
+**      regaddrCount    - count register used to validate iinst, 0 if none
+**      iinst           - index of the supply or fan
+**
+**  Return Value:
+**      pointer to the staged register, NULL if the transaction is full
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function returns the entry for the specified register,
+**      inserting a new entry with no fields to modify if the register
+**      hasn't been staged yet. Entries are kept sorted by address.
+*/
+static PmcuTxnReg*
+PtxnregStage(PmcuConfigTxn* ptxn, WORD regaddr, BYTE cb, WORD regaddrCount, BYTE iinst) {
+
+	BYTE	ireg;
+
+	for ( ireg = 0; ireg < ptxn->creg; ireg++ ) {
+		if ( regaddr == ptxn->rgreg[ireg].regaddr ) {
+			return &ptxn->rgreg[ireg];
+		}
+		if ( regaddr < ptxn->rgreg[ireg].regaddr ) {
+			break;
+		}
+	}
+
+	if ( cPmcuTxnRegMax <= ptxn->creg ) {
+		return NULL;
+	}
+
+	memmove(&ptxn->rgreg[ireg+1], &ptxn->rgreg[ireg], (ptxn->creg - ireg) * sizeof(PmcuTxnReg));
+	ptxn->creg++;
+
+	memset(&ptxn->rgreg[ireg], 0, sizeof(PmcuTxnReg));
+	ptxn->rgreg[ireg].regaddr = regaddr;
+	ptxn->rgreg[ireg].cb = cb;
+	ptxn->rgreg[ireg].regaddrCount = regaddrCount;
+	ptxn->rgreg[ireg].iinst = iinst;
+
+	return &ptxn->rgreg[ireg];
+}
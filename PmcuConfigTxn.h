@@ -0,0 +1,90 @@
+/************************************************************************/
+/*                                                                      */
+/*  PmcuConfigTxn.h - Platform MCU configuration transaction            */
+/*                    declarations                                      */
+/*                                                                      */
+/************************************************************************/
+/*  Author: Digilent Inc.                                               */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  This header file contains the declarations for functions that can   */
+/*  be used to change several Platform MCU configuration registers at   */
+/*  once. Changes to the PLATFORM_CONFIG, VADJ_n_OVERRIDE and           */
+/*  FAN_n_CONFIGURATION registers are staged in a transaction and then  */
+/*  committed together. Only the registers whose value changes are      */
+/*  written, and each of them still costs its own EEPROM write time,    */
+/*  since the registers aren't adjacent and the PMCU can't be written   */
+/*  while it's busy.                                                    */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*  10/14/2026: created                                                 */
+/*  10/14/2026: description no longer claims a single pass              */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef PMCUCONFIGTXN_H_
+#define PMCUCONFIGTXN_H_
+
+#include "../dpmutil/I2CHAL.h"
+#include "../dpmutil/PlatformMCU.h"
+
+/* ------------------------------------------------------------ */
+/*                  Miscellaneous Declarations                  */
+/* ------------------------------------------------------------ */
+
+/* Define the maximum number of registers that a transaction can modify,
+** which is every writable configuration register.
+*/
+#define cPmcuTxnRegMax		(1 + cPmcuVadjGroupMax + cPmcuFanMax)
+
+/* ------------------------------------------------------------ */
+/*                  General Type Declarations                   */
+/* ------------------------------------------------------------ */
+
+/* A register modified by a transaction. The fields following fsBits are
+** filled in by PmcuTxnCommit.
+*/
+typedef struct {
+	WORD	regaddr;
+	BYTE	cb;
+	WORD	regaddrCount;	// count register used to validate iinst, 0 if none
+	BYTE	iinst;
+	WORD	fsMask;			// bits of the register to modify
+	WORD	fsBits;			// new value of the bits in fsMask
+	WORD	fsOld;			// value read before the commit
+	WORD	fsWritten;		// value written, same as fsOld if nothing changed
+	WORD	fsRead;			// value read back after the PMCU was ready
+	BOOL	fMismatch;		// the PMCU restricted the new value
+} PmcuTxnReg;
+
+/* A configuration transaction. Registers are kept sorted by address and
+** are written in that order.
+*/
+typedef struct {
+	BYTE		creg;
+	PmcuTxnReg	rgreg[cPmcuTxnRegMax];
+	BYTE		cwrite;		// I2C write transactions performed by the commit
+	BYTE		csettle;	// times the commit waited for the PMCU to be ready
+} PmcuConfigTxn;
+
+/* ------------------------------------------------------------ */
+/*                  Variable Declarations                       */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*                  Procedure Declarations                      */
+/* ------------------------------------------------------------ */
+
+void	PmcuTxnBegin(PmcuConfigTxn* ptxn);
+BOOL	PmcuTxnStagePlatformConfig(PmcuConfigTxn* ptxn, BOOL setEnforce5v0, BOOL enforce5v0, BOOL setEnforce3v3, BOOL enforce3v3, BOOL setEnforceVio, BOOL enforceVio, BOOL setCrcCheck, BOOL crcCheck);
+BOOL	PmcuTxnStageVioConfig(PmcuConfigTxn* ptxn, int chanid, BOOL setEnable, BOOL enable, BOOL setOverride, BOOL override, BOOL setVoltage, WORD voltage);
+BOOL	PmcuTxnStageFanConfig(PmcuConfigTxn* ptxn, int fanid, BOOL setEnable, BOOL enable, BOOL setSpeed, BYTE speed, BOOL setProbe, BYTE probe);
+BOOL	PmcuTxnCommit(int fdI2cDev, PmcuConfigTxn* ptxn);
+
+/* ------------------------------------------------------------ */
+
+#endif /* PMCUCONFIGTXN_H_ */
@@ -0,0 +1,419 @@
+/************************************************************************/
+/*                                                                      */
+/*  PwrBudget.c - SmartVIO power budget model implementation            */
+/*                                                                      */
+/************************************************************************/
+/*  Author: Digilent Inc.                                               */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  This source file contains the implementation of functions that can  */
+/*  be used to decide whether the supplies of a board can power a pod   */
+/*  without accessing the I2C bus.                                      */
+/*                                                                      */
+/*  The load of each group is the sum of the current required by every  */
+/*  pod assigned to that group, which is also how the Platform MCU      */
+/*  computes the CURRENT_REQUESTED registers. Each port records the     */
+/*  requirements it contributes, so that PwrBudgetSetPort can subtract  */
+/*  them from the groups of the port before adding those of its new     */
+/*  pod, and no other port needs to be revisited. The pods that share a */
+/*  VADJ group are powered at the same voltage, so an admission query   */
+/*  checks the voltage against the VIO ranges of each of them.          */
+/*                                                                      */
+/*  A model isn't protected by a lock. It's meant to be updated and     */
+/*  queried by the thread that polls the change watch, or the caller    */
+/*  must serialize access to it.                                        */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*  10/14/2026: created                                                 */
+/*                                                                      */
+/************************************************************************/
+
+/* ------------------------------------------------------------ */
+/*              Include File Definitions                        */
+/* ------------------------------------------------------------ */
+
+#include <string.h>
+#include "stdtypes.h"
+#include "PlatformMCU.h"
+#include "syzygy.h"
+#include "PwrBudget.h"
+
+/* ------------------------------------------------------------ */
+/*              Miscellaneous Declarations                      */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*              Local Type Definitions                          */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*              Global Variables                                */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*              Local Variables                                 */
+/* ------------------------------------------------------------ */
+
+/* Refusal reason of each supply, indexed by pwrsup.
+*/
+static const BYTE	rgfsRefuseSupply[cPwrSupplyMax] = {
+	fsPwrRefuse5v0,
+	fsPwrRefuse3v3,
+	fsPwrRefuseVio
+};
+
+/* ------------------------------------------------------------ */
+/*              Forward Declarations                            */
+/* ------------------------------------------------------------ */
+
+static void		PwrPortSetPod(PwrPort* pport, const SzgDnaHeader* pheader);
+static void		PwrBudgetAddLoad(PwrBudget* pbudget, const PwrPort* pport, INT32 sign);
+static BOOL		FPwrInRange(const PwrPort* pport, WORD vltg);
+
+/* ------------------------------------------------------------ */
+/*              Procedure Definitions                           */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/***    PwrBudgetInit
+**
+**  Parameters:
+**      pbudget         - pointer to the model to initialize
+**      pcfgregs        - configuration registers read from the Platform MCU
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function initializes a power budget model from a snapshot of
+**      the configuration registers. The number of groups of each supply
+**      and the current allowed for each group are taken from the
+**      snapshot, as is the group assignment of each port. No pods are
+**      counted until PwrBudgetSetPort is called for their ports.
+*/
+void
+PwrBudgetInit(PwrBudget* pbudget, const PMCU_CONFIG_REGS* pcfgregs) {
+
+	BYTE	igroup;
+	BYTE	iport;
+
+	memset(pbudget, 0, sizeof(PwrBudget));
+
+	pbudget->cport = ( cPmcuPortMax < pcfgregs->cport ) ? cPmcuPortMax : pcfgregs->cport;
+	pbudget->rgcgroup[pwrsup5v0] = ( cPmcu5v0GroupMax < pcfgregs->c5v0 ) ? cPmcu5v0GroupMax : pcfgregs->c5v0;
+	pbudget->rgcgroup[pwrsup3v3] = ( cPmcu3v3GroupMax < pcfgregs->c3v3 ) ? cPmcu3v3GroupMax : pcfgregs->c3v3;
+	pbudget->rgcgroup[pwrsupVio] = ( cPmcuVadjGroupMax < pcfgregs->cvadj ) ? cPmcuVadjGroupMax : pcfgregs->cvadj;
+
+	for ( igroup = 0; igroup < pbudget->rgcgroup[pwrsup5v0]; igroup++ ) {
+		pbudget->rgrggroup[pwrsup5v0][igroup].crntAllowed = pcfgregs->rg5v0[igroup].crntAllowed;
+	}
+	for ( igroup = 0; igroup < pbudget->rgcgroup[pwrsup3v3]; igroup++ ) {
+		pbudget->rgrggroup[pwrsup3v3][igroup].crntAllowed = pcfgregs->rg3v3[igroup].crntAllowed;
+	}
+	for ( igroup = 0; igroup < pbudget->rgcgroup[pwrsupVio]; igroup++ ) {
+		pbudget->rgrggroup[pwrsupVio][igroup].crntAllowed = pcfgregs->rgvadj[igroup].crntAllowed;
+	}
+
+	for ( iport = 0; iport < pbudget->cport; iport++ ) {
+		PwrBudgetSetPort(pbudget, iport, &pcfgregs->rgport[iport], NULL);
+	}
+}
+
+/* ------------------------------------------------------------ */
+/***    PwrBudgetSetPort
+**
+**  Parameters:
+**      pbudget         - pointer to an initialized model
+**      iport           - index of the SmartVIO port
+**      pportregs       - port registers read from the Platform MCU
+**      pheader         - DNA header of the pod on the port, NULL if there's none
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function updates the group assignment and the pod of a
+**      single port. The requirements of the previous pod are removed
+**      from the load of its groups and those of the new pod, if any,
+**      are added to the load of the groups given by pportregs.
+*/
+void
+PwrBudgetSetPort(PwrBudget* pbudget, BYTE iport, const PMCU_PORT_REGS* pportregs, const SzgDnaHeader* pheader) {
+
+	PwrPort*	pport;
+
+	if ( pbudget->cport <= iport ) {
+		return;
+	}
+
+	pport = &pbudget->rgport[iport];
+
+	PwrBudgetAddLoad(pbudget, pport, -1);
+
+	pport->rgigroup[pwrsup5v0] = pportregs->group5v0;
+	pport->rgigroup[pwrsup3v3] = pportregs->group3v3;
+	pport->rgigroup[pwrsupVio] = pportregs->groupVio;
+	PwrPortSetPod(pport, pheader);
+
+	PwrBudgetAddLoad(pbudget, pport, 1);
+}
+
+/* ------------------------------------------------------------ */
+/***    PwrBudgetFAdmit
+**
+**  Parameters:
+**      pbudget         - pointer to an initialized model
+**      iport           - index of the SmartVIO port
+**      vltg            - VIO voltage the port would be powered at (10 mV)
+**      pheader         - DNA header of the pod to check, NULL for the pod on the port
+**      padmit          - pointer to a variable to receive the reasons and headroom, may be NULL
+**
+**  Return Value:
+**      fTrue if the pod can be powered, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function determines whether the supplies of a port can power
+**      a pod at the specified VIO voltage without reading any registers.
+**      The pod replaces whichever pod is counted on the port. Each group
+**      of the port must be able to supply the requirements of the pod in
+**      addition to the load of the other pods assigned to it, and the
+**      voltage must be within a VIO range of the pod and of every other
+**      pod on the same VADJ group.
+**
+**      Passing a DNA header allows a pod to be checked before it's
+**      inserted, or with requirements other than those read from it.
+*/
+BOOL
+PwrBudgetFAdmit(const PwrBudget* pbudget, BYTE iport, WORD vltg, const SzgDnaHeader* pheader, PwrAdmit* padmit) {
+
+	PwrAdmit		admit;
+	PwrPort			portCand;
+	const PwrPort*	pport;
+	const PwrPort*	pportOther;
+	const PwrGroup*	pgroup;
+	BYTE			igroup;
+	BYTE			pwrsup;
+	BYTE			iportOther;
+	INT32			crntLoad;
+
+	memset(&admit, 0, sizeof(PwrAdmit));
+
+	if ( pbudget->cport <= iport ) {
+		admit.fsRefuse = fsPwrRefuseNoPod;
+		goto lExit;
+	}
+
+	pport = &pbudget->rgport[iport];
+	portCand = *pport;
+	if ( NULL != pheader ) {
+		PwrPortSetPod(&portCand, pheader);
+	}
+
+	if ( ! portCand.fPod ) {
+		admit.fsRefuse = fsPwrRefuseNoPod;
+		goto lExit;
+	}
+
+	for ( pwrsup = 0; pwrsup < cPwrSupplyMax; pwrsup++ ) {
+		igroup = portCand.rgigroup[pwrsup];
+		if ( pbudget->rgcgroup[pwrsup] <= igroup ) {
+			admit.fsRefuse |= fsPwrRefuseGroup;
+			continue;
+		}
+
+		pgroup = &pbudget->rgrggroup[pwrsup][igroup];
+		crntLoad = (INT32)pgroup->crntLoad + portCand.rgcrnt[pwrsup];
+		if ( pport->fPod ) {
+			crntLoad -= pport->rgcrnt[pwrsup];
+		}
+
+		admit.rgcrntHeadroom[pwrsup] = (INT32)pgroup->crntAllowed - crntLoad;
+		if ( 0 > admit.rgcrntHeadroom[pwrsup] ) {
+			admit.fsRefuse |= rgfsRefuseSupply[pwrsup];
+		}
+	}
+
+	if ( ! FPwrInRange(&portCand, vltg) ) {
+		admit.fsRefuse |= fsPwrRefuseRange;
+	}
+
+	for ( iportOther = 0; iportOther < pbudget->cport; iportOther++ ) {
+		pportOther = &pbudget->rgport[iportOther];
+		if (( iportOther != iport ) &&
+			( pportOther->fPod ) &&
+			( pportOther->rgigroup[pwrsupVio] == portCand.rgigroup[pwrsupVio] ) &&
+			( ! FPwrInRange(pportOther, vltg) )) {
+			admit.fsRefuse |= fsPwrRefuseShared;
+		}
+	}
+
+lExit:
+
+	if ( NULL != padmit ) {
+		*padmit = admit;
+	}
+
+	return ( 0 == admit.fsRefuse ) ? fTrue : fFalse;
+}
+
+/* ------------------------------------------------------------ */
+/***    PwrBudgetHeadroom
+**
+**  Parameters:
+**      pbudget         - pointer to an initialized model
+**      pwrsup          - supply of the group, pwrsup5v0, pwrsup3v3 or pwrsupVio
+**      igroup          - index of the group
+**
+**  Return Value:
+**      current left in the group (mA), negative if the group is over its
+**      limit and 0 if there's no such group
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function returns the difference between the current allowed
+**      for a group and the sum of the requirements of the pods assigned
+**      to it.
+*/
+INT32
+PwrBudgetHeadroom(const PwrBudget* pbudget, BYTE pwrsup, BYTE igroup) {
+
+	const PwrGroup*	pgroup;
+
+	if (( cPwrSupplyMax <= pwrsup ) || ( pbudget->rgcgroup[pwrsup] <= igroup )) {
+		return 0;
+	}
+
+	pgroup = &pbudget->rgrggroup[pwrsup][igroup];
+
+	return (INT32)pgroup->crntAllowed - (INT32)pgroup->crntLoad;
+}
+
+/* ------------------------------------------------------------ */
+/*          Local Functions                                     */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/***    PwrPortSetPod
+**
+**  Parameters:
+**      pport           - pointer to the port to update
+**      pheader         - DNA header of the pod, NULL if there's none
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function copies the current requirements and the VIO ranges
+**      of a pod from its DNA header.
+*/
+static void
+PwrPortSetPod(PwrPort* pport, const SzgDnaHeader* pheader) {
+
+	if ( NULL == pheader ) {
+		pport->fPod = fFalse;
+		memset(pport->rgcrnt, 0, sizeof(pport->rgcrnt));
+		memset(pport->rgvltgMin, 0, sizeof(pport->rgvltgMin));
+		memset(pport->rgvltgMax, 0, sizeof(pport->rgvltgMax));
+		return;
+	}
+
+	pport->fPod = fTrue;
+	pport->rgcrnt[pwrsup5v0] = pheader->crntRequired5v0;
+	pport->rgcrnt[pwrsup3v3] = pheader->crntRequired3v3;
+	pport->rgcrnt[pwrsupVio] = pheader->crntRequiredVio;
+	pport->rgvltgMin[0] = pheader->vltgRange1Min;
+	pport->rgvltgMax[0] = pheader->vltgRange1Max;
+	pport->rgvltgMin[1] = pheader->vltgRange2Min;
+	pport->rgvltgMax[1] = pheader->vltgRange2Max;
+	pport->rgvltgMin[2] = pheader->vltgRange3Min;
+	pport->rgvltgMax[2] = pheader->vltgRange3Max;
+	pport->rgvltgMin[3] = pheader->vltgRange4Min;
+	pport->rgvltgMax[3] = pheader->vltgRange4Max;
+}
+
+/* ------------------------------------------------------------ */
+/***    PwrBudgetAddLoad
+**
+**  Parameters:
+**      pbudget         - pointer to the model
+**      pport           - pointer to a port of the model
+**      sign            - 1 to add the requirements of the pod, -1 to remove them
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function adds the requirements of the pod counted on a port
+**      to the load of each group that the port is assigned, or removes
+**      them. Groups that the board doesn't have are ignored.
+*/
+static void
+PwrBudgetAddLoad(PwrBudget* pbudget, const PwrPort* pport, INT32 sign) {
+
+	BYTE	pwrsup;
+	BYTE	igroup;
+
+	if ( ! pport->fPod ) {
+		return;
+	}
+
+	for ( pwrsup = 0; pwrsup < cPwrSupplyMax; pwrsup++ ) {
+		igroup = pport->rgigroup[pwrsup];
+		if ( pbudget->rgcgroup[pwrsup] > igroup ) {
+			pbudget->rgrggroup[pwrsup][igroup].crntLoad += sign * (INT32)pport->rgcrnt[pwrsup];
+		}
+	}
+}
+
+/* ------------------------------------------------------------ */
+/***    FPwrInRange
+**
+**  Parameters:
+**      pport           - pointer to a port whose pod is counted
+**      vltg            - VIO voltage (10 mV)
+**
+**  Return Value:
+**      fTrue if the voltage is within one of the VIO ranges of the pod
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      A range whose minimum and maximum are both 0 isn't used by the pod.
+*/
+static BOOL
+FPwrInRange(const PwrPort* pport, WORD vltg) {
+
+	BYTE	irng;
+
+	for ( irng = 0; irng < cPwrVioRangeMax; irng++ ) {
+		if (( 0 != pport->rgvltgMax[irng] ) &&
+			( pport->rgvltgMin[irng] <= vltg ) &&
+			( pport->rgvltgMax[irng] >= vltg )) {
+			return fTrue;
+		}
+	}
+
+	return fFalse;
+}
@@ -0,0 +1,112 @@
+/************************************************************************/
+/*                                                                      */
+/*  PwrBudget.h - SmartVIO power budget model declarations              */
+/*                                                                      */
+/************************************************************************/
+/*  Author: Digilent Inc.                                               */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  This header file contains the declarations for functions that can   */
+/*  be used to decide whether the supplies of a board can power a pod   */
+/*  without accessing the I2C bus. The model holds the current allowed  */
+/*  for each 5V0, 3V3 and VADJ group, taken from one snapshot of the    */
+/*  Platform MCU configuration registers, and the current and VIO       */
+/*  voltage requirements of the pod on each port, taken from its DNA    */
+/*  header. It's updated one port at a time when a pod is inserted or   */
+/*  removed.                                                            */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*  10/14/2026: created                                                 */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef PWRBUDGET_H_
+#define PWRBUDGET_H_
+
+#include "../dpmutil/PlatformMCU.h"
+#include "../dpmutil/syzygy.h"
+
+/* ------------------------------------------------------------ */
+/*                  Miscellaneous Declarations                  */
+/* ------------------------------------------------------------ */
+
+/* Define the supplies that power a port. Each port is assigned one group
+** of each supply by the PORT_x_5V0_GROUP, PORT_x_3V3_GROUP and
+** PORT_x_VIO_GROUP registers.
+*/
+#define pwrsup5v0				0
+#define pwrsup3v3				1
+#define pwrsupVio				2
+#define cPwrSupplyMax			3
+
+/* Define the maximum number of groups of a single supply.
+*/
+#define cPwrGroupMax			cPmcuVadjGroupMax
+
+/* Define the number of VIO voltage ranges given by the DNA header.
+*/
+#define cPwrVioRangeMax			4
+
+/* Define the reasons reported by PwrBudgetFAdmit for refusing a pod.
+*/
+#define fsPwrRefuse5v0			0x01	// the 5V0 group would exceed the current allowed
+#define fsPwrRefuse3v3			0x02	// the 3V3 group would exceed the current allowed
+#define fsPwrRefuseVio			0x04	// the VADJ group would exceed the current allowed
+#define fsPwrRefuseRange		0x08	// the voltage is outside the VIO ranges of the pod
+#define fsPwrRefuseShared		0x10	// the voltage is outside the VIO ranges of another pod on the VADJ group
+#define fsPwrRefuseGroup		0x20	// the port is assigned a group that the board doesn't have
+#define fsPwrRefuseNoPod		0x40	// the port has no pod whose DNA was read
+
+/* ------------------------------------------------------------ */
+/*                  General Type Declarations                   */
+/* ------------------------------------------------------------ */
+
+typedef struct {
+	WORD			crntAllowed;	// mA, from the PMCU snapshot
+	DWORD			crntLoad;		// mA, sum of the requirements of the pods in the group
+} PwrGroup;
+
+typedef struct {
+	BYTE			rgigroup[cPwrSupplyMax];	// group of each supply, from the port registers
+	BOOL			fPod;						// the requirements of a pod are counted
+	WORD			rgcrnt[cPwrSupplyMax];		// mA, crntRequired* of the pod
+	WORD			rgvltgMin[cPwrVioRangeMax];	// 10 mV, VIO ranges of the pod
+	WORD			rgvltgMax[cPwrVioRangeMax];
+} PwrPort;
+
+typedef struct {
+	BYTE			cport;
+	BYTE			rgcgroup[cPwrSupplyMax];
+	PwrGroup		rgrggroup[cPwrSupplyMax][cPwrGroupMax];
+	PwrPort			rgport[cPmcuPortMax];
+} PwrBudget;
+
+/* Result of an admission query. The headroom is the current left in the
+** group of each supply of the port once the pod is powered, and is
+** negative if the group would be over its limit.
+*/
+typedef struct {
+	BYTE			fsRefuse;		// fsPwrRefuse* reasons, 0 when admitted
+	INT32			rgcrntHeadroom[cPwrSupplyMax];
+} PwrAdmit;
+
+/* ------------------------------------------------------------ */
+/*                  Variable Declarations                       */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*                  Procedure Declarations                      */
+/* ------------------------------------------------------------ */
+
+void	PwrBudgetInit(PwrBudget* pbudget, const PMCU_CONFIG_REGS* pcfgregs);
+void	PwrBudgetSetPort(PwrBudget* pbudget, BYTE iport, const PMCU_PORT_REGS* pportregs, const SzgDnaHeader* pheader);
+BOOL	PwrBudgetFAdmit(const PwrBudget* pbudget, BYTE iport, WORD vltg, const SzgDnaHeader* pheader, PwrAdmit* padmit);
+INT32	PwrBudgetHeadroom(const PwrBudget* pbudget, BYTE pwrsup, BYTE igroup);
+
+/* ------------------------------------------------------------ */
+
+#endif /* PWRBUDGET_H_ */
@@ -0,0 +1,439 @@
+/************************************************************************/
+/*                                                                      */
+/*  Sampler.c - Platform MCU telemetry sampler implementation           */
+/*                                                                      */
+/************************************************************************/
+/*  Author: Digilent Inc.                                               */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  This source file contains the implementation of functions that can  */
+/*  be used to continuously sample the temperatures, fan speeds and     */
+/*  supply currents reported by the Platform MCU.                       */
+/*                                                                      */
+/*  SamplerOpen reads the configuration register block once in order   */
+/*  to determine how many temperature probes, fans and supplies the     */
+/*  board has and which of them can be measured. Each call to           */
+/*  SamplerPoll then submits a single batch containing only the         */
+/*  temperature, fan RPM and current registers of the groups that are   */
+/*  present, and pushes the result onto the ring buffer.                */
+/*                                                                      */
+/*  The ring buffer has exactly one producer (SamplerPoll, or the       */
+/*  sampling thread started by SamplerStart) and one consumer           */
+/*  (SamplerDrain). The producer only writes ismpHead and the consumer  */
+/*  only writes ismpTail, so neither needs to take a lock. When the     */
+/*  ring is full new samples are discarded and counted rather than      */
+/*  overwriting samples the consumer may be reading.                    */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*  10/14/2026: created                                                 */
+/*                                                                      */
+/************************************************************************/
+
+/* ------------------------------------------------------------ */
+/*              Include File Definitions                        */
+/* ------------------------------------------------------------ */
+
+#if defined(__linux__)
+#include <time.h>
+#include <pthread.h>
+#endif
+#include <stdio.h>
+#include <string.h>
+#include "stdtypes.h"
+#include "I2CHAL.h"
+#include "PlatformMCU.h"
+#include "Sampler.h"
+
+/* ------------------------------------------------------------ */
+/*              Miscellaneous Declarations                      */
+/* ------------------------------------------------------------ */
+
+#if ( 0 != ( cSamplerRingMax & ( cSamplerRingMax - 1 )))
+#error "cSamplerRingMax must be a power of two"
+#endif
+
+#define ismpRingMask			(cSamplerRingMax - 1)
+
+/* The ring indices are shared between the producer and the consumer.
+** Acquire/release ordering guarantees that a sample is completely
+** written before the consumer can observe the updated head, and that
+** the consumer is done copying a sample before the producer can
+** observe the updated tail.
+*/
+#define SamplerLoadIndex(p)			__atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define SamplerStoreIndex(p, v)		__atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+#define nsPerSecond				1000000000L
+
+/* ------------------------------------------------------------ */
+/*              Local Type Definitions                          */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*              Global Variables                                */
+/* ------------------------------------------------------------ */
+
+extern I2CHALThreadLocal BOOL	dpmutilfVerbose;
+
+/* ------------------------------------------------------------ */
+/*              Local Variables                                 */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*              Forward Declarations                            */
+/* ------------------------------------------------------------ */
+
+#if defined(__linux__)
+static void*	SamplerThread(void* pvSampler);
+static UINT64	UsMonotonic();
+#endif
+
+/* ------------------------------------------------------------ */
+/*              Procedure Definitions                           */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/***    SamplerOpen
+**
+**  Parameters:
+**  	fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      psmp            - pointer to the sampler to initialize
+**
+**  Return Value:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function initializes the specified sampler and reads the
+**      static capabilities of the board from the Platform MCU: the
+**      number of temperature probes, fans and supply groups, the
+**      attributes of each probe, and the capabilities of each fan.
+**      These registers are not read again by the sampler.
+**
+**      The file descriptor must remain open for as long as the sampler
+**      is in use. On Linux it's typically the fdI2c field of an open
+**      dpmutil session.
+*/
+BOOL
+SamplerOpen(Sampler* psmp, int fdI2cDev) {
+
+	PMCU_CONFIG_REGS	cfgregs;
+	BYTE				iprobe;
+	BYTE				ifan;
+
+	if ( NULL == psmp ) {
+		return fFalse;
+	}
+
+	memset(psmp, 0, sizeof(Sampler));
+	psmp->fdI2cDev = fdI2cDev;
+
+	if ( ! PmcuReadConfigRegs(fdI2cDev, &cfgregs) ) {
+		if(dpmutilfVerbose)printf("ERROR: failed to read PMCU configuration registers\n");
+		return fFalse;
+	}
+
+	psmp->cprobe = ( cPmcuTempProbeMax < cfgregs.cprobe ) ? cPmcuTempProbeMax : cfgregs.cprobe;
+	psmp->cfan = ( cPmcuFanMax < cfgregs.cfan ) ? cPmcuFanMax : cfgregs.cfan;
+	psmp->c5v0 = ( cPmcu5v0GroupMax < cfgregs.c5v0 ) ? cPmcu5v0GroupMax : cfgregs.c5v0;
+	psmp->c3v3 = ( cPmcu3v3GroupMax < cfgregs.c3v3 ) ? cPmcu3v3GroupMax : cfgregs.c3v3;
+	psmp->cvadj = ( cPmcuVadjGroupMax < cfgregs.cvadj ) ? cPmcuVadjGroupMax : cfgregs.cvadj;
+
+	for ( iprobe = 0; iprobe < psmp->cprobe; iprobe++ ) {
+		psmp->rgattr[iprobe] = cfgregs.rgtemp[iprobe].attr;
+	}
+
+	for ( ifan = 0; ifan < psmp->cfan; ifan++ ) {
+		psmp->rgfcap[ifan] = cfgregs.rgfan[ifan].fcap;
+	}
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    SamplerPoll
+**
+**  Parameters:
+**      psmp            - pointer to an open sampler
+**      usTimestamp     - timestamp to record with the sample (us)
+**
+**  Return Value:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      Returns fFalse if the dynamic registers couldn't be read, in
+**      which case no sample is produced and cerr is incremented.
+**
+**  Description:
+**      This function reads the dynamic registers of the Platform MCU
+**      using a single batch and pushes the resulting sample onto the
+**      ring buffer. Only the temperatures of present probes, the RPM of
+**      fans that can measure it, and the allowed and requested currents
+**      of the supply groups that exist are read.
+**
+**      If the ring buffer is full then the sample is discarded and
+**      csmpDropped is incremented. Its sequence number is still
+**      consumed so that the consumer can detect the gap.
+**
+**      On bare metal this function is called by the application at the
+**      desired sampling rate. On Linux it may be called directly or by
+**      the thread started by SamplerStart, but not both.
+*/
+BOOL
+SamplerPoll(Sampler* psmp, UINT64 usTimestamp) {
+
+	I2cBatch		batch;
+	SamplerSample	smp;
+	DWORD			ismpHead;
+	DWORD			ismpTail;
+	BYTE			igrp;
+
+	memset(&smp, 0, sizeof(SamplerSample));
+	I2CHALBatchBegin(&batch, psmp->fdI2cDev);
+
+	for ( igrp = 0; igrp < psmp->cprobe; igrp++ ) {
+		if ( psmp->rgattr[igrp].fPresent ) {
+			PmcuBatchAddRead(&batch, regaddrTemp1 + (igrp * offsetTemperatureReg), (BYTE*)&smp.rgtemp[igrp], sizeof(SHORT));
+		}
+	}
+
+	for ( igrp = 0; igrp < psmp->cfan; igrp++ ) {
+		if ( psmp->rgfcap[igrp].fcapMeasureRpm ) {
+			PmcuBatchAddRead(&batch, regaddrFan1Rpm + (igrp * offsetFanReg), (BYTE*)&smp.rgrpm[igrp], sizeof(WORD));
+		}
+	}
+
+	/* The 5V0 and 3V3 current registers are contiguous so each type of
+	** supply only requires a single read.
+	*/
+	if ( 0 < psmp->c5v0 ) {
+		PmcuBatchAddRead(&batch, regaddr5v0ACurrentAllowed, (BYTE*)smp.rg5v0, psmp->c5v0 * sizeof(PMCU_SUPPLY_REGS));
+	}
+
+	if ( 0 < psmp->c3v3 ) {
+		PmcuBatchAddRead(&batch, regaddr3v3ACurrentAllowed, (BYTE*)smp.rg3v3, psmp->c3v3 * sizeof(PMCU_SUPPLY_REGS));
+	}
+
+	for ( igrp = 0; igrp < psmp->cvadj; igrp++ ) {
+		PmcuBatchAddRead(&batch, regaddrVadjACurrentAllowed + (igrp * offsetVadjReg), (BYTE*)&smp.rgvadj[igrp], sizeof(PMCU_SUPPLY_REGS));
+	}
+
+	if (( 0 < batch.cop ) && ( ! I2CHALBatchSubmit(&batch) )) {
+		psmp->cerr++;
+		return fFalse;
+	}
+
+	smp.usTimestamp = usTimestamp;
+	smp.iseq = psmp->iseqNext++;
+
+	ismpHead = psmp->ismpHead;
+	ismpTail = SamplerLoadIndex(&psmp->ismpTail);
+	if ( cSamplerRingMax <= (ismpHead - ismpTail) ) {
+		psmp->csmpDropped++;
+		return fTrue;
+	}
+
+	memcpy(&psmp->rgsmp[ismpHead & ismpRingMask], &smp, sizeof(SamplerSample));
+	SamplerStoreIndex(&psmp->ismpHead, ismpHead + 1);
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    SamplerDrain
+**
+**  Parameters:
+**      psmp            - pointer to an open sampler
+**      rgsmp           - array to receive the samples
+**      csmpMax         - number of entries in rgsmp
+**
+**  Return Value:
+**      number of samples copied to rgsmp
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function removes up to csmpMax of the oldest samples from
+**      the ring buffer and copies them to rgsmp. It never blocks and
+**      may be called while the sampling thread is running.
+*/
+WORD
+SamplerDrain(Sampler* psmp, SamplerSample rgsmp[], WORD csmpMax) {
+
+	DWORD	ismpHead;
+	DWORD	ismpTail;
+	WORD	csmp;
+
+	ismpTail = psmp->ismpTail;
+	ismpHead = SamplerLoadIndex(&psmp->ismpHead);
+
+	csmp = 0;
+	while (( ismpTail != ismpHead ) && ( csmpMax > csmp )) {
+		memcpy(&rgsmp[csmp], &psmp->rgsmp[ismpTail & ismpRingMask], sizeof(SamplerSample));
+		ismpTail++;
+		csmp++;
+	}
+
+	SamplerStoreIndex(&psmp->ismpTail, ismpTail);
+
+	return csmp;
+}
+
+#if defined(__linux__)
+/* ------------------------------------------------------------ */
+/***    SamplerStart
+**
+**  Parameters:
+**      psmp            - pointer to an open sampler
+**      hz              - sampling rate, hzSamplerMin to hzSamplerMax
+**
+**  Return Value:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      Returns fFalse if the rate is out of range, the sampler is
+**      already running, or the thread couldn't be created.
+**
+**  Description:
+**      This function starts a thread that calls SamplerPoll at the
+**      specified rate. The thread sleeps until an absolute deadline
+**      between polls so that the rate doesn't drift and no CPU time is
+**      used between samples. Samples are timestamped with
+**      CLOCK_MONOTONIC in microseconds.
+*/
+BOOL
+SamplerStart(Sampler* psmp, WORD hz) {
+
+	if (( NULL == psmp ) || ( psmp->fThread ) ||
+		( hzSamplerMin > hz ) || ( hzSamplerMax < hz )) {
+		return fFalse;
+	}
+
+	psmp->hz = hz;
+	psmp->fRun = fTrue;
+	psmp->fVerbose = dpmutilfVerbose;
+
+	if ( 0 != pthread_create(&psmp->thread, NULL, SamplerThread, psmp) ) {
+		psmp->fRun = fFalse;
+		return fFalse;
+	}
+
+	psmp->fThread = fTrue;
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    SamplerStop
+**
+**  Parameters:
+**      psmp            - pointer to a sampler
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function stops the thread started by SamplerStart and waits
+**      for it to exit. Samples remaining in the ring buffer may still be
+**      drained afterwards.
+*/
+void
+SamplerStop(Sampler* psmp) {
+
+	if (( NULL == psmp ) || ( ! psmp->fThread )) {
+		return;
+	}
+
+	__atomic_store_n(&psmp->fRun, fFalse, __ATOMIC_RELEASE);
+	pthread_join(psmp->thread, NULL);
+	psmp->fThread = fFalse;
+}
+
+/* ------------------------------------------------------------ */
+/***    SamplerThread
+**
+**  Parameters:
+**      pvSampler       - pointer to the sampler
+**
+**  Return Value:
+**      NULL
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      Sampling thread. If a poll takes longer than the sampling period
+**      then the next deadline is computed from the current time rather
+**      than trying to catch up with a burst of polls.
+*/
+static void*
+SamplerThread(void* pvSampler) {
+
+	Sampler*		psmp;
+	struct timespec	tsNext;
+	struct timespec	tsNow;
+	long			nsPeriod;
+
+	psmp = (Sampler*)pvSampler;
+	nsPeriod = nsPerSecond / psmp->hz;
+	dpmutilfVerbose = psmp->fVerbose;
+
+	clock_gettime(CLOCK_MONOTONIC, &tsNext);
+
+	while ( __atomic_load_n(&psmp->fRun, __ATOMIC_ACQUIRE) ) {
+		SamplerPoll(psmp, UsMonotonic());
+
+		tsNext.tv_nsec += nsPeriod;
+		while ( nsPerSecond <= tsNext.tv_nsec ) {
+			tsNext.tv_nsec -= nsPerSecond;
+			tsNext.tv_sec++;
+		}
+
+		clock_gettime(CLOCK_MONOTONIC, &tsNow);
+		if (( tsNow.tv_sec > tsNext.tv_sec ) ||
+			(( tsNow.tv_sec == tsNext.tv_sec ) && ( tsNow.tv_nsec > tsNext.tv_nsec ))) {
+			tsNext = tsNow;
+			continue;
+		}
+
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &tsNext, NULL);
+	}
+
+	return NULL;
+}
+
+/* ------------------------------------------------------------ */
+/***    UsMonotonic
+**
+**  Parameters:
+**      none
+**
+**  Return Value:
+**      current value of CLOCK_MONOTONIC in microseconds
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function returns the time used to timestamp samples.
+*/
+static UINT64
+UsMonotonic() {
+
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((UINT64)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+#endif
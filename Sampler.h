@@ -0,0 +1,118 @@
+/************************************************************************/
+/*                                                                      */
+/*  Sampler.h - Platform MCU telemetry sampler declarations             */
+/*                                                                      */
+/************************************************************************/
+/*  Author: Digilent Inc.                                               */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  This header file contains the declarations for functions that can   */
+/*  be used to continuously sample the temperatures, fan speeds and     */
+/*  supply currents reported by the Platform MCU. The static            */
+/*  capabilities of the board are read once when the sampler is opened  */
+/*  and only the dynamic registers are polled afterwards. Samples are   */
+/*  placed in a single producer, single consumer ring buffer that may   */
+/*  be drained without taking any locks.                                */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*  10/14/2026: created                                                 */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef SAMPLER_H_
+#define SAMPLER_H_
+
+#include "../dpmutil/I2CHAL.h"
+#include "../dpmutil/PlatformMCU.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#endif
+
+/* ------------------------------------------------------------ */
+/*                  Miscellaneous Declarations                  */
+/* ------------------------------------------------------------ */
+
+/* Define the number of samples held by the ring buffer. This must be a
+** power of two. It may be defined before including this file in order
+** to reduce the size of a sampler on targets with little memory.
+*/
+#if !defined(cSamplerRingMax)
+#define cSamplerRingMax			256
+#endif
+
+/* Define the range of sampling rates supported by SamplerStart.
+*/
+#define hzSamplerMin			1
+#define hzSamplerMax			100
+
+/* ------------------------------------------------------------ */
+/*                  General Type Declarations                   */
+/* ------------------------------------------------------------ */
+
+typedef struct {
+	UINT64				usTimestamp;	// time the sample was taken (us)
+	DWORD				iseq;			// sequence number, gaps indicate dropped samples
+	SHORT				rgtemp[cPmcuTempProbeMax];
+	WORD				rgrpm[cPmcuFanMax];
+	PMCU_SUPPLY_REGS	rg5v0[cPmcu5v0GroupMax];
+	PMCU_SUPPLY_REGS	rg3v3[cPmcu3v3GroupMax];
+	PMCU_SUPPLY_REGS	rgvadj[cPmcuVadjGroupMax];
+} SamplerSample;
+
+typedef struct {
+	int						fdI2cDev;
+
+	/* Static capabilities, read once by SamplerOpen.
+	*/
+	BYTE					cprobe;
+	BYTE					cfan;
+	BYTE					c5v0;
+	BYTE					c3v3;
+	BYTE					cvadj;
+	TEMPERATURE_ATTRIBUTES	rgattr[cPmcuTempProbeMax];
+	FAN_CAPABILITIES		rgfcap[cPmcuFanMax];
+
+	/* Ring buffer. ismpHead is only written by the producer and ismpTail
+	** is only written by the consumer. Both increase monotonically and
+	** are reduced modulo cSamplerRingMax when indexing rgsmp.
+	*/
+	DWORD					ismpHead;
+	DWORD					ismpTail;
+	DWORD					iseqNext;
+	DWORD					csmpDropped;	// samples discarded because the ring was full
+	DWORD					cerr;			// polls that failed
+	SamplerSample			rgsmp[cSamplerRingMax];
+
+#if defined(__linux__)
+	pthread_t				thread;
+	BOOL					fThread;
+	BOOL					fRun;
+	BOOL					fVerbose;		// dpmutilfVerbose of the thread that started the sampler
+	WORD					hz;
+#endif
+} Sampler;
+
+/* ------------------------------------------------------------ */
+/*                  Variable Declarations                       */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*                  Procedure Declarations                      */
+/* ------------------------------------------------------------ */
+
+BOOL	SamplerOpen(Sampler* psmp, int fdI2cDev);
+BOOL	SamplerPoll(Sampler* psmp, UINT64 usTimestamp);
+WORD	SamplerDrain(Sampler* psmp, SamplerSample rgsmp[], WORD csmpMax);
+#if defined(__linux__)
+BOOL	SamplerStart(Sampler* psmp, WORD hz);
+void	SamplerStop(Sampler* psmp);
+#endif
+
+/* ------------------------------------------------------------ */
+
+#endif /* SAMPLER_H_ */
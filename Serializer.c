@@ -0,0 +1,930 @@
+/************************************************************************/
+/*                                                                      */
+/*  Serializer.c - machine readable output implementation               */
+/*                                                                      */
+/************************************************************************/
+/*  Author: Digilent Inc.                                               */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  This source file contains the implementation of functions that can  */
+/*  be used to output the information returned by dpmutil in a machine  */
+/*  readable form.                                                      */
+/*                                                                      */
+/*  The JSON functions format into a caller supplied buffer and, like   */
+/*  snprintf, return the length the output would have had so that the  */
+/*  buffer can be sized with a first call that passes a NULL buffer.    */
+/*  The SerializerFWrite functions do exactly that and then write the   */
+/*  entire output, JSON or binary, with a single call to fwrite.        */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*  10/14/2026: created                                                 */
+/*                                                                      */
+/************************************************************************/
+
+/* ------------------------------------------------------------ */
+/*              Include File Definitions                        */
+/* ------------------------------------------------------------ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stdtypes.h"
+#include "dpmutil.h"
+#include "Serializer.h"
+
+/* ------------------------------------------------------------ */
+/*              Miscellaneous Declarations                      */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*              Local Type Definitions                          */
+/* ------------------------------------------------------------ */
+
+/* Output buffer. ich keeps counting once the buffer is full so that the
+** length of the complete output is known.
+*/
+typedef struct {
+	char*	pch;
+	size_t	cch;
+	size_t	ich;
+} SerBuf;
+
+/* ------------------------------------------------------------ */
+/*              Global Variables                                */
+/* ------------------------------------------------------------ */
+
+extern I2CHALThreadLocal BOOL	dpmutilfVerbose;
+
+/* ------------------------------------------------------------ */
+/*              Local Variables                                 */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*              Forward Declarations                            */
+/* ------------------------------------------------------------ */
+
+static void		SerBufInit(SerBuf* pbuf, char* pchBuf, size_t cchBuf);
+static void		SerPutch(SerBuf* pbuf, char ch);
+static void		SerPrintf(SerBuf* pbuf, const char* szFmt, ...) __attribute__((format(printf, 2, 3)));
+static void		SerString(SerBuf* pbuf, const char* sz);
+static void		SerCal(SerBuf* pbuf, const char* szName, BOOL fValid, const unsigned int* rgcoef, BYTE ccoef);
+static void		SerDevInfo(SerBuf* pbuf, const dpmutildevInfo_t* pDevInfo);
+static void		SerPowerInfo(SerBuf* pbuf, BYTE cgroup, const dpmutilPowerInfo_t pPowerInfo[]);
+static void		SerPortInfo(SerBuf* pbuf, BYTE cport, const dpmutilPortInfo_t pPortInfo[]);
+static void		SerRecordHeader(DpmRecordHeader* phdr, WORD rtyp, DWORD cbRecord, WORD iindex);
+static BOOL		FSerWrite(FILE* pfile, const void* pv, size_t cb);
+
+/* ------------------------------------------------------------ */
+/*              Procedure Definitions                           */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/***    SerializerJsonDevInfo
+**
+**  Parameters:
+**      pDevInfo        - information returned by dpmutilFGetInfo
+**      pchBuf          - buffer to receive the JSON object, may be NULL
+**      cchBuf          - size of the buffer, including the terminator
+**
+**  Return Value:
+**      length of the complete JSON object, excluding the terminator
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function formats the device information as a compact JSON
+**      object. If the buffer is too small the output is truncated but
+**      still terminated, which the caller detects by comparing the
+**      returned length to cchBuf.
+*/
+size_t
+SerializerJsonDevInfo(const dpmutildevInfo_t* pDevInfo, char* pchBuf, size_t cchBuf) {
+
+	SerBuf	buf;
+
+	SerBufInit(&buf, pchBuf, cchBuf);
+	SerDevInfo(&buf, pDevInfo);
+
+	return buf.ich;
+}
+
+/* ------------------------------------------------------------ */
+/***    SerializerJsonPowerInfo
+**
+**  Parameters:
+**      cgroup          - number of supply groups to output
+**      pPowerInfo      - information returned by dpmutilFGetInfoPower
+**      pchBuf          - buffer to receive the JSON array, may be NULL
+**      cchBuf          - size of the buffer, including the terminator
+**
+**  Return Value:
+**      length of the complete JSON array, excluding the terminator
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function formats the power supply information of the first
+**      cgroup groups as a compact JSON array of objects.
+*/
+size_t
+SerializerJsonPowerInfo(BYTE cgroup, const dpmutilPowerInfo_t pPowerInfo[], char* pchBuf, size_t cchBuf) {
+
+	SerBuf	buf;
+
+	SerBufInit(&buf, pchBuf, cchBuf);
+	SerPowerInfo(&buf, cgroup, pPowerInfo);
+
+	return buf.ich;
+}
+
+/* ------------------------------------------------------------ */
+/***    SerializerJsonPortInfo
+**
+**  Parameters:
+**      cport           - number of SmartVIO ports to output
+**      pPortInfo       - information returned by dpmutilFEnum
+**      pchBuf          - buffer to receive the JSON array, may be NULL
+**      cchBuf          - size of the buffer, including the terminator
+**
+**  Return Value:
+**      length of the complete JSON array, excluding the terminator
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function formats the SmartVIO port information, including
+**      the SYZYGY DNA and calibration coefficients of each installed
+**      pod, as a compact JSON array of objects.
+*/
+size_t
+SerializerJsonPortInfo(BYTE cport, const dpmutilPortInfo_t pPortInfo[], char* pchBuf, size_t cchBuf) {
+
+	SerBuf	buf;
+
+	SerBufInit(&buf, pchBuf, cchBuf);
+	SerPortInfo(&buf, cport, pPortInfo);
+
+	return buf.ich;
+}
+
+/* ------------------------------------------------------------ */
+/***    SerializerDevRecord
+**
+**  Parameters:
+**      pDevInfo        - information returned by dpmutilFGetInfo
+**      prec            - binary record to fill in
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function stores the device information in a binary record.
+*/
+void
+SerializerDevRecord(const dpmutildevInfo_t* pDevInfo, DpmDevRecord* prec) {
+
+	BYTE	i;
+
+	memset(prec, 0, sizeof(DpmDevRecord));
+	SerRecordHeader(&prec->hdr, rtypDpmDevInfo, sizeof(DpmDevRecord), 0);
+
+	prec->pdid = pDevInfo->pdid;
+	prec->fwVerRaw = pDevInfo->fwVerRaw;
+	prec->cfgVerRaw = pDevInfo->cfgVerRaw;
+	prec->fsPlatcfg = pDevInfo->platcfg.fsConfig;
+	prec->cntVioPort = pDevInfo->cntVioPort;
+	prec->cnt5v0 = pDevInfo->cnt5v0;
+	prec->cnt3v3 = pDevInfo->cnt3v3;
+	prec->cntVadj = pDevInfo->cntVadj;
+	prec->cntProbe = pDevInfo->cntProbe;
+	prec->cntFan = pDevInfo->cntFan;
+
+	for ( i = 0; i < 4; i++ ) {
+		prec->rgfsProbeAttr[i] = pDevInfo->probeAttr[i].fs;
+		prec->rgtemp[i] = pDevInfo->temp[i];
+		prec->rgfsFanCap[i] = pDevInfo->fanCapabilities[i].fs;
+		prec->rgfsFanConfig[i] = pDevInfo->fanConfig[i].fs;
+		prec->rgfanRpm[i] = pDevInfo->fanRPM[i];
+	}
+}
+
+/* ------------------------------------------------------------ */
+/***    SerializerPowerRecord
+**
+**  Parameters:
+**      igroup          - index of the supply group
+**      pPowerInfo      - information of the supply group
+**      prec            - binary record to fill in
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function stores the information of a supply group in a
+**      binary record.
+*/
+void
+SerializerPowerRecord(BYTE igroup, const dpmutilPowerInfo_t* pPowerInfo, DpmPowerRecord* prec) {
+
+	memset(prec, 0, sizeof(DpmPowerRecord));
+	SerRecordHeader(&prec->hdr, rtypDpmPowerInfo, sizeof(DpmPowerRecord), igroup);
+
+	prec->currentAllowed5v0 = pPowerInfo->currentAllowed5v0;
+	prec->currentRequested5v0 = pPowerInfo->currentRequested5v0;
+	prec->currentAllowed3v3 = pPowerInfo->currentAllowed3v3;
+	prec->currentRequested3v3 = pPowerInfo->currentRequested3v3;
+	prec->vadjVoltage = pPowerInfo->vadjVoltage;
+	prec->fsVadjOverride = pPowerInfo->vadjOverride.fs;
+	prec->currentAllowedVadj = pPowerInfo->currentAllowedVadj;
+	prec->currentRequestedVadj = pPowerInfo->currentRequestedVadj;
+}
+
+/* ------------------------------------------------------------ */
+/***    SerializerPortRecord
+**
+**  Parameters:
+**      iport           - index of the SmartVIO port
+**      pPortInfo       - information of the SmartVIO port
+**      prec            - binary record to fill in
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function stores the information of a SmartVIO port, and
+**      the DNA and calibration data of its pod, in a binary record.
+**      Fields that aren't valid for the port are zero.
+*/
+void
+SerializerPortRecord(BYTE iport, const dpmutilPortInfo_t* pPortInfo, DpmPortRecord* prec) {
+
+	const dpmutilDnaInfo_t*	pdna;
+
+	memset(prec, 0, sizeof(DpmPortRecord));
+	SerRecordHeader(&prec->hdr, rtypDpmPortInfo, sizeof(DpmPortRecord), iport);
+
+	prec->i2cAddr = pPortInfo->i2cAddr;
+	prec->group5v0 = pPortInfo->group5v0;
+	prec->group3v3 = pPortInfo->group3v3;
+	prec->groupVio = pPortInfo->groupVio;
+	prec->portType = pPortInfo->portType;
+	prec->fsPortSts = pPortInfo->portSts.fsStatus;
+	prec->fVioEnable = pPortInfo->fVioEnable ? 1 : 0;
+	prec->fDna = pPortInfo->fDna ? 1 : 0;
+	prec->voltage = pPortInfo->voltage;
+
+	if ( ! pPortInfo->fDna ) {
+		return;
+	}
+
+	pdna = &pPortInfo->dna;
+	prec->fwRegs = pdna->fwRegs;
+	prec->header = pdna->header;
+	strcpy(prec->szManufacturerName, pdna->szManufacturerName);
+	strcpy(prec->szProductName, pdna->szProductName);
+	strcpy(prec->szProductModel, pdna->szProductModel);
+	strcpy(prec->szProductVersion, pdna->szProductVersion);
+	strcpy(prec->szSerialNumber, pdna->szSerialNumber);
+
+	prec->fPdid = pdna->fPdid ? 1 : 0;
+	prec->pdid = pdna->pdid;
+	prec->family = (BYTE)pdna->family;
+
+	if ( ! pdna->fCal ) {
+		return;
+	}
+
+	prec->fCal = 1;
+	prec->fsCal = pdna->fsCal;
+	memcpy(prec->rgbFactCal, &pdna->factoryCal, sizeof(prec->rgbFactCal));
+	memcpy(prec->rgbUserCal, &pdna->userCal, sizeof(prec->rgbUserCal));
+	memcpy(prec->rgFactCalS18, &pdna->factoryCalS18, sizeof(prec->rgFactCalS18));
+	memcpy(prec->rgUserCalS18, &pdna->userCalS18, sizeof(prec->rgUserCalS18));
+}
+
+/* ------------------------------------------------------------ */
+/***    SerializerFWriteDevInfo
+**
+**  Parameters:
+**      pfile           - file to write to
+**      sfmt            - sfmtJson or sfmtBinary
+**      pDevInfo        - information returned by dpmutilFGetInfo
+**
+**  Return Value:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function writes the device information to a file as a
+**      single line of JSON or as a DpmDevRecord, using a single call
+**      to fwrite.
+*/
+BOOL
+SerializerFWriteDevInfo(FILE* pfile, BYTE sfmt, const dpmutildevInfo_t* pDevInfo) {
+
+	DpmDevRecord	rec;
+	char*			pch;
+	size_t			cchJson;
+	size_t			cchBuf;
+	BOOL			fRet;
+
+	if ( sfmtBinary == sfmt ) {
+		SerializerDevRecord(pDevInfo, &rec);
+		return FSerWrite(pfile, &rec, sizeof(rec));
+	}
+
+	/* The newline replaces the terminator, so the buffer is one byte
+	** longer than the JSON text and must not wrap around.
+	*/
+	cchJson = SerializerJsonDevInfo(pDevInfo, NULL, 0);
+	if (( 0 == cchJson ) || ( SIZE_MAX == cchJson )) {
+		return fFalse;
+	}
+	cchBuf = cchJson + 1;
+
+	pch = (char*)malloc(cchBuf);
+	if ( NULL == pch ) {
+		return fFalse;
+	}
+
+	SerializerJsonDevInfo(pDevInfo, pch, cchBuf);
+	pch[cchJson] = '\n';
+	fRet = FSerWrite(pfile, pch, cchBuf);
+
+	free(pch);
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    SerializerFWritePowerInfo
+**
+**  Parameters:
+**      pfile           - file to write to
+**      sfmt            - sfmtJson or sfmtBinary
+**      cgroup          - number of supply groups to output
+**      pPowerInfo      - information returned by dpmutilFGetInfoPower
+**
+**  Return Value:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function writes the information of the first cgroup supply
+**      groups to a file as a single line of JSON or as an array of
+**      DpmPowerRecord, using a single call to fwrite.
+*/
+BOOL
+SerializerFWritePowerInfo(FILE* pfile, BYTE sfmt, BYTE cgroup, const dpmutilPowerInfo_t pPowerInfo[]) {
+
+	DpmPowerRecord	rgrec[cPmcuVadjGroupMax];
+	char*			pch;
+	size_t			cchJson;
+	size_t			cchBuf;
+	BYTE			igroup;
+	BOOL			fRet;
+
+	if ( cPmcuVadjGroupMax < cgroup ) {
+		cgroup = cPmcuVadjGroupMax;
+	}
+
+	if ( sfmtBinary == sfmt ) {
+		for ( igroup = 0; igroup < cgroup; igroup++ ) {
+			SerializerPowerRecord(igroup, &pPowerInfo[igroup], &rgrec[igroup]);
+		}
+		return FSerWrite(pfile, rgrec, cgroup * sizeof(DpmPowerRecord));
+	}
+
+	cchJson = SerializerJsonPowerInfo(cgroup, pPowerInfo, NULL, 0);
+	if (( 0 == cchJson ) || ( SIZE_MAX == cchJson )) {
+		return fFalse;
+	}
+	cchBuf = cchJson + 1;
+
+	pch = (char*)malloc(cchBuf);
+	if ( NULL == pch ) {
+		return fFalse;
+	}
+
+	SerializerJsonPowerInfo(cgroup, pPowerInfo, pch, cchBuf);
+	pch[cchJson] = '\n';
+	fRet = FSerWrite(pfile, pch, cchBuf);
+
+	free(pch);
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    SerializerFWritePortInfo
+**
+**  Parameters:
+**      pfile           - file to write to
+**      sfmt            - sfmtJson or sfmtBinary
+**      cport           - number of SmartVIO ports to output
+**      pPortInfo       - information returned by dpmutilFEnum
+**
+**  Return Value:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function writes the information of the first cport
+**      SmartVIO ports to a file as a single line of JSON or as an array
+**      of DpmPortRecord, using a single call to fwrite.
+*/
+BOOL
+SerializerFWritePortInfo(FILE* pfile, BYTE sfmt, BYTE cport, const dpmutilPortInfo_t pPortInfo[]) {
+
+	DpmPortRecord*	rgrec;
+	char*			pch;
+	size_t			cchJson;
+	size_t			cchBuf;
+	BYTE			iport;
+	BOOL			fRet;
+
+	if ( cPmcuPortMax < cport ) {
+		cport = cPmcuPortMax;
+	}
+
+	if ( sfmtBinary == sfmt ) {
+		rgrec = (DpmPortRecord*)malloc(cport * sizeof(DpmPortRecord));
+		if (( NULL == rgrec ) && ( 0 < cport )) {
+			return fFalse;
+		}
+		for ( iport = 0; iport < cport; iport++ ) {
+			SerializerPortRecord(iport, &pPortInfo[iport], &rgrec[iport]);
+		}
+		fRet = FSerWrite(pfile, rgrec, cport * sizeof(DpmPortRecord));
+		free(rgrec);
+		return fRet;
+	}
+
+	cchJson = SerializerJsonPortInfo(cport, pPortInfo, NULL, 0);
+	if (( 0 == cchJson ) || ( SIZE_MAX == cchJson )) {
+		return fFalse;
+	}
+	cchBuf = cchJson + 1;
+
+	pch = (char*)malloc(cchBuf);
+	if ( NULL == pch ) {
+		return fFalse;
+	}
+
+	SerializerJsonPortInfo(cport, pPortInfo, pch, cchBuf);
+	pch[cchJson] = '\n';
+	fRet = FSerWrite(pfile, pch, cchBuf);
+
+	free(pch);
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/*          Local Functions                                     */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/***    SerBufInit
+**
+**  Parameters:
+**      pbuf            - output buffer to initialize
+**      pchBuf          - buffer to format into, may be NULL
+**      cchBuf          - size of the buffer, including the terminator
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function initializes an output buffer.
+*/
+static void
+SerBufInit(SerBuf* pbuf, char* pchBuf, size_t cchBuf) {
+
+	pbuf->pch = pchBuf;
+	pbuf->cch = ( NULL != pchBuf ) ? cchBuf : 0;
+	pbuf->ich = 0;
+
+	if ( 0 < pbuf->cch ) {
+		pbuf->pch[0] = '\0';
+	}
+}
+
+/* ------------------------------------------------------------ */
+/***    SerPutch
+**
+**  Parameters:
+**      pbuf            - output buffer
+**      ch              - character to append
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function appends a character to the output, keeping the
+**      buffer terminated.
+*/
+static void
+SerPutch(SerBuf* pbuf, char ch) {
+
+	if ( pbuf->ich + 1 < pbuf->cch ) {
+		pbuf->pch[pbuf->ich] = ch;
+		pbuf->pch[pbuf->ich+1] = '\0';
+	}
+
+	pbuf->ich++;
+}
+
+/* ------------------------------------------------------------ */
+/***    SerPrintf
+**
+**  Parameters:
+**      pbuf            - output buffer
+**      szFmt           - printf format string
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function appends formatted text to the output.
+*/
+static void
+SerPrintf(SerBuf* pbuf, const char* szFmt, ...) {
+
+	va_list	va;
+	size_t	cchAvail;
+	int		cch;
+
+	cchAvail = ( pbuf->ich < pbuf->cch ) ? pbuf->cch - pbuf->ich : 0;
+
+	va_start(va, szFmt);
+	cch = vsnprintf(( 0 < cchAvail ) ? pbuf->pch + pbuf->ich : NULL, cchAvail, szFmt, va);
+	va_end(va);
+
+	if ( 0 < cch ) {
+		pbuf->ich += cch;
+	}
+}
+
+/* ------------------------------------------------------------ */
+/***    SerString
+**
+**  Parameters:
+**      pbuf            - output buffer
+**      sz              - string to append
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function appends a JSON string, escaping the quote,
+**      backslash and control characters. DNA strings are read from the
+**      pod and may contain any byte, so bytes of 0x80 and above are
+**      escaped as the code point of the same value rather than passed
+**      through as what may not be valid UTF-8.
+*/
+static void
+SerString(SerBuf* pbuf, const char* sz) {
+
+	SerPutch(pbuf, '"');
+
+	for ( ; '\0' != *sz; sz++ ) {
+		if (( '"' == *sz ) || ( '\\' == *sz )) {
+			SerPutch(pbuf, '\\');
+			SerPutch(pbuf, *sz);
+		}
+		else if (( 0x20 > (BYTE)*sz ) || ( 0x80 <= (BYTE)*sz )) {
+			SerPrintf(pbuf, "\\u%04X", (BYTE)*sz);
+		}
+		else {
+			SerPutch(pbuf, *sz);
+		}
+	}
+
+	SerPutch(pbuf, '"');
+}
+
+/* ------------------------------------------------------------ */
+/***    SerCal
+**
+**  Parameters:
+**      pbuf            - output buffer
+**      szName          - name of the member
+**      fValid          - fTrue if the checksum of the area is valid
+**      rgcoef          - S18 coefficients computed from the area, only
+**                        appended when fValid is set
+**      ccoef           - number of coefficients
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function appends a calibration area member.
+*/
+static void
+SerCal(SerBuf* pbuf, const char* szName, BOOL fValid, const unsigned int* rgcoef, BYTE ccoef) {
+
+	BYTE	icoef;
+
+	SerPrintf(pbuf, ",\"%s\":{\"valid\":%s", szName, fValid ? "true" : "false");
+	if ( fValid ) {
+		SerPrintf(pbuf, ",\"s18\":[");
+		for ( icoef = 0; icoef < ccoef; icoef++ ) {
+			SerPrintf(pbuf, "%s%u", ( 0 == icoef ) ? "" : ",", rgcoef[icoef]);
+		}
+		SerPutch(pbuf, ']');
+	}
+	SerPutch(pbuf, '}');
+}
+
+/* ------------------------------------------------------------ */
+/***    SerDevInfo
+**
+**  Parameters:
+**      pbuf            - output buffer
+**      pDevInfo        - information returned by dpmutilFGetInfo
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function appends the device information JSON object.
+*/
+static void
+SerDevInfo(SerBuf* pbuf, const dpmutildevInfo_t* pDevInfo) {
+
+	BYTE	i;
+
+	SerPrintf(pbuf, "{\"pdid\":%u,\"fwVer\":\"%d.%d\",\"cfgVer\":\"%d.%d\"",
+		(unsigned int)pDevInfo->pdid,
+		pDevInfo->fwVerRaw >> 8, pDevInfo->fwVerRaw & 0xFF,
+		pDevInfo->cfgVerRaw >> 8, pDevInfo->cfgVerRaw & 0xFF);
+
+	SerPrintf(pbuf, ",\"platformConfig\":{\"raw\":%u,\"enforce5v0\":%s,\"enforce3v3\":%s,\"enforceVio\":%s,\"crcCheck\":%s}",
+		pDevInfo->platcfg.fsConfig,
+		pDevInfo->platcfg.fEnforce5v0CurLimit ? "true" : "false",
+		pDevInfo->platcfg.fEnforce3v3CurLimit ? "true" : "false",
+		pDevInfo->platcfg.fEnforceVioCurLimit ? "true" : "false",
+		pDevInfo->platcfg.fPerformCrcCheck ? "true" : "false");
+
+	SerPrintf(pbuf, ",\"portCount\":%d,\"5v0Count\":%d,\"3v3Count\":%d,\"vadjCount\":%d",
+		pDevInfo->cntVioPort, pDevInfo->cnt5v0, pDevInfo->cnt3v3, pDevInfo->cntVadj);
+
+	SerPrintf(pbuf, ",\"probes\":[");
+	for ( i = 0; ( i < pDevInfo->cntProbe ) && ( i < 4 ); i++ ) {
+		SerPrintf(pbuf, "%s{\"present\":%s,\"location\":%d,\"format\":%d,\"temp\":%d}",
+			( 0 == i ) ? "" : ",",
+			pDevInfo->probeAttr[i].fPresent ? "true" : "false",
+			pDevInfo->probeAttr[i].tlocation,
+			pDevInfo->probeAttr[i].tformat,
+			pDevInfo->temp[i]);
+	}
+
+	SerPrintf(pbuf, "],\"fans\":[");
+	for ( i = 0; ( i < pDevInfo->cntFan ) && ( i < 4 ); i++ ) {
+		SerPrintf(pbuf, "%s{\"capabilities\":%u,\"enable\":%s,\"speed\":%d,\"probe\":%d,\"rpm\":%u}",
+			( 0 == i ) ? "" : ",",
+			pDevInfo->fanCapabilities[i].fs,
+			pDevInfo->fanConfig[i].fEnable ? "true" : "false",
+			pDevInfo->fanConfig[i].fspeed,
+			pDevInfo->fanConfig[i].tempsrc,
+			pDevInfo->fanRPM[i]);
+	}
+
+	SerPrintf(pbuf, "]}");
+}
+
+/* ------------------------------------------------------------ */
+/***    SerPowerInfo
+**
+**  Parameters:
+**      pbuf            - output buffer
+**      cgroup          - number of supply groups to output
+**      pPowerInfo      - information returned by dpmutilFGetInfoPower
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function appends the power supply information JSON array.
+*/
+static void
+SerPowerInfo(SerBuf* pbuf, BYTE cgroup, const dpmutilPowerInfo_t pPowerInfo[]) {
+
+	BYTE	igroup;
+
+	SerPutch(pbuf, '[');
+
+	for ( igroup = 0; igroup < cgroup; igroup++ ) {
+		SerPrintf(pbuf, "%s{\"group\":%d,\"currentAllowed5v0\":%u,\"currentRequested5v0\":%u"
+			",\"currentAllowed3v3\":%u,\"currentRequested3v3\":%u"
+			",\"vadjVoltage\":%u,\"vadjOverride\":%u,\"currentAllowedVadj\":%u,\"currentRequestedVadj\":%u}",
+			( 0 == igroup ) ? "" : ",", igroup,
+			pPowerInfo[igroup].currentAllowed5v0, pPowerInfo[igroup].currentRequested5v0,
+			pPowerInfo[igroup].currentAllowed3v3, pPowerInfo[igroup].currentRequested3v3,
+			pPowerInfo[igroup].vadjVoltage, pPowerInfo[igroup].vadjOverride.fs,
+			pPowerInfo[igroup].currentAllowedVadj, pPowerInfo[igroup].currentRequestedVadj);
+	}
+
+	SerPutch(pbuf, ']');
+}
+
+/* ------------------------------------------------------------ */
+/***    SerPortInfo
+**
+**  Parameters:
+**      pbuf            - output buffer
+**      cport           - number of SmartVIO ports to output
+**      pPortInfo       - information returned by dpmutilFEnum
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function appends the SmartVIO port information JSON array.
+**      The dna member of a port without a pod is null.
+*/
+static void
+SerPortInfo(SerBuf* pbuf, BYTE cport, const dpmutilPortInfo_t pPortInfo[]) {
+
+	const dpmutilPortInfo_t*	pport;
+	const dpmutilDnaInfo_t*		pdna;
+	const ZMOD_FAMILY_HANDLER*	pzfh;
+	BYTE						iport;
+
+	SerPutch(pbuf, '[');
+
+	for ( iport = 0; iport < cport; iport++ ) {
+
+		pport = &pPortInfo[iport];
+		SerPrintf(pbuf, "%s{\"port\":\"%c\",\"i2cAddr\":%u,\"group5v0\":%u,\"group3v3\":%u,\"groupVio\":%u"
+			",\"type\":%u,\"status\":%u,\"present\":%s,\"voltage\":%u,\"vioEnable\":%s,\"dna\":",
+			( 0 == iport ) ? "" : ",", 'A' + iport,
+			pport->i2cAddr, pport->group5v0, pport->group3v3, pport->groupVio,
+			pport->portType, pport->portSts.fsStatus,
+			pport->portSts.fPresent ? "true" : "false",
+			pport->voltage, pport->fVioEnable ? "true" : "false");
+
+		if ( ! pport->fDna ) {
+			SerPrintf(pbuf, "null}");
+			continue;
+		}
+
+		pdna = &pport->dna;
+		SerPrintf(pbuf, "{\"fwVer\":\"%d.%d\",\"dnaVer\":\"%d.%d\",\"manufacturer\":",
+			pdna->fwRegs.fwverMjr, pdna->fwRegs.fwverMin,
+			pdna->header.dnaverMjr, pdna->header.dnaverMin);
+		SerString(pbuf, pdna->szManufacturerName);
+		SerPrintf(pbuf, ",\"product\":");
+		SerString(pbuf, pdna->szProductName);
+		SerPrintf(pbuf, ",\"model\":");
+		SerString(pbuf, pdna->szProductModel);
+		SerPrintf(pbuf, ",\"version\":");
+		SerString(pbuf, pdna->szProductVersion);
+		SerPrintf(pbuf, ",\"serial\":");
+		SerString(pbuf, pdna->szSerialNumber);
+
+		SerPrintf(pbuf, ",\"crntRequired5v0\":%u,\"crntRequired3v3\":%u,\"crntRequiredVio\":%u,\"attributes\":%u"
+			",\"vioRanges\":[[%d,%d],[%d,%d],[%d,%d],[%d,%d]]",
+			pdna->header.crntRequired5v0, pdna->header.crntRequired3v3,
+			pdna->header.crntRequiredVio, pdna->header.fsAttributes,
+			pdna->header.vltgRange1Min * 10, pdna->header.vltgRange1Max * 10,
+			pdna->header.vltgRange2Min * 10, pdna->header.vltgRange2Max * 10,
+			pdna->header.vltgRange3Min * 10, pdna->header.vltgRange3Max * 10,
+			pdna->header.vltgRange4Min * 10, pdna->header.vltgRange4Max * 10);
+
+		if ( pdna->fPdid ) {
+			SerPrintf(pbuf, ",\"pdid\":%u", (unsigned int)pdna->pdid);
+			pzfh = PzfhFromZmodFamily(pdna->family);
+			if ( NULL != pzfh ) {
+				SerPrintf(pbuf, ",\"family\":\"%s\"", pzfh->szName);
+				if ( pdna->fCal ) {
+					SerPrintf(pbuf, ",\"cal\":{\"fsCal\":%u", pdna->fsCal);
+					if ( pdna->fsCal & fsZmodCalFactRead ) {
+						SerCal(pbuf, "factory", ( pdna->fsCal & fsZmodCalFactValid ) ? fTrue : fFalse,
+							(const unsigned int*)&pdna->factoryCalS18, pzfh->ccoefS18);
+					}
+					if ( pdna->fsCal & fsZmodCalUserRead ) {
+						SerCal(pbuf, "user", ( pdna->fsCal & fsZmodCalUserValid ) ? fTrue : fFalse,
+							(const unsigned int*)&pdna->userCalS18, pzfh->ccoefS18);
+					}
+					SerPutch(pbuf, '}');
+				}
+			}
+		}
+
+		SerPrintf(pbuf, "}}");
+	}
+
+	SerPutch(pbuf, ']');
+}
+
+/* ------------------------------------------------------------ */
+/***    SerRecordHeader
+**
+**  Parameters:
+**      phdr            - header to fill in
+**      rtyp            - rtypDpm* type of the record
+**      cbRecord        - size of the record, including the header
+**      iindex          - index of the group or port
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function fills in the header of a binary record.
+*/
+static void
+SerRecordHeader(DpmRecordHeader* phdr, WORD rtyp, DWORD cbRecord, WORD iindex) {
+
+	phdr->magic = magicDpmRecord;
+	phdr->ver = verDpmRecord;
+	phdr->rtyp = rtyp;
+	phdr->cbRecord = cbRecord;
+	phdr->iindex = iindex;
+	phdr->rsv1 = 0;
+}
+
+/* ------------------------------------------------------------ */
+/***    FSerWrite
+**
+**  Parameters:
+**      pfile           - file to write to
+**      pv              - data to write
+**      cb              - number of bytes to write
+**
+**  Return Value:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function writes the output to the file with a single call
+**      to fwrite.
+*/
+static BOOL
+FSerWrite(FILE* pfile, const void* pv, size_t cb) {
+
+	if ( 0 == cb ) {
+		return fTrue;
+	}
+
+	if ( 1 != fwrite(pv, cb, 1, pfile) ) {
+		if(dpmutilfVerbose)printf("ERROR: failed to write %u bytes of output\n", (unsigned int)cb);
+		return fFalse;
+	}
+
+	return fTrue;
+}
@@ -0,0 +1,157 @@
+/************************************************************************/
+/*                                                                      */
+/*  Serializer.h - machine readable output declarations                 */
+/*                                                                      */
+/************************************************************************/
+/*  Author: Digilent Inc.                                               */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  This header file contains the declarations for functions that can   */
+/*  be used to output the information returned by dpmutil in a machine  */
+/*  readable form, either as compact JSON or as fixed layout binary     */
+/*  records. Each record starts with a versioned header and has a size  */
+/*  that only depends on its type, so a file of records can be mapped   */
+/*  into memory and indexed directly.                                   */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*  10/14/2026: created                                                 */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef SERIALIZER_H_
+#define SERIALIZER_H_
+
+#include <stdio.h>
+#include "../dpmutil/dpmutil.h"
+
+/* ------------------------------------------------------------ */
+/*                  Miscellaneous Declarations                  */
+/* ------------------------------------------------------------ */
+
+/* Define the output formats.
+*/
+#define sfmtJson				0
+#define sfmtBinary				1
+
+/* Define the values used to identify a binary record. The version is
+** incremented whenever the layout of any record changes.
+*/
+#define magicDpmRecord			0x524D5044	// "DPMR"
+#define verDpmRecord			1
+
+/* Define the types of binary records.
+*/
+#define rtypDpmDevInfo			1
+#define rtypDpmPowerInfo		2
+#define rtypDpmPortInfo			3
+
+/* ------------------------------------------------------------ */
+/*                  General Type Declarations                   */
+/* ------------------------------------------------------------ */
+
+/* The binary records have no implicit padding and every field is
+** naturally aligned, so they may be accessed in place once mapped.
+** Multi-byte fields are in the byte order of the host that wrote them,
+** which is little endian on every supported platform.
+*/
+#pragma pack(push, 1)
+
+typedef struct {
+	DWORD			magic;
+	WORD			ver;
+	WORD			rtyp;
+	DWORD			cbRecord;		// size of the record, including this header
+	WORD			iindex;			// index of the group or port, 0 for rtypDpmDevInfo
+	WORD			rsv1;
+} DpmRecordHeader;
+
+typedef struct {
+	DpmRecordHeader	hdr;
+	DWORD			pdid;
+	WORD			fwVerRaw;
+	WORD			cfgVerRaw;
+	WORD			fsPlatcfg;
+	BYTE			cntVioPort;
+	BYTE			cnt5v0;
+	BYTE			cnt3v3;
+	BYTE			cntVadj;
+	BYTE			cntProbe;
+	BYTE			cntFan;
+	BYTE			rgfsProbeAttr[4];
+	SHORT			rgtemp[4];
+	BYTE			rgfsFanCap[4];
+	BYTE			rgfsFanConfig[4];
+	WORD			rgfanRpm[4];
+	DWORD			rsv1;
+} DpmDevRecord;
+
+typedef struct {
+	DpmRecordHeader	hdr;
+	WORD			currentAllowed5v0;
+	WORD			currentRequested5v0;
+	WORD			currentAllowed3v3;
+	WORD			currentRequested3v3;
+	WORD			vadjVoltage;
+	WORD			fsVadjOverride;
+	WORD			currentAllowedVadj;
+	WORD			currentRequestedVadj;
+} DpmPowerRecord;
+
+typedef struct {
+	DpmRecordHeader	hdr;
+	BYTE			i2cAddr;
+	BYTE			group5v0;
+	BYTE			group3v3;
+	BYTE			groupVio;
+	BYTE			portType;
+	BYTE			fsPortSts;
+	BYTE			fVioEnable;
+	BYTE			fDna;
+	WORD			voltage;
+	BYTE			fPdid;
+	BYTE			family;
+	BYTE			fCal;
+	BYTE			fsCal;
+	WORD			rsv1;
+	DWORD			pdid;
+	SzgStdFwRegs	fwRegs;
+	WORD			rsv2;
+	SzgDnaHeader	header;
+	char			szManufacturerName[cchDnaCacheStringMax+1];
+	char			szProductName[cchDnaCacheStringMax+1];
+	char			szProductModel[cchDnaCacheStringMax+1];
+	char			szProductVersion[cchDnaCacheStringMax+1];
+	char			szSerialNumber[cchDnaCacheStringMax+1];
+	BYTE			rgbFactCal[cbDnaCacheCalMax];
+	BYTE			rgbUserCal[cbDnaCacheCalMax];
+	DWORD			rgFactCalS18[2 * cZmodCalPairMax];
+	DWORD			rgUserCalS18[2 * cZmodCalPairMax];
+} DpmPortRecord;
+
+#pragma pack(pop)
+
+/* ------------------------------------------------------------ */
+/*                  Variable Declarations                       */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*                  Procedure Declarations                      */
+/* ------------------------------------------------------------ */
+
+size_t	SerializerJsonDevInfo(const dpmutildevInfo_t* pDevInfo, char* pchBuf, size_t cchBuf);
+size_t	SerializerJsonPowerInfo(BYTE cgroup, const dpmutilPowerInfo_t pPowerInfo[], char* pchBuf, size_t cchBuf);
+size_t	SerializerJsonPortInfo(BYTE cport, const dpmutilPortInfo_t pPortInfo[], char* pchBuf, size_t cchBuf);
+void	SerializerDevRecord(const dpmutildevInfo_t* pDevInfo, DpmDevRecord* prec);
+void	SerializerPowerRecord(BYTE igroup, const dpmutilPowerInfo_t* pPowerInfo, DpmPowerRecord* prec);
+void	SerializerPortRecord(BYTE iport, const dpmutilPortInfo_t* pPortInfo, DpmPortRecord* prec);
+BOOL	SerializerFWriteDevInfo(FILE* pfile, BYTE sfmt, const dpmutildevInfo_t* pDevInfo);
+BOOL	SerializerFWritePowerInfo(FILE* pfile, BYTE sfmt, BYTE cgroup, const dpmutilPowerInfo_t pPowerInfo[]);
+BOOL	SerializerFWritePortInfo(FILE* pfile, BYTE sfmt, BYTE cport, const dpmutilPortInfo_t pPortInfo[]);
+
+/* ------------------------------------------------------------ */
+
+#endif /* SERIALIZER_H_ */
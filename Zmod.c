@@ -15,6 +15,10 @@
 /*  Revision History:                                                   */
 /*                                                                      */
 /*  02/21/2024 (ArtVVB): created                                        */
+/*  10/14/2026: added ZmodCalConvertToS18                               */
+/*  10/14/2026: added the calibration loader, FZmodLoadCal              */
+/*  10/14/2026: family identification and calibration handling are now  */
+/*      driven by a per-family handler table                            */
 /*                                                                      */
 /************************************************************************/
 
@@ -33,6 +37,7 @@
 #include <stdio.h>
 #include <time.h>
 #include <stdlib.h>
+#include <string.h>
 #include "stdtypes.h"
 #include "syzygy.h"
 #include "Zmod.h"
@@ -58,16 +63,38 @@
 /*              Global Variables                                */
 /* ------------------------------------------------------------ */
 
+extern I2CHALThreadLocal BOOL dpmutilfVerbose;
 
 /* ------------------------------------------------------------ */
-/*              Local Variables                                 */
+/*              Forward Declarations                            */
 /* ------------------------------------------------------------ */
 
+static void	ZmodADCCalConvert(DWORD Pdid, const void* pvCal, void* pvCalS18);
+static void	ZmodADCDisplayCal(const void* pvFactCal, const void* pvUserCal);
+static void	ZmodDACCalConvert(DWORD Pdid, const void* pvCal, void* pvCalS18);
+static void	ZmodDACDisplayCal(const void* pvFactCal, const void* pvUserCal);
+static void	ZmodDigitizerCalConvert(DWORD Pdid, const void* pvCal, void* pvCalS18);
+static void	ZmodDigitizerDisplayCal(const void* pvFactCal, const void* pvUserCal);
 
 /* ------------------------------------------------------------ */
-/*              Forward Declarations                            */
+/*              Local Variables                                 */
 /* ------------------------------------------------------------ */
 
+/* Handler table indexed by ZMOD_FAMILY. FGetZmodFamily tries each entry
+** in order, so adding a family only requires adding an entry here.
+*/
+static const ZMOD_FAMILY_HANDLER rgzfhZmod[ZMOD_FAMILY_UNSUPPORTED] = {
+	{ ZMOD_FAMILY_ADC, "ZmodADC", FZmodIsADC,
+	  addrAdcFactCalStart, addrAdcUserCalStart, sizeof(ZMOD_ADC_CAL), sizeof(ZMOD_ADC_CAL_S18) / sizeof(unsigned int),
+	  ZmodADCCalConvert, ZmodADCDisplayCal },
+	{ ZMOD_FAMILY_DAC, "ZmodDAC", FZmodIsDAC,
+	  addrDacFactCalStart, addrDacUserCalStart, sizeof(ZMOD_DAC_CAL), sizeof(ZMOD_DAC_CAL_S18) / sizeof(unsigned int),
+	  ZmodDACCalConvert, ZmodDACDisplayCal },
+	{ ZMOD_FAMILY_DIGITIZER, "ZmodDigitizer", FZmodIsDigitizer,
+	  addrDigitizerFactCalStart, addrDigitizerUserCalStart, sizeof(ZMOD_DIGITIZER_CAL), sizeof(ZMOD_DIGITIZER_CAL_S18) / sizeof(unsigned int),
+	  ZmodDigitizerCalConvert, ZmodDigitizerDisplayCal }
+};
+
 
 /* ------------------------------------------------------------ */
 /*              Procedure Definitions                           */
@@ -95,8 +122,10 @@ FZmodReadPdid(int fdI2cDev, BYTE addrI2cSlave, DWORD *pPdid) {
     WORD            cbRead;
 
     if ( ! SyzygyI2cRead(fdI2cDev, addrI2cSlave, addrZmodPdidStart, (BYTE*)pPdid, sizeof(DWORD), &cbRead) ) {
-        printf("Error: failed to read PDID from 0x%02X\n", addrI2cSlave);
-        printf("Error: received %d of %d bytes\n", cbRead, sizeof(ZMOD_DIGITIZER_CAL));
+        if(dpmutilfVerbose){
+            printf("Error: failed to read PDID from 0x%02X\n", addrI2cSlave);
+            printf("Error: received %d of %d bytes\n", cbRead, sizeof(ZMOD_DIGITIZER_CAL));
+        }
         return fFalse;
     }
 
@@ -117,22 +146,339 @@ FZmodReadPdid(int fdI2cDev, BYTE addrI2cSlave, DWORD *pPdid) {
 **      none
 **
 **  Description:
-**      This function uses the product ID to identify a Zmod Family
+**      This function uses the product ID to identify a Zmod Family by
+**      calling the identification function of each family handler
 */
 BOOL
 FGetZmodFamily(DWORD Pdid, ZMOD_FAMILY *pFamily) {
-	if (FZmodIsADC(Pdid)) {
-		*pFamily = ZMOD_FAMILY_ADC;
-		return fTrue;
+
+	int		izfh;
+
+	for ( izfh = 0; izfh < ZMOD_FAMILY_UNSUPPORTED; izfh++ ) {
+		if ( rgzfhZmod[izfh].pfnIs(Pdid) ) {
+			*pFamily = rgzfhZmod[izfh].family;
+			return fTrue;
+		}
+	}
+
+	*pFamily = ZMOD_FAMILY_UNSUPPORTED;
+	return fFalse;
+}
+
+/* ------------------------------------------------------------ */
+/***    PzfhFromZmodFamily
+**
+**  Parameters:
+**      family			- Zmod family, result of FGetZmodFamily
+**
+**  Return Value:
+**      pointer to the handler of the family, NULL if the family is unsupported
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function returns the handler used to identify the family
+**      and to load, convert and display its calibration data.
+*/
+const ZMOD_FAMILY_HANDLER*
+PzfhFromZmodFamily(ZMOD_FAMILY family) {
+
+	if (( 0 > (int)family ) || ( ZMOD_FAMILY_UNSUPPORTED <= family )) {
+		return NULL;
+	}
+
+	return &rgzfhZmod[family];
+}
+
+/* ------------------------------------------------------------ */
+/***    ZmodCalConvertToS18
+**
+**  Parameters:
+**      pconv           - conversion table of the Zmod variant
+**      pvCal           - pointer to the float cal array of a calibration structure
+**      cpair           - number of coefficient pairs in the array
+**      pS18            - pointer to the unsigned int cal array of the
+**                        corresponding _S18 structure
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function converts an entire array of calibration
+**      coefficient pairs, as stored in Zmod flash ([...][0 multiplicative
+**      : 1 additive]), to the signed 18-bit format used in PL hardware
+**      in a single pass. The array is copied into an aligned local
+**      buffer first because the calibration structures are packed,
+**      after which the loop body has no branches or calls so that it
+**      can be vectorized by the compiler.
+**
+**      The arithmetic is performed in the same order and precision as
+**      the per coefficient ComputeMultCoef and ComputeAddCoef functions
+**      of each family, so the results are bit for bit identical.
+*/
+void
+ZmodCalConvertToS18(const ZMOD_CAL_CONV* pconv, const void* pvCal, int cpair, unsigned int* pS18) {
+
+	float			rgcal[2 * cZmodCalPairMax];
+	double			rgdMult[cZmodCalPairMax];
+	double			rgdAddNum[cZmodCalPairMax];
+	double			rgdAddDen[cZmodCalPairMax];
+	float			rgfCoef[2 * cZmodCalPairMax];
+	float			fGain;
+	int				ipair;
+	int				icoef;
+
+	if ( cZmodCalPairMax < cpair ) {
+		cpair = cZmodCalPairMax;
 	}
-	if (FZmodIsDAC(Pdid)) {
-		*pFamily = ZMOD_FAMILY_DAC;
-		return fTrue;
+
+	memcpy(rgcal, pvCal, cpair * 2 * sizeof(float));
+
+	/* Expand the scale table so that pair i uses element i.
+	*/
+	for ( ipair = 0; ipair < cpair; ipair++ ) {
+		rgdMult[ipair] = pconv->rgscale[ipair % pconv->cscale].dMult;
+		rgdAddNum[ipair] = pconv->rgscale[ipair % pconv->cscale].dAddNum;
+		rgdAddDen[ipair] = pconv->rgscale[ipair % pconv->cscale].dAddDen;
 	}
-	if (FZmodIsDigitizer(Pdid)) {
-		*pFamily = ZMOD_FAMILY_DIGITIZER;
-		return fTrue;
+
+	if ( pconv->fInvGain ) {
+		for ( ipair = 0; ipair < cpair; ipair++ ) {
+			fGain = 1 + rgcal[2*ipair];
+			rgfCoef[2*ipair] = rgdMult[ipair] / fGain;
+			rgfCoef[2*ipair+1] = (rgcal[2*ipair+1] * rgdAddNum[ipair]) / (rgdAddDen[ipair] * fGain);
+		}
 	}
-	*pFamily = ZMOD_FAMILY_UNSUPPORTED;
+	else {
+		for ( ipair = 0; ipair < cpair; ipair++ ) {
+			fGain = 1 + rgcal[2*ipair];
+			rgfCoef[2*ipair] = rgdMult[ipair] * fGain;
+			rgfCoef[2*ipair+1] = (rgcal[2*ipair+1] * rgdAddNum[ipair]) / rgdAddDen[ipair];
+		}
+	}
+
+	/* Round and truncate to 18 bits in a separate pass. The coefficients
+	** must be rounded to float first, as the per coefficient functions
+	** do, and keeping them in a float array ensures the vectorized loops
+	** above don't carry the double intermediate through to here.
+	*/
+	for ( icoef = 0; icoef < 2 * cpair; icoef++ ) {
+		pS18[icoef] = (unsigned int)((int32_t)(rgfCoef[icoef] + 0.5) & ((1<<18) - 1));
+	}
+}
+
+/* ------------------------------------------------------------ */
+/***    FZmodGetCalLayout
+**
+**  Parameters:
+**      family          - Zmod family, result of FGetZmodFamily
+**      paddrFactCal    - pointer to return the address of the factory calibration area
+**      paddrUserCal    - pointer to return the address of the user calibration area
+**      pcbCal          - pointer to return the size of each calibration area
+**
+**  Return Value:
+**      fTrue if the family has calibration areas, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function returns the location of the calibration areas in
+**      the DNA of a Zmod of the specified family.
+*/
+BOOL
+FZmodGetCalLayout(ZMOD_FAMILY family, WORD* paddrFactCal, WORD* paddrUserCal, WORD* pcbCal) {
+
+	const ZMOD_FAMILY_HANDLER*	pzfh;
+
+	pzfh = PzfhFromZmodFamily(family);
+	if (( NULL == pzfh ) || ( 0 == pzfh->cbCal )) {
+		return fFalse;
+	}
+
+	*paddrFactCal = pzfh->addrFactCal;
+	*paddrUserCal = pzfh->addrUserCal;
+	*pcbCal = pzfh->cbCal;
+
 	return fTrue;
 }
+
+/* ------------------------------------------------------------ */
+/***    FZmodCalChecksumValid
+**
+**  Parameters:
+**      pbCal           - pointer to a calibration area
+**      cbCal           - size of the calibration area
+**
+**  Return Value:
+**      fTrue if the checksum is valid, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      The last byte of each calibration area is generated by starting
+**      with 0 and subtracting every other byte of the area, so the
+**      bytes of a valid area, including the checksum, sum to 0.
+*/
+BOOL
+FZmodCalChecksumValid(const BYTE* pbCal, WORD cbCal) {
+
+	BYTE	bSum;
+	WORD	ib;
+
+	bSum = 0;
+	for ( ib = 0; ib < cbCal; ib++ ) {
+		bSum += pbCal[ib];
+	}
+
+	return ( 0 == bSum ) ? fTrue : fFalse;
+}
+
+/* ------------------------------------------------------------ */
+/***    FZmodLoadCal
+**
+**  Parameters:
+**      fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      addrI2cSlave    - I2C bus address for the slave
+**      family          - Zmod family, result of FGetZmodFamily
+**      calpol          - zcalpol* policy selecting which areas to read
+**      pbFactCal       - buffer to receive the factory calibration area
+**      pbUserCal       - buffer to receive the user calibration area
+**      pfsCal          - pointer to return fsZmodCal* flags describing
+**                        which areas were read and which are valid
+**
+**  Return Value:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function reads only the calibration areas required by the
+**      specified policy and validates the checksum of each area read.
+**      A checksum failure isn't considered an error. Buffers of areas
+**      that weren't read are left untouched. Each buffer must be large
+**      enough to hold the calibration area of the family.
+*/
+BOOL
+FZmodLoadCal(int fdI2cDev, BYTE addrI2cSlave, ZMOD_FAMILY family, BYTE calpol, BYTE* pbFactCal, BYTE* pbUserCal, BYTE* pfsCal) {
+
+	WORD	addrFactCal;
+	WORD	addrUserCal;
+	WORD	cbCal;
+	BYTE	fsCal;
+
+	*pfsCal = 0;
+
+	if ( ! FZmodGetCalLayout(family, &addrFactCal, &addrUserCal, &cbCal) ) {
+		return fFalse;
+	}
+
+	fsCal = 0;
+
+	if ( zcalpolFactoryOnly != calpol ) {
+		if ( ! SyzygyI2cRead(fdI2cDev, addrI2cSlave, addrUserCal, pbUserCal, cbCal, NULL) ) {
+			if(dpmutilfVerbose)printf("Error: failed to read user calibration from 0x%02X\n", addrI2cSlave);
+			return fFalse;
+		}
+		fsCal |= fsZmodCalUserRead;
+		if ( FZmodCalChecksumValid(pbUserCal, cbCal) ) {
+			fsCal |= fsZmodCalUserValid;
+		}
+	}
+
+	if (( zcalpolPreferUser != calpol ) || ( 0 == (fsCal & fsZmodCalUserValid) )) {
+		if ( ! SyzygyI2cRead(fdI2cDev, addrI2cSlave, addrFactCal, pbFactCal, cbCal, NULL) ) {
+			if(dpmutilfVerbose)printf("Error: failed to read factory calibration from 0x%02X\n", addrI2cSlave);
+			return fFalse;
+		}
+		fsCal |= fsZmodCalFactRead;
+		if ( FZmodCalChecksumValid(pbFactCal, cbCal) ) {
+			fsCal |= fsZmodCalFactValid;
+		}
+	}
+
+	*pfsCal = fsCal;
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    ZmodADCCalConvert, ZmodDACCalConvert, ZmodDigitizerCalConvert
+**
+**  Parameters:
+**      Pdid            - product ID, selects the variant
+**      pvCal           - pointer to the family's ZMOD_*_CAL structure
+**      pvCalS18        - pointer to the family's ZMOD_*_CAL_S18 structure
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      Handler table adapters for the FZmod*CalConvertVariant functions.
+*/
+static void
+ZmodADCCalConvert(DWORD Pdid, const void* pvCal, void* pvCalS18) {
+
+	ZMOD_ADC_VARIANT	variant;
+
+	FGetZmodADCVariant(Pdid, &variant);
+	FZmodADCCalConvertVariant((const ZMOD_ADC_CAL*)pvCal, variant, (ZMOD_ADC_CAL_S18*)pvCalS18);
+}
+
+static void
+ZmodDACCalConvert(DWORD Pdid, const void* pvCal, void* pvCalS18) {
+
+	ZMOD_DAC_VARIANT	variant;
+
+	FGetZmodDACVariant(Pdid, &variant);
+	FZmodDACCalConvertVariant((const ZMOD_DAC_CAL*)pvCal, variant, (ZMOD_DAC_CAL_S18*)pvCalS18);
+}
+
+static void
+ZmodDigitizerCalConvert(DWORD Pdid, const void* pvCal, void* pvCalS18) {
+
+	ZMOD_DIGITIZER_VARIANT	variant;
+
+	FGetZmodDigitizerVariant(Pdid, &variant);
+	FZmodDigitizerCalConvertVariant((const ZMOD_DIGITIZER_CAL*)pvCal, variant, (ZMOD_DIGITIZER_CAL_S18*)pvCalS18);
+}
+
+/* ------------------------------------------------------------ */
+/***    ZmodADCDisplayCal, ZmodDACDisplayCal, ZmodDigitizerDisplayCal
+**
+**  Parameters:
+**      pvFactCal       - pointer to the factory ZMOD_*_CAL structure, or NULL
+**      pvUserCal       - pointer to the user ZMOD_*_CAL structure, or NULL
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      Handler table adapters for the DisplayZmod*CalData functions.
+*/
+static void
+ZmodADCDisplayCal(const void* pvFactCal, const void* pvUserCal) {
+	DisplayZmodADCCalData((const ZMOD_ADC_CAL*)pvFactCal, (const ZMOD_ADC_CAL*)pvUserCal);
+}
+
+static void
+ZmodDACDisplayCal(const void* pvFactCal, const void* pvUserCal) {
+	DisplayZmodDACCalData((const ZMOD_DAC_CAL*)pvFactCal, (const ZMOD_DAC_CAL*)pvUserCal);
+}
+
+static void
+ZmodDigitizerDisplayCal(const void* pvFactCal, const void* pvUserCal) {
+	DisplayZmodDigitizerCalData((const ZMOD_DIGITIZER_CAL*)pvFactCal, (const ZMOD_DIGITIZER_CAL*)pvUserCal);
+}
@@ -16,12 +16,39 @@
 /*  Revision History:                                                   */
 /*                                                                      */
 /*  02/21/2024 (ArtVVB): created                                        */
+/*  10/14/2026: added ZmodCalConvertToS18                               */
+/*  10/14/2026: added the calibration loader, FZmodLoadCal              */
+/*  10/14/2026: added the per-family handler table                      */
+/*  10/14/2026: added the number of S18 coefficients to the handler     */
+/*              table                                                   */
 /*                                                                      */
 /************************************************************************/
 
 #ifndef ZMOD_H_
 #define ZMOD_H_
 
+/* Define the maximum number of multiplicative/additive coefficient pairs
+** in a calibration structure, which is the 7 frequency steps of the
+** ZmodDigitizer times 2 channels.
+*/
+#define cZmodCalPairMax		14
+
+/* Define the policies used by FZmodLoadCal to decide which calibration
+** areas to read.
+*/
+#define zcalpolBoth			0	// read the factory and user areas
+#define zcalpolPreferUser	1	// read the user area, and the factory area only if the user area is invalid
+#define zcalpolFactoryOnly	2	// read the factory area
+
+/* Define the flags returned by FZmodLoadCal.
+*/
+#define fsZmodCalFactRead	0x01	// the factory area was read
+#define fsZmodCalFactValid	0x02	// the factory area checksum is valid
+#define fsZmodCalUserRead	0x04	// the user area was read
+#define fsZmodCalUserValid	0x08	// the user area checksum is valid
+#define fsZmodCalFactOk		(fsZmodCalFactRead | fsZmodCalFactValid)	// the factory area can be used
+#define fsZmodCalUserOk		(fsZmodCalUserRead | fsZmodCalUserValid)	// the user area can be used
+
 typedef enum {
 	ZMOD_FAMILY_ADC=0,
 	ZMOD_FAMILY_DAC,
@@ -29,7 +56,54 @@ typedef enum {
 	ZMOD_FAMILY_UNSUPPORTED
 } ZMOD_FAMILY;
 
+/* Describes how one pair of calibration coefficients, the gain cg and
+** the additive ca, is converted to the signed 18-bit format used by PL
+** calibration hardware:
+**      mult = dMult * (1 + cg)                 or dMult / (1 + cg)
+**      add  = (ca * dAddNum) / dAddDen         or (ca * dAddNum) / (dAddDen * (1 + cg))
+** where the second form is used when fInvGain is set. The power of two
+** scale of the PL format is folded into dMult and dAddNum.
+*/
+typedef struct {
+	double	dMult;
+	double	dAddNum;
+	double	dAddDen;
+} ZMOD_CAL_SCALE;
+
+/* Describes the conversion for every coefficient pair of a Zmod variant.
+** Pair i of a calibration structure uses rgscale[i % cscale], so the ADC
+** and DAC, whose pairs alternate between low and high gain, use two
+** scales and the Digitizer uses one.
+*/
+typedef struct {
+	BOOL			fInvGain;
+	BYTE			cscale;
+	ZMOD_CAL_SCALE	rgscale[2];
+} ZMOD_CAL_CONV;
+
+/* Operations implemented by each Zmod family, looked up with
+** PzfhFromZmodFamily. The calibration pointers refer to the family's
+** ZMOD_*_CAL and ZMOD_*_CAL_S18 structures. Families without
+** calibration areas have a cbCal of 0 and NULL calibration functions.
+*/
+typedef struct {
+	ZMOD_FAMILY	family;
+	const char*	szName;
+	BOOL		(*pfnIs)(DWORD Pdid);
+	WORD		addrFactCal;
+	WORD		addrUserCal;
+	WORD		cbCal;
+	BYTE		ccoefS18;		// number of coefficients in the ZMOD_*_CAL_S18 structure
+	void		(*pfnCalConvertToS18)(DWORD Pdid, const void* pvCal, void* pvCalS18);
+	void		(*pfnDisplayCal)(const void* pvFactCal, const void* pvUserCal);
+} ZMOD_FAMILY_HANDLER;
+
 BOOL	FZmodReadPdid(int fdI2cDev, BYTE addrI2cSlave, DWORD *pPdid);
 BOOL	FGetZmodFamily(DWORD Pdid, ZMOD_FAMILY *pFamily);
+const ZMOD_FAMILY_HANDLER*	PzfhFromZmodFamily(ZMOD_FAMILY family);
+void	ZmodCalConvertToS18(const ZMOD_CAL_CONV* pconv, const void* pvCal, int cpair, unsigned int* pS18);
+BOOL	FZmodGetCalLayout(ZMOD_FAMILY family, WORD* paddrFactCal, WORD* paddrUserCal, WORD* pcbCal);
+BOOL	FZmodCalChecksumValid(const BYTE* pbCal, WORD cbCal);
+BOOL	FZmodLoadCal(int fdI2cDev, BYTE addrI2cSlave, ZMOD_FAMILY family, BYTE calpol, BYTE* pbFactCal, BYTE* pbUserCal, BYTE* pfsCal);
 
 #endif
@@ -24,6 +24,9 @@
 /*  01/15/2020 (MichaelA): modified FDisplayZmodADCCal to display the   */
 /*      raw calibration constants as retrieved from flash               */
 /*  02/21/2024 (ArtVVB): added identification functions                 */
+/*  10/14/2026: added FZmodADCCalConvertVariant, which converts         */
+/*      all coefficients in one pass using a per-variant table          */
+/*  10/14/2026: DisplayZmodADCCalData skips areas that weren't read     */
 /*                                                                      */
 /************************************************************************/
 
@@ -39,9 +42,11 @@
 #endif
 #include <stdio.h>
 #include <time.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include "stdtypes.h"
 #include "syzygy.h"
+#include "Zmod.h"
 #include "ZmodADC.h"
 
 /* ------------------------------------------------------------ */
@@ -53,6 +58,14 @@
 #define ADC1410_REAL_RANGE_ADC_HIGH     1.086
 #define ADC1410_REAL_RANGE_ADC_LOW      26.25
 
+/* Conversion of a pair of ZmodADC1410 coefficients for low and high gain
+** to the 18-bit signed format, equivalent to ComputeMultCoefADC1410 and
+** ComputeAddCoefADC1410.
+*/
+#define ADC1410_CAL_CONV	{ fFalse, 2, { \
+	{ (ADC1410_REAL_RANGE_ADC_LOW/ADC1410_IDEAL_RANGE_ADC_LOW)*(double)(1<<16), (double)(1<<17), ADC1410_IDEAL_RANGE_ADC_LOW }, \
+	{ (ADC1410_REAL_RANGE_ADC_HIGH/ADC1410_IDEAL_RANGE_ADC_HIGH)*(double)(1<<16), (double)(1<<17), ADC1410_IDEAL_RANGE_ADC_HIGH } } }
+
 /* ------------------------------------------------------------ */
 /*              Local Type Definitions                          */
 /* ------------------------------------------------------------ */
@@ -62,12 +75,26 @@
 /*              Global Variables                                */
 /* ------------------------------------------------------------ */
 
-extern BOOL dpmutilfVerbose;
+extern I2CHALThreadLocal BOOL dpmutilfVerbose;
 
 /* ------------------------------------------------------------ */
 /*              Local Variables                                 */
 /* ------------------------------------------------------------ */
 
+/* Coefficient conversion table indexed by ZMOD_ADC_VARIANT. Every
+** variant uses the ADC1410 ranges, and so do unsupported variants as
+** FZmodADCCalConvertToS18 always has.
+*/
+static const ZMOD_CAL_CONV rgconvAdc[ZMOD_ADC_VARIANT_UNSUPPORTED + 1] = {
+	ADC1410_CAL_CONV,	// ZMOD_ADC_VARIANT_1410_105
+	ADC1410_CAL_CONV,	// ZMOD_ADC_VARIANT_1010_40
+	ADC1410_CAL_CONV,	// ZMOD_ADC_VARIANT_1210_40
+	ADC1410_CAL_CONV,	// ZMOD_ADC_VARIANT_1410_40
+	ADC1410_CAL_CONV,	// ZMOD_ADC_VARIANT_1010_125
+	ADC1410_CAL_CONV,	// ZMOD_ADC_VARIANT_1210_125
+	ADC1410_CAL_CONV,	// ZMOD_ADC_VARIANT_1410_125
+	ADC1410_CAL_CONV	// ZMOD_ADC_VARIANT_UNSUPPORTED
+};
 
 /* ------------------------------------------------------------ */
 /*              Forward Declarations                            */
@@ -75,6 +102,7 @@ extern BOOL dpmutilfVerbose;
 
 int32_t ComputeMultCoefADC1410(float cg, BOOL fHighGain);
 int32_t ComputeAddCoefADC1410(float ca, BOOL fHighGain);
+static void DisplayZmodADCCalArea(const char* szLabel, const ZMOD_ADC_CAL* padcal);
 
 /* ------------------------------------------------------------ */
 /*              Procedure Definitions                           */
@@ -102,73 +130,95 @@ int32_t ComputeAddCoefADC1410(float ca, BOOL fHighGain);
 BOOL
 FDisplayZmodADCCal(int fdI2cDev, BYTE addrI2cSlave) {
 
-    ZMOD_ADC_CAL    adcal;
-    WORD            cbRead;
-    time_t          t;
-    struct tm       time;
-    char            szDate[256];
+    ZMOD_ADC_CAL    adcalFactory;
+    ZMOD_ADC_CAL    adcalUser;
 
-    if ( ! SyzygyI2cRead(fdI2cDev, addrI2cSlave, addrAdcFactCalStart, (BYTE*)&adcal, sizeof(ZMOD_ADC_CAL), &cbRead) ) {
-        printf("Error: failed to read ZmodADC factory calibration from 0x%02X\n", addrI2cSlave);
-        printf("Error: received %d of %d bytes\n", cbRead, sizeof(ZMOD_ADC_CAL));
+    if ( ! FGetZmodADCCal(fdI2cDev, addrI2cSlave, &adcalFactory, &adcalUser) ) {
         return fFalse;
     }
 
-    t = (time_t)adcal.date;
-    localtime_r(&t, &time);
-    if ( 0 != strftime(szDate, sizeof(szDate), "%B %d, %Y at %T", &time) ) {
-        printf("\n    Factory Calibration:   %s\n", szDate);
-    }
+    DisplayZmodADCCalData(&adcalFactory, &adcalUser);
 
-    printf("    CHAN_1_LG_GAIN:        %f\n", adcal.cal[0][0][0]);
-    printf("    CHAN_1_LG_OFFSET:      %f\n", adcal.cal[0][0][1]);
-    printf("    CHAN_1_HG_GAIN:        %f\n", adcal.cal[0][1][0]);
-    printf("    CHAN_1_HG_OFFSET:      %f\n", adcal.cal[0][1][1]);
-    printf("    CHAN_2_LG_GAIN:        %f\n", adcal.cal[1][0][0]);
-    printf("    CHAN_2_LG_OFFSET:      %f\n", adcal.cal[1][0][1]);
-    printf("    CHAN_2_HG_GAIN:        %f\n", adcal.cal[1][1][0]);
-    printf("    CHAN_2_HG_OFFSET:      %f\n", adcal.cal[1][1][1]);
-
-    printf("    Ch1LgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefADC1410(adcal.cal[0][0][0], fFalse));
-    printf("    Ch1LgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefADC1410(adcal.cal[0][0][1], fFalse));
-    printf("    Ch1HgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefADC1410(adcal.cal[0][1][0], fTrue));
-    printf("    Ch1HgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefADC1410(adcal.cal[0][1][1], fTrue));
-    printf("    Ch2LgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefADC1410(adcal.cal[1][0][0], fFalse));
-    printf("    Ch2LgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefADC1410(adcal.cal[1][0][1], fFalse));
-    printf("    Ch2HgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefADC1410(adcal.cal[1][1][0], fTrue));
-    printf("    Ch2HgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefADC1410(adcal.cal[1][1][1], fTrue));
-
-    if ( ! SyzygyI2cRead(fdI2cDev, addrI2cSlave, addrAdcUserCalStart, (BYTE*)&adcal, sizeof(ZMOD_ADC_CAL), &cbRead) ) {
-        printf("Error: failed to read ZmodADC user calibration from 0x%02X\n", addrI2cSlave);
-        printf("Error: received %d of %d bytes\n", cbRead, sizeof(ZMOD_ADC_CAL));
-        return fFalse;
+    return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    DisplayZmodADCCalData
+**
+**  Parameters:
+**      pFactoryCal		- pointer to the factory calibration data, or NULL
+**      pUserCal		- pointer to the user calibration data, or NULL
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function computes the multiplicative and additive
+**      coefficients for calibration data that has already been read
+**      from a ZmodADC and then displays them using stdout. Either
+**      pointer may be NULL if that calibration area wasn't read.
+*/
+void
+DisplayZmodADCCalData(const ZMOD_ADC_CAL* pFactoryCal, const ZMOD_ADC_CAL* pUserCal) {
+
+    if ( NULL != pFactoryCal ) {
+        DisplayZmodADCCalArea("Factory Calibration:   ", pFactoryCal);
+    }
+    if ( NULL != pUserCal ) {
+        DisplayZmodADCCalArea("User Calibration:      ", pUserCal);
     }
+}
+
+/* ------------------------------------------------------------ */
+/***    DisplayZmodADCCalArea
+**
+**  Parameters:
+**      szLabel         - label to display in front of the calibration date
+**      padcal          - pointer to the calibration data to display
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function displays the contents of a single calibration area
+**      along with the coefficients computed from it.
+*/
+static void
+DisplayZmodADCCalArea(const char* szLabel, const ZMOD_ADC_CAL* padcal) {
+
+    time_t          t;
+    struct tm       time;
+    char            szDate[256];
 
-    t = (time_t)adcal.date;
+    t = (time_t)padcal->date;
     localtime_r(&t, &time);
     if ( 0 != strftime(szDate, sizeof(szDate), "%B %d, %Y at %T", &time) ) {
-        printf("\n    User Calibration:      %s\n", szDate);
+        printf("\n    %s%s\n", szLabel, szDate);
     }
 
-    printf("    CHAN_1_LG_GAIN:        %f\n", adcal.cal[0][0][0]);
-    printf("    CHAN_1_LG_OFFSET:      %f\n", adcal.cal[0][0][1]);
-    printf("    CHAN_1_HG_GAIN:        %f\n", adcal.cal[0][1][0]);
-    printf("    CHAN_1_HG_OFFSET:      %f\n", adcal.cal[0][1][1]);
-    printf("    CHAN_2_LG_GAIN:        %f\n", adcal.cal[1][0][0]);
-    printf("    CHAN_2_LG_OFFSET:      %f\n", adcal.cal[1][0][1]);
-    printf("    CHAN_2_HG_GAIN:        %f\n", adcal.cal[1][1][0]);
-    printf("    CHAN_2_HG_OFFSET:      %f\n", adcal.cal[1][1][1]);
-
-    printf("    Ch1LgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefADC1410(adcal.cal[0][0][0], fFalse));
-    printf("    Ch1LgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefADC1410(adcal.cal[0][0][1], fFalse));
-    printf("    Ch1HgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefADC1410(adcal.cal[0][1][0], fTrue));
-    printf("    Ch1HgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefADC1410(adcal.cal[0][1][1], fTrue));
-    printf("    Ch2LgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefADC1410(adcal.cal[1][0][0], fFalse));
-    printf("    Ch2LgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefADC1410(adcal.cal[1][0][1], fFalse));
-    printf("    Ch2HgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefADC1410(adcal.cal[1][1][0], fTrue));
-    printf("    Ch2HgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefADC1410(adcal.cal[1][1][1], fTrue));
-
-    return fTrue;
+    printf("    CHAN_1_LG_GAIN:        %f\n", padcal->cal[0][0][0]);
+    printf("    CHAN_1_LG_OFFSET:      %f\n", padcal->cal[0][0][1]);
+    printf("    CHAN_1_HG_GAIN:        %f\n", padcal->cal[0][1][0]);
+    printf("    CHAN_1_HG_OFFSET:      %f\n", padcal->cal[0][1][1]);
+    printf("    CHAN_2_LG_GAIN:        %f\n", padcal->cal[1][0][0]);
+    printf("    CHAN_2_LG_OFFSET:      %f\n", padcal->cal[1][0][1]);
+    printf("    CHAN_2_HG_GAIN:        %f\n", padcal->cal[1][1][0]);
+    printf("    CHAN_2_HG_OFFSET:      %f\n", padcal->cal[1][1][1]);
+
+    printf("    Ch1LgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefADC1410(padcal->cal[0][0][0], fFalse));
+    printf("    Ch1LgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefADC1410(padcal->cal[0][0][1], fFalse));
+    printf("    Ch1HgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefADC1410(padcal->cal[0][1][0], fTrue));
+    printf("    Ch1HgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefADC1410(padcal->cal[0][1][1], fTrue));
+    printf("    Ch2LgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefADC1410(padcal->cal[1][0][0], fFalse));
+    printf("    Ch2LgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefADC1410(padcal->cal[1][0][1], fFalse));
+    printf("    Ch2HgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefADC1410(padcal->cal[1][1][0], fTrue));
+    printf("    Ch2HgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefADC1410(padcal->cal[1][1][1], fTrue));
 }
 
 /* ------------------------------------------------------------ */
@@ -197,14 +247,18 @@ FGetZmodADCCal(int fdI2cDev, BYTE addrI2cSlave, ZMOD_ADC_CAL *pFactoryCal, ZMOD_
     WORD            cbRead;
 
     if ( ! SyzygyI2cRead(fdI2cDev, addrI2cSlave, addrAdcFactCalStart, (BYTE*)pFactoryCal, sizeof(ZMOD_ADC_CAL), &cbRead) ) {
-        printf("Error: failed to read ZmodADC factory calibration from 0x%02X\n", addrI2cSlave);
-        printf("Error: received %d of %d bytes\n", cbRead, sizeof(ZMOD_ADC_CAL));
+        if(dpmutilfVerbose){
+            printf("Error: failed to read ZmodADC factory calibration from 0x%02X\n", addrI2cSlave);
+            printf("Error: received %d of %d bytes\n", cbRead, sizeof(ZMOD_ADC_CAL));
+        }
         return fFalse;
     }
 
     if ( ! SyzygyI2cRead(fdI2cDev, addrI2cSlave, addrAdcUserCalStart, (BYTE*)pUserCal, sizeof(ZMOD_ADC_CAL), &cbRead) ) {
-        printf("Error: failed to read ZmodADC user calibration from 0x%02X\n", addrI2cSlave);
-        printf("Error: received %d of %d bytes\n", cbRead, sizeof(ZMOD_ADC_CAL));
+        if(dpmutilfVerbose){
+            printf("Error: failed to read ZmodADC user calibration from 0x%02X\n", addrI2cSlave);
+            printf("Error: received %d of %d bytes\n", cbRead, sizeof(ZMOD_ADC_CAL));
+        }
         return fFalse;
     }
 
@@ -226,17 +280,38 @@ FGetZmodADCCal(int fdI2cDev, BYTE addrI2cSlave, ZMOD_ADC_CAL *pFactoryCal, ZMOD_
 **
 **  Description:
 **      This function converts calibration coefficients to the 18-bit signed format used in PL hardware.
+**      See FZmodADCCalConvertVariant, which avoids copying the calibration structure.
 */
 void
 FZmodADCCalConvertToS18(ZMOD_ADC_CAL adcal, ZMOD_ADC_CAL_S18 *pReturn) {
-	pReturn->cal[0][0][0] = (unsigned int)ComputeMultCoefADC1410(adcal.cal[0][0][0], fFalse);
-	pReturn->cal[0][0][1] = (unsigned int)ComputeAddCoefADC1410(adcal.cal[0][0][1], fFalse);
-	pReturn->cal[0][1][0] = (unsigned int)ComputeMultCoefADC1410(adcal.cal[0][1][0], fTrue);
-	pReturn->cal[0][1][1] = (unsigned int)ComputeAddCoefADC1410(adcal.cal[0][1][1], fTrue);
-	pReturn->cal[1][0][0] = (unsigned int)ComputeMultCoefADC1410(adcal.cal[1][0][0], fFalse);
-	pReturn->cal[1][0][1] = (unsigned int)ComputeAddCoefADC1410(adcal.cal[1][0][1], fFalse);
-	pReturn->cal[1][1][0] = (unsigned int)ComputeMultCoefADC1410(adcal.cal[1][1][0], fTrue);
-	pReturn->cal[1][1][1] = (unsigned int)ComputeAddCoefADC1410(adcal.cal[1][1][1], fTrue);
+	FZmodADCCalConvertVariant(&adcal, ZMOD_ADC_VARIANT_UNSUPPORTED, pReturn);
+}
+
+/* ------------------------------------------------------------ */
+/***    FZmodADCCalConvertVariant
+**
+**  Parameters:
+**      padcal			- pointer to the calibration coefficients to convert
+**      variant			- Zmod ADC variant, result of FGetZmodADCVariant
+**      pReturn			- ZMOD_ADC_CAL_S18 object to return data by argument
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function converts all of the calibration coefficients to the
+**      18-bit signed format used in PL hardware in a single pass, using
+**      the precomputed conversion table of the specified variant.
+*/
+void
+FZmodADCCalConvertVariant(const ZMOD_ADC_CAL* padcal, ZMOD_ADC_VARIANT variant, ZMOD_ADC_CAL_S18 *pReturn) {
+	if (( 0 > (int)variant ) || ( ZMOD_ADC_VARIANT_UNSUPPORTED < variant )) {
+		variant = ZMOD_ADC_VARIANT_UNSUPPORTED;
+	}
+	ZmodCalConvertToS18(&rgconvAdc[variant], (const BYTE*)padcal + offsetof(ZMOD_ADC_CAL, cal), 4, &pReturn->cal[0][0][0]);
 }
 
 /* ------------------------------------------------------------ */
@@ -80,7 +80,9 @@ typedef enum {
 
 BOOL    FDisplayZmodADCCal(int fdI2cDev, BYTE addrI2cSlave);
 BOOL    FGetZmodADCCal(int fdI2cDev, BYTE addrI2cSlave, ZMOD_ADC_CAL* pFactoryCal, ZMOD_ADC_CAL* pUserCal);
+void    DisplayZmodADCCalData(const ZMOD_ADC_CAL* pFactoryCal, const ZMOD_ADC_CAL* pUserCal);
 void    FZmodADCCalConvertToS18(ZMOD_ADC_CAL adcal, ZMOD_ADC_CAL_S18 *pReturn);
+void    FZmodADCCalConvertVariant(const ZMOD_ADC_CAL* pcal, ZMOD_ADC_VARIANT variant, ZMOD_ADC_CAL_S18 *pReturn);
 BOOL 	FZmodIsADC(DWORD Pdid);
 BOOL	FGetZmodADCVariant(DWORD Pdid, ZMOD_ADC_VARIANT *pVariant);
 BOOL 	FGetZmodADCResolution(ZMOD_ADC_VARIANT variant, DWORD *pResolution);
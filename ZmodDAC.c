@@ -27,6 +27,9 @@
 /*  01/15/2020 (MichaelA): modified FDisplayZmodDACCal to display the   */
 /*      raw calibration constants as retrieved from flash               */
 /*  02/21/2024 (ArtVVB): added identification functions                 */
+/*  10/14/2026: added FZmodDACCalConvertVariant, which converts         */
+/*      all coefficients in one pass using a per-variant table          */
+/*  10/14/2026: DisplayZmodDACCalData skips areas that weren't read     */
 /*                                                                      */
 /************************************************************************/
 
@@ -42,9 +45,11 @@
 #endif
 #include <stdio.h>
 #include <time.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include "stdtypes.h"
 #include "syzygy.h"
+#include "Zmod.h"
 #include "ZmodDAC.h"
 
 /* ------------------------------------------------------------ */
@@ -56,6 +61,14 @@
 #define DAC1411_REAL_RANGE_DAC_HIGH     5.32
 #define DAC1411_REAL_RANGE_DAC_LOW      1.33
 
+/* Conversion of a pair of ZmodDAC1411 coefficients for low and high gain
+** to the 18-bit signed format, equivalent to ComputeMultCoefDAC1411 and
+** ComputeAddCoefDAC1411.
+*/
+#define DAC1411_CAL_CONV	{ fTrue, 2, { \
+	{ (DAC1411_IDEAL_RANGE_DAC_LOW/DAC1411_REAL_RANGE_DAC_LOW)*(double)(1<<16), -(double)(1<<17), DAC1411_REAL_RANGE_DAC_LOW }, \
+	{ (DAC1411_IDEAL_RANGE_DAC_HIGH/DAC1411_REAL_RANGE_DAC_HIGH)*(double)(1<<16), -(double)(1<<17), DAC1411_REAL_RANGE_DAC_HIGH } } }
+
 /* ------------------------------------------------------------ */
 /*              Local Type Definitions                          */
 /* ------------------------------------------------------------ */
@@ -65,12 +78,19 @@
 /*              Global Variables                                */
 /* ------------------------------------------------------------ */
 
-extern BOOL dpmutilfVerbose;
+extern I2CHALThreadLocal BOOL dpmutilfVerbose;
 
 /* ------------------------------------------------------------ */
 /*              Local Variables                                 */
 /* ------------------------------------------------------------ */
 
+/* Coefficient conversion table indexed by ZMOD_DAC_VARIANT. Unsupported
+** variants use the DAC1411 ranges as FZmodDACCalConvertToS18 always has.
+*/
+static const ZMOD_CAL_CONV rgconvDac[ZMOD_DAC_VARIANT_UNSUPPORTED + 1] = {
+	DAC1411_CAL_CONV,	// ZMOD_DAC_VARIANT_1411_125
+	DAC1411_CAL_CONV	// ZMOD_DAC_VARIANT_UNSUPPORTED
+};
 
 /* ------------------------------------------------------------ */
 /*              Forward Declarations                            */
@@ -78,6 +98,7 @@ extern BOOL dpmutilfVerbose;
 
 int32_t ComputeMultCoefDAC1411(float cg, BOOL fHighGain);
 int32_t ComputeAddCoefDAC1411(float ca, float cg, BOOL fHighGain);
+static void DisplayZmodDACCalArea(const char* szLabel, const ZMOD_DAC_CAL* pdacal);
 
 /* ------------------------------------------------------------ */
 /*              Procedure Definitions                           */
@@ -105,73 +126,95 @@ int32_t ComputeAddCoefDAC1411(float ca, float cg, BOOL fHighGain);
 BOOL
 FDisplayZmodDACCal(int fdI2cDev, BYTE addrI2cSlave) {
 
-    ZMOD_DAC_CAL    dacal;
-    WORD            cbRead;
-    time_t          t;
-    struct tm       time;
-    char            szDate[256];
+    ZMOD_DAC_CAL    dacalFactory;
+    ZMOD_DAC_CAL    dacalUser;
 
-    if ( ! SyzygyI2cRead(fdI2cDev, addrI2cSlave, addrDacFactCalStart, (BYTE*)&dacal, sizeof(ZMOD_DAC_CAL), &cbRead) ) {
-        printf("Error: failed to read ZmodDAC factory calibration from 0x%02X\n", addrI2cSlave);
-        printf("Error: received %d of %d bytes\n", cbRead, sizeof(ZMOD_DAC_CAL));
+    if ( ! FGetZmodDACCal(fdI2cDev, addrI2cSlave, &dacalFactory, &dacalUser) ) {
         return fFalse;
     }
 
-    t = (time_t)dacal.date;
-    localtime_r(&t, &time);
-    if ( 0 != strftime(szDate, sizeof(szDate), "%B %d, %Y at %T", &time) ) {
-        printf("\n    Factory Calibration:   %s\n", szDate);
-    }
+    DisplayZmodDACCalData(&dacalFactory, &dacalUser);
 
-    printf("    CHAN_1_LG_GAIN:        %f\n", dacal.cal[0][0][0]);
-    printf("    CHAN_1_LG_OFFSET:      %f\n", dacal.cal[0][0][1]);
-    printf("    CHAN_1_HG_GAIN:        %f\n", dacal.cal[0][1][0]);
-    printf("    CHAN_1_HG_OFFSET:      %f\n", dacal.cal[0][1][1]);
-    printf("    CHAN_2_LG_GAIN:        %f\n", dacal.cal[1][0][0]);
-    printf("    CHAN_2_LG_OFFSET:      %f\n", dacal.cal[1][0][1]);
-    printf("    CHAN_2_HG_GAIN:        %f\n", dacal.cal[1][1][0]);
-    printf("    CHAN_2_HG_OFFSET:      %f\n", dacal.cal[1][1][1]);
-
-    printf("    Ch1LgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefDAC1411(dacal.cal[0][0][0], fFalse));
-    printf("    Ch1LgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefDAC1411(dacal.cal[0][0][1], dacal.cal[0][0][0], fFalse));
-    printf("    Ch1HgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefDAC1411(dacal.cal[0][1][0], fTrue));
-    printf("    Ch1HgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefDAC1411(dacal.cal[0][1][1], dacal.cal[0][1][0], fTrue));
-    printf("    Ch2LgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefDAC1411(dacal.cal[1][0][0], fFalse));
-    printf("    Ch2LgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefDAC1411(dacal.cal[1][0][1], dacal.cal[1][0][0], fFalse));
-    printf("    Ch2HgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefDAC1411(dacal.cal[1][1][0], fTrue));
-    printf("    Ch2HgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefDAC1411(dacal.cal[1][1][1], dacal.cal[1][1][0], fTrue));
-
-    if ( ! SyzygyI2cRead(fdI2cDev, addrI2cSlave, addrDacUserCalStart, (BYTE*)&dacal, sizeof(ZMOD_DAC_CAL), &cbRead) ) {
-        printf("Error: failed to read ZmodDAC user calibration from 0x%02X\n", addrI2cSlave);
-        printf("Error: received %d of %d bytes\n", cbRead, sizeof(ZMOD_DAC_CAL));
-        return fFalse;
+    return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    DisplayZmodDACCalData
+**
+**  Parameters:
+**      pFactoryCal		- pointer to the factory calibration data, or NULL
+**      pUserCal		- pointer to the user calibration data, or NULL
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function computes the multiplicative and additive
+**      coefficients for calibration data that has already been read
+**      from a ZmodDAC and then displays them using stdout. Either
+**      pointer may be NULL if that calibration area wasn't read.
+*/
+void
+DisplayZmodDACCalData(const ZMOD_DAC_CAL* pFactoryCal, const ZMOD_DAC_CAL* pUserCal) {
+
+    if ( NULL != pFactoryCal ) {
+        DisplayZmodDACCalArea("Factory Calibration:   ", pFactoryCal);
+    }
+    if ( NULL != pUserCal ) {
+        DisplayZmodDACCalArea("User Calibration:      ", pUserCal);
     }
+}
+
+/* ------------------------------------------------------------ */
+/***    DisplayZmodDACCalArea
+**
+**  Parameters:
+**      szLabel         - label to display in front of the calibration date
+**      pdacal          - pointer to the calibration data to display
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function displays the contents of a single calibration area
+**      along with the coefficients computed from it.
+*/
+static void
+DisplayZmodDACCalArea(const char* szLabel, const ZMOD_DAC_CAL* pdacal) {
+
+    time_t          t;
+    struct tm       time;
+    char            szDate[256];
 
-    t = (time_t)dacal.date;
+    t = (time_t)pdacal->date;
     localtime_r(&t, &time);
     if ( 0 != strftime(szDate, sizeof(szDate), "%B %d, %Y at %T", &time) ) {
-        printf("\n    User Calibration:      %s\n", szDate);
+        printf("\n    %s%s\n", szLabel, szDate);
     }
 
-    printf("    CHAN_1_LG_GAIN:        %f\n", dacal.cal[0][0][0]);
-    printf("    CHAN_1_LG_OFFSET:      %f\n", dacal.cal[0][0][1]);
-    printf("    CHAN_1_HG_GAIN:        %f\n", dacal.cal[0][1][0]);
-    printf("    CHAN_1_HG_OFFSET:      %f\n", dacal.cal[0][1][1]);
-    printf("    CHAN_2_LG_GAIN:        %f\n", dacal.cal[1][0][0]);
-    printf("    CHAN_2_LG_OFFSET:      %f\n", dacal.cal[1][0][1]);
-    printf("    CHAN_2_HG_GAIN:        %f\n", dacal.cal[1][1][0]);
-    printf("    CHAN_2_HG_OFFSET:      %f\n", dacal.cal[1][1][1]);
-
-    printf("    Ch1LgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefDAC1411(dacal.cal[0][0][0], fFalse));
-    printf("    Ch1LgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefDAC1411(dacal.cal[0][0][1], dacal.cal[0][0][0], fFalse));
-    printf("    Ch1HgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefDAC1411(dacal.cal[0][1][0], fTrue));
-    printf("    Ch1HgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefDAC1411(dacal.cal[0][1][1], dacal.cal[0][1][0], fTrue));
-    printf("    Ch2LgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefDAC1411(dacal.cal[1][0][0], fFalse));
-    printf("    Ch2LgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefDAC1411(dacal.cal[1][0][1], dacal.cal[1][0][0], fFalse));
-    printf("    Ch2HgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefDAC1411(dacal.cal[1][1][0], fTrue));
-    printf("    Ch2HgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefDAC1411(dacal.cal[1][1][1], dacal.cal[1][1][0], fTrue));
-
-    return fTrue;
+    printf("    CHAN_1_LG_GAIN:        %f\n", pdacal->cal[0][0][0]);
+    printf("    CHAN_1_LG_OFFSET:      %f\n", pdacal->cal[0][0][1]);
+    printf("    CHAN_1_HG_GAIN:        %f\n", pdacal->cal[0][1][0]);
+    printf("    CHAN_1_HG_OFFSET:      %f\n", pdacal->cal[0][1][1]);
+    printf("    CHAN_2_LG_GAIN:        %f\n", pdacal->cal[1][0][0]);
+    printf("    CHAN_2_LG_OFFSET:      %f\n", pdacal->cal[1][0][1]);
+    printf("    CHAN_2_HG_GAIN:        %f\n", pdacal->cal[1][1][0]);
+    printf("    CHAN_2_HG_OFFSET:      %f\n", pdacal->cal[1][1][1]);
+
+    printf("    Ch1LgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefDAC1411(pdacal->cal[0][0][0], fFalse));
+    printf("    Ch1LgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefDAC1411(pdacal->cal[0][0][1], pdacal->cal[0][0][0], fFalse));
+    printf("    Ch1HgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefDAC1411(pdacal->cal[0][1][0], fTrue));
+    printf("    Ch1HgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefDAC1411(pdacal->cal[0][1][1], pdacal->cal[0][1][0], fTrue));
+    printf("    Ch2LgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefDAC1411(pdacal->cal[1][0][0], fFalse));
+    printf("    Ch2LgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefDAC1411(pdacal->cal[1][0][1], pdacal->cal[1][0][0], fFalse));
+    printf("    Ch2HgCoefMultStatic:   0x%05X\n", (unsigned int)ComputeMultCoefDAC1411(pdacal->cal[1][1][0], fTrue));
+    printf("    Ch2HgCoefAddStatic:    0x%05X\n", (unsigned int)ComputeAddCoefDAC1411(pdacal->cal[1][1][1], pdacal->cal[1][1][0], fTrue));
 }
 
 /* ------------------------------------------------------------ */
@@ -200,14 +243,18 @@ FGetZmodDACCal(int fdI2cDev, BYTE addrI2cSlave, ZMOD_DAC_CAL *pFactoryCal, ZMOD_
     WORD            cbRead;
 
     if ( ! SyzygyI2cRead(fdI2cDev, addrI2cSlave, addrDacFactCalStart, (BYTE*)pFactoryCal, sizeof(ZMOD_DAC_CAL), &cbRead) ) {
-        printf("Error: failed to read ZmodDAC factory calibration from 0x%02X\n", addrI2cSlave);
-        printf("Error: received %d of %d bytes\n", cbRead, sizeof(ZMOD_DAC_CAL));
+        if(dpmutilfVerbose){
+            printf("Error: failed to read ZmodDAC factory calibration from 0x%02X\n", addrI2cSlave);
+            printf("Error: received %d of %d bytes\n", cbRead, sizeof(ZMOD_DAC_CAL));
+        }
         return fFalse;
     }
 
     if ( ! SyzygyI2cRead(fdI2cDev, addrI2cSlave, addrDacUserCalStart, (BYTE*)pUserCal, sizeof(ZMOD_DAC_CAL), &cbRead) ) {
-        printf("Error: failed to read ZmodDAC user calibration from 0x%02X\n", addrI2cSlave);
-        printf("Error: received %d of %d bytes\n", cbRead, sizeof(ZMOD_DAC_CAL));
+        if(dpmutilfVerbose){
+            printf("Error: failed to read ZmodDAC user calibration from 0x%02X\n", addrI2cSlave);
+            printf("Error: received %d of %d bytes\n", cbRead, sizeof(ZMOD_DAC_CAL));
+        }
         return fFalse;
     }
 
@@ -229,17 +276,38 @@ FGetZmodDACCal(int fdI2cDev, BYTE addrI2cSlave, ZMOD_DAC_CAL *pFactoryCal, ZMOD_
 **
 **  Description:
 **      This function converts calibration coefficients to the 18-bit signed format used in PL hardware.
+**      See FZmodDACCalConvertVariant, which avoids copying the calibration structure.
 */
 void
 FZmodDACCalConvertToS18(ZMOD_DAC_CAL dacal, ZMOD_DAC_CAL_S18 *pReturn) {
-	pReturn->cal[0][0][0] = (unsigned int)ComputeMultCoefDAC1411(dacal.cal[0][0][0], fFalse);
-	pReturn->cal[0][0][1] = (unsigned int)ComputeAddCoefDAC1411(dacal.cal[0][0][1], dacal.cal[0][0][0], fFalse);
-	pReturn->cal[0][1][0] = (unsigned int)ComputeMultCoefDAC1411(dacal.cal[0][1][0], fTrue);
-	pReturn->cal[0][1][1] = (unsigned int)ComputeAddCoefDAC1411(dacal.cal[0][1][1], dacal.cal[0][1][0], fTrue);
-	pReturn->cal[1][0][0] = (unsigned int)ComputeMultCoefDAC1411(dacal.cal[1][0][0], fFalse);
-	pReturn->cal[1][0][1] = (unsigned int)ComputeAddCoefDAC1411(dacal.cal[1][0][1], dacal.cal[1][0][0], fFalse);
-	pReturn->cal[1][1][0] = (unsigned int)ComputeMultCoefDAC1411(dacal.cal[1][1][0], fTrue);
-	pReturn->cal[1][1][1] = (unsigned int)ComputeAddCoefDAC1411(dacal.cal[1][1][1], dacal.cal[1][1][0], fTrue);
+	FZmodDACCalConvertVariant(&dacal, ZMOD_DAC_VARIANT_UNSUPPORTED, pReturn);
+}
+
+/* ------------------------------------------------------------ */
+/***    FZmodDACCalConvertVariant
+**
+**  Parameters:
+**      pdacal			- pointer to the calibration coefficients to convert
+**      variant			- Zmod DAC variant, result of FGetZmodDACVariant
+**      pReturn			- ZMOD_DAC_CAL_S18 object to return data by argument
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function converts all of the calibration coefficients to the
+**      18-bit signed format used in PL hardware in a single pass, using
+**      the precomputed conversion table of the specified variant.
+*/
+void
+FZmodDACCalConvertVariant(const ZMOD_DAC_CAL* pdacal, ZMOD_DAC_VARIANT variant, ZMOD_DAC_CAL_S18 *pReturn) {
+	if (( 0 > (int)variant ) || ( ZMOD_DAC_VARIANT_UNSUPPORTED < variant )) {
+		variant = ZMOD_DAC_VARIANT_UNSUPPORTED;
+	}
+	ZmodCalConvertToS18(&rgconvDac[variant], (const BYTE*)pdacal + offsetof(ZMOD_DAC_CAL, cal), 4, &pReturn->cal[0][0][0]);
 }
 
 /* ------------------------------------------------------------ */
@@ -74,7 +74,9 @@ typedef enum {
 
 BOOL    FDisplayZmodDACCal(int fdI2cDev, BYTE addrI2cSLave);
 BOOL    FGetZmodDACCal(int fdI2cDev, BYTE addrI2cSlave, ZMOD_DAC_CAL* pFactoryCal, ZMOD_DAC_CAL* pUserCal);
+void    DisplayZmodDACCalData(const ZMOD_DAC_CAL* pFactoryCal, const ZMOD_DAC_CAL* pUserCal);
 void    FZmodDACCalConvertToS18(ZMOD_DAC_CAL adcal, ZMOD_DAC_CAL_S18 *pReturn);
+void    FZmodDACCalConvertVariant(const ZMOD_DAC_CAL* pcal, ZMOD_DAC_VARIANT variant, ZMOD_DAC_CAL_S18 *pReturn);
 BOOL 	FZmodIsDAC(DWORD Pdid);
 BOOL	FGetZmodDACVariant(DWORD Pdid, ZMOD_DAC_VARIANT *pVariant);
 BOOL 	FGetZmodDACResolution(ZMOD_DAC_VARIANT variant, DWORD *pResolution);
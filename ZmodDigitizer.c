@@ -20,6 +20,11 @@
 /*                                                                      */
 /*  08/30/2022 (ArtVVB): created, ported from ZmodDigitizer.c           */
 /*  02/21/2024 (ArtVVB): added identification functions                 */
+/*  10/14/2026: added FZmodDigitizerCalConvertVariant, which converts   */
+/*      all coefficients in one pass using a per-variant table          */
+/*  10/14/2026: added the calibration context functions                 */
+/*  10/14/2026: added DisplayZmodDigitizerCalData and fixed the offsets */
+/*      being displayed as multiplicative coefficients                  */
 /*                                                                      */
 /************************************************************************/
 
@@ -35,9 +40,12 @@
 #endif
 #include <stdio.h>
 #include <time.h>
+#include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 #include "stdtypes.h"
 #include "syzygy.h"
+#include "Zmod.h"
 #include "ZmodDigitizer.h"
 
 /* ------------------------------------------------------------ */
@@ -48,6 +56,12 @@
 #define DIGITIZER_IDEAL_RANGE_ADC    1.0
 #define DIGITIZER_REAL_RANGE_ADC     1.055
 
+/* Conversion of a pair of ZmodDigitizer coefficients to the 18-bit signed
+** format, equivalent to ComputeMultCoefDigitizer and ComputeAddCoefDigitizer.
+*/
+#define DIGITIZER_CAL_CONV	{ fFalse, 1, { \
+	{ (DIGITIZER_REAL_RANGE_ADC/DIGITIZER_IDEAL_RANGE_ADC)*(double)(1<<16), (double)(1<<17), DIGITIZER_IDEAL_RANGE_ADC } } }
+
 /* ------------------------------------------------------------ */
 /*              Local Type Definitions                          */
 /* ------------------------------------------------------------ */
@@ -57,17 +71,26 @@
 /*              Global Variables                                */
 /* ------------------------------------------------------------ */
 
-extern BOOL dpmutilfVerbose;
+extern I2CHALThreadLocal BOOL dpmutilfVerbose;
 
 /* ------------------------------------------------------------ */
 /*              Local Variables                                 */
 /* ------------------------------------------------------------ */
 
+/* Coefficient conversion table indexed by ZMOD_DIGITIZER_VARIANT.
+** Unsupported variants use the same ranges as
+** FZmodDigitizerCalConvertToS18 always has.
+*/
+static const ZMOD_CAL_CONV rgconvDigitizer[ZMOD_DIGITIZER_VARIANT_UNSUPPORTED + 1] = {
+	DIGITIZER_CAL_CONV,	// ZMOD_DIGITIZER_VARIANT_1430_125
+	DIGITIZER_CAL_CONV	// ZMOD_DIGITIZER_VARIANT_UNSUPPORTED
+};
 
 /* ------------------------------------------------------------ */
 /*              Forward Declarations                            */
 /* ------------------------------------------------------------ */
 
+static void DisplayZmodDigitizerCalArea(const char* szLabel, const ZMOD_DIGITIZER_CAL* pdgtcal);
 int32_t ComputeMultCoefDigitizer(float cg);
 int32_t ComputeAddCoefDigitizer(float ca);
 
@@ -97,70 +120,94 @@ int32_t ComputeAddCoefDigitizer(float ca);
 BOOL
 FDisplayZmodDigitizerCal(int fdI2cDev, BYTE addrI2cSlave) {
 
-    ZMOD_DIGITIZER_CAL    adcal;
-    WORD                  cbRead;
-    time_t                t;
-    struct tm             time;
-    char                  szDate[256];
-    int                   hz;
+    ZMOD_DIGITIZER_CAL    dgtcalFactory;
+    ZMOD_DIGITIZER_CAL    dgtcalUser;
 
-    if ( ! SyzygyI2cRead(fdI2cDev, addrI2cSlave, addrDigitizerFactCalStart, (BYTE*)&adcal, sizeof(ZMOD_DIGITIZER_CAL), &cbRead) ) {
-        printf("Error: failed to read ZmodDigitizer factory calibration from 0x%02X\n", addrI2cSlave);
-        printf("Error: received %d of %d bytes\n", cbRead, sizeof(ZMOD_DIGITIZER_CAL));
+    if ( ! FGetZmodDigitizerCal(fdI2cDev, addrI2cSlave, &dgtcalFactory, &dgtcalUser) ) {
         return fFalse;
     }
 
-    t = (time_t)adcal.date;
-    localtime_r(&t, &time);
-    if ( 0 != strftime(szDate, sizeof(szDate), "%B %d, %Y at %T", &time) ) {
-        printf("\n    Factory Calibration:   %s\n", szDate);
-    }
+    DisplayZmodDigitizerCalData(&dgtcalFactory, &dgtcalUser);
 
-    for (hz = 0; hz < cbDigitizerCalibHzSteps; hz++) {
-        float freq = FZmodDigitizerGetFrequencyStepMHz(adcal.hz[hz]);
-        printf("    Channel 1 Gain   at %.02f MHz: %f\n", freq, adcal.cal[hz][0][0]);
-        printf("    Channel 1 Offset at %.02f MHz: %f\n", freq, adcal.cal[hz][0][1]);
-        printf("    Channel 2 Gain   at %.02f MHz: %f\n", freq, adcal.cal[hz][1][0]);
-        printf("    Channel 2 Offset at %.02f MHz: %f\n", freq, adcal.cal[hz][1][1]);
-    }
+    return fTrue;
+}
 
-    for (hz = 0; hz < cbDigitizerCalibHzSteps; hz++) {
-        float freq = FZmodDigitizerGetFrequencyStepMHz(adcal.hz[hz]);
-        printf("    Channel 1 Gain   at %.02f MHz (static): 0x%05X\n", freq, (unsigned int)ComputeMultCoefDigitizer(adcal.cal[hz][0][0]));
-        printf("    Channel 1 Offset at %.02f MHz (static): 0x%05X\n", freq, (unsigned int)ComputeMultCoefDigitizer(adcal.cal[hz][0][1]));
-        printf("    Channel 2 Gain   at %.02f MHz (static): 0x%05X\n", freq, (unsigned int)ComputeMultCoefDigitizer(adcal.cal[hz][1][0]));
-        printf("    Channel 2 Offset at %.02f MHz (static): 0x%05X\n", freq, (unsigned int)ComputeMultCoefDigitizer(adcal.cal[hz][1][1]));
-    }
+/* ------------------------------------------------------------ */
+/***    DisplayZmodDigitizerCalData
+**
+**  Parameters:
+**      pFactoryCal		- pointer to the factory calibration data, or NULL
+**      pUserCal		- pointer to the user calibration data, or NULL
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function computes the multiplicative and additive
+**      coefficients for calibration data that has already been read
+**      from a ZmodDigitizer and then displays them using stdout. Either
+**      pointer may be NULL if that calibration area wasn't read.
+*/
+void
+DisplayZmodDigitizerCalData(const ZMOD_DIGITIZER_CAL* pFactoryCal, const ZMOD_DIGITIZER_CAL* pUserCal) {
 
-    if ( ! SyzygyI2cRead(fdI2cDev, addrI2cSlave, addrDigitizerUserCalStart, (BYTE*)&adcal, sizeof(ZMOD_DIGITIZER_CAL), &cbRead) ) {
-        printf("Error: failed to read ZmodDigitizer user calibration from 0x%02X\n", addrI2cSlave);
-        printf("Error: received %d of %d bytes\n", cbRead, sizeof(ZMOD_DIGITIZER_CAL));
-        return fFalse;
+    if ( NULL != pFactoryCal ) {
+        DisplayZmodDigitizerCalArea("Factory Calibration:   ", pFactoryCal);
+    }
+    if ( NULL != pUserCal ) {
+        DisplayZmodDigitizerCalArea("User Calibration:      ", pUserCal);
     }
+}
+
+/* ------------------------------------------------------------ */
+/***    DisplayZmodDigitizerCalArea
+**
+**  Parameters:
+**      szLabel         - label to display in front of the calibration date
+**      pdgtcal         - pointer to the calibration data to display
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function displays the contents of a single calibration area
+**      along with the coefficients computed from it.
+*/
+static void
+DisplayZmodDigitizerCalArea(const char* szLabel, const ZMOD_DIGITIZER_CAL* pdgtcal) {
+
+    time_t                t;
+    struct tm             time;
+    char                  szDate[256];
+    int                   hz;
 
-    t = (time_t)adcal.date;
+    t = (time_t)pdgtcal->date;
     localtime_r(&t, &time);
     if ( 0 != strftime(szDate, sizeof(szDate), "%B %d, %Y at %T", &time) ) {
-        printf("\n    User Calibration:      %s\n", szDate);
+        printf("\n    %s%s\n", szLabel, szDate);
     }
 
     for (hz = 0; hz < cbDigitizerCalibHzSteps; hz++) {
-        float freq = FZmodDigitizerGetFrequencyStepMHz(adcal.hz[hz]);
-        printf("    Channel 1 Gain   at %.02f MHz: %f\n", freq, adcal.cal[hz][0][0]);
-        printf("    Channel 1 Offset at %.02f MHz: %f\n", freq, adcal.cal[hz][0][1]);
-        printf("    Channel 2 Gain   at %.02f MHz: %f\n", freq, adcal.cal[hz][1][0]);
-        printf("    Channel 2 Offset at %.02f MHz: %f\n", freq, adcal.cal[hz][1][1]);
+        float freq = FZmodDigitizerGetFrequencyStepMHz(pdgtcal->hz[hz]);
+        printf("    Channel 1 Gain   at %.02f MHz: %f\n", freq, pdgtcal->cal[hz][0][0]);
+        printf("    Channel 1 Offset at %.02f MHz: %f\n", freq, pdgtcal->cal[hz][0][1]);
+        printf("    Channel 2 Gain   at %.02f MHz: %f\n", freq, pdgtcal->cal[hz][1][0]);
+        printf("    Channel 2 Offset at %.02f MHz: %f\n", freq, pdgtcal->cal[hz][1][1]);
     }
 
     for (hz = 0; hz < cbDigitizerCalibHzSteps; hz++) {
-        float freq = FZmodDigitizerGetFrequencyStepMHz(adcal.hz[hz]);
-        printf("    Channel 1 Gain   at %.02f MHz (static): 0x%05X\n", freq, (unsigned int)ComputeMultCoefDigitizer(adcal.cal[hz][0][0]));
-        printf("    Channel 1 Offset at %.02f MHz (static): 0x%05X\n", freq, (unsigned int)ComputeMultCoefDigitizer(adcal.cal[hz][0][1]));
-        printf("    Channel 2 Gain   at %.02f MHz (static): 0x%05X\n", freq, (unsigned int)ComputeMultCoefDigitizer(adcal.cal[hz][1][0]));
-        printf("    Channel 2 Offset at %.02f MHz (static): 0x%05X\n", freq, (unsigned int)ComputeMultCoefDigitizer(adcal.cal[hz][1][1]));
+        float freq = FZmodDigitizerGetFrequencyStepMHz(pdgtcal->hz[hz]);
+        printf("    Channel 1 Gain   at %.02f MHz (static): 0x%05X\n", freq, (unsigned int)ComputeMultCoefDigitizer(pdgtcal->cal[hz][0][0]));
+        printf("    Channel 1 Offset at %.02f MHz (static): 0x%05X\n", freq, (unsigned int)ComputeAddCoefDigitizer(pdgtcal->cal[hz][0][1]));
+        printf("    Channel 2 Gain   at %.02f MHz (static): 0x%05X\n", freq, (unsigned int)ComputeMultCoefDigitizer(pdgtcal->cal[hz][1][0]));
+        printf("    Channel 2 Offset at %.02f MHz (static): 0x%05X\n", freq, (unsigned int)ComputeAddCoefDigitizer(pdgtcal->cal[hz][1][1]));
     }
-
-    return fTrue;
 }
 
 /* ------------------------------------------------------------ */
@@ -189,14 +236,18 @@ FGetZmodDigitizerCal(int fdI2cDev, BYTE addrI2cSlave, ZMOD_DIGITIZER_CAL *pFacto
     WORD            cbRead;
 
     if ( ! SyzygyI2cRead(fdI2cDev, addrI2cSlave, addrDigitizerFactCalStart, (BYTE*)pFactoryCal, sizeof(ZMOD_DIGITIZER_CAL), &cbRead) ) {
-        printf("Error: failed to read ZmodDigitizer factory calibration from 0x%02X\n", addrI2cSlave);
-        printf("Error: received %d of %d bytes\n", cbRead, sizeof(ZMOD_DIGITIZER_CAL));
+        if(dpmutilfVerbose){
+            printf("Error: failed to read ZmodDigitizer factory calibration from 0x%02X\n", addrI2cSlave);
+            printf("Error: received %d of %d bytes\n", cbRead, sizeof(ZMOD_DIGITIZER_CAL));
+        }
         return fFalse;
     }
 
     if ( ! SyzygyI2cRead(fdI2cDev, addrI2cSlave, addrDigitizerUserCalStart, (BYTE*)pUserCal, sizeof(ZMOD_DIGITIZER_CAL), &cbRead) ) {
-        printf("Error: failed to read ZmodDigitizer user calibration from 0x%02X\n", addrI2cSlave);
-        printf("Error: received %d of %d bytes\n", cbRead, sizeof(ZMOD_DIGITIZER_CAL));
+        if(dpmutilfVerbose){
+            printf("Error: failed to read ZmodDigitizer user calibration from 0x%02X\n", addrI2cSlave);
+            printf("Error: received %d of %d bytes\n", cbRead, sizeof(ZMOD_DIGITIZER_CAL));
+        }
         return fFalse;
     }
 
@@ -207,8 +258,8 @@ FGetZmodDigitizerCal(int fdI2cDev, BYTE addrI2cSlave, ZMOD_DIGITIZER_CAL *pFacto
 /***    FZmodDigitizerCalConvertToS18
 **
 **  Parameters:
-**      adcal           - ZMOD_DIGITIZER_CAL object to pull calibration coefficients from
-**      pReturn         - ZMOD_DIGITIZER_CAL_S18 object to return data by argument
+**      adcal			- ZMOD_DIGITIZER_CAL object to pull calibration coefficients from
+**      pReturn			- ZMOD_DIGITIZER_CAL_S18 object to return data by argument
 **
 **  Return Value:
 **      none
@@ -218,16 +269,38 @@ FGetZmodDigitizerCal(int fdI2cDev, BYTE addrI2cSlave, ZMOD_DIGITIZER_CAL *pFacto
 **
 **  Description:
 **      This function converts calibration coefficients to the 18-bit signed format used in PL hardware.
+**      See FZmodDigitizerCalConvertVariant, which avoids copying the calibration structure.
 */
 void
 FZmodDigitizerCalConvertToS18(ZMOD_DIGITIZER_CAL adcal, ZMOD_DIGITIZER_CAL_S18 *pReturn) {
-    int hz, ch;
-    for (hz = 0; hz < cbDigitizerCalibHzSteps; hz++) { // frequency step
-        for (ch = 0; ch < 2; ch++) { // channel index
-            pReturn->cal[hz][ch][0] = (unsigned int)ComputeMultCoefDigitizer(adcal.cal[hz][ch][0]);
-            pReturn->cal[hz][ch][1] = (unsigned int)ComputeAddCoefDigitizer(adcal.cal[hz][ch][1]);
-        }
-    }
+	FZmodDigitizerCalConvertVariant(&adcal, ZMOD_DIGITIZER_VARIANT_UNSUPPORTED, pReturn);
+}
+
+/* ------------------------------------------------------------ */
+/***    FZmodDigitizerCalConvertVariant
+**
+**  Parameters:
+**      padcal			- pointer to the calibration coefficients to convert
+**      variant			- Zmod Digitizer variant, result of FGetZmodDigitizerVariant
+**      pReturn			- ZMOD_DIGITIZER_CAL_S18 object to return data by argument
+**
+**  Return Value:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function converts all of the calibration coefficients to the
+**      18-bit signed format used in PL hardware in a single pass, using
+**      the precomputed conversion table of the specified variant.
+*/
+void
+FZmodDigitizerCalConvertVariant(const ZMOD_DIGITIZER_CAL* padcal, ZMOD_DIGITIZER_VARIANT variant, ZMOD_DIGITIZER_CAL_S18 *pReturn) {
+	if (( 0 > (int)variant ) || ( ZMOD_DIGITIZER_VARIANT_UNSUPPORTED < variant )) {
+		variant = ZMOD_DIGITIZER_VARIANT_UNSUPPORTED;
+	}
+	ZmodCalConvertToS18(&rgconvDigitizer[variant], (const BYTE*)padcal + offsetof(ZMOD_DIGITIZER_CAL, cal), 2 * cbDigitizerCalibHzSteps, &pReturn->cal[0][0][0]);
 }
 
 /* ------------------------------------------------------------ */
@@ -395,3 +468,238 @@ BOOL FGetZmodDigitizerResolution(ZMOD_DIGITIZER_VARIANT variant, DWORD *pResolut
 		return fFalse;
 	}
 }
+
+/* ------------------------------------------------------------ */
+/***    FZmodDigitizerCalCtxInit
+**
+**  Parameters:
+**      pctx            - calibration context to initialize
+**      pcal            - factory or user calibration area to build the context from
+**      variant         - Zmod Digitizer variant, result of FGetZmodDigitizerVariant
+**
+**  Return Value:
+**      fTrue for success, fFalse if the area contains no calibrated frequency steps
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function converts the coefficients of every calibrated
+**      frequency step to the 18-bit signed format used in PL hardware
+**      and stores them in the context, sorted by frequency, along with a
+**      table that maps each frequency step code to its sorted index.
+**      Steps whose code is unknown and repeated steps are ignored.
+*/
+BOOL
+FZmodDigitizerCalCtxInit(ZMOD_DIGITIZER_CAL_CTX* pctx, const ZMOD_DIGITIZER_CAL* pcal, ZMOD_DIGITIZER_VARIANT variant) {
+
+    ZMOD_DIGITIZER_CAL_S18  dgtcalS18;
+    float                   mhz;
+    int                     ihz;
+    int                     istep;
+    int                     istepT;
+
+    if (( 0 > (int)variant ) || ( ZMOD_DIGITIZER_VARIANT_UNSUPPORTED < variant )) {
+        variant = ZMOD_DIGITIZER_VARIANT_UNSUPPORTED;
+    }
+
+    memset(pctx, 0, sizeof(ZMOD_DIGITIZER_CAL_CTX));
+    memset(pctx->rgistep, istepDigitizerCalNone, sizeof(pctx->rgistep));
+    pctx->variant = variant;
+
+    FZmodDigitizerCalConvertVariant(pcal, variant, &dgtcalS18);
+
+    /* Insert each step into the sorted arrays. There are only a handful
+    ** of steps so an insertion sort is all that's needed.
+    */
+    for ( ihz = 0; ihz < cbDigitizerCalibHzSteps; ihz++ ) {
+        mhz = FZmodDigitizerGetFrequencyStepMHz(pcal->hz[ihz]);
+        if ( 0.0f == mhz ) {
+            continue;
+        }
+
+        for ( istep = 0; istep < pctx->cstep; istep++ ) {
+            if ( pctx->rghz[istep] == pcal->hz[ihz] ) {
+                break;
+            }
+        }
+        if ( istep < pctx->cstep ) {
+            continue;
+        }
+
+        istep = pctx->cstep;
+        while (( 0 < istep ) && ( mhz < pctx->rgmhz[istep-1] )) {
+            pctx->rghz[istep] = pctx->rghz[istep-1];
+            pctx->rgmhz[istep] = pctx->rgmhz[istep-1];
+            memcpy(pctx->rgcal[istep], pctx->rgcal[istep-1], sizeof(pctx->rgcal[0]));
+            pctx->rgs18[istep] = pctx->rgs18[istep-1];
+            istep--;
+        }
+
+        pctx->rghz[istep] = pcal->hz[ihz];
+        pctx->rgmhz[istep] = mhz;
+        memcpy(pctx->rgcal[istep], pcal->cal[ihz], sizeof(pctx->rgcal[0]));
+        memcpy(pctx->rgs18[istep].cal, dgtcalS18.cal[ihz], sizeof(pctx->rgs18[0].cal));
+        pctx->cstep++;
+    }
+
+    for ( istepT = 0; istepT < pctx->cstep; istepT++ ) {
+        pctx->rgistep[pctx->rghz[istepT]] = (BYTE)istepT;
+    }
+
+    return ( 0 < pctx->cstep ) ? fTrue : fFalse;
+}
+
+/* ------------------------------------------------------------ */
+/***    FZmodDigitizerCalCtxLoad
+**
+**  Parameters:
+**      fdI2cDev        - open file descriptor for underlying I2C device (linux only)
+**      addrI2cSlave    - I2C bus address for the slave
+**      fUserCal        - fTrue to build the context from the user calibration
+**                        area, fFalse for the factory calibration area
+**      variant         - Zmod Digitizer variant, result of FGetZmodDigitizerVariant
+**      pctx            - calibration context to initialize
+**
+**  Return Value:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function reads the calibration areas of the ZmodDigitizer
+**      with the specified I2C bus address and builds a calibration
+**      context from the requested one. This is the only function of the
+**      calibration context that accesses the I2C bus.
+*/
+BOOL
+FZmodDigitizerCalCtxLoad(int fdI2cDev, BYTE addrI2cSlave, BOOL fUserCal, ZMOD_DIGITIZER_VARIANT variant, ZMOD_DIGITIZER_CAL_CTX* pctx) {
+
+    ZMOD_DIGITIZER_CAL  dgtcalFact;
+    ZMOD_DIGITIZER_CAL  dgtcalUser;
+
+    if ( ! FGetZmodDigitizerCal(fdI2cDev, addrI2cSlave, &dgtcalFact, &dgtcalUser) ) {
+        return fFalse;
+    }
+
+    if ( ! FZmodDigitizerCalCtxInit(pctx, fUserCal ? &dgtcalUser : &dgtcalFact, variant) ) {
+        if(dpmutilfVerbose){
+            printf("Error: ZmodDigitizer at 0x%02X has no calibrated frequency steps\n", addrI2cSlave);
+        }
+        return fFalse;
+    }
+
+    return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    FZmodDigitizerCalCtxGetStep
+**
+**  Parameters:
+**      pctx            - calibration context built by FZmodDigitizerCalCtxInit
+**      hz              - frequency step code, as stored in ZMOD_DIGITIZER_CAL.hz
+**      pReturn         - ZMOD_DIGITIZER_STEP_S18 object to return data by argument
+**
+**  Return Value:
+**      fTrue for success, fFalse if the frequency step wasn't calibrated
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function returns the precomputed coefficients of a
+**      calibrated frequency step with a single table lookup.
+*/
+BOOL
+FZmodDigitizerCalCtxGetStep(const ZMOD_DIGITIZER_CAL_CTX* pctx, BYTE hz, ZMOD_DIGITIZER_STEP_S18* pReturn) {
+
+    BYTE    istep;
+
+    istep = pctx->rgistep[hz];
+    if ( istepDigitizerCalNone == istep ) {
+        return fFalse;
+    }
+
+    *pReturn = pctx->rgs18[istep];
+
+    return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    FZmodDigitizerCalCtxGetRate
+**
+**  Parameters:
+**      pctx            - calibration context built by FZmodDigitizerCalCtxInit
+**      mhz             - sample rate in MHz
+**      fInterpolate    - fTrue to interpolate between the calibrated steps
+**                        on either side of the sample rate, fFalse to use
+**                        the nearest calibrated step
+**      pReturn         - ZMOD_DIGITIZER_STEP_S18 object to return data by argument
+**
+**  Return Value:
+**      fTrue for success, fFalse if the context is empty
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function returns the coefficients for an arbitrary sample
+**      rate. Rates that match a calibrated step, and rates below the
+**      lowest or above the highest calibrated step, use the precomputed
+**      coefficients of that step. Otherwise the gain and offset are
+**      interpolated linearly before being converted to the 18-bit
+**      signed format.
+*/
+BOOL
+FZmodDigitizerCalCtxGetRate(const ZMOD_DIGITIZER_CAL_CTX* pctx, float mhz, BOOL fInterpolate, ZMOD_DIGITIZER_STEP_S18* pReturn) {
+
+    float   rgcal[2][2];
+    float   t;
+    int     istep;
+    int     ich;
+    int     icoef;
+
+    if ( 0 == pctx->cstep ) {
+        return fFalse;
+    }
+
+    if ( mhz <= pctx->rgmhz[0] ) {
+        *pReturn = pctx->rgs18[0];
+        return fTrue;
+    }
+
+    for ( istep = 1; istep < pctx->cstep; istep++ ) {
+        if ( mhz <= pctx->rgmhz[istep] ) {
+            break;
+        }
+    }
+
+    if ( istep == pctx->cstep ) {
+        *pReturn = pctx->rgs18[pctx->cstep-1];
+        return fTrue;
+    }
+
+    if ( mhz == pctx->rgmhz[istep] ) {
+        *pReturn = pctx->rgs18[istep];
+        return fTrue;
+    }
+
+    t = (mhz - pctx->rgmhz[istep-1]) / (pctx->rgmhz[istep] - pctx->rgmhz[istep-1]);
+
+    if ( ! fInterpolate ) {
+        *pReturn = pctx->rgs18[(0.5f > t) ? istep-1 : istep];
+        return fTrue;
+    }
+
+    for ( ich = 0; ich < 2; ich++ ) {
+        for ( icoef = 0; icoef < 2; icoef++ ) {
+            rgcal[ich][icoef] = pctx->rgcal[istep-1][ich][icoef] +
+                t * (pctx->rgcal[istep][ich][icoef] - pctx->rgcal[istep-1][ich][icoef]);
+        }
+    }
+
+    ZmodCalConvertToS18(&rgconvDigitizer[pctx->variant], rgcal, 2, &pReturn->cal[0][0]);
+
+    return fTrue;
+}
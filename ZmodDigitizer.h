@@ -17,6 +17,9 @@
 /*                                                                      */
 /*  08/30/2022 (ArtVVB): created, adapted from ZmodADC.h                */
 /*  02/21/2024 (ArtVVB): added identification functions                 */
+/*  10/14/2026: added the calibration context, which holds the S18      */
+/*      coefficients of every calibrated frequency step                 */
+/*  10/14/2026: added DisplayZmodDigitizerCalData                       */
 /*                                                                      */
 /************************************************************************/
 
@@ -40,6 +43,9 @@
 // The number of frequencies that the digitizer was calibrated at, for which coefficients are stored in DNA
 #define cbDigitizerCalibHzSteps   7
 
+// Value of ZMOD_DIGITIZER_CAL_CTX.rgistep for frequency step codes that weren't calibrated
+#define istepDigitizerCalNone     0xFF
+
 /* ------------------------------------------------------------ */
 /*                  General Type Declarations                   */
 /* ------------------------------------------------------------ */
@@ -68,6 +74,26 @@ typedef enum {
 	ZMOD_DIGITIZER_VARIANT_UNSUPPORTED
 } ZMOD_DIGITIZER_VARIANT;
 
+typedef struct {
+	// coefficients of a single frequency step, in the format used by PL calibration hardware
+	unsigned int cal[2][2]; // [channel 0:1][0 multiplicative : 1 additive]
+} ZMOD_DIGITIZER_STEP_S18;
+
+/* Calibration context built once from a calibration area, so that the
+** coefficients for a new sample rate can be looked up without any I2C
+** transactions. Steps are sorted by frequency and rgistep maps each
+** frequency step code (ZMOD_DIGITIZER_CAL.hz) to its index.
+*/
+typedef struct {
+	ZMOD_DIGITIZER_VARIANT	variant;
+	BYTE					cstep;
+	BYTE					rgistep[256];
+	BYTE					rghz[cbDigitizerCalibHzSteps];
+	float					rgmhz[cbDigitizerCalibHzSteps];
+	float					rgcal[cbDigitizerCalibHzSteps][2][2];
+	ZMOD_DIGITIZER_STEP_S18	rgs18[cbDigitizerCalibHzSteps];
+} ZMOD_DIGITIZER_CAL_CTX;
+
 /* ------------------------------------------------------------ */
 /*                  Variable Declarations                       */
 /* ------------------------------------------------------------ */
@@ -78,11 +104,17 @@ typedef enum {
 
 BOOL    FDisplayZmodDigitizerCal(int fdI2cDev, BYTE addrI2cSlave);
 BOOL    FGetZmodDigitizerCal(int fdI2cDev, BYTE addrI2cSlave, ZMOD_DIGITIZER_CAL* pFactoryCal, ZMOD_DIGITIZER_CAL* pUserCal);
+void    DisplayZmodDigitizerCalData(const ZMOD_DIGITIZER_CAL* pFactoryCal, const ZMOD_DIGITIZER_CAL* pUserCal);
 void    FZmodDigitizerCalConvertToS18(ZMOD_DIGITIZER_CAL adcal, ZMOD_DIGITIZER_CAL_S18 *pReturn);
+void    FZmodDigitizerCalConvertVariant(const ZMOD_DIGITIZER_CAL* pcal, ZMOD_DIGITIZER_VARIANT variant, ZMOD_DIGITIZER_CAL_S18 *pReturn);
 float   FZmodDigitizerGetFrequencyStepMHz(BYTE hz);
 BOOL 	FZmodIsDigitizer(DWORD Pdid);
 BOOL	FGetZmodDigitizerVariant(DWORD Pdid, ZMOD_DIGITIZER_VARIANT *pVariant);
 BOOL 	FGetZmodDigitizerResolution(ZMOD_DIGITIZER_VARIANT variant, DWORD *pResolution);
+BOOL    FZmodDigitizerCalCtxInit(ZMOD_DIGITIZER_CAL_CTX* pctx, const ZMOD_DIGITIZER_CAL* pcal, ZMOD_DIGITIZER_VARIANT variant);
+BOOL    FZmodDigitizerCalCtxLoad(int fdI2cDev, BYTE addrI2cSlave, BOOL fUserCal, ZMOD_DIGITIZER_VARIANT variant, ZMOD_DIGITIZER_CAL_CTX* pctx);
+BOOL    FZmodDigitizerCalCtxGetStep(const ZMOD_DIGITIZER_CAL_CTX* pctx, BYTE hz, ZMOD_DIGITIZER_STEP_S18* pReturn);
+BOOL    FZmodDigitizerCalCtxGetRate(const ZMOD_DIGITIZER_CAL_CTX* pctx, float mhz, BOOL fInterpolate, ZMOD_DIGITIZER_STEP_S18* pReturn);
 
 /* ------------------------------------------------------------ */
 
@@ -0,0 +1,607 @@
+/************************************************************************/
+/*                                                                      */
+/*  dpmutilbench.c - dpmutil benchmark on a simulated I2C bus           */
+/*                                                                      */
+/************************************************************************/
+/*  Author: Digilent Inc.                                               */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  This program times the main dpmutil operations against the          */
+/*  simulated Platform MCU and SYZYGY bus of I2CSim.c, at the standard  */
+/*  (100 kHz) and fast (400 kHz) I2C clock rates, without any hardware. */
+/*  It reports the host time and the modelled bus time of each          */
+/*  operation along with the transfers, messages and bytes it needed,   */
+/*  so that changes to the library can be compared run to run. The      */
+/*  counts are deterministic and the program exits with a non-zero      */
+/*  status if any operation fails, so it can also be used as a          */
+/*  regression test.                                                    */
+/*                                                                      */
+/*  Build it from the parent directory of the dpmutil sources with:     */
+/*                                                                      */
+/*      gcc -std=gnu99 -O2 -o dpmutilbench dpmutil/bench/dpmutilbench.c */
+/*          dpmutil/?*.c -lpthread                                       */
+/*                                                                      */
+/*  Usage: dpmutilbench [-r] [-n iterations]                            */
+/*                                                                      */
+/*      -r  run the simulation in real time, so that the host time of   */
+/*          each operation includes the bus time                        */
+/*      -n  number of iterations of each operation, 20 by default       */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*  10/14/2026: created                                                 */
+/*  10/14/2026: added the DNA program operation                         */
+/*  10/14/2026: added the power budget operations                       */
+/*                                                                      */
+/************************************************************************/
+
+/* ------------------------------------------------------------ */
+/*              Include File Definitions                        */
+/* ------------------------------------------------------------ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "../dpmutil.h"
+#include "../I2CHAL.h"
+#include "../syzygy.h"
+#include "../DnaProgram.h"
+#include "../Sampler.h"
+#include "../I2CSim.h"
+
+/* ------------------------------------------------------------ */
+/*              Miscellaneous Declarations                      */
+/* ------------------------------------------------------------ */
+
+#define citerDefault		20
+
+/* Define the PDIDs of the simulated pods.
+*/
+#define pdidBenchAdc		0x80100200
+#define pdidBenchDac		0x80200300
+
+/* Define the number of simulated pods, all of which are programmed by
+** the DNA program operation.
+*/
+#define cpodBench			2
+
+/* Define the VIO voltages (10 mV) used for admission queries, one within
+** the VIO range of the simulated pods and one below it.
+*/
+#define vltgBenchAdmit		180
+#define vltgBenchRefuse		90
+
+/* ------------------------------------------------------------ */
+/*              Local Type Definitions                          */
+/* ------------------------------------------------------------ */
+
+typedef struct {
+	int			fdI2c;
+	BYTE		addrPod;
+	BYTE		rgbDna[cbSyzygyDnaMax];
+	WORD		cbDna;
+	BYTE		rgrgbPgm[cpodBench][2][cbSyzygyDnaMax];	// original and altered DNA of each pod
+	WORD		rgcbPgm[cpodBench];
+	BYTE		iimgPgm;	// image programmed by the last DNA program
+	Sampler		smp;
+	UINT64		usTimestamp;
+	dpmutilSession_t	sess;
+	dpmutilWatch_t		watch;
+	dpmutilBudget_t		budget;
+	dpmutilPowerInfo_t	rgpwr[cPmcuVadjGroupMax];
+} BenchContext;
+
+typedef BOOL (*PFNBENCHOP)(BenchContext* pctx);
+
+/* ------------------------------------------------------------ */
+/*              Global Variables                                */
+/* ------------------------------------------------------------ */
+
+extern I2CHALThreadLocal BOOL	dpmutilfVerbose;
+
+/* ------------------------------------------------------------ */
+/*              Local Variables                                 */
+/* ------------------------------------------------------------ */
+
+static dpmutildevInfo_t		devInfoBench;
+static dpmutilPortInfo_t	rgportBench[cPmcuPortMax];
+
+/* ------------------------------------------------------------ */
+/*              Forward Declarations                            */
+/* ------------------------------------------------------------ */
+
+static BOOL		FBenchGetInfo(BenchContext* pctx);
+static BOOL		FBenchEnumRefresh(BenchContext* pctx);
+static BOOL		FBenchEnumCached(BenchContext* pctx);
+static BOOL		FBenchDnaWrite(BenchContext* pctx);
+static BOOL		FBenchDnaProgram(BenchContext* pctx);
+static BOOL		FBenchPgmSetup(BenchContext* pctx);
+static BOOL		FBenchSamplerPoll(BenchContext* pctx);
+static BOOL		FBenchGetInfoVio(BenchContext* pctx);
+static BOOL		FBenchBudgetAdmit(BenchContext* pctx);
+static BOOL		FBenchCheckBudget(I2cSim* psim, BenchContext* pctx);
+static void		BenchWatchEvent(const dpmutilWatchEvent_t* pevt, void* pvContext);
+static BOOL		FBenchRun(I2cSim* psim, const char* szOp, PFNBENCHOP pfnOp, BenchContext* pctx, DWORD citer);
+static BOOL		FBenchClock(DWORD hzScl, BOOL fRealTime, DWORD citer);
+static BOOL		FBenchCheckPorts(void);
+static UINT64	NsBenchNow(void);
+
+/* ------------------------------------------------------------ */
+/*              Procedure Definitions                           */
+/* ------------------------------------------------------------ */
+
+int
+main(int argc, char* argv[]) {
+
+	BOOL	fRealTime;
+	DWORD	citer;
+	int		opt;
+
+	fRealTime = fFalse;
+	citer = citerDefault;
+
+	while ( -1 != (opt = getopt(argc, argv, "rn:v")) ) {
+		switch ( opt ) {
+			case 'r':
+				fRealTime = fTrue;
+				break;
+			case 'n':
+				citer = strtoul(optarg, NULL, 0);
+				break;
+			case 'v':
+				dpmutilfVerbose = fTrue;
+				break;
+			default:
+				fprintf(stderr, "usage: %s [-r] [-n iterations]\n", argv[0]);
+				return 2;
+		}
+	}
+
+	if ( 0 == citer ) {
+		citer = 1;
+	}
+
+	if (( ! FBenchClock(100000, fRealTime, citer) ) ||
+		( ! FBenchClock(400000, fRealTime, citer) )) {
+		return 1;
+	}
+
+	return 0;
+}
+
+/* ------------------------------------------------------------ */
+/*          Local Functions                                     */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/***    FBenchClock
+**
+**  Parameters:
+**      hzScl           - I2C clock frequency of the simulated bus
+**      fRealTime       - fTrue to run the simulation in real time
+**      citer           - number of iterations of each operation
+**
+**  Return Value:
+**      fTrue if every operation succeeded, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function simulates a board with a ZmodADC on port A and a
+**      ZmodDAC on port B and times each operation on it.
+*/
+static BOOL
+FBenchClock(DWORD hzScl, BOOL fRealTime, DWORD citer) {
+
+	static I2cSim	sim;
+	static BenchContext	ctx;
+	I2cSimTiming	timing;
+	BOOL			fRet;
+	WORD			cbRead;
+
+	fRet = fFalse;
+	ctx.fdI2c = -1;
+	ctx.sess.fOpen = fFalse;
+
+	I2CSimTimingFromClock(hzScl, &timing);
+	timing.fRealTime = fRealTime;
+	I2CSimInit(&sim, &timing);
+	I2CSimAddPod(&sim, 0, pdidBenchAdc, "Zmod ADC 1410-105", "SIM0000001");
+	I2CSimAddPod(&sim, 1, pdidBenchDac, "Zmod DAC 1411", "SIM0000002");
+	I2CHALSetDefaultBackend(&i2cbeSim, &sim);
+
+	printf("%u kHz%s\n", (unsigned)(hzScl / 1000), fRealTime ? ", real time" : "");
+	printf("%-16s %6s %10s %10s %10s %8s %8s %8s %8s\n",
+		"operation", "iter", "host us", "bus us", "delay us", "xfers", "msgs", "rd bytes", "wr bytes");
+
+	if (( ! FBenchRun(&sim, "FGetInfo", FBenchGetInfo, &ctx, citer) ) ||
+		( ! FBenchRun(&sim, "FEnum refresh", FBenchEnumRefresh, &ctx, citer) ) ||
+		( ! FBenchCheckPorts() ) ||
+		( ! FBenchRun(&sim, "FEnum cached", FBenchEnumCached, &ctx, citer) )) {
+		goto lErrorExit;
+	}
+
+	/* Rewrite the DNA of the ZmodADC with its own image, so that it's
+	** still valid afterwards, and check that it is.
+	*/
+	ctx.fdI2c = I2CHALOpenI2cController();
+	if ( 0 > ctx.fdI2c ) {
+		goto lErrorExit;
+	}
+
+	ctx.addrPod = rgportBench[0].i2cAddr;
+	ctx.cbDna = rgportBench[0].dna.header.cbDna;
+	if (( ! SyzygyI2cRead(ctx.fdI2c, ctx.addrPod, addrDnaStart, ctx.rgbDna, ctx.cbDna, &cbRead) ) ||
+		( cbRead != ctx.cbDna )) {
+		printf("failed to read the DNA of the simulated pod\n");
+		goto lErrorExit;
+	}
+
+	if (( ! FBenchRun(&sim, "DNA write", FBenchDnaWrite, &ctx, citer) ) ||
+		( ! FBenchEnumRefresh(&ctx) ) ||
+		( ! FBenchCheckPorts() )) {
+		goto lErrorExit;
+	}
+
+	/* Program the DNA of both pods, alternating between an altered image
+	** and the original one, and leave the original programmed.
+	*/
+	if (( ! FBenchPgmSetup(&ctx) ) ||
+		( ! FBenchRun(&sim, "DNA program", FBenchDnaProgram, &ctx, citer) ) ||
+		(( 0 != ctx.iimgPgm ) && ( ! FBenchDnaProgram(&ctx) )) ||
+		( ! FBenchEnumRefresh(&ctx) ) ||
+		( ! FBenchCheckPorts() )) {
+		goto lErrorExit;
+	}
+
+	if ( ! SamplerOpen(&ctx.smp, ctx.fdI2c) ) {
+		printf("SamplerOpen failed\n");
+		goto lErrorExit;
+	}
+
+	ctx.usTimestamp = 0;
+	if ( ! FBenchRun(&sim, "SamplerPoll", FBenchSamplerPoll, &ctx, citer) ) {
+		goto lErrorExit;
+	}
+
+	/* Compare reading the VADJ groups with answering admission queries
+	** from the power budget model, then check that the model follows a
+	** pod being removed and inserted again.
+	*/
+	if (( ! dpmutilOpen(&ctx.sess) ) ||
+		( ! dpmutilSessFWatchBegin(&ctx.sess, &ctx.watch) ) ||
+		( ! dpmutilSessFBudgetBegin(&ctx.sess, &ctx.watch, &ctx.budget) )) {
+		printf("failed to build the power budget model\n");
+		goto lErrorExit;
+	}
+
+	if (( ! FBenchRun(&sim, "FGetInfoVio", FBenchGetInfoVio, &ctx, citer) ) ||
+		( ! FBenchRun(&sim, "Budget admit", FBenchBudgetAdmit, &ctx, citer) ) ||
+		( ! FBenchCheckBudget(&sim, &ctx) )) {
+		goto lErrorExit;
+	}
+
+	printf("\n");
+	fRet = fTrue;
+
+lErrorExit:
+
+	dpmutilClose(&ctx.sess);
+
+	if ( 0 <= ctx.fdI2c ) {
+		I2CHALCloseI2cController(ctx.fdI2c);
+	}
+
+	I2CHALSetDefaultBackend(NULL, NULL);
+	I2CSimTerm(&sim);
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    FBenchRun
+**
+**  Parameters:
+**      psim            - simulated bus
+**      szOp            - name of the operation
+**      pfnOp           - operation
+**      pctx            - context of the operation
+**      citer           - number of iterations
+**
+**  Return Value:
+**      fTrue if every iteration succeeded, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function performs an operation repeatedly and prints the
+**      average cost of one iteration.
+*/
+static BOOL
+FBenchRun(I2cSim* psim, const char* szOp, PFNBENCHOP pfnOp, BenchContext* pctx, DWORD citer) {
+
+	I2cSimCounters	cnt;
+	UINT64			nsStart;
+	UINT64			nsHost;
+	DWORD			iiter;
+
+	I2CSimResetCounters(psim);
+	nsStart = NsBenchNow();
+
+	for ( iiter = 0; iiter < citer; iiter++ ) {
+		if ( ! pfnOp(pctx) ) {
+			printf("%-16s failed on iteration %u\n", szOp, (unsigned)iiter);
+			return fFalse;
+		}
+	}
+
+	nsHost = NsBenchNow() - nsStart;
+	I2CSimGetCounters(psim, &cnt);
+
+	printf("%-16s %6u %10.1f %10.1f %10.1f %8.1f %8.1f %8.1f %8.1f\n",
+		szOp,
+		(unsigned)citer,
+		(double)nsHost / 1000 / citer,
+		(double)cnt.nsBus / 1000 / citer,
+		(double)cnt.nsDelay / 1000 / citer,
+		(double)cnt.cxfer / citer,
+		(double)cnt.cmsg / citer,
+		(double)cnt.cbRead / citer,
+		(double)cnt.cbWrite / citer);
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    FBenchCheckPorts
+**
+**  Parameters:
+**      none
+**
+**  Return Value:
+**      fTrue if the last enumeration found both pods, fFalse otherwise
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function checks that the last enumeration read a valid DNA,
+**      PDID and factory and user calibration from both simulated pods.
+*/
+static BOOL
+FBenchCheckPorts(void) {
+
+	static const DWORD	rgpdid[] = { pdidBenchAdc, pdidBenchDac };
+	BYTE				iport;
+
+	for ( iport = 0; iport < sizeof(rgpdid) / sizeof(rgpdid[0]); iport++ ) {
+		if (( ! rgportBench[iport].fDna ) ||
+			( ! rgportBench[iport].dna.fPdid ) ||
+			( rgpdid[iport] != rgportBench[iport].dna.pdid ) ||
+			( ! rgportBench[iport].dna.fCal ) ||
+			( (fsZmodCalFactRead | fsZmodCalFactValid | fsZmodCalUserRead | fsZmodCalUserValid) != rgportBench[iport].dna.fsCal )) {
+			printf("port %c: the DNA or calibration of the simulated pod wasn't read\n", 'A' + iport);
+			return fFalse;
+		}
+	}
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    FBenchCheckBudget
+**
+**  Parameters:
+**      psim            - simulated board
+**      pctx            - context holding the watch and the power budget model
+**
+**  Return Value:
+**      fTrue if the model followed the removal and insertion of a pod
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function removes the pod on port B, polls the watch, and
+**      checks that the headroom of the 5V0 group of the port grew by the
+**      requirement of the pod and that the pod is no longer admitted.
+**      The pod is then inserted again and the headroom must return to
+**      its previous value.
+*/
+static BOOL
+FBenchCheckBudget(I2cSim* psim, BenchContext* pctx) {
+
+	const dpmutilPortInfo_t*	pport;
+	INT32						crntHeadroom;
+
+	pport = &pctx->watch.portInfo[1];
+	crntHeadroom = PwrBudgetHeadroom(&pctx->budget, pwrsup5v0, pport->group5v0);
+
+	I2CSimRemovePod(psim, 1);
+	if (( ! dpmutilSessFWatchPoll(&pctx->sess, &pctx->watch, BenchWatchEvent, &pctx->budget, NULL) ) ||
+		( crntHeadroom + rgportBench[1].dna.header.crntRequired5v0 != PwrBudgetHeadroom(&pctx->budget, pwrsup5v0, pport->group5v0) ) ||
+		( PwrBudgetFAdmit(&pctx->budget, 1, vltgBenchAdmit, NULL, NULL) )) {
+		printf("the power budget model didn't follow the removal of a pod\n");
+		return fFalse;
+	}
+
+	I2CSimAddPod(psim, 1, pdidBenchDac, "Zmod DAC 1411", "SIM0000002");
+	if (( ! dpmutilSessFWatchPoll(&pctx->sess, &pctx->watch, BenchWatchEvent, &pctx->budget, NULL) ) ||
+		( crntHeadroom != PwrBudgetHeadroom(&pctx->budget, pwrsup5v0, pport->group5v0) ) ||
+		( ! PwrBudgetFAdmit(&pctx->budget, 1, vltgBenchAdmit, NULL, NULL) )) {
+		printf("the power budget model didn't follow the insertion of a pod\n");
+		return fFalse;
+	}
+
+	return fTrue;
+}
+
+static void
+BenchWatchEvent(const dpmutilWatchEvent_t* pevt, void* pvContext) {
+
+	dpmutilBudgetUpdate((dpmutilBudget_t*)pvContext, pevt);
+}
+
+/* ------------------------------------------------------------ */
+/*          Operations                                          */
+/* ------------------------------------------------------------ */
+
+static BOOL
+FBenchGetInfo(BenchContext* pctx) {
+
+	(void)pctx;
+
+	return dpmutilFGetInfo(&devInfoBench);
+}
+
+static BOOL
+FBenchEnumRefresh(BenchContext* pctx) {
+
+	(void)pctx;
+
+	return dpmutilFEnum(fFalse, fFalse, fTrue, rgportBench);
+}
+
+static BOOL
+FBenchEnumCached(BenchContext* pctx) {
+
+	(void)pctx;
+
+	return dpmutilFEnum(fFalse, fFalse, fFalse, rgportBench);
+}
+
+static BOOL
+FBenchDnaWrite(BenchContext* pctx) {
+
+	WORD	cbWritten;
+
+	return SyzygyI2cWrite(pctx->fdI2c, pctx->addrPod, addrDnaStart, pctx->rgbDna, pctx->cbDna, &cbWritten) &&
+		   ( cbWritten == pctx->cbDna );
+}
+
+static BOOL
+FBenchDnaProgram(BenchContext* pctx) {
+
+	DnaPgmJob	rgjob[cpodBench];
+	BYTE		ipod;
+
+	pctx->iimgPgm = 1 - pctx->iimgPgm;
+	for ( ipod = 0; ipod < cpodBench; ipod++ ) {
+		DnaPgmJobInit(&rgjob[ipod], rgportBench[ipod].i2cAddr);
+		DnaPgmJobAddRegion(&rgjob[ipod], addrDnaStart, pctx->rgrgbPgm[ipod][pctx->iimgPgm], pctx->rgcbPgm[ipod]);
+	}
+
+	return DnaPgmRun(pctx->fdI2c, rgjob, cpodBench);
+}
+
+/* ------------------------------------------------------------ */
+/***    FBenchPgmSetup
+**
+**  Parameters:
+**      pctx            - context of the DNA program operation
+**
+**  Return Value:
+**      fTrue for success, fFalse if the DNA of a pod couldn't be read
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function reads the DNA of every pod and makes a copy whose
+**      strings are inverted. Every page of the copy differs from the
+**      original except the first, which only holds header fields.
+*/
+static BOOL
+FBenchPgmSetup(BenchContext* pctx) {
+
+	BYTE	ipod;
+	WORD	cbRead;
+	WORD	ib;
+
+	for ( ipod = 0; ipod < cpodBench; ipod++ ) {
+		pctx->rgcbPgm[ipod] = rgportBench[ipod].dna.header.cbDna;
+		if (( ! SyzygyI2cRead(pctx->fdI2c, rgportBench[ipod].i2cAddr, addrDnaStart, pctx->rgrgbPgm[ipod][0], pctx->rgcbPgm[ipod], &cbRead) ) ||
+			( cbRead != pctx->rgcbPgm[ipod] )) {
+			printf("failed to read the DNA of the simulated pod\n");
+			return fFalse;
+		}
+
+		memcpy(pctx->rgrgbPgm[ipod][1], pctx->rgrgbPgm[ipod][0], pctx->rgcbPgm[ipod]);
+		for ( ib = cbSyzygyDnaHeader; ib < pctx->rgcbPgm[ipod]; ib++ ) {
+			pctx->rgrgbPgm[ipod][1][ib] ^= 0xFF;
+		}
+	}
+
+	pctx->iimgPgm = 0;
+
+	return fTrue;
+}
+
+static BOOL
+FBenchGetInfoVio(BenchContext* pctx) {
+
+	return dpmutilSessFGetInfoVio(&pctx->sess, -1, pctx->rgpwr);
+}
+
+static BOOL
+FBenchBudgetAdmit(BenchContext* pctx) {
+
+	PwrAdmit	admit;
+	BYTE		ipod;
+
+	for ( ipod = 0; ipod < cpodBench; ipod++ ) {
+		if (( ! PwrBudgetFAdmit(&pctx->budget, ipod, vltgBenchAdmit, NULL, NULL) ) ||
+			( PwrBudgetFAdmit(&pctx->budget, ipod, vltgBenchRefuse, NULL, &admit) ) ||
+			( fsPwrRefuseRange != admit.fsRefuse )) {
+			printf("port %c: unexpected admission result\n", 'A' + ipod);
+			return fFalse;
+		}
+	}
+
+	return fTrue;
+}
+
+static BOOL
+FBenchSamplerPoll(BenchContext* pctx) {
+
+	pctx->usTimestamp += 1000;
+
+	return SamplerPoll(&pctx->smp, pctx->usTimestamp);
+}
+
+/* ------------------------------------------------------------ */
+/***    NsBenchNow
+**
+**  Parameters:
+**      none
+**
+**  Return Value:
+**      monotonic time in nanoseconds
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      This function returns the time used to measure the host time of
+**      an operation.
+*/
+static UINT64
+NsBenchNow(void) {
+
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((UINT64)ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+/* ------------------------------------------------------------ */
+
+/************************************************************************/
@@ -40,6 +40,19 @@
 /*      and ZmodLOOP.c                                                  */
 /*	05/04/2020(ThomasK): namechange to dpmutil.c. Changed from linux    */
 /* 		console app to baremetal api                                    */
+/*	10/14/2026: added dpmutilOpenBus and dpmutilFEnumAll, which         */
+/*		enumerates the ports of every PMCU I2C bus in parallel          */
+/*	10/14/2026: dpmutilfVerbose is now per thread. The set functions    */
+/*		hold the bus lock across their read-modify-write sequences      */
+/*	10/14/2026: wait for the PMCU to respond instead of fixed delays	*/
+/*		after configuration writes and resets                           */
+/*	10/14/2026: added dpmutilFCommitConfig                              */
+/*	10/14/2026: Zmod calibration is converted and displayed through the */
+/*		family handler table, which adds the ZmodDigitizer              */
+/*	10/14/2026: added dpmutilSessFWatchBegin and dpmutilSessFWatchPoll  */
+/*	10/14/2026: added dpmutilGetStats and dpmutilResetStats             */
+/*	10/14/2026: dpmutilSessFGetInfo negotiates the PMCU transaction sizes */
+/*	10/14/2026: added dpmutilSessFBudgetBegin and dpmutilBudgetUpdate   */
 /*                                                                      */
 /************************************************************************/
 
@@ -55,11 +68,13 @@
 #include <stdio.h>
 #include <linux/i2c-dev.h>
 #include <time.h>
+#include <pthread.h>
 #else
 #include "sleep.h"
 #endif
 #include "dpmutil.h"
 #include <stdio.h>
+#include <string.h>
 
 /* ------------------------------------------------------------ */
 /*                  Miscellaneous Declarations                  */
@@ -70,33 +85,231 @@
 */
 #define addrPdid			0x80FC
 
-/* The following macro can be utilized to convert a Digilent PDID
-** into a product.
+/* Define the mask of the f5v0InLimit, f3v3InLimit and fVioInLimit flags
+** of the PMCU port status register.
 */
-#define ProductFromPdid(pdid)   ((pdid >> 20) & 0xFFF)
+#define fsPortStsInLimit	0x1C
 
 /* ------------------------------------------------------------ */
 /*                  Local Type Definitions                      */
 /* ------------------------------------------------------------ */
 
+#if defined(__linux__)
+/* Arguments and results of a dpmutilFEnumAll worker thread.
+*/
+typedef struct{
+	BYTE					ibus;
+	BOOL					fVerbose;		// dpmutilfVerbose of the calling thread
+	BOOL					setCrcCheck;
+	BOOL					crcCheck;
+	BOOL					fRefresh;
+	dpmutilBusInfo_t*		pBusInfo;
+}dpmutilEnumWork_t;
+#endif
+
 /* ------------------------------------------------------------ */
 /*                   Global Variables                           */
 /* ------------------------------------------------------------ */
 
-BOOL dpmutilfVerbose;
+I2CHALThreadLocal BOOL dpmutilfVerbose;
 
 /* ------------------------------------------------------------ */
 /*                  Local Variables                             */
 /* ------------------------------------------------------------ */
 
+/* ------------------------------------------------------------ */
+/*                  Forward Declarations                        */
+/* ------------------------------------------------------------ */
+
+static BOOL	FSessEnumPorts(dpmutilSession_t* psess, BOOL setCrcCheck, BOOL crcCheck, BOOL fRefresh, dpmutilPortInfo_t pPortInfo[], BYTE* pcport);
+static void	FillDnaInfo(DnaCacheEntry* pentry, dpmutilDnaInfo_t* pdna);
+#if defined(__linux__)
+static void*	EnumBusThread(void* pvWork);
+#endif
+
 /* ------------------------------------------------------------ */
 /*                  Procedure Definitions                       */
 /* ------------------------------------------------------------ */
 
 /* ------------------------------------------------------------ */
-/***    dpmutilFGetInfo
+/***    dpmutilOpen
+**
+**  Parameters:
+**      psess			- pointer to a dpmutilSession_t object to initialize
+**
+**  Return Values:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**
+**  Description:
+**      Open a session with the Platform MCU. On Linux the I2C controller
+**      attached to the Platform MCU / SYZYGY I2C bus is located and opened
+**      once, and the resulting file descriptor is kept by the session for
+**      use by all of the dpmutilSess functions. On baremetal the I2C device
+**      with deviceID 0 is initialized if that has not already been done.
+**
+**      The session must be closed with dpmutilClose once the caller is
+**      done using it.
+*/
+BOOL
+dpmutilOpen(dpmutilSession_t* psess) {
+
+	if ( NULL == psess ) {
+		return fFalse;
+	}
+
+	psess->fdI2c = -1;
+	psess->ibus = 0;
+	psess->fOpen = fFalse;
+
+#if defined(__linux__)
+	psess->fdI2c = I2CHALOpenI2cController();
+	if ( 0 > psess->fdI2c ) {
+		if(dpmutilfVerbose)printf("ERROR: failed to open file descriptor for I2C device\n");
+		return fFalse;
+	}
+#else
+	if(!I2CHALInit(0)){
+		if(dpmutilfVerbose)printf("ERROR: failed to initialize I2C device\n");
+		return fFalse;
+	}
+#endif
+
+	psess->fOpen = fTrue;
+
+	return fTrue;
+}
+
+#if defined(__linux__)
+/* ------------------------------------------------------------ */
+/***    dpmutilOpenBus
+**
+**  Parameters:
+**      psess			- pointer to a dpmutilSession_t object to initialize
+**      szDevPath		- path of the I2C controller device node
+**      ibus			- index of the bus, as returned by dpmutilFEnumAll
+**
+**  Return Values:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**
+**  Description:
+**      Open a session with the Platform MCU attached to the I2C controller
+**      with the specified device node. This is used on systems with more
+**      than one PMCU I2C bus, whose controllers can be found with
+**      I2CHALEnumI2cControllers. The bus index keys the DNA cache and
+**      must be the index of the controller in the list returned by
+**      I2CHALEnumI2cControllers.
+**
+**      The session must be closed with dpmutilClose once the caller is
+**      done using it.
+*/
+BOOL
+dpmutilOpenBus(dpmutilSession_t* psess, const char* szDevPath, BYTE ibus) {
+
+	if (( NULL == psess ) || ( NULL == szDevPath )) {
+		return fFalse;
+	}
+
+	psess->fdI2c = -1;
+	psess->ibus = ibus;
+	psess->fOpen = fFalse;
+
+	psess->fdI2c = I2CHALOpenI2cControllerPath(szDevPath);
+	if ( 0 > psess->fdI2c ) {
+		if(dpmutilfVerbose)printf("ERROR: failed to open file descriptor for I2C device \"%s\"\n", szDevPath);
+		return fFalse;
+	}
+
+	psess->fOpen = fTrue;
+
+	return fTrue;
+}
+#endif
+
+/* ------------------------------------------------------------ */
+/***    dpmutilClose
 **
 **  Parameters:
+**      psess			- pointer to a session opened with dpmutilOpen
+**
+**  Return Values:
+**      none
+**
+**  Errors:
+**
+**  Description:
+**      Close a session that was opened with dpmutilOpen and release the
+**      I2C controller file descriptor held by it.
+*/
+void
+dpmutilClose(dpmutilSession_t* psess) {
+
+	if (( NULL == psess ) || ( ! psess->fOpen )) {
+		return;
+	}
+
+#if defined(__linux__)
+	I2CHALCloseI2cController(psess->fdI2c);
+#endif
+
+	psess->fdI2c = -1;
+	psess->fOpen = fFalse;
+}
+
+/* ------------------------------------------------------------ */
+/***    dpmutilGetStats
+**
+**  Parameters:
+**      pstats			- pointer to a dpmutilStats_t object to store data
+**
+**  Return Values:
+**      fTrue for success, fFalse if dpmutil was built without
+**      DPMUTIL_STATS
+**
+**  Errors:
+**
+**  Description:
+**      Get the number of I2C transfers performed on each controller and
+**      on each slave address, the bytes transferred, the time spent in
+**      transfers and in the delays they require, and a histogram of
+**      their latencies. Counting starts with the first transfer or the
+**      last call to dpmutilResetStats and includes the transfers of
+**      every session and every thread.
+*/
+BOOL
+dpmutilGetStats(dpmutilStats_t* pstats) {
+
+	return I2CHALGetStats(pstats);
+}
+
+/* ------------------------------------------------------------ */
+/***    dpmutilResetStats
+**
+**  Parameters:
+**      none
+**
+**  Return Values:
+**      none
+**
+**  Errors:
+**
+**  Description:
+**      Zero the transfer statistics returned by dpmutilGetStats.
+*/
+void
+dpmutilResetStats() {
+
+	I2CHALResetStats();
+}
+
+/* ------------------------------------------------------------ */
+/***    dpmutilSessFGetInfo
+**
+**  Parameters:
+**      psess			- pointer to an open dpmutil session
 **      pDevInfo		- Pointer to a dpmutilDevInfo_t object to store data
 **
 **  Return Values:
@@ -115,309 +328,125 @@ BOOL dpmutilfVerbose;
 **      number of fans supported by the board. If the board supports
 **      one or more temperature probe then the capabilities of each
 **      supported probe and the most recent temperature measurement
-**      of that probe are displayed via the console. If the board
-**      supports one or more fan then the capabilities of each
-**      supported fan are displayed via the console and if a fan supports
-**      RPM measurement then the most recent RPM measurement is also
-**      displayed.
+**      of that probe are retrieved. If the board supports one or more
+**      fan then the capabilities, configuration and most recent RPM
+**      measurement of each supported fan are retrieved.
+**
+**      When dpmutilfVerbose is set the information is displayed via
+**      the console using dpmutilPrintDevInfo.
 */
 BOOL
-dpmutilFGetInfo(dpmutildevInfo_t* pDevInfo) {
+dpmutilSessFGetInfo(dpmutilSession_t* psess, dpmutildevInfo_t* pDevInfo) {
 
 	int						fdI2c;
-	WORD					wTemp;
 	BYTE					i;
+	PMCU_SNAPSHOT			snap;
 
-	fdI2c = -1;
-#if defined(__linux__)
+	fdI2c = psess->fdI2c;
 
-	fdI2c = I2CHALOpenI2cController();
-	if ( 0 > fdI2c ) {
-		printf("ERROR: failed to open file descriptor for I2C device\n");
-		goto lErrorExit;
-	}
-#else
-	if(!I2CHALInit(0)){
-		printf("ERROR: failed to initialize I2C device\n");
-		goto lErrorExit;
-	}
-#endif
-	/* Read and display the PDID.
+	/* Read the firmware and configuration registers of the PMCU in as few
+	** transactions as possible. All of the information reported by this
+	** function is decoded from the snapshot.
 	*/
-	if ( ! PmcuI2cRead(fdI2c, regaddrPDID, (BYTE*)(&pDevInfo->pdid), 4, NULL) ) {
-		printf("ERROR: failed to read PDID\n");
+	if ( ! PmcuReadSnapshot(fdI2c, &snap) ) {
+		if(dpmutilfVerbose)printf("ERROR: failed to read PMCU registers\n");
 		goto lErrorExit;
 	}
-	if(dpmutilfVerbose)printf("PMCU_PDID:                       0x%08X\n", (unsigned int)pDevInfo->pdid);
 
-	/* Read and display the firmware revision number.
+	/* Use the largest transfers the firmware supports from now on.
 	*/
-	if ( ! PmcuI2cRead(fdI2c, regaddrFirmwareVersion, (BYTE*)(&wTemp), 2, NULL) ) {
-		printf("ERROR: failed to read FIRMWARE_VERSION register\n");
-		goto lErrorExit;
-	}
-	if(dpmutilfVerbose)printf("PMCU_FIRMWARE_VERSION:           %d.%d\n", wTemp >> 8, wTemp & 0xFF);
-	pDevInfo->fwVer = wTemp / (1<<8);
+	PmcuNegotiateXfer(snap.fwregs.fwver);
 
-	/* Read and display the configuration revision number.
+	/* Get the PDID.
 	*/
-	if ( ! PmcuI2cRead(fdI2c, regaddrConfigurationVersion, (BYTE*)(&wTemp), 2, NULL) ) {
-		printf("ERROR: failed to read CONFIGURATION_VERSION register\n");
-		goto lErrorExit;
-	}
-	if(dpmutilfVerbose)printf("PMCU_CONFIGURATION_VERSION:      %d.%d\n", wTemp >> 8, wTemp & 0xFF);
-	pDevInfo->cfgVer = wTemp / (1<<8);
+	pDevInfo->pdid = snap.fwregs.pdid;
 
-	/* Read and display the platform configuration.
+	/* Get the firmware revision number.
 	*/
-	if ( ! PmcuI2cRead(fdI2c, regaddrPlatformConfig, (BYTE*)(&pDevInfo->platcfg), 2, NULL) ) {
-		printf("ERROR: failed to read PLATFORM_CONFIGURATION register\n");
-		goto lErrorExit;
-	}
+	pDevInfo->fwVerRaw = snap.fwregs.fwver;
+	pDevInfo->fwVer = pDevInfo->fwVerRaw / (1<<8);
 
-	if(dpmutilfVerbose){
-		memcpy(&wTemp, &(pDevInfo->platcfg), 2);
-		printf("PLATFORM_CONFIGURATION:          0x%04X\n", wTemp);
-		printf("    ENFORCE_5V0_CURRENT_LIMIT    [%c]\n", pDevInfo->platcfg.fEnforce5v0CurLimit ? 'Y':'N');
-		printf("    ENFORCE_3V3_CURRENT_LIMIT    [%c]\n", pDevInfo->platcfg.fEnforce3v3CurLimit ? 'Y':'N');
-		printf("    ENFORCE_VIO_CURRENT_LIMIT    [%c]\n", pDevInfo->platcfg.fEnforceVioCurLimit ? 'Y':'N');
-		printf("    PERFORM_SYZYGY_CRC_CHECK     [%c]\n", pDevInfo->platcfg.fPerformCrcCheck ? 'Y':'N');
-	}
+	/* Get the configuration revision number.
+	*/
+	pDevInfo->cfgVerRaw = snap.cfgregs.cfgver;
+	pDevInfo->cfgVer = pDevInfo->cfgVerRaw / (1<<8);
 
-	/* Read and display the SmartVio port count.
+	/* Get the platform configuration.
 	*/
-	if ( ! PmcuI2cRead(fdI2c, regaddrPortCount, &pDevInfo->cntVioPort, 1, NULL) ) {
-		printf("ERROR: failed to read SMARTVIO_PORT_COUNT register\n");
-		goto lErrorExit;
-	}
-	if(dpmutilfVerbose)printf("SMARTVIO_PORT_COUNT:             %d\n", pDevInfo->cntVioPort);
+	pDevInfo->platcfg = snap.cfgregs.platcfg;
 
-	/* Read and display the 5V0 group count.
+	/* Get the SmartVio port count.
 	*/
-	if ( ! PmcuI2cRead(fdI2c, regaddr5v0GroupCount, &pDevInfo->cnt5v0, 1, NULL) ) {
-		printf("ERROR: failed to read 5V0_GROUP_COUNT register\n");
-		goto lErrorExit;
-	}
-	if(dpmutilfVerbose)printf("5V0_GROUP_COUNT:                 %d\n", pDevInfo->cnt5v0);
+	pDevInfo->cntVioPort = snap.cfgregs.cport;
 
-	/* Read and display the 3V3 group count.
+	/* Get the 5V0 group count.
 	*/
-	if ( ! PmcuI2cRead(fdI2c, regaddr3v3GroupCount, &pDevInfo->cnt3v3, 1, NULL) ) {
-		printf("ERROR: failed to read 3V3_GROUP_COUNT register\n");
-		goto lErrorExit;
-	}
-	if(dpmutilfVerbose)printf("3V3_GROUP_COUNT:                 %d\n", pDevInfo->cnt3v3);
+	pDevInfo->cnt5v0 = snap.cfgregs.c5v0;
 
-	/* Read and display the VADJ group count.
+	/* Get the 3V3 group count.
 	*/
-	if ( ! PmcuI2cRead(fdI2c, regaddrVadjGroupCount, &pDevInfo->cntVadj, 1, NULL) ) {
-		printf("ERROR: failed to read VADJ_GROUP_COUNT register\n");
-		goto lErrorExit;
-	}
-	if(dpmutilfVerbose)printf("VADJ_GROUP_COUNT:                %d\n", pDevInfo->cntVadj);
+	pDevInfo->cnt3v3 = snap.cfgregs.c3v3;
 
-	/* Read and display the temperature probe count.
+	/* Get the VADJ group count.
 	*/
-	if ( ! PmcuI2cRead(fdI2c, regaddrTempProbeCount, &pDevInfo->cntProbe, 1, NULL) ) {
-		printf("ERROR: failed to read TEMPERATURE_PROBE_COUNT register\n");
-		goto lErrorExit;
+	pDevInfo->cntVadj = snap.cfgregs.cvadj;
+
+	/* Get the temperature probe count.
+	*/
+	pDevInfo->cntProbe = snap.cfgregs.cprobe;
+	if ( cPmcuTempProbeMax < pDevInfo->cntProbe ) {
+		pDevInfo->cntProbe = cPmcuTempProbeMax;
 	}
-	if(dpmutilfVerbose)printf("TEMPERATURE_PROBE_COUNT:         %d\n", pDevInfo->cntProbe);
 
 	for ( i = 0; i < pDevInfo->cntProbe; i++ ) {
 
-		/* Read and display this temperature probe's capabilities.
+		/* Get this temperature probe's capabilities.
 		*/
-		if ( ! PmcuI2cRead(fdI2c, regaddrTemp1Attributes + (offsetTemperatureReg*i), (BYTE*)&pDevInfo->probeAttr[i], 1, NULL) ) {
-			printf("ERROR: failed to read TEMPERATURE_%d_ATTRIBUTES register\n", i+1);
-			goto lErrorExit;
-		}
-		if(dpmutilfVerbose){
-			printf("    TEMPERATURE_%d_CAPABILITIES:  0x%02X\n", i + 1, pDevInfo->probeAttr[i].fs);
-			printf("        PRESENT                  [%c]\n", pDevInfo->probeAttr[i].fPresent ? 'Y' : 'N');
-			printf("        LOCATION                 ");
-			switch ( pDevInfo->probeAttr[i].tlocation ) {
-				case tlocationFpgaCpu1:
-					printf("FPGA/CPU_1\n");
-					break;
-				case tlocationFpgaCpu2:
-					printf("FPGA/CPU_2\n");
-					break;
-				case tlocationExternal1:
-					printf("EXTERNAL_1\n");
-					break;
-				case tlocationExternal2:
-					printf("EXTERNAL_2\n");
-					break;
-				default:
-					printf("UNKNOWN\n");
-					break;
-			}
-			printf("        TEMPERATURE_FORMAT       ");
-			switch ( pDevInfo->probeAttr[i].tformat ) {
-				case tformatDegCDecimal:
-					printf("Degrees C (decimal)\n");
-					break;
-				case tformatDegCFixedPoint:
-					printf("Degrees C (fixed point)\n");
-					break;
-				case tformatDegFDecimal:
-					printf("Degrees F (decimal)\n");
-					break;
-				case tformatDegFFixedPoint:
-					printf("Degrees F (fixed point)\n");
-					break;
-				default:
-					printf("UNKNOWN\n");
-					break;
-			}
-		}
+		pDevInfo->probeAttr[i] = snap.cfgregs.rgtemp[i].attr;
 
-		/* Read and display this probe's temperature.
+		/* Get this probe's temperature.
 		*/
-		if ( ! PmcuI2cRead(fdI2c, regaddrTemp1 + (offsetTemperatureReg*i), (BYTE*)&pDevInfo->temp[i], 2, NULL) ) {
-			printf("ERROR: failed to read TEMPERATURE_%d register\n", i+1);
-			goto lErrorExit;
-		}
-		if(dpmutilfVerbose){
-			printf("    TEMPERATURE_%d:               ", i + 1);
-			switch ( pDevInfo->probeAttr[i].tformat ) {
-				case tformatDegCDecimal:
-					printf("%hd Degrees C\n", pDevInfo->temp[i]);
-					break;
-				case tformatDegCFixedPoint:
-					printf("%8.2f Degrees C\n", pDevInfo->temp[i] / 256.0);
-					break;
-				case tformatDegFDecimal:
-					printf("%hd Degrees F\n", pDevInfo->temp[i]);
-					break;
-				case tformatDegFFixedPoint:
-					printf("%8.2f Degrees F\n", pDevInfo->temp[i] / 256.0);
-					break;
-				default:
-					printf("UNKNOWN\n");
-					break;
-			}
-
-			if ( (i+1) != pDevInfo->cntProbe ) {
-				printf("\n");
-			}
-		}
+		pDevInfo->temp[i] = snap.cfgregs.rgtemp[i].temp;
 	}
 
-	/* Read and display the fan count.
+	/* Get the fan count.
 	*/
-	if ( ! PmcuI2cRead(fdI2c, regaddrFanCount, &pDevInfo->cntFan, 1, NULL) ) {
-		printf("ERROR: failed to read FAN_COUNT register\n");
-		goto lErrorExit;
+	pDevInfo->cntFan = snap.cfgregs.cfan;
+	if ( cPmcuFanMax < pDevInfo->cntFan ) {
+		pDevInfo->cntFan = cPmcuFanMax;
 	}
-	if(dpmutilfVerbose)printf("FAN_COUNT:                       %d\n", pDevInfo->cntFan);
 
 	for ( i = 0; i < pDevInfo->cntFan; i++ ) {
 
-		/* Read and display this fan's capabilities.
-		*/
-		if ( ! PmcuI2cRead(fdI2c, regaddrFan1Capabilities + (offsetFanReg*i), (BYTE*)&pDevInfo->fanCapabilities[i], 1, NULL) ) {
-			printf("ERROR: failed to read FAN_%d_CAPABILITIES register\n", i+1);
-			goto lErrorExit;
-		}
-		if(dpmutilfVerbose){
-			printf("    FAN_%d_CAPABILITIES:          0x%02X\n", i + 1, pDevInfo->fanCapabilities[i].fs);
-			printf("        ENABLE_AND_DISABLE       [%c]\n", pDevInfo->fanCapabilities[i].fcapEnable ? 'Y' : 'N');
-			printf("        SET_FIXED_SPEED          [%c]\n", pDevInfo->fanCapabilities[i].fcapSetSpeed ? 'Y' : 'N');
-			printf("        AUTO_SPEED_CONTROL       [%c]\n", pDevInfo->fanCapabilities[i].fcapAutoSpeed ? 'Y' : 'N');
-			printf("        MEASURE_RPM              [%c]\n", pDevInfo->fanCapabilities[i].fcapMeasureRpm ? 'Y' : 'N');
-		}
-		/* Read and display this fan's configuration.
+		/* Get this fan's capabilities.
 		*/
-		if ( ! PmcuI2cRead(fdI2c, regaddrFan1Config + (offsetFanReg*i), (BYTE*)&pDevInfo->fanConfig[i], 1, NULL) ) {
-			printf("ERROR: failed to read FAN_%d_CONFIGURATION register\n", i+1);
-			goto lErrorExit;
-		}
-		if(dpmutilfVerbose){
-			printf("    FAN_%d_CONFIGURATION:         0x%02X\n", i + 1, pDevInfo->fanConfig[i].fs);
-			printf("        ENABLE                   [%c]\n", pDevInfo->fanConfig[i].fEnable ? 'Y' : 'N');
-			printf("        SPEED                    ");
-			switch ( pDevInfo->fanConfig[i].fspeed ) {
-				case fancfgMinimumSpeed:
-					printf("MINIMUM\n");
-					break;
-				case fancfgMediumSpeed:
-					printf("MEDIUM\n");
-					break;
-				case fancfgMaximumSpeed:
-					printf("MAXIMUM\n");
-					break;
-				case fancfgAutoSpeed:
-					printf("AUTOMATIC\n");
-					break;
-				default:
-					printf("UNKNOWN\n");
-					break;
-			}
-			printf("        TEMPERATURE_SOURCE       ");
-			switch ( pDevInfo->fanConfig[i].tempsrc ) {
-				case fancfgTempProbeNone:
-					printf("NONE\n");
-					break;
-				case fancfgTempProbe1:
-					printf("TEMP_PROBE_1\n");
-					break;
-				case fancfgTempProbe2:
-					printf("TEMP_PROBE_2\n");
-					break;
-				case fancfgTempProbe3:
-					printf("TEMP_PROBE_3\n");
-					break;
-				case fancfgTempProbe4:
-					printf("TEMP_PROBE_4\n");
-					break;
-				default:
-					printf("UNKNOWN\n");
-					break;
-			}
+		pDevInfo->fanCapabilities[i] = snap.cfgregs.rgfan[i].fcap;
 
-			printf("        MEASURE_RPM              [%c]\n", pDevInfo->fanCapabilities[i].fcapMeasureRpm ? 'Y' : 'N');
-		}
-
-		/* Read and display this fan's RPM.
+		/* Get this fan's configuration.
 		*/
-		if ( ! PmcuI2cRead(fdI2c, regaddrFan1Rpm + (offsetFanReg*i), (BYTE*)(&pDevInfo->fanRPM[i]), 2, NULL) ) {
-			printf("ERROR: failed to read FAN_%d_RPM register\n", i+1);
-			goto lErrorExit;
-		}
-		if(dpmutilfVerbose){
-			printf("    FAN_%d_RPM:                   %d\n", i+1, pDevInfo->fanRPM[i]);
-
+		pDevInfo->fanConfig[i] = snap.cfgregs.rgfan[i].fcfg;
 
-			if ( (i+1) != pDevInfo->cntFan ) {
-				printf("\n");
-			}
-		}
+		/* Get this fan's RPM.
+		*/
+		pDevInfo->fanRPM[i] = snap.cfgregs.rgfan[i].rpm;
 	}
 
-#if defined(__linux__)
-	/* Close the I2C controller file descriptor.
-	*/
-	close(fdI2c);
-#endif
+	if ( dpmutilfVerbose ) {
+		dpmutilPrintDevInfo(pDevInfo);
+	}
 
 	return fTrue;
 
 lErrorExit:
-#if defined(__linux__)
-	if ( 0 <= fdI2c ) {
-		close(fdI2c);
-	}
-#endif
 	return fFalse;
 }
 
 
 /* ------------------------------------------------------------ */
-/***    dpmutilFGetInfoPower
+/***    dpmutilSessFGetInfoPower
 **
 **  Parameters:
+**      psess			- pointer to an open dpmutil session
 **      chanid			- channel id to get power from. -1 to scan all
 **      pPowerInfo		- Pointer to a dpmutilPowerInfo_t array [8] to store data
 **
@@ -440,25 +469,25 @@ lErrorExit:
 **      for every channel supported by the board.
 */
 BOOL
-dpmutilFGetInfoPower(int chanid, dpmutilPowerInfo_t pPowerInfo[]) {
+dpmutilSessFGetInfoPower(dpmutilSession_t* psess, int chanid, dpmutilPowerInfo_t pPowerInfo[]) {
 
 	BOOL	fRet;
 
 	fRet = fTrue;
 
-	if ( ! dpmutilFGetInfo5V0(chanid, pPowerInfo) ) {
+	if ( ! dpmutilSessFGetInfo5V0(psess, chanid, pPowerInfo) ) {
 		fRet = fFalse;
 	}
 
 	if(dpmutilfVerbose)printf("\n");
 
-	if ( ! dpmutilFGetInfo3V3(chanid, pPowerInfo) ) {
+	if ( ! dpmutilSessFGetInfo3V3(psess, chanid, pPowerInfo) ) {
 		fRet = fFalse;
 	}
 
 	if(dpmutilfVerbose)printf("\n");
 
-	if ( ! dpmutilFGetInfoVio(chanid, pPowerInfo) ) {
+	if ( ! dpmutilSessFGetInfoVio(psess, chanid, pPowerInfo) ) {
 		fRet = fFalse;
 	}
 
@@ -466,9 +495,10 @@ dpmutilFGetInfoPower(int chanid, dpmutilPowerInfo_t pPowerInfo[]) {
 }
 
 /* ------------------------------------------------------------ */
-/***    dpmutilFGetInfo5V0
+/***    dpmutilSessFGetInfo5V0
 **
 **  Parameters:
+**      psess			- pointer to an open dpmutil session
 **      chanid			- channel id to get power from. -1 to scan all
 **      pPowerInfo		- Pointer to a dpmutilPowerInfo_t array [8] to store data
 **
@@ -493,36 +523,27 @@ dpmutilFGetInfoPower(int chanid, dpmutilPowerInfo_t pPowerInfo[]) {
 **      for every channel supported by the board.
 */
 BOOL
-dpmutilFGetInfo5V0(int chanid, dpmutilPowerInfo_t pPowerInfo[]) {
+dpmutilSessFGetInfo5V0(dpmutilSession_t* psess, int chanid, dpmutilPowerInfo_t pPowerInfo[]) {
 
 	int				fdI2c;
 	BYTE			csupply;
 	BYTE			isupply;
 
-	fdI2c = -1;
-#if defined(__linux__)
-	fdI2c = I2CHALOpenI2cController();
-	if ( 0 > fdI2c ) {
-		printf("ERROR: failed to open file descriptor for I2C device\n");
-		goto lErrorExit;
-	}
-#else
-	if(!I2CHALInit(0)){
-		printf("ERROR: failed to initialize I2C device\n");
-		goto lErrorExit;
-	}
-#endif
+	fdI2c = psess->fdI2c;
+
 	/* Determine how many 5V0 supplies there are.
 	*/
 	if ( ! PmcuI2cRead(fdI2c, regaddr5v0GroupCount, &csupply, 1, NULL) ) {
-		printf("ERROR: failed to read 5V0_GROUP_COUNT register\n");
+		if(dpmutilfVerbose)printf("ERROR: failed to read 5V0_GROUP_COUNT register\n");
 		goto lErrorExit;
 	}
 
 	if ( chanid != -1 ) {
 		if ( chanid >= csupply ) {
-			printf("ERROR: device has %d 5V0 supplies. Channel %d is\n", csupply, chanid);
-			printf("not supported by this device\n");
+			if(dpmutilfVerbose){
+				printf("ERROR: device has %d 5V0 supplies. Channel %d is\n", csupply, chanid);
+				printf("not supported by this device\n");
+			}
 			goto lErrorExit;
 		}
 
@@ -548,7 +569,7 @@ dpmutilFGetInfo5V0(int chanid, dpmutilPowerInfo_t pPowerInfo[]) {
 		/* Read and display the current allowed for the supply.
 		*/
 		if ( ! PmcuI2cRead(fdI2c, regaddr5v0ACurrentAllowed + (offset5v0Reg*isupply), (BYTE*)&pPowerInfo[isupply].currentAllowed5v0, 2, NULL) ) {
-			printf("ERROR: failed to read 5V0_%c_CURRENT_ALLOWED register\n", 0x41 + isupply);
+			if(dpmutilfVerbose)printf("ERROR: failed to read 5V0_%c_CURRENT_ALLOWED register\n", 0x41 + isupply);
 			goto lErrorExit;
 		}
 		if(dpmutilfVerbose)printf("    5V0_%c_CURRENT_ALLOWED:       %d mA\n", 0x41 + isupply, pPowerInfo[isupply].currentAllowed5v0);
@@ -556,7 +577,7 @@ dpmutilFGetInfo5V0(int chanid, dpmutilPowerInfo_t pPowerInfo[]) {
 		/* Read and display the current requested for the supply.
 		*/
 		if ( ! PmcuI2cRead(fdI2c, regaddr5v0ACurrentRequested + (offset3v3Reg*isupply), (BYTE*)&pPowerInfo[isupply].currentRequested5v0, 2, NULL) ) {
-			printf("ERROR: failed to read 5V0_%c_CURRENT_REQUESTED register\n", 0x41 + isupply);
+			if(dpmutilfVerbose)printf("ERROR: failed to read 5V0_%c_CURRENT_REQUESTED register\n", 0x41 + isupply);
 			goto lErrorExit;
 		}
 		if(dpmutilfVerbose)printf("    5V0_%c_CURRENT_REQUESTED:     %d mA\n", 0x41 + isupply, pPowerInfo[isupply].currentRequested5v0);
@@ -569,28 +590,18 @@ dpmutilFGetInfo5V0(int chanid, dpmutilPowerInfo_t pPowerInfo[]) {
 		}
 	}
 
-#if defined(__linux__)
-	/* Close the I2C controller file descriptor.
-	*/
-	close(fdI2c);
-#endif
 
 	return fTrue;
 
 lErrorExit:
-#if defined(__linux__)
-	if ( 0 <= fdI2c ) {
-		close(fdI2c);
-	}
-#endif
-
 	return fFalse;
 }
 
 /* ------------------------------------------------------------ */
-/***    dpmutilFGetInfo3V3
+/***    dpmutilSessFGetInfo3V3
 **
 **  Parameters:
+**      psess			- pointer to an open dpmutil session
 **      chanid			- channel id to get power from. -1 to scan all
 **      pPowerInfo		- Pointer to a dpmutilPowerInfo_t array [8] to store data
 **
@@ -615,37 +626,27 @@ lErrorExit:
 **      for every channel supported by the board.
 */
 BOOL
-dpmutilFGetInfo3V3(int chanid, dpmutilPowerInfo_t pPowerinfo[]) {
+dpmutilSessFGetInfo3V3(dpmutilSession_t* psess, int chanid, dpmutilPowerInfo_t pPowerinfo[]) {
 
 	int				fdI2c;
 	BYTE			csupply;
 	BYTE			isupply;
 
-	fdI2c = -1;
-#if defined(__linux__)
-	fdI2c = I2CHALOpenI2cController();
-	if ( 0 > fdI2c ) {
-		printf("ERROR: failed to open file descriptor for I2C device\n");
-		goto lErrorExit;
-	}
-#else
-	if(!I2CHALInit(0)){
-		printf("ERROR: failed to initialize I2C device\n");
-		goto lErrorExit;
-	}
-#endif
+	fdI2c = psess->fdI2c;
 
 	/* Determine how many 3V3 supplies there are.
 	*/
 	if ( ! PmcuI2cRead(fdI2c, regaddr3v3GroupCount, &csupply, 1, NULL) ) {
-		printf("ERROR: failed to read 3V3_GROUP_COUNT register\n");
+		if(dpmutilfVerbose)printf("ERROR: failed to read 3V3_GROUP_COUNT register\n");
 		goto lErrorExit;
 	}
 
 	if ( chanid != -1 ) {
 		if ( chanid >= csupply ) {
-			printf("ERROR: device has %d 3V3 supplies. Channel %d is\n", csupply, chanid);
-			printf("not supported by this device\n");
+			if(dpmutilfVerbose){
+				printf("ERROR: device has %d 3V3 supplies. Channel %d is\n", csupply, chanid);
+				printf("not supported by this device\n");
+			}
 			goto lErrorExit;
 		}
 
@@ -671,7 +672,7 @@ dpmutilFGetInfo3V3(int chanid, dpmutilPowerInfo_t pPowerinfo[]) {
 		/* Read and display the current allowed for the supply.
 		*/
 		if ( ! PmcuI2cRead(fdI2c, regaddr3v3ACurrentAllowed + (offset3v3Reg*isupply), (BYTE*)&pPowerinfo[isupply].currentAllowed3v3, 2, NULL) ) {
-			printf("ERROR: failed to read 3V3_%c_CURRENT_ALLOWED register\n", 0x41 + isupply);
+			if(dpmutilfVerbose)printf("ERROR: failed to read 3V3_%c_CURRENT_ALLOWED register\n", 0x41 + isupply);
 			goto lErrorExit;
 		}
 		if(dpmutilfVerbose)printf("    3V3_%c_CURRENT_ALLOWED:       %d mA\n", 0x41 + isupply, pPowerinfo[isupply].currentAllowed3v3);
@@ -679,7 +680,7 @@ dpmutilFGetInfo3V3(int chanid, dpmutilPowerInfo_t pPowerinfo[]) {
 		/* Read and display the current requested for the supply.
 		*/
 		if ( ! PmcuI2cRead(fdI2c, regaddr3v3ACurrentRequested + (offset3v3Reg*isupply), (BYTE*)&pPowerinfo[isupply].currentRequested3v3, 2, NULL) ) {
-			printf("ERROR: failed to read 3V3_%c_CURRENT_REQUESTED register\n", 0x41 + isupply);
+			if(dpmutilfVerbose)printf("ERROR: failed to read 3V3_%c_CURRENT_REQUESTED register\n", 0x41 + isupply);
 			goto lErrorExit;
 		}
 		if(dpmutilfVerbose)printf("    3V3_%c_CURRENT_REQUESTED:     %d mA\n", 0x41 + isupply, pPowerinfo[isupply].currentRequested3v3);
@@ -691,26 +692,17 @@ dpmutilFGetInfo3V3(int chanid, dpmutilPowerInfo_t pPowerinfo[]) {
 			}
 		}
 	}
-#if defined(__linux__)
-	/* Close the I2C controller file descriptor.
-	*/
-	close(fdI2c);
-#endif
 	return fTrue;
 
 lErrorExit:
-#if defined(__linux__)
-	if ( 0 <= fdI2c ) {
-		close(fdI2c);
-	}
-#endif
 	return fFalse;
 }
 
 /* ------------------------------------------------------------ */
-/***    dpmutilFGetInfoVio
+/***    dpmutilSessFGetInfoVio
 **
 **  Parameters:
+**      psess			- pointer to an open dpmutil session
 **      chanid			- channel id to get power from. -1 to scan all
 **      pPowerInfo		- Pointer to a dpmutilPowerInfo_t array [8] to store data
 **
@@ -736,44 +728,35 @@ lErrorExit:
 **      for every channel supported by the board.
 */
 BOOL
-dpmutilFGetInfoVio(int chanid, dpmutilPowerInfo_t pPowerInfo[]) {
+dpmutilSessFGetInfoVio(dpmutilSession_t* psess, int chanid, dpmutilPowerInfo_t pPowerInfo[]) {
 
 	int				fdI2c;
 	BYTE			cvadj;
 	BYTE			ivadj;
 	VADJ_STATUS		vadjsts;
 
-	fdI2c = -1;
-#if defined(__linux__)
-	fdI2c = I2CHALOpenI2cController();
-	if ( 0 > fdI2c ) {
-		printf("ERROR: failed to open file descriptor for I2C device\n");
-		goto lErrorExit;
-	}
-#else
-	if(!I2CHALInit(0)){
-		printf("ERROR: failed to initialize I2C device\n");
-		goto lErrorExit;
-	}
-#endif
+	fdI2c = psess->fdI2c;
+
 	/* Determine how many VADJ supplies there are.
 	*/
 	if ( ! PmcuI2cRead(fdI2c, regaddrVadjGroupCount, &cvadj, 1, NULL) ) {
-		printf("ERROR: failed to read VADJ_GROUP_COUNT register\n");
+		if(dpmutilfVerbose)printf("ERROR: failed to read VADJ_GROUP_COUNT register\n");
 		goto lErrorExit;
 	}
 
 	/* Get the status for all VADJ supplies.
 	*/
 	if ( ! PmcuI2cRead(fdI2c, regaddrVadjStatus, (BYTE*)&vadjsts, 2, NULL) ) {
-		printf("ERROR: failed to read VADJ_STATUS register\n");
+		if(dpmutilfVerbose)printf("ERROR: failed to read VADJ_STATUS register\n");
 		goto lErrorExit;
 	}
 
 	if ( chanid != -1 ) {
 		if ( chanid >= cvadj ) {
-			printf("ERROR: device has %d VIO supplies. Channel %d is\n", cvadj, chanid);
-			printf("not supported by this device\n");
+			if(dpmutilfVerbose){
+				printf("ERROR: device has %d VIO supplies. Channel %d is\n", cvadj, chanid);
+				printf("not supported by this device\n");
+			}
 			goto lErrorExit;
 		}
 
@@ -804,7 +787,7 @@ dpmutilFGetInfoVio(int chanid, dpmutilPowerInfo_t pPowerInfo[]) {
 		/* Read and display the voltage setting for the current supply.
 		*/
 		if ( ! PmcuI2cRead(fdI2c, regaddrVadjAVoltage + (offsetVadjReg*ivadj), (BYTE*)&pPowerInfo[ivadj].vadjVoltage, 2, NULL) ) {
-			printf("ERROR: failed to read VADJ_%c_VOLTAGE register\n", 0x41 + ivadj);
+			if(dpmutilfVerbose)printf("ERROR: failed to read VADJ_%c_VOLTAGE register\n", 0x41 + ivadj);
 			goto lErrorExit;
 		}
 		if(dpmutilfVerbose)printf("    VADJ_%c_VOLTAGE:              %d mV\n", 0x41 + ivadj, pPowerInfo[ivadj].vadjVoltage * 10);
@@ -812,7 +795,7 @@ dpmutilFGetInfoVio(int chanid, dpmutilPowerInfo_t pPowerInfo[]) {
 		/* Read and display the current allowed for the supply.
 		*/
 		if ( ! PmcuI2cRead(fdI2c, regaddrVadjACurrentAllowed + (offsetVadjReg*ivadj), (BYTE*)&pPowerInfo[ivadj].currentAllowedVadj, 2, NULL) ) {
-			printf("ERROR: failed to read VADJ_%c_CURRENT_ALLOWED register\n", 0x41 + ivadj);
+			if(dpmutilfVerbose)printf("ERROR: failed to read VADJ_%c_CURRENT_ALLOWED register\n", 0x41 + ivadj);
 			goto lErrorExit;
 		}
 		if(dpmutilfVerbose)printf("    VADJ_%c_CURRENT_ALLOWED:      %d mA\n", 0x41 + ivadj, pPowerInfo[ivadj].currentAllowedVadj);
@@ -820,7 +803,7 @@ dpmutilFGetInfoVio(int chanid, dpmutilPowerInfo_t pPowerInfo[]) {
 		/* Read and display the current requested for the supply.
 		*/
 		if ( ! PmcuI2cRead(fdI2c, regaddrVadjACurrentRequested + (offsetVadjReg*ivadj), (BYTE*)&pPowerInfo[ivadj].currentRequestedVadj, 2, NULL) ) {
-			printf("ERROR: failed to read VADJ_%c_CURRENT_REQUESTED register\n", 0x41 + ivadj);
+			if(dpmutilfVerbose)printf("ERROR: failed to read VADJ_%c_CURRENT_REQUESTED register\n", 0x41 + ivadj);
 			goto lErrorExit;
 		}
 		if(dpmutilfVerbose)printf("    VADJ_%c_CURRENT_REQUESTED:    %d mA\n", 0x41 + ivadj, pPowerInfo[ivadj].currentRequestedVadj);
@@ -828,7 +811,7 @@ dpmutilFGetInfoVio(int chanid, dpmutilPowerInfo_t pPowerInfo[]) {
 		/* Read and display the override register for the supply.
 		*/
 		if ( ! PmcuI2cRead(fdI2c, regaddrVadjAOverride + (offsetVadjReg*ivadj), (BYTE*)&pPowerInfo[ivadj].vadjOverride, 2, NULL) ) {
-			printf("ERROR: failed to read VADJ_%c_OVERRIDE register\n", 0x41 + ivadj);
+			if(dpmutilfVerbose)printf("ERROR: failed to read VADJ_%c_OVERRIDE register\n", 0x41 + ivadj);
 			goto lErrorExit;
 		}
 		if(dpmutilfVerbose){
@@ -845,29 +828,21 @@ dpmutilFGetInfoVio(int chanid, dpmutilPowerInfo_t pPowerInfo[]) {
 		}
 	}
 
-#if defined(__linux__)
-	/* Close the I2C controller file descriptor.
-	*/
-	close(fdI2c);
-#endif
 	return fTrue;
 
 lErrorExit:
-#if defined(__linux__)
-	if ( 0 <= fdI2c ) {
-		close(fdI2c);
-	}
-#endif
 	return fFalse;
 }
 
 
 /* ------------------------------------------------------------ */
-/***    dpmutilFEnum
+/***    dpmutilSessFEnum
 **
 **  Parameters:
+**      psess			- pointer to an open dpmutil session
 **      setCrcCheck			- Flag to set crcCheck or not
 **      crcCheck			- False to skip crcCheck when reading Syzygy DNA header
+**      fRefresh			- True to re-read the SYZYGY DNA even if it's cached
 **      pPortInfo			- dpmutilPortInfo_t object array [8] to store data
 **
 **  Return Values:
@@ -881,237 +856,416 @@ lErrorExit:
 **      the board supports and to retrieve the configuration and status of
 **      those ports. If a SmartVIO port has a SYZYGY pod installed then
 **      the I2C bus is used to retrieve the Standard SYZYGY firmware
-**      registers and the SYZYGY DNA (including all string fields) and that
-**      information is output to the console.
+**      registers and the SYZYGY DNA (including all string fields), and
+**      for pods manufactured by Digilent the PDID and calibration, and
+**      that information is returned in the dna field of the port.
+**
+**      Nothing is output to the console unless dpmutilfVerbose is set,
+**      in which case the information is displayed using
+**      dpmutilPrintPortInfo.
+**
+**      The SYZYGY DNA, PDID and calibration data of each pod are cached
+**      (see DnaCache.c) and only re-read when the cached header CRC or
+**      serial number no longer match the pod, when the port reports that
+**      the pod was removed, or when fRefresh is fTrue.
 */
 BOOL
-dpmutilFEnum(BOOL setCrcCheck, BOOL crcCheck, dpmutilPortInfo_t pPortInfo[]) {
+dpmutilSessFEnum(dpmutilSession_t* psess, BOOL setCrcCheck, BOOL crcCheck, BOOL fRefresh, dpmutilPortInfo_t pPortInfo[]) {
 
-	int				fdI2c;
-	BYTE			csvioPorts;
-	BYTE			isvioPort;
-	VADJ_STATUS		vadjsts;
-	SzgStdFwRegs	szgstdfwRegs;
-	SzgDnaHeader	szgdnaHeader;
-	SzgDnaStrings	szgdnaStrings;
-	DWORD			pdid;
+	BYTE	cport;
 
-	fdI2c = -1;
-	memset(&szgdnaStrings, 0, sizeof(SzgDnaStrings));
-#if defined(__linux__)
-	fdI2c = I2CHALOpenI2cController();
-	if ( 0 > fdI2c ) {
-		printf("ERROR: failed to open file descriptor for I2C device\n");
-		goto lErrorExit;
+	if ( ! FSessEnumPorts(psess, setCrcCheck, crcCheck, fRefresh, pPortInfo, &cport) ) {
+		return fFalse;
 	}
-#else
-	if(!I2CHALInit(0)){
-		printf("ERROR: failed to initialize I2C device\n");
-		goto lErrorExit;
+
+	if ( dpmutilfVerbose ) {
+		dpmutilPrintPortInfo(cport, pPortInfo);
 	}
-#endif
 
-	/* Get the status for all VADJ supplies.
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    FSessEnumPorts
+**
+**  Parameters:
+**      psess			- pointer to an open dpmutil session
+**      setCrcCheck			- Flag to set crcCheck or not
+**      crcCheck			- False to skip crcCheck when reading Syzygy DNA header
+**      fRefresh			- True to re-read the SYZYGY DNA even if it's cached
+**      pPortInfo			- dpmutilPortInfo_t object array [8] to store data
+**      pcport				- pointer to variable to receive the port count
+**
+**  Return Values:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**
+**  Description:
+**      This function performs the enumeration described by
+**      dpmutilSessFEnum without displaying the result, and returns the
+**      number of SmartVIO ports that were enumerated.
+*/
+static BOOL
+FSessEnumPorts(dpmutilSession_t* psess, BOOL setCrcCheck, BOOL crcCheck, BOOL fRefresh, dpmutilPortInfo_t pPortInfo[], BYTE* pcport) {
+
+	int				fdI2c;
+	BYTE			csvioPorts;
+	BYTE			isvioPort;
+	VADJ_STATUS		vadjsts;
+	DnaCacheEntry	entry;
+	PMCU_CONFIG_REGS	cfgregs;
+	PMCU_PORT_REGS*	pportregs;
+
+	fdI2c = psess->fdI2c;
+
+	/* Read the entire configuration register block of the PMCU. The port
+	** registers, the VADJ status, and the VADJ voltages are all decoded
+	** from this snapshot rather than being read one at a time.
 	*/
-	if ( ! PmcuI2cRead(fdI2c, regaddrVadjStatus, (BYTE*)&vadjsts, 2, NULL) ) {
-		printf("ERROR: failed to read VADJ_STATUS register\n");
+	if ( ! PmcuReadConfigRegs(fdI2c, &cfgregs) ) {
+		if(dpmutilfVerbose)printf("ERROR: failed to read PMCU configuration registers\n");
 		goto lErrorExit;
 	}
 
+	/* Get the status for all VADJ supplies.
+	*/
+	vadjsts = cfgregs.vadjsts;
+
 	/* Determine how many SmartVIO ports the board contains.
 	*/
-	if ( ! PmcuI2cRead(fdI2c, regaddrPortCount, &csvioPorts, 1, NULL) ) {
-		printf("ERROR: failed to read SMART_VIO_PORT_COUNT register\n");
-		goto lErrorExit;
+	csvioPorts = cfgregs.cport;
+	if ( cPmcuPortMax < csvioPorts ) {
+		csvioPorts = cPmcuPortMax;
 	}
 
-	if(dpmutilfVerbose)printf("Found %d SmartVIO port(s)\n", csvioPorts);
-
 	for ( isvioPort = 0; isvioPort < csvioPorts; isvioPort++ ) {
 
-		if(dpmutilfVerbose)printf("\nPort: %c\n", 0x41 + isvioPort);
+		pportregs = &cfgregs.rgport[isvioPort];
 
-		/* Read and display the I2C address for this port.
+		/* Get the I2C address, supply groups, type and status of this port.
 		*/
-		if ( ! PmcuI2cRead(fdI2c, regaddrPortAI2cAddress + (offsetPortReg*isvioPort), &pPortInfo[isvioPort].i2cAddr, 1, NULL) ) {
-			printf("ERROR: failed to read PORT_%c_I2C_ADDRESS register\n", 0x41 + isvioPort);
-			goto lErrorExit;
-		}
-		if(dpmutilfVerbose)printf("    PORT_%c_I2C_ADDRESS:    0x%02X\n", 0x41 + isvioPort, pPortInfo[isvioPort].i2cAddr);
-
-		/* Read and display the 5V0 group for this port.
+		pPortInfo[isvioPort].i2cAddr = pportregs->i2cAddr;
+		pPortInfo[isvioPort].group5v0 = pportregs->group5v0;
+		pPortInfo[isvioPort].group3v3 = pportregs->group3v3;
+		pPortInfo[isvioPort].groupVio = pportregs->groupVio;
+		pPortInfo[isvioPort].portType = pportregs->ptype;
+		pPortInfo[isvioPort].portSts = pportregs->psts;
+
+		/* Get the VIO voltage setting for this port.
 		*/
-		if ( ! PmcuI2cRead(fdI2c, regaddrPortA5v0Group + (offsetPortReg*isvioPort), &pPortInfo[isvioPort].group5v0, 1, NULL) ) {
-			printf("ERROR: failed to read PORT_%c_5V0_GROUP register\n", 0x41 + isvioPort);
+		if ( cPmcuVadjGroupMax <= pPortInfo[isvioPort].groupVio ) {
+			if(dpmutilfVerbose)printf("ERROR: PORT_%c_VIO_GROUP %d is not a valid VADJ group\n", 0x41 + isvioPort, pPortInfo[isvioPort].groupVio);
 			goto lErrorExit;
 		}
-		if(dpmutilfVerbose)printf("    PORT_%c_5V0_GROUP:      %d\n", 0x41 + isvioPort, pPortInfo[isvioPort].group5v0);
+		pPortInfo[isvioPort].voltage = cfgregs.rgvadj[pPortInfo[isvioPort].groupVio].vltg;
+		pPortInfo[isvioPort].fVioEnable = ( vadjsts.fsEn & (1 << pPortInfo[isvioPort].groupVio) ) ? fTrue : fFalse;
 
-		/* Read and display the 3V3 group for this port.
+		/* Get the DNA of the SYZYGY pod installed on this port, if any. The
+		** DNA is only read from the pod when it isn't already cached or
+		** when the pod has been swapped. A pod whose DNA can't be read
+		** doesn't prevent the remaining ports from being enumerated.
 		*/
-		if ( ! PmcuI2cRead(fdI2c, regaddrPortA3v3Group + (offsetPortReg*isvioPort), &pPortInfo[isvioPort].group3v3, 1, NULL) ) {
-			printf("ERROR: failed to read PORT_%c_3V3_GROUP register\n", 0x41 + isvioPort);
-			goto lErrorExit;
+		pPortInfo[isvioPort].fDna = fFalse;
+		if (( pPortInfo[isvioPort].portSts.fPresent )  && ( IsSyzygyPort(pPortInfo[isvioPort].portType) )) {
+			if ( DnaCacheLookup(fdI2c, psess->ibus, isvioPort, pPortInfo[isvioPort].i2cAddr, setCrcCheck ? crcCheck : fTrue, fRefresh, &entry) ) {
+				FillDnaInfo(&entry, &pPortInfo[isvioPort].dna);
+				pPortInfo[isvioPort].fDna = fTrue;
+			}
 		}
-		if(dpmutilfVerbose)printf("    PORT_%c_3V3_GROUP:      %d\n", 0x41 + isvioPort, pPortInfo[isvioPort].group3v3);
 
-		/* Read and display the VIO group for this port.
+		/* A pod may have been removed from this port, in which case
+		** anything cached for the port is no longer valid.
 		*/
-		if ( ! PmcuI2cRead(fdI2c, regaddrPortAVioGroup + (offsetPortReg*isvioPort), &pPortInfo[isvioPort].groupVio, 1, NULL) ) {
-			printf("ERROR: failed to read PORT_%c_VIO_GROUP register\n", 0x41 + isvioPort);
-			goto lErrorExit;
+		if ( ! pPortInfo[isvioPort].portSts.fPresent ) {
+			DnaCacheInvalidate(psess->ibus, isvioPort);
 		}
-		if(dpmutilfVerbose)printf("    PORT_%c_VIO_GROUP:      %d\n", 0x41 + isvioPort, pPortInfo[isvioPort].groupVio);
+	}
+
+	*pcport = csvioPorts;
+
+	return fTrue;
+
+lErrorExit:
+
+	return fFalse;
+}
+
+/* ------------------------------------------------------------ */
+/***    dpmutilSessFWatchBegin
+**
+**  Parameters:
+**      psess			- pointer to an open dpmutil session
+**      pwatch			- pointer to the dpmutilWatch_t object to initialize
+**
+**  Return Values:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**
+**  Description:
+**      Start watching the SmartVIO ports for changes. The status
+**      registers are read to take the initial snapshot and then the
+**      ports are enumerated as by dpmutilSessFEnum, so that the port
+**      information held by the watch starts out complete. The status
+**      registers are read first so that a change that occurs during
+**      the enumeration is reported by the next poll.
+*/
+BOOL
+dpmutilSessFWatchBegin(dpmutilSession_t* psess, dpmutilWatch_t* pwatch) {
+
+	BYTE	cport;
+
+	memset(pwatch, 0, sizeof(dpmutilWatch_t));
+
+	if ( ! PmcuReadStatusRegs(psess->fdI2c, cPmcuPortMax, &pwatch->stsregs) ) {
+		if(dpmutilfVerbose)printf("ERROR: failed to read PMCU status registers\n");
+		return fFalse;
+	}
+
+	if ( ! FSessEnumPorts(psess, fFalse, fFalse, fFalse, pwatch->portInfo, &cport) ) {
+		return fFalse;
+	}
+
+	pwatch->cport = cport;
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/***    dpmutilSessFWatchPoll
+**
+**  Parameters:
+**      psess			- pointer to an open dpmutil session
+**      pwatch			- pointer to a watch started by dpmutilSessFWatchBegin
+**      pfnEvent		- function to call for each port that reports an event, may be NULL
+**      pvContext		- context passed to pfnEvent
+**      pcevt			- pointer to variable to receive the number of ports that reported events, may be NULL
+**
+**  Return Values:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**
+**  Description:
+**      Check the SmartVIO ports for changes since the previous poll.
+**      Only the VADJ status and port registers are read, using a single
+**      I2C transaction, and they're compared to the snapshot held by
+**      the watch. The DNA is only read from ports on which a pod was
+**      inserted. The port information held by the watch is updated and
+**      pfnEvent is called for every port that reports an event.
+**
+**      A limit fault is reported when the 5V0, 3V3 or VIO in-limit flag
+**      of a port goes false, and a VIO fault is reported when the VADJ
+**      supply of the port is enabled and loses power good.
+*/
+BOOL
+dpmutilSessFWatchPoll(dpmutilSession_t* psess, dpmutilWatch_t* pwatch, PFNDPMUTILWATCH pfnEvent, void* pvContext, BYTE* pcevt) {
+
+	PMCU_STATUS_REGS	stsregs;
+	dpmutilWatchEvent_t	evt;
+	dpmutilPortInfo_t*	pport;
+	DnaCacheEntry		entry;
+	PmcuPortStatus		pstsOld;
+	PmcuPortStatus		pstsNew;
+	BYTE				fsLimitOld;
+	BYTE				fsVadjGroup;
+	BOOL				fPgoodOld;
+	BOOL				fPgoodNew;
+	BYTE				isvioPort;
+	BYTE				cevt;
+
+	cevt = 0;
+	if ( NULL != pcevt ) {
+		*pcevt = 0;
+	}
+
+	if ( ! PmcuReadStatusRegs(psess->fdI2c, pwatch->cport, &stsregs) ) {
+		if(dpmutilfVerbose)printf("ERROR: failed to read PMCU status registers\n");
+		return fFalse;
+	}
+
+	for ( isvioPort = 0; isvioPort < pwatch->cport; isvioPort++ ) {
+
+		pport = &pwatch->portInfo[isvioPort];
+		pstsOld = pwatch->stsregs.rgport[isvioPort].psts;
+		pstsNew = stsregs.rgport[isvioPort].psts;
 
-		/* Read and display the port type for this port.
+		evt.iport = isvioPort;
+		evt.fsEvt = 0;
+		evt.portStsOld = pstsOld;
+		evt.portSts = pstsNew;
+		evt.pPortInfo = pport;
+
+		/* Detect insertion and removal of a pod.
 		*/
-		if ( ! PmcuI2cRead(fdI2c, regaddrPortAType + (offsetPortReg*isvioPort), &pPortInfo[isvioPort].portType, 1, NULL) ) {
-			printf("ERROR: failed to read PORT_%c_I2C_ADDRESS register\n", 0x41 + isvioPort);
-			goto lErrorExit;
+		if (( ! pstsOld.fPresent ) && ( pstsNew.fPresent )) {
+			evt.fsEvt |= evtdpmutilInsert;
 		}
-		if(dpmutilfVerbose){
-			printf("    PORT_%c_TYPE:           0x%02X (", 0x41 + isvioPort, pPortInfo[isvioPort].portType);
-			switch ( pPortInfo[isvioPort].portType ) {
-				case ptypeSyzygyStd:
-					printf("SYZYGY_STD)\n");
-					break;
-				case ptypeSyzygyTxr2:
-					printf("SYZYGY_TXR2)\n");
-					break;
-				case ptypeSyzygyTxr4:
-					printf("SYZYGY_TXR4)\n");
-					break;
-				case ptypeNone:
-				default:
-					printf("UNKNOWN)\n");
-					break;
-			}
+		else if (( pstsOld.fPresent ) && ( ! pstsNew.fPresent )) {
+			evt.fsEvt |= evtdpmutilRemove;
 		}
 
-		/* Read and display the status for this port.
+		/* Detect supplies leaving or returning to their limits.
 		*/
-		if ( ! PmcuI2cRead(fdI2c, regaddrPortAStatus + (offsetPortReg*isvioPort), (BYTE*)&pPortInfo[isvioPort].portSts, 1, NULL) ) {
-			printf("ERROR: failed to read PORT_%c_I2C_ADDRESS register\n", 0x41 + isvioPort);
-			goto lErrorExit;
+		fsLimitOld = pstsOld.fsStatus & fsPortStsInLimit;
+		if ( 0 != (fsLimitOld & ~pstsNew.fsStatus) ) {
+			evt.fsEvt |= evtdpmutilLimitFault;
 		}
-		if(dpmutilfVerbose){
-			printf("    PORT_%c_STATUS:         0x%02X\n", 0x41 + isvioPort, *(BYTE*)&pPortInfo[isvioPort].portSts);
-			printf("        PRESENT            [%c]\n", pPortInfo[isvioPort].portSts.fPresent ? 'Y':'N');
-			printf("        DOUBLE_WIDE        [%c]\n", pPortInfo[isvioPort].portSts.fDW ? 'Y':'N');
-			printf("        5V0_WITHIN_LIMIT   [%c]\n", pPortInfo[isvioPort].portSts.f5v0InLimit ? 'Y':'N');
-			printf("        3V3_WITHIN_LIMIT   [%c]\n", pPortInfo[isvioPort].portSts.f3v3InLimit ? 'Y':'N');
-			printf("        VIO_WITHIN_LIMIT   [%c]\n", pPortInfo[isvioPort].portSts.fVioInLimit ? 'Y':'N');
-			printf("        ALLOW_VIO_ENABLE   [%c]\n", pPortInfo[isvioPort].portSts.fAllowVioEnable ? 'Y':'N');
+		if ( 0 != (~fsLimitOld & pstsNew.fsStatus & fsPortStsInLimit) ) {
+			evt.fsEvt |= evtdpmutilLimitClear;
 		}
-		/* Read and display the VIO voltage setting for this port.
+
+		/* Detect the VADJ supply of the port losing or regaining power
+		** good while it's enabled.
 		*/
-		if ( ! PmcuI2cRead(fdI2c, regaddrVadjAVoltage + (offsetVadjReg*pPortInfo[isvioPort].groupVio), (BYTE*)&pPortInfo[isvioPort].voltage, 2, NULL) ) {
-			printf("ERROR: failed to read VADJ_%c_VOLTAGE register\n", 0x41 + pPortInfo[isvioPort].groupVio);
-			goto lErrorExit;
-		}
-		if(dpmutilfVerbose){
-			if ( vadjsts.fsEn & (1 << pPortInfo[isvioPort].groupVio) ) {
-				printf("    PORT_%c_VIO_ENABLE:     [Y]\n", 0x41 + isvioPort);
-				printf("    PORT_%c_VOLTAGE:        %d mV\n", 0x41 + isvioPort, pPortInfo[isvioPort].voltage * 10);
+		if ( cPmcuVadjGroupMax > stsregs.rgport[isvioPort].groupVio ) {
+			fsVadjGroup = 1 << stsregs.rgport[isvioPort].groupVio;
+			fPgoodOld = (( pwatch->stsregs.vadjsts.fsEn & fsVadjGroup ) && ( pwatch->stsregs.vadjsts.fsPgood & fsVadjGroup )) ? fTrue : fFalse;
+			fPgoodNew = (( stsregs.vadjsts.fsEn & fsVadjGroup ) && ( stsregs.vadjsts.fsPgood & fsVadjGroup )) ? fTrue : fFalse;
+			if (( fPgoodOld ) && ( ! fPgoodNew ) && ( stsregs.vadjsts.fsEn & fsVadjGroup )) {
+				evt.fsEvt |= evtdpmutilVioFault;
 			}
-			else {
-				printf("    PORT_%c_VIO_ENABLE:     [N]\n", 0x41 + isvioPort);
-				printf("    PORT_%c_VOLTAGE:        0 mV\n", 0x41 + isvioPort);
+			if (( ! fPgoodOld ) && ( fPgoodNew )) {
+				evt.fsEvt |= evtdpmutilVioClear;
 			}
+			pport->fVioEnable = ( stsregs.vadjsts.fsEn & fsVadjGroup ) ? fTrue : fFalse;
+		}
 
-			if (( pPortInfo[isvioPort].portSts.fPresent )  && ( IsSyzygyPort(pPortInfo[isvioPort].portType) )) {
-
-				if ( ! SyzygyReadStdFwRegisters(fdI2c, pPortInfo[isvioPort].i2cAddr, &szgstdfwRegs) ) {
-					printf("ERROR: failed to retrieve SYZYGY standard fw registers from 0x%02X\n", pPortInfo[isvioPort].i2cAddr);
-					goto lErrorExit;
-				}
-
-				if ( ! SyzygyReadDNAHeader(fdI2c, pPortInfo[isvioPort].i2cAddr, &szgdnaHeader, setCrcCheck ? crcCheck : fTrue) ) {
-					printf("ERROR: failed to retrieve SYZYGY DNA header from 0x%02X\n", pPortInfo[isvioPort].i2cAddr);
-					goto lErrorExit;
-				}
-
-				if ( ! SyzygyReadDNAStrings(fdI2c, pPortInfo[isvioPort].i2cAddr, &szgdnaHeader, &szgdnaStrings) ) {
-					printf("Error: failed to retrieve SYZYGY DNA strings from 0x%02X\n", pPortInfo[isvioPort].i2cAddr);
-					SyzygyFreeDNAStrings(&szgdnaStrings);
-					goto lErrorExit;
+		/* Update the port information, reading the DNA only when a pod
+		** was inserted.
+		*/
+		pport->i2cAddr = stsregs.rgport[isvioPort].i2cAddr;
+		pport->group5v0 = stsregs.rgport[isvioPort].group5v0;
+		pport->group3v3 = stsregs.rgport[isvioPort].group3v3;
+		pport->groupVio = stsregs.rgport[isvioPort].groupVio;
+		pport->portType = stsregs.rgport[isvioPort].ptype;
+		pport->portSts = pstsNew;
+
+		if ( evt.fsEvt & evtdpmutilInsert ) {
+			DnaCacheInvalidate(psess->ibus, isvioPort);
+			pport->fDna = fFalse;
+			if ( IsSyzygyPort(pport->portType) ) {
+				if ( DnaCacheLookup(psess->fdI2c, psess->ibus, isvioPort, pport->i2cAddr, fTrue, fFalse, &entry) ) {
+					FillDnaInfo(&entry, &pport->dna);
+					pport->fDna = fTrue;
 				}
+			}
+		}
 
-				printf("    Manufacturer Name:     %s\n", szgdnaStrings.szManufacturerName);
-				printf("    Product Name:          %s\n", szgdnaStrings.szProductName);
-				printf("    Product Model:         %s\n", szgdnaStrings.szProductModel);
-				printf("    Product Version:       %s\n", szgdnaStrings.szProductVersion);
-				printf("    Serial Number:         %s\n", szgdnaStrings.szSerialNumber);
-				printf("    Firmware Version:      %d.%d\n", szgstdfwRegs.fwverMjr, szgstdfwRegs.fwverMin);
-				printf("    DNA Version:           %d.%d\n", szgstdfwRegs.dnaverMjr, szgstdfwRegs.dnaverMin);
-				printf("    Maximum 5V Load:       %d mA\n", szgdnaHeader.crntRequired5v0);
-				printf("    Maximum 3.3V Load:     %d mA\n", szgdnaHeader.crntRequired3v3);
-				printf("    Maximum VIO Load:      %d mA\n", szgdnaHeader.crntRequiredVio);
-				printf("    Voltage Range 1:       %d to %d mV\n", szgdnaHeader.vltgRange1Min * 10, szgdnaHeader.vltgRange1Max * 10);
-				printf("    Voltage Range 2:       %d to %d mV\n", szgdnaHeader.vltgRange2Min * 10, szgdnaHeader.vltgRange2Max * 10);
-				printf("    Voltage Range 3:       %d to %d mV\n", szgdnaHeader.vltgRange3Min * 10, szgdnaHeader.vltgRange3Max * 10);
-				printf("    Voltage Range 4:       %d to %d mV\n", szgdnaHeader.vltgRange4Min * 10, szgdnaHeader.vltgRange4Max * 10);
-				printf("    Attribute Flags:       0x%04X\n", szgdnaHeader.fsAttributes);
-				printf("        IS_LVDS            [%c]\n", szgdnaHeader.fsAttributes & sattrLvds ? 'Y' : 'N');
-				printf("        IS_DOUBLEWIDE      [%c]\n", szgdnaHeader.fsAttributes & sattrDoubleWide ? 'Y' : 'N');
-				printf("        IS_TXR4            [%c]\n", szgdnaHeader.fsAttributes & sattrTxr4 ? 'Y' : 'N');
-
-				if ( 0 == strncmp(szgdnaStrings.szManufacturerName, "Digilent", strlen("Digilent")) ) {
-					if ( ! SyzygyI2cRead(fdI2c, pPortInfo[isvioPort].i2cAddr, addrPdid, (BYTE*)&pdid, 4, NULL) ) {
-						printf("Error: failed to read PDID from 0x%02X\n", pPortInfo[isvioPort].i2cAddr);
-						goto lErrorExit;
-					}
-					printf("    PDID:                  0x%08X\n", (unsigned int)pdid);
-
-					/* Output additional information (if available) based on the
-					** product number of the installed module.
-					*/
-					switch ( ProductFromPdid(pdid) ) {
-						case prodZmodADC:
-							if ( ! FDisplayZmodADCCal(fdI2c, pPortInfo[isvioPort].i2cAddr) ) {
-								goto lErrorExit;
-							}
-							break;
-
-						case prodZmodDAC:
-							if ( ! FDisplayZmodDACCal(fdI2c, pPortInfo[isvioPort].i2cAddr) ) {
-								goto lErrorExit;
-							}
-							break;
-
-
-						default:
-							break;
-					}
-				}
+		if ( evt.fsEvt & evtdpmutilRemove ) {
+			DnaCacheInvalidate(psess->ibus, isvioPort);
+			pport->fDna = fFalse;
+		}
 
-				SyzygyFreeDNAStrings(&szgdnaStrings);
+		if ( 0 != evt.fsEvt ) {
+			cevt++;
+			if ( NULL != pfnEvent ) {
+				pfnEvent(&evt, pvContext);
 			}
 		}
 	}
 
-#if defined(__linux__)
-	/* Close the I2C controller file descriptor.
-	*/
-	close(fdI2c);
-#endif
+	pwatch->stsregs = stsregs;
+
+	if ( NULL != pcevt ) {
+		*pcevt = cevt;
+	}
+
 	return fTrue;
+}
 
-lErrorExit:
-#if defined(__linux__)
-	if ( 0 <= fdI2c ) {
-		close(fdI2c);
+/* ------------------------------------------------------------ */
+/***    dpmutilSessFBudgetBegin
+**
+**  Parameters:
+**      psess			- pointer to an open dpmutil session
+**      pwatch			- pointer to a watch started by dpmutilSessFWatchBegin
+**      pbudget			- pointer to the dpmutilBudget_t object to initialize
+**
+**  Return Values:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**
+**  Description:
+**      Build a power budget model of the board. The configuration
+**      registers are read once to get the current allowed for each
+**      5V0, 3V3 and VADJ group. The group assignment of each port and
+**      the DNA header of each pod are taken from the watch, whose DNA
+**      comes from the DNA cache, so no pod is accessed.
+**
+**      Admission queries are then answered by PwrBudgetFAdmit without
+**      accessing the I2C bus. The model stays current as long as
+**      dpmutilBudgetUpdate is called for each event reported by
+**      dpmutilSessFWatchPoll.
+*/
+BOOL
+dpmutilSessFBudgetBegin(dpmutilSession_t* psess, const dpmutilWatch_t* pwatch, dpmutilBudget_t* pbudget) {
+
+	PMCU_CONFIG_REGS			cfgregs;
+	const dpmutilPortInfo_t*	pport;
+	BYTE						isvioPort;
+
+	if ( ! PmcuReadConfigRegs(psess->fdI2c, &cfgregs) ) {
+		if(dpmutilfVerbose)printf("ERROR: failed to read PMCU configuration registers\n");
+		return fFalse;
 	}
-#endif
-	SyzygyFreeDNAStrings(&szgdnaStrings);
 
-	return fFalse;
+	PwrBudgetInit(pbudget, &cfgregs);
+
+	for ( isvioPort = 0; isvioPort < pwatch->cport; isvioPort++ ) {
+		pport = &pwatch->portInfo[isvioPort];
+		PwrBudgetSetPort(pbudget, isvioPort, &pwatch->stsregs.rgport[isvioPort],
+			(( pport->portSts.fPresent ) && ( pport->fDna )) ? &pport->dna.header : NULL);
+	}
+
+	return fTrue;
 }
 
 /* ------------------------------------------------------------ */
-/***    dpmutilFSetPlatformConfig
+/***    dpmutilBudgetUpdate
+**
+**  Parameters:
+**      pbudget			- pointer to a model built by dpmutilSessFBudgetBegin
+**      pevt			- event reported by dpmutilSessFWatchPoll
+**
+**  Return Values:
+**      none
+**
+**  Errors:
+**
+**  Description:
+**      Update the port of a watch event in a power budget model. Only
+**      that port is changed: the requirements of a removed pod are
+**      dropped and those of an inserted pod whose DNA was read are
+**      added. This is typically called from the event callback passed
+**      to dpmutilSessFWatchPoll.
+*/
+void
+dpmutilBudgetUpdate(dpmutilBudget_t* pbudget, const dpmutilWatchEvent_t* pevt) {
+
+	const dpmutilPortInfo_t*	pport;
+	PMCU_PORT_REGS				portregs;
+
+	pport = pevt->pPortInfo;
+
+	portregs.i2cAddr = pport->i2cAddr;
+	portregs.group5v0 = pport->group5v0;
+	portregs.group3v3 = pport->group3v3;
+	portregs.groupVio = pport->groupVio;
+	portregs.ptype = pport->portType;
+	portregs.psts = pport->portSts;
+
+	PwrBudgetSetPort(pbudget, pevt->iport, &portregs,
+		(( pport->portSts.fPresent ) && ( pport->fDna )) ? &pport->dna.header : NULL);
+}
+
+/* ------------------------------------------------------------ */
+/***    dpmutilSessFSetPlatformConfig
 **
 **  Parameters:
+**      psess			- pointer to an open dpmutil session
 **      pDevInfo		- Pointer to a dpmutilDevInfo_t object to store data
 **      setEnforce5v0	- flag to set enforce5v0 setting
 **      enforce5v0		- if flag is true, value to set enforce5v0 to
@@ -1165,15 +1319,20 @@ lErrorExit:
 **      SmartVIO port will not be enabled.
 */
 BOOL
-dpmutilFSetPlatformConfig(dpmutildevInfo_t* pDevInfo, BOOL setEnforce5v0, BOOL enforce5v0, BOOL setEnforce3v3, BOOL enforce3v3, BOOL setEnforceVio, BOOL enforceVio, BOOL setCrcCheck, BOOL crcCheck) {
+dpmutilSessFSetPlatformConfig(dpmutilSession_t* psess, dpmutildevInfo_t* pDevInfo, BOOL setEnforce5v0, BOOL enforce5v0, BOOL setEnforce3v3, BOOL enforce3v3, BOOL setEnforceVio, BOOL enforceVio, BOOL setCrcCheck, BOOL crcCheck) {
 
 	int					fdI2c;
 	WORD				wTemp;
 	PLATFORM_CONFIG*	ppcfg;
-#if defined(__linux__)
-	struct timespec		tsWait;
-#endif
-	fdI2c = -1;
+	fdI2c = psess->fdI2c;
+
+	/* Hold the bus for the entire read-modify-write sequence so that
+	** another thread sharing this session can't modify the register
+	** between the read and the write.
+	*/
+	if ( ! I2CHALLock(fdI2c) ) {
+		return fFalse;
+	}
 
 	/* Make sure the user passed in a parameter specifying the value to
 	** set for one or more of the bits in the platform configuration
@@ -1183,30 +1342,19 @@ dpmutilFSetPlatformConfig(dpmutildevInfo_t* pDevInfo, BOOL setEnforce5v0, BOOL e
 		( ! setEnforce3v3) &&
 		( ! setEnforceVio) &&
 		( ! setCrcCheck )) {
-		printf("ERROR: you must specify one or more field to set in the\n");
-		printf("platform configuration register. Use the \"-enforce5v0\",\n");
-		printf("\"-enforce3v3\", \"-enforcevio\", and \"-checkcrc\" options\n");
-		printf("to specify the field to set.\n");
-		goto lErrorExit;
-	}
-
-#if defined(__linux__)
-	fdI2c = I2CHALOpenI2cController();
-	if ( 0 > fdI2c ) {
-		printf("ERROR: failed to open file descriptor for I2C device\n");
-		goto lErrorExit;
-	}
-#else
-	if(!I2CHALInit(0)){
-		printf("ERROR: failed to initialize I2C device\n");
+		if(dpmutilfVerbose){
+			printf("ERROR: you must specify one or more field to set in the\n");
+			printf("platform configuration register. Use the \"-enforce5v0\",\n");
+			printf("\"-enforce3v3\", \"-enforcevio\", and \"-checkcrc\" options\n");
+			printf("to specify the field to set.\n");
+		}
 		goto lErrorExit;
 	}
-#endif
 
 	/* Read and display the platform configuration register.
 	*/
 	if ( ! PmcuI2cRead(fdI2c, regaddrPlatformConfig, (BYTE*)(&pDevInfo->platcfg), 2, NULL) ) {
-		printf("ERROR: failed to read PLATFORM_CONFIGURATION register\n");
+		if(dpmutilfVerbose)printf("ERROR: failed to read PLATFORM_CONFIGURATION register\n");
 		goto lErrorExit;
 	}
 
@@ -1237,29 +1385,26 @@ dpmutilFSetPlatformConfig(dpmutildevInfo_t* pDevInfo, BOOL setEnforce5v0, BOOL e
 	/* Attempt to write the new configuration to the PMCU.
 	*/
 	if ( ! PmcuI2cWrite(fdI2c, regaddrPlatformConfig, (BYTE*)(&pDevInfo->platcfg), 2, NULL) ) {
-		printf("ERROR: failed to write PLATFORM_CONFIGURATION register\n");
+		if(dpmutilfVerbose)printf("ERROR: failed to write PLATFORM_CONFIGURATION register\n");
 		goto lErrorExit;
 	}
 
 	/* Give the platform MCU time to write the EEPROM. The typical write
 	** time is 3.3ms per byte and writing the platform configuration
 	** register results in a total of 10 bytes being written (2 bytes
-	** of data and 4 bytes of sequence numbers). Therefore I suggest
-	** waiting at least 50 milliseconds before attempting to communicate
-	** with the PMCU.
+	** of data and 4 bytes of sequence numbers). The PMCU doesn't respond
+	** until the write is complete, so wait for it to respond rather than
+	** for a fixed worst case delay.
 	*/
-#if defined(__linux__)
-	tsWait.tv_sec = 0;
-	tsWait.tv_nsec = 50000000;
-	nanosleep(&tsWait, NULL);
-#else
-	usleep(50000);
-#endif
+	if ( ! PmcuWaitReady(fdI2c, msPmcuEepromFirstPoll, msPmcuEepromWriteTimeout) ) {
+		if(dpmutilfVerbose)printf("ERROR: timed out waiting for Platform MCU to write EEPROM\n");
+		goto lErrorExit;
+	}
 
 	/* Read and display the platform configuration register.
 	*/
 	if ( ! PmcuI2cRead(fdI2c, regaddrPlatformConfig, (BYTE*)(&wTemp), 2, NULL) ) {
-		printf("ERROR: failed to read PLATFORM_CONFIGURATION register 2\n");
+		if(dpmutilfVerbose)printf("ERROR: failed to read PLATFORM_CONFIGURATION register 2\n");
 		goto lErrorExit;
 	}
 	ppcfg = (PLATFORM_CONFIG*)(&wTemp);
@@ -1275,31 +1420,28 @@ dpmutilFSetPlatformConfig(dpmutildevInfo_t* pDevInfo, BOOL setEnforce5v0, BOOL e
 	}
 
 	if ( *(WORD*)&pDevInfo->platcfg != wTemp ) {
-		printf("ERROR: new platform configuration (0x%04X) does\n", *(WORD*)&pDevInfo->platcfg);
-		printf("not match specified configuration (0x%04X)\n", wTemp);
+		if(dpmutilfVerbose){
+			printf("ERROR: new platform configuration (0x%04X) does\n", *(WORD*)&pDevInfo->platcfg);
+			printf("not match specified configuration (0x%04X)\n", wTemp);
+		}
 		goto lErrorExit;
 	}
 
-#if defined(__linux__)
-	/* Close the I2C controller file descriptor.
-	*/
-	close(fdI2c);
-#endif
+	I2CHALUnlock(fdI2c);
+
 	return fTrue;
 
 lErrorExit:
-#if defined(__linux__)
-	if ( 0 <= fdI2c ) {
-		close(fdI2c);
-	}
-#endif
+	I2CHALUnlock(fdI2c);
+
 	return fFalse;
 }
 
 /* ------------------------------------------------------------ */
-/***    dpmutilFSetVioConfig
+/***    dpmutilSessFSetVioConfig
 **
 **  Parameters:
+**      psess			- pointer to an open dpmutil session
 **      chanid			- channel id to set
 **      setEnable		- flag to set enabled setting
 **      enable			- if flag is true, value to set enable to
@@ -1344,7 +1486,7 @@ lErrorExit:
 **      when the override field of the VADJ_n_OVERRIDE register is cleared.
 */
 BOOL
-dpmutilFSetVioConfig(int chanid, BOOL setEnable, BOOL enable, BOOL setOverride, BOOL override, BOOL setVoltage, WORD voltage) {
+dpmutilSessFSetVioConfig(dpmutilSession_t* psess, int chanid, BOOL setEnable, BOOL enable, BOOL setOverride, BOOL override, BOOL setVoltage, WORD voltage) {
 
 	int				fdI2c;
 	WORD			wTemp;
@@ -1352,16 +1494,21 @@ dpmutilFSetVioConfig(int chanid, BOOL setEnable, BOOL enable, BOOL setOverride,
 	VADJ_STATUS		vadjsts;
 	VADJ_OVERRIDE	vadjow;
 	VADJ_OVERRIDE	vadjow2;
-#if defined(__linux__)
-	struct timespec		tsWait;
-#endif
 
-	fdI2c = -1;
+	fdI2c = psess->fdI2c;
+
+	/* Hold the bus for the entire read-modify-write sequence so that
+	** another thread sharing this session can't modify the register
+	** between the read and the write.
+	*/
+	if ( ! I2CHALLock(fdI2c) ) {
+		return fFalse;
+	}
 
 	/* Make sure the user specified the channel ID.
 	*/
 	if ( chanid < 0 ) {
-		printf("ERROR: you must specify a channel identifier using the \"-chanid\" option\n");
+		if(dpmutilfVerbose)printf("ERROR: you must specify a channel identifier using the \"-chanid\" option\n");
 		goto lErrorExit;
 	}
 
@@ -1370,44 +1517,35 @@ dpmutilFSetVioConfig(int chanid, BOOL setEnable, BOOL enable, BOOL setOverride,
 	** there is nothing to do.
 	*/
 	if (( ! setEnable ) && ( ! setOverride ) && ( ! setVoltage )) {
-		printf("ERROR: you must specify one or more field to set. Use\n");
-		printf("the \"-override\", \"-enable\", and \"-voltage\" options to \n");
-		printf("specify the field to set.\n");
-		goto lErrorExit;
-	}
-
-#if defined(__linux__)
-	fdI2c = I2CHALOpenI2cController();
-	if ( 0 > fdI2c ) {
-		printf("ERROR: failed to open file descriptor for I2C device\n");
-		goto lErrorExit;
-	}
-#else
-	if(!I2CHALInit(0)){
-		printf("ERROR: failed to initialize I2C device\n");
+		if(dpmutilfVerbose){
+			printf("ERROR: you must specify one or more field to set. Use\n");
+			printf("the \"-override\", \"-enable\", and \"-voltage\" options to \n");
+			printf("specify the field to set.\n");
+		}
 		goto lErrorExit;
 	}
-#endif
 
 	/* Determine how many VADJ supplies there are.
 	*/
 	if ( ! PmcuI2cRead(fdI2c, regaddrVadjGroupCount, &cvadj, 1, NULL) ) {
-		printf("ERROR: failed to read VADJ_GROUP_COUNT register\n");
+		if(dpmutilfVerbose)printf("ERROR: failed to read VADJ_GROUP_COUNT register\n");
 		goto lErrorExit;
 	}
 
 	/* Make sure the specified channel is supported by this device.
 	*/
 	if ( chanid >= cvadj ) {
-		printf("ERROR: device has %d VIO supplies. Channel %d is\n", cvadj, chanid);
-		printf("not supported by this device\n");
+		if(dpmutilfVerbose){
+			printf("ERROR: device has %d VIO supplies. Channel %d is\n", cvadj, chanid);
+			printf("not supported by this device\n");
+		}
 		goto lErrorExit;
 	}
 
 	/* Read and display the override register for the supply.
 	*/
 	if ( ! PmcuI2cRead(fdI2c, regaddrVadjAOverride + (offsetVadjReg*chanid), (BYTE*)&vadjow, 2, NULL) ) {
-		printf("ERROR: failed to read VADJ_%c_OVERRIDE register\n", 0x41 + chanid);
+		if(dpmutilfVerbose)printf("ERROR: failed to read VADJ_%c_OVERRIDE register\n", 0x41 + chanid);
 		goto lErrorExit;
 	}
 	if(dpmutilfVerbose){
@@ -1420,7 +1558,7 @@ dpmutilFSetVioConfig(int chanid, BOOL setEnable, BOOL enable, BOOL setOverride,
 	/* Read and display the voltage register for the supply.
 	*/
 	if ( ! PmcuI2cRead(fdI2c, regaddrVadjAVoltage + (offsetVadjReg*chanid), (BYTE*)&wTemp, 2, NULL) ) {
-		printf("ERROR: failed to read VADJ_%c_VOLTAGE register\n", 0x41 + chanid);
+		if(dpmutilfVerbose)printf("ERROR: failed to read VADJ_%c_VOLTAGE register\n", 0x41 + chanid);
 		goto lErrorExit;
 	}
 	if(dpmutilfVerbose)printf("Existing VADJ_%c_VOLTAGE:     %d mV\n", 0x41 + chanid, wTemp * 10);
@@ -1428,7 +1566,7 @@ dpmutilFSetVioConfig(int chanid, BOOL setEnable, BOOL enable, BOOL setOverride,
 	/* Get and display the status for this supply.
 	*/
 	if ( ! PmcuI2cRead(fdI2c, regaddrVadjStatus, (BYTE*)&vadjsts, 2, NULL) ) {
-		printf("ERROR: failed to read VADJ_STATUS register\n");
+		if(dpmutilfVerbose)printf("ERROR: failed to read VADJ_STATUS register\n");
 		goto lErrorExit;
 	}
 	if(dpmutilfVerbose){
@@ -1461,7 +1599,7 @@ dpmutilFSetVioConfig(int chanid, BOOL setEnable, BOOL enable, BOOL setOverride,
 	/* Attempt to write the new configuration to the PMCU.
 	*/
 	if ( ! PmcuI2cWrite(fdI2c, regaddrVadjAOverride + (offsetVadjReg*chanid), (BYTE*)(&vadjow), 2, NULL) ) {
-		printf("ERROR: failed to write VADJ_%c_OVERRIDE register\n", 0x41 + chanid);
+		if(dpmutilfVerbose)printf("ERROR: failed to write VADJ_%c_OVERRIDE register\n", 0x41 + chanid);
 		goto lErrorExit;
 	}
 
@@ -1469,18 +1607,15 @@ dpmutilFSetVioConfig(int chanid, BOOL setEnable, BOOL enable, BOOL setOverride,
 	** VADJ_n_OVERRIDE register before attempting to read the
 	** override register or associated voltage register.
 	*/
-#if defined(__linux__)
-	tsWait.tv_sec = 0;
-	tsWait.tv_nsec = 50000000;
-	nanosleep(&tsWait, NULL);
-#else
-	usleep(50000);
-#endif
+	if ( ! PmcuWaitReady(fdI2c, msPmcuEepromFirstPoll, msPmcuEepromWriteTimeout) ) {
+		if(dpmutilfVerbose)printf("ERROR: timed out waiting for Platform MCU to process VADJ_%c_OVERRIDE\n", 0x41 + chanid);
+		goto lErrorExit;
+	}
 
 	/* Read and display the new override register settings.
 	*/
 	if ( ! PmcuI2cRead(fdI2c, regaddrVadjAOverride + (offsetVadjReg*chanid), (BYTE*)&vadjow2, 2, NULL) ) {
-		printf("ERROR: failed to read VADJ_%c_OVERRIDE register\n", 0x41 + chanid);
+		if(dpmutilfVerbose)printf("ERROR: failed to read VADJ_%c_OVERRIDE register\n", 0x41 + chanid);
 		goto lErrorExit;
 	}
 	if(dpmutilfVerbose){
@@ -1493,7 +1628,7 @@ dpmutilFSetVioConfig(int chanid, BOOL setEnable, BOOL enable, BOOL setOverride,
 	/* Read and display the voltage register for the supply.
 	*/
 	if ( ! PmcuI2cRead(fdI2c, regaddrVadjAVoltage + (offsetVadjReg*chanid), (BYTE*)&wTemp, 2, NULL) ) {
-		printf("ERROR: failed to read VADJ_%c_VOLTAGE register\n", 0x41 + chanid);
+		if(dpmutilfVerbose)printf("ERROR: failed to read VADJ_%c_VOLTAGE register\n", 0x41 + chanid);
 		goto lErrorExit;
 	}
 	if(dpmutilfVerbose)printf("Actual VADJ_%c_VOLTAGE:       %d mV\n", 0x41 + chanid, wTemp * 10);
@@ -1501,7 +1636,7 @@ dpmutilFSetVioConfig(int chanid, BOOL setEnable, BOOL enable, BOOL setOverride,
 	/* Get and display the status for this supply.
 	*/
 	if ( ! PmcuI2cRead(fdI2c, regaddrVadjStatus, (BYTE*)&vadjsts, 2, NULL) ) {
-		printf("ERROR: failed to read VADJ_STATUS register\n");
+		if(dpmutilfVerbose)printf("ERROR: failed to read VADJ_STATUS register\n");
 		goto lErrorExit;
 	}
 	if(dpmutilfVerbose){
@@ -1510,32 +1645,28 @@ dpmutilFSetVioConfig(int chanid, BOOL setEnable, BOOL enable, BOOL setOverride,
 	}
 
 	if ( vadjow.fs != vadjow2.fs ) {
-		printf("ERROR: new VADJ_%c_OVERRIDE configuration (0x%04X) does\n", 0x41 + chanid, vadjow2.fs);
-		printf("not match specified configuration (0x%04X)\n", vadjow.fs);
+		if(dpmutilfVerbose){
+			printf("ERROR: new VADJ_%c_OVERRIDE configuration (0x%04X) does\n", 0x41 + chanid, vadjow2.fs);
+			printf("not match specified configuration (0x%04X)\n", vadjow.fs);
+		}
 		goto lErrorExit;
 	}
 
-#if defined(__linux__)
-	/* Close the I2C controller file descriptor.
-	*/
-	close(fdI2c);
-#endif
+	I2CHALUnlock(fdI2c);
+
 	return fTrue;
 
 lErrorExit:
-#if defined(__linux__)
-	if ( 0 <= fdI2c ) {
-		close(fdI2c);
-	}
-#endif
+	I2CHALUnlock(fdI2c);
 
 	return fFalse;
 }
 
 /* ------------------------------------------------------------ */
-/***    dpmutilFSetFanConfig
+/***    dpmutilSessFSetFanConfig
 **
 **  Parameters:
+**      psess			- pointer to an open dpmutil session
 **      fanid			- fan id to configure
 **      setEnable		- flag to set enabled setting
 **      enable			- if flag is true, value to set enable to
@@ -1584,61 +1715,57 @@ lErrorExit:
 **      1...4 - probe[1...4]
 */
 BOOL
-dpmutilFSetFanConfig(int fanid, BOOL setEnable, BOOL enable, BOOL setSpeed, BYTE speed, BOOL setProbe, BYTE probe) {
+dpmutilSessFSetFanConfig(dpmutilSession_t* psess, int fanid, BOOL setEnable, BOOL enable, BOOL setSpeed, BYTE speed, BOOL setProbe, BYTE probe) {
 
 	int					fdI2c;
 	BYTE				cfan;
 	FAN_CAPABILITIES	fcap;
 	FAN_CONFIGURATION	fcfg;
 	FAN_CONFIGURATION	fcfg2;
-#if defined(__linux__)
-	struct timespec		tsWait;
-#endif
 
-	fdI2c = -1;
+	fdI2c = psess->fdI2c;
+
+	/* Hold the bus for the entire read-modify-write sequence so that
+	** another thread sharing this session can't modify the register
+	** between the read and the write.
+	*/
+	if ( ! I2CHALLock(fdI2c) ) {
+		return fFalse;
+	}
 
 	/* Make sure the user passed in a parameter specifying the value to
 	** set for one or more fields of the FAN_n_CONFIGURATION register.
 	*/
 	if (( ! setEnable ) && ( ! setSpeed ) && ( ! setProbe )) {
-		printf("ERROR: you must specify one or more field to set. Use\n");
-		printf("the \"-enable\", \"-speed\", and \"-probe\" options to \n");
-		printf("specify the field to set.\n");
-		goto lErrorExit;
-	}
-
-#if defined(__linux__)
-	fdI2c = I2CHALOpenI2cController();
-	if ( 0 > fdI2c ) {
-		printf("ERROR: failed to open file descriptor for I2C device\n");
-		goto lErrorExit;
-	}
-#else
-	if(!I2CHALInit(0)){
-		printf("ERROR: failed to initialize I2C device\n");
+		if(dpmutilfVerbose){
+			printf("ERROR: you must specify one or more field to set. Use\n");
+			printf("the \"-enable\", \"-speed\", and \"-probe\" options to \n");
+			printf("specify the field to set.\n");
+		}
 		goto lErrorExit;
 	}
-#endif
 
 	/* Determine how many fans the device supports.
 	*/
 	if ( ! PmcuI2cRead(fdI2c, regaddrFanCount, &cfan, 1, NULL) ) {
-		printf("ERROR: failed to read FAN_COUNT register\n");
+		if(dpmutilfVerbose)printf("ERROR: failed to read FAN_COUNT register\n");
 		goto lErrorExit;
 	}
 
 	/* Make sure the specified fan is supported by this device.
 	*/
 	if ( fanid >= cfan ) {
-		printf("ERROR: device supports %d fans. Fan %d is\n", cfan, fanid + 1);
-		printf("not supported by this device\n");
+		if(dpmutilfVerbose){
+			printf("ERROR: device supports %d fans. Fan %d is\n", cfan, fanid + 1);
+			printf("not supported by this device\n");
+		}
 		goto lErrorExit;
 	}
 
 	/* Read and display this fan's capabilities.
 	*/
 	if ( ! PmcuI2cRead(fdI2c, regaddrFan1Capabilities + (offsetFanReg*fanid), (BYTE*)&fcap, 1, NULL) ) {
-		printf("ERROR: failed to read FAN_%d_CAPABILITIES register\n", fanid+1);
+		if(dpmutilfVerbose)printf("ERROR: failed to read FAN_%d_CAPABILITIES register\n", fanid+1);
 		goto lErrorExit;
 	}
 
@@ -1653,7 +1780,7 @@ dpmutilFSetFanConfig(int fanid, BOOL setEnable, BOOL enable, BOOL setSpeed, BYTE
 	/* Read and display this fan's configuration.
 	*/
 	if ( ! PmcuI2cRead(fdI2c, regaddrFan1Config + (offsetFanReg*fanid), (BYTE*)&fcfg, 1, NULL) ) {
-		printf("ERROR: failed to read FAN_%d_CONFIGURATION register\n", fanid+1);
+		if(dpmutilfVerbose)printf("ERROR: failed to read FAN_%d_CONFIGURATION register\n", fanid+1);
 		goto lErrorExit;
 	}
 	if(dpmutilfVerbose){
@@ -1759,29 +1886,26 @@ dpmutilFSetFanConfig(int fanid, BOOL setEnable, BOOL enable, BOOL setSpeed, BYTE
 	/* Send the new fan configuration to the PMCU.
 	*/
 	if ( ! PmcuI2cWrite(fdI2c, regaddrFan1Config + (offsetFanReg*fanid), (BYTE*)&fcfg, 1, NULL) ) {
-		printf("ERROR: failed to write FAN_%d_CONFIGURATION register\n", fanid + 1);
+		if(dpmutilfVerbose)printf("ERROR: failed to write FAN_%d_CONFIGURATION register\n", fanid + 1);
 		goto lErrorExit;
 	}
 
 	/* Give the platform MCU time to write the EEPROM. The typical write
 	** time is 3.3ms per byte and writing the platform configuration
 	** register results in a total of 10 bytes being written (2 bytes
-	** of data and 4 bytes of sequence numbers). Therefore I suggest
-	** waiting at least 50 milliseconds before attempting to communicate
-	** with the PMCU.
+	** of data and 4 bytes of sequence numbers). The PMCU doesn't respond
+	** until the write is complete, so wait for it to respond rather than
+	** for a fixed worst case delay.
 	*/
-#if defined(__linux__)
-	tsWait.tv_sec = 0;
-	tsWait.tv_nsec = 50000000;
-	nanosleep(&tsWait, NULL);
-#else
-	usleep(50000);
-#endif
+	if ( ! PmcuWaitReady(fdI2c, msPmcuEepromFirstPoll, msPmcuEepromWriteTimeout) ) {
+		if(dpmutilfVerbose)printf("ERROR: timed out waiting for Platform MCU to write EEPROM\n");
+		goto lErrorExit;
+	}
 
 	/* Read and display the fan configuration that was actually set.
 	*/
 	if ( ! PmcuI2cRead(fdI2c, regaddrFan1Config + (offsetFanReg*fanid), (BYTE*)&fcfg2, 1, NULL) ) {
-		printf("ERROR: failed to read FAN_%d_CONFIGURATION register\n", fanid+1);
+		if(dpmutilfVerbose)printf("ERROR: failed to read FAN_%d_CONFIGURATION register\n", fanid+1);
 		goto lErrorExit;
 	}
 	if(dpmutilfVerbose){
@@ -1829,33 +1953,28 @@ dpmutilFSetFanConfig(int fanid, BOOL setEnable, BOOL enable, BOOL setSpeed, BYTE
 	}
 
 	if ( fcfg.fs != fcfg2.fs ) {
-		printf("ERROR: new FAN_%d_CONFIGURATION (0x%02X) does\n", fanid + 1, fcfg2.fs);
-		printf("not match specified configuration (0x%02X)\n", fcfg.fs);
+		if(dpmutilfVerbose){
+			printf("ERROR: new FAN_%d_CONFIGURATION (0x%02X) does\n", fanid + 1, fcfg2.fs);
+			printf("not match specified configuration (0x%02X)\n", fcfg.fs);
+		}
 		goto lErrorExit;
 	}
 
-#if defined(__linux__)
-	/* Close the I2C controller file descriptor.
-	*/
-	close(fdI2c);
-#endif
+	I2CHALUnlock(fdI2c);
+
 	return fTrue;
 
 lErrorExit:
-#if defined(__linux__)
-	if ( 0 <= fdI2c ) {
-		close(fdI2c);
-	}
-#endif
+	I2CHALUnlock(fdI2c);
 
 	return fFalse;
 }
 
 /* ------------------------------------------------------------ */
-/***    dpmutilFResetPMCU
+/***    dpmutilSessFResetPMCU
 **
 **  Parameters:
-**      none
+**      psess			- pointer to an open dpmutil session
 **
 **  Return Values:
 **      fTrue for success, fFalse otherwise
@@ -1865,28 +1984,21 @@ lErrorExit:
 **  Description:
 **      This function uses the I2C bus to write a positive value to the
 **      software reset register of the Platform MCU (PMCU), which causes
-**      the process to perform a software reset.
+**      the process to perform a software reset. The function returns
+**      once the PMCU responds on the I2C bus again, at which point it's
+**      safe to use the bus.
 */
 BOOL
-dpmutilFResetPMCU() {
+dpmutilSessFResetPMCU(dpmutilSession_t* psess) {
 
 	int		fdI2c;
 	BYTE	bTemp;
 
-	fdI2c = -1;
+	fdI2c = psess->fdI2c;
 
-#if defined(__linux__)
-	fdI2c = I2CHALOpenI2cController();
-	if ( 0 > fdI2c ) {
-		printf("ERROR: failed to open file descriptor for I2C device\n");
-		goto lErrorExit;
-	}
-#else
-	if(!I2CHALInit(0)){
-		printf("ERROR: failed to initialize I2C device\n");
-		goto lErrorExit;
+	if ( ! I2CHALLock(fdI2c) ) {
+		return fFalse;
 	}
-#endif
 
 	/* Send the reset command to the Platform MCU (PMCU). A non-zero value
 	** must be sent to the reset address in order for the PMCU to perform
@@ -1895,30 +2007,875 @@ dpmutilFResetPMCU() {
 	** any SmartVIO devices that are plugged into the onboard SmartVIO ports
 	** and turn on the applicable VADJ supplies. The PMCU does not reconfigure
 	** itself as an I2C slave until its done enabling the VADJ supplies.
-	** Therefore it is recommended that you avoid using the I2C bus for at
-	** least 1 second after sending the reset command.
 	*/
 	bTemp = 1;
 	if ( ! PmcuI2cWrite(fdI2c, regaddrSoftwareReset, &bTemp, 1, NULL) ) {
-		printf("ERROR: failed to write SOFTWARE_RESET register\n");
+		if(dpmutilfVerbose)printf("ERROR: failed to write SOFTWARE_RESET register\n");
 		goto lErrorExit;
 	}
 
-	if(dpmutilfVerbose)printf("Successfully sent reset command to Platform MCU!\n");
-
-#if defined(__linux__)
-	/* Close the I2C controller file descriptor.
+	/* Wait for the PMCU to respond as a slave again. Nothing is sent on
+	** the bus for the first msPmcuResetFirstPoll milliseconds, which is
+	** when the PMCU is typically done enumerating the ports. The bus lock
+	** is held while waiting so that other threads sharing the controller
+	** don't use the bus in the meantime. The polls that follow the
+	** initial delay are sent whether or not the PMCU is still a master.
 	*/
-	close(fdI2c);
-#endif
+	if ( ! PmcuWaitReady(fdI2c, msPmcuResetFirstPoll, msPmcuResetTimeout) ) {
+		if(dpmutilfVerbose)printf("ERROR: timed out waiting for Platform MCU to restart\n");
+		goto lErrorExit;
+	}
+
+	I2CHALUnlock(fdI2c);
+
+	if(dpmutilfVerbose)printf("Successfully reset Platform MCU!\n");
+
 	return fTrue;
 
 lErrorExit:
+	I2CHALUnlock(fdI2c);
+
+	return fFalse;
+}
+
+/* ------------------------------------------------------------ */
+/***    dpmutilSessFCommitConfig
+**
+**  Parameters:
+**      psess			- pointer to an open dpmutil session
+**      ptxn			- pointer to a transaction staged with the
+**                        PmcuTxnStage functions
+**
+**  Return Values:
+**      fTrue for success, fFalse otherwise
+**
+**  Errors:
+**      See PmcuTxnCommit.
+**
+**  Description:
+**      This function applies every change staged in the transaction to
+**      the Platform MCU. Only the registers whose value changes are
+**      written, each followed by a wait for the PMCU to write its
+**      EEPROM, and the registers are read before and after the writes
+**      in one batch each.
+*/
+BOOL
+dpmutilSessFCommitConfig(dpmutilSession_t* psess, PmcuConfigTxn* ptxn) {
+
+	if ( ! PmcuTxnCommit(psess->fdI2c, ptxn) ) {
+		if(dpmutilfVerbose)printf("ERROR: failed to commit configuration transaction\n");
+		return fFalse;
+	}
+
+	if(dpmutilfVerbose)printf("Successfully updated %d configuration registers using %d writes\n", ptxn->creg, ptxn->cwrite);
+
+	return fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/*          Formatting                                          */
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/***    dpmutilPrintDevInfo
+**
+**  Parameters:
+**      pDevInfo		- Pointer to a dpmutilDevInfo_t object filled in by
+**                        dpmutilFGetInfo
+**
+**  Return Values:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      Display the general configuration and information about the
+**      supported features of the Platform MCU via the console.
+*/
+void
+dpmutilPrintDevInfo(dpmutildevInfo_t* pDevInfo) {
+
+	WORD	wTemp;
+	BYTE	i;
+
+	/* Display the PDID.
+	*/
+	printf("PMCU_PDID:                       0x%08X\n", (unsigned int)pDevInfo->pdid);
+
+	/* Display the firmware revision number.
+	*/
+	printf("PMCU_FIRMWARE_VERSION:           %d.%d\n", pDevInfo->fwVerRaw >> 8, pDevInfo->fwVerRaw & 0xFF);
+
+	/* Display the configuration revision number.
+	*/
+	printf("PMCU_CONFIGURATION_VERSION:      %d.%d\n", pDevInfo->cfgVerRaw >> 8, pDevInfo->cfgVerRaw & 0xFF);
+
+	/* Display the platform configuration.
+	*/
+	memcpy(&wTemp, &(pDevInfo->platcfg), 2);
+	printf("PLATFORM_CONFIGURATION:          0x%04X\n", wTemp);
+	printf("    ENFORCE_5V0_CURRENT_LIMIT    [%c]\n", pDevInfo->platcfg.fEnforce5v0CurLimit ? 'Y':'N');
+	printf("    ENFORCE_3V3_CURRENT_LIMIT    [%c]\n", pDevInfo->platcfg.fEnforce3v3CurLimit ? 'Y':'N');
+	printf("    ENFORCE_VIO_CURRENT_LIMIT    [%c]\n", pDevInfo->platcfg.fEnforceVioCurLimit ? 'Y':'N');
+	printf("    PERFORM_SYZYGY_CRC_CHECK     [%c]\n", pDevInfo->platcfg.fPerformCrcCheck ? 'Y':'N');
+
+	/* Display the SmartVio port count.
+	*/
+	printf("SMARTVIO_PORT_COUNT:             %d\n", pDevInfo->cntVioPort);
+
+	/* Display the 5V0 group count.
+	*/
+	printf("5V0_GROUP_COUNT:                 %d\n", pDevInfo->cnt5v0);
+
+	/* Display the 3V3 group count.
+	*/
+	printf("3V3_GROUP_COUNT:                 %d\n", pDevInfo->cnt3v3);
+
+	/* Display the VADJ group count.
+	*/
+	printf("VADJ_GROUP_COUNT:                %d\n", pDevInfo->cntVadj);
+
+	/* Display the temperature probe count.
+	*/
+	printf("TEMPERATURE_PROBE_COUNT:         %d\n", pDevInfo->cntProbe);
+
+	for ( i = 0; i < pDevInfo->cntProbe; i++ ) {
+
+		/* Display this temperature probe's capabilities.
+		*/
+		printf("    TEMPERATURE_%d_CAPABILITIES:  0x%02X\n", i + 1, pDevInfo->probeAttr[i].fs);
+		printf("        PRESENT                  [%c]\n", pDevInfo->probeAttr[i].fPresent ? 'Y' : 'N');
+		printf("        LOCATION                 ");
+		switch ( pDevInfo->probeAttr[i].tlocation ) {
+			case tlocationFpgaCpu1:
+				printf("FPGA/CPU_1\n");
+				break;
+			case tlocationFpgaCpu2:
+				printf("FPGA/CPU_2\n");
+				break;
+			case tlocationExternal1:
+				printf("EXTERNAL_1\n");
+				break;
+			case tlocationExternal2:
+				printf("EXTERNAL_2\n");
+				break;
+			default:
+				printf("UNKNOWN\n");
+				break;
+		}
+		printf("        TEMPERATURE_FORMAT       ");
+		switch ( pDevInfo->probeAttr[i].tformat ) {
+			case tformatDegCDecimal:
+				printf("Degrees C (decimal)\n");
+				break;
+			case tformatDegCFixedPoint:
+				printf("Degrees C (fixed point)\n");
+				break;
+			case tformatDegFDecimal:
+				printf("Degrees F (decimal)\n");
+				break;
+			case tformatDegFFixedPoint:
+				printf("Degrees F (fixed point)\n");
+				break;
+			default:
+				printf("UNKNOWN\n");
+				break;
+		}
+
+		/* Display this probe's temperature.
+		*/
+		printf("    TEMPERATURE_%d:               ", i + 1);
+		switch ( pDevInfo->probeAttr[i].tformat ) {
+			case tformatDegCDecimal:
+				printf("%hd Degrees C\n", pDevInfo->temp[i]);
+				break;
+			case tformatDegCFixedPoint:
+				printf("%8.2f Degrees C\n", pDevInfo->temp[i] / 256.0);
+				break;
+			case tformatDegFDecimal:
+				printf("%hd Degrees F\n", pDevInfo->temp[i]);
+				break;
+			case tformatDegFFixedPoint:
+				printf("%8.2f Degrees F\n", pDevInfo->temp[i] / 256.0);
+				break;
+			default:
+				printf("UNKNOWN\n");
+				break;
+		}
+
+		if ( (i+1) != pDevInfo->cntProbe ) {
+			printf("\n");
+		}
+	}
+
+	/* Display the fan count.
+	*/
+	printf("FAN_COUNT:                       %d\n", pDevInfo->cntFan);
+
+	for ( i = 0; i < pDevInfo->cntFan; i++ ) {
+
+		/* Display this fan's capabilities.
+		*/
+		printf("    FAN_%d_CAPABILITIES:          0x%02X\n", i + 1, pDevInfo->fanCapabilities[i].fs);
+		printf("        ENABLE_AND_DISABLE       [%c]\n", pDevInfo->fanCapabilities[i].fcapEnable ? 'Y' : 'N');
+		printf("        SET_FIXED_SPEED          [%c]\n", pDevInfo->fanCapabilities[i].fcapSetSpeed ? 'Y' : 'N');
+		printf("        AUTO_SPEED_CONTROL       [%c]\n", pDevInfo->fanCapabilities[i].fcapAutoSpeed ? 'Y' : 'N');
+		printf("        MEASURE_RPM              [%c]\n", pDevInfo->fanCapabilities[i].fcapMeasureRpm ? 'Y' : 'N');
+
+		/* Display this fan's configuration.
+		*/
+		printf("    FAN_%d_CONFIGURATION:         0x%02X\n", i + 1, pDevInfo->fanConfig[i].fs);
+		printf("        ENABLE                   [%c]\n", pDevInfo->fanConfig[i].fEnable ? 'Y' : 'N');
+		printf("        SPEED                    ");
+		switch ( pDevInfo->fanConfig[i].fspeed ) {
+			case fancfgMinimumSpeed:
+				printf("MINIMUM\n");
+				break;
+			case fancfgMediumSpeed:
+				printf("MEDIUM\n");
+				break;
+			case fancfgMaximumSpeed:
+				printf("MAXIMUM\n");
+				break;
+			case fancfgAutoSpeed:
+				printf("AUTOMATIC\n");
+				break;
+			default:
+				printf("UNKNOWN\n");
+				break;
+		}
+		printf("        TEMPERATURE_SOURCE       ");
+		switch ( pDevInfo->fanConfig[i].tempsrc ) {
+			case fancfgTempProbeNone:
+				printf("NONE\n");
+				break;
+			case fancfgTempProbe1:
+				printf("TEMP_PROBE_1\n");
+				break;
+			case fancfgTempProbe2:
+				printf("TEMP_PROBE_2\n");
+				break;
+			case fancfgTempProbe3:
+				printf("TEMP_PROBE_3\n");
+				break;
+			case fancfgTempProbe4:
+				printf("TEMP_PROBE_4\n");
+				break;
+			default:
+				printf("UNKNOWN\n");
+				break;
+		}
+
+		printf("        MEASURE_RPM              [%c]\n", pDevInfo->fanCapabilities[i].fcapMeasureRpm ? 'Y' : 'N');
+
+		/* Display this fan's RPM.
+		*/
+		printf("    FAN_%d_RPM:                   %d\n", i+1, pDevInfo->fanRPM[i]);
+
+		if ( (i+1) != pDevInfo->cntFan ) {
+			printf("\n");
+		}
+	}
+}
+
+/* ------------------------------------------------------------ */
+/***    dpmutilPrintPortInfo
+**
+**  Parameters:
+**      cport			- number of SmartVIO ports in pPortInfo
+**      pPortInfo		- dpmutilPortInfo_t object array filled in by
+**                        dpmutilFEnum
+**
+**  Return Values:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      Display the configuration and status of each SmartVIO port via
+**      the console. If a SYZYGY pod is installed on a port then its
+**      DNA is displayed as well, along with its PDID and calibration
+**      constants when the pod was manufactured by Digilent.
+*/
+void
+dpmutilPrintPortInfo(BYTE cport, dpmutilPortInfo_t pPortInfo[]) {
+
+	BYTE						isvioPort;
+	dpmutilDnaInfo_t*			pdna;
+	const ZMOD_FAMILY_HANDLER*	pzfh;
+
+	printf("Found %d SmartVIO port(s)\n", cport);
+
+	for ( isvioPort = 0; isvioPort < cport; isvioPort++ ) {
+
+		printf("\nPort: %c\n", 0x41 + isvioPort);
+
+		printf("    PORT_%c_I2C_ADDRESS:    0x%02X\n", 0x41 + isvioPort, pPortInfo[isvioPort].i2cAddr);
+		printf("    PORT_%c_5V0_GROUP:      %d\n", 0x41 + isvioPort, pPortInfo[isvioPort].group5v0);
+		printf("    PORT_%c_3V3_GROUP:      %d\n", 0x41 + isvioPort, pPortInfo[isvioPort].group3v3);
+		printf("    PORT_%c_VIO_GROUP:      %d\n", 0x41 + isvioPort, pPortInfo[isvioPort].groupVio);
+
+		printf("    PORT_%c_TYPE:           0x%02X (", 0x41 + isvioPort, pPortInfo[isvioPort].portType);
+		switch ( pPortInfo[isvioPort].portType ) {
+			case ptypeSyzygyStd:
+				printf("SYZYGY_STD)\n");
+				break;
+			case ptypeSyzygyTxr2:
+				printf("SYZYGY_TXR2)\n");
+				break;
+			case ptypeSyzygyTxr4:
+				printf("SYZYGY_TXR4)\n");
+				break;
+			case ptypeNone:
+			default:
+				printf("UNKNOWN)\n");
+				break;
+		}
+
+		printf("    PORT_%c_STATUS:         0x%02X\n", 0x41 + isvioPort, *(BYTE*)&pPortInfo[isvioPort].portSts);
+		printf("        PRESENT            [%c]\n", pPortInfo[isvioPort].portSts.fPresent ? 'Y':'N');
+		printf("        DOUBLE_WIDE        [%c]\n", pPortInfo[isvioPort].portSts.fDW ? 'Y':'N');
+		printf("        5V0_WITHIN_LIMIT   [%c]\n", pPortInfo[isvioPort].portSts.f5v0InLimit ? 'Y':'N');
+		printf("        3V3_WITHIN_LIMIT   [%c]\n", pPortInfo[isvioPort].portSts.f3v3InLimit ? 'Y':'N');
+		printf("        VIO_WITHIN_LIMIT   [%c]\n", pPortInfo[isvioPort].portSts.fVioInLimit ? 'Y':'N');
+		printf("        ALLOW_VIO_ENABLE   [%c]\n", pPortInfo[isvioPort].portSts.fAllowVioEnable ? 'Y':'N');
+
+		if ( pPortInfo[isvioPort].fVioEnable ) {
+			printf("    PORT_%c_VIO_ENABLE:     [Y]\n", 0x41 + isvioPort);
+			printf("    PORT_%c_VOLTAGE:        %d mV\n", 0x41 + isvioPort, pPortInfo[isvioPort].voltage * 10);
+		}
+		else {
+			printf("    PORT_%c_VIO_ENABLE:     [N]\n", 0x41 + isvioPort);
+			printf("    PORT_%c_VOLTAGE:        0 mV\n", 0x41 + isvioPort);
+		}
+
+		if ( ! pPortInfo[isvioPort].fDna ) {
+			continue;
+		}
+
+		pdna = &pPortInfo[isvioPort].dna;
+
+		printf("    Manufacturer Name:     %s\n", pdna->szManufacturerName);
+		printf("    Product Name:          %s\n", pdna->szProductName);
+		printf("    Product Model:         %s\n", pdna->szProductModel);
+		printf("    Product Version:       %s\n", pdna->szProductVersion);
+		printf("    Serial Number:         %s\n", pdna->szSerialNumber);
+		printf("    Firmware Version:      %d.%d\n", pdna->fwRegs.fwverMjr, pdna->fwRegs.fwverMin);
+		printf("    DNA Version:           %d.%d\n", pdna->fwRegs.dnaverMjr, pdna->fwRegs.dnaverMin);
+		printf("    Maximum 5V Load:       %d mA\n", pdna->header.crntRequired5v0);
+		printf("    Maximum 3.3V Load:     %d mA\n", pdna->header.crntRequired3v3);
+		printf("    Maximum VIO Load:      %d mA\n", pdna->header.crntRequiredVio);
+		printf("    Voltage Range 1:       %d to %d mV\n", pdna->header.vltgRange1Min * 10, pdna->header.vltgRange1Max * 10);
+		printf("    Voltage Range 2:       %d to %d mV\n", pdna->header.vltgRange2Min * 10, pdna->header.vltgRange2Max * 10);
+		printf("    Voltage Range 3:       %d to %d mV\n", pdna->header.vltgRange3Min * 10, pdna->header.vltgRange3Max * 10);
+		printf("    Voltage Range 4:       %d to %d mV\n", pdna->header.vltgRange4Min * 10, pdna->header.vltgRange4Max * 10);
+		printf("    Attribute Flags:       0x%04X\n", pdna->header.fsAttributes);
+		printf("        IS_LVDS            [%c]\n", pdna->header.fsAttributes & sattrLvds ? 'Y' : 'N');
+		printf("        IS_DOUBLEWIDE      [%c]\n", pdna->header.fsAttributes & sattrDoubleWide ? 'Y' : 'N');
+		printf("        IS_TXR4            [%c]\n", pdna->header.fsAttributes & sattrTxr4 ? 'Y' : 'N');
+
+		if ( ! pdna->fPdid ) {
+			continue;
+		}
+
+		printf("    PDID:                  0x%08X\n", (unsigned int)pdna->pdid);
+
+		/* Output additional information (if available) based on the Zmod
+		** family of the installed module.
+		*/
+		pzfh = PzfhFromZmodFamily(pdna->family);
+		if ( NULL != pzfh ) {
+			printf("    Zmod Family:           %s\n", pzfh->szName);
+		}
+
+		if (( pdna->fCal ) && ( NULL != pzfh )) {
+			pzfh->pfnDisplayCal((fsZmodCalFactOk == (pdna->fsCal & fsZmodCalFactOk)) ? (const void*)&pdna->factoryCal : NULL,
+								(fsZmodCalUserOk == (pdna->fsCal & fsZmodCalUserOk)) ? (const void*)&pdna->userCal : NULL);
+
+			if (( pdna->fsCal & fsZmodCalFactRead ) && ( 0 == (pdna->fsCal & fsZmodCalFactValid) )) {
+				printf("    WARNING: factory calibration checksum is invalid\n");
+			}
+			if (( pdna->fsCal & fsZmodCalUserRead ) && ( 0 == (pdna->fsCal & fsZmodCalUserValid) )) {
+				printf("    WARNING: user calibration checksum is invalid\n");
+			}
+		}
+	}
+}
+
+/* ------------------------------------------------------------ */
+/***    FillDnaInfo
+**
+**  Parameters:
+**      pentry			- pointer to a valid DNA cache entry
+**      pdna			- pointer to the dpmutilDnaInfo_t object to fill in
+**
+**  Return Values:
+**      none
+**
+**  Errors:
+**      none
+**
+**  Description:
+**      Copy the DNA, PDID and calibration data of a SYZYGY pod from the
+**      DNA cache into a dpmutilDnaInfo_t object and compute the S18
+**      calibration coefficients used by the PL calibration hardware.
+**      Only the calibration areas that were read and whose checksum is
+**      valid are copied and converted, the others are left zeroed.
+*/
+static void
+FillDnaInfo(DnaCacheEntry* pentry, dpmutilDnaInfo_t* pdna) {
+
+	const ZMOD_FAMILY_HANDLER*	pzfh;
+
+	memset(pdna, 0, sizeof(dpmutilDnaInfo_t));
+
+	pdna->fwRegs = pentry->szgfwregs;
+	pdna->header = pentry->szgdnahdr;
+	strcpy(pdna->szManufacturerName, pentry->szManufacturerName);
+	strcpy(pdna->szProductName, pentry->szProductName);
+	strcpy(pdna->szProductModel, pentry->szProductModel);
+	strcpy(pdna->szProductVersion, pentry->szProductVersion);
+	strcpy(pdna->szSerialNumber, pentry->szSerialNumber);
+
+	pdna->family = ZMOD_FAMILY_UNSUPPORTED;
+	pdna->fPdid = pentry->fPdid;
+	if ( ! pdna->fPdid ) {
+		return;
+	}
+
+	pdna->pdid = pentry->pdid;
+	FGetZmodFamily(pdna->pdid, &pdna->family);
+
+	if ( ! pentry->fCal ) {
+		return;
+	}
+
+	pzfh = PzfhFromZmodFamily(pdna->family);
+	if ( NULL == pzfh ) {
+		return;
+	}
+
+	pdna->fsCal = pentry->fsCal;
+	if ( fsZmodCalFactOk == (pdna->fsCal & fsZmodCalFactOk) ) {
+		memcpy(&pdna->factoryCal, pentry->rgbFactCal, cbDnaCacheCalMax);
+		pzfh->pfnCalConvertToS18(pdna->pdid, &pdna->factoryCal, &pdna->factoryCalS18);
+	}
+	if ( fsZmodCalUserOk == (pdna->fsCal & fsZmodCalUserOk) ) {
+		memcpy(&pdna->userCal, pentry->rgbUserCal, cbDnaCacheCalMax);
+		pzfh->pfnCalConvertToS18(pdna->pdid, &pdna->userCal, &pdna->userCalS18);
+	}
+
+	pdna->fCal = fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/*          Single Call Wrappers                                */
+/* ------------------------------------------------------------ */
+
+/* The following functions preserve the original dpmutil API. Each one
+** opens a session, calls the corresponding dpmutilSess function, and
+** then closes the session again. Callers that make repeated calls
+** should use dpmutilOpen and the dpmutilSess functions instead, which
+** avoids locating and opening the I2C controller on every call.
+*/
+
+/* ------------------------------------------------------------ */
+/***    dpmutilFGetInfo
+**
+**  Description:
+**      See dpmutilSessFGetInfo.
+*/
+BOOL
+dpmutilFGetInfo(dpmutildevInfo_t* pDevInfo) {
+
+	dpmutilSession_t	sess;
+	BOOL				fRet;
+
+	if ( ! dpmutilOpen(&sess) ) {
+		return fFalse;
+	}
+
+	fRet = dpmutilSessFGetInfo(&sess, pDevInfo);
+
+	dpmutilClose(&sess);
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    dpmutilFGetInfoPower
+**
+**  Description:
+**      See dpmutilSessFGetInfoPower.
+*/
+BOOL
+dpmutilFGetInfoPower(int chanid, dpmutilPowerInfo_t pPowerInfo[]) {
+
+	dpmutilSession_t	sess;
+	BOOL				fRet;
+
+	if ( ! dpmutilOpen(&sess) ) {
+		return fFalse;
+	}
+
+	fRet = dpmutilSessFGetInfoPower(&sess, chanid, pPowerInfo);
+
+	dpmutilClose(&sess);
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    dpmutilFGetInfo5V0
+**
+**  Description:
+**      See dpmutilSessFGetInfo5V0.
+*/
+BOOL
+dpmutilFGetInfo5V0(int chanid, dpmutilPowerInfo_t pPowerInfo[]) {
+
+	dpmutilSession_t	sess;
+	BOOL				fRet;
+
+	if ( ! dpmutilOpen(&sess) ) {
+		return fFalse;
+	}
+
+	fRet = dpmutilSessFGetInfo5V0(&sess, chanid, pPowerInfo);
+
+	dpmutilClose(&sess);
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    dpmutilFGetInfo3V3
+**
+**  Description:
+**      See dpmutilSessFGetInfo3V3.
+*/
+BOOL
+dpmutilFGetInfo3V3(int chanid, dpmutilPowerInfo_t pPowerInfo[]) {
+
+	dpmutilSession_t	sess;
+	BOOL				fRet;
+
+	if ( ! dpmutilOpen(&sess) ) {
+		return fFalse;
+	}
+
+	fRet = dpmutilSessFGetInfo3V3(&sess, chanid, pPowerInfo);
+
+	dpmutilClose(&sess);
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    dpmutilFGetInfoVio
+**
+**  Description:
+**      See dpmutilSessFGetInfoVio.
+*/
+BOOL
+dpmutilFGetInfoVio(int chanid, dpmutilPowerInfo_t pPowerInfo[]) {
+
+	dpmutilSession_t	sess;
+	BOOL				fRet;
+
+	if ( ! dpmutilOpen(&sess) ) {
+		return fFalse;
+	}
+
+	fRet = dpmutilSessFGetInfoVio(&sess, chanid, pPowerInfo);
+
+	dpmutilClose(&sess);
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    dpmutilFEnum
+**
+**  Description:
+**      See dpmutilSessFEnum.
+*/
+BOOL
+dpmutilFEnum(BOOL setCrcCheck, BOOL crcCheck, BOOL fRefresh, dpmutilPortInfo_t pPortInfo[]) {
+
+	dpmutilSession_t	sess;
+	BOOL				fRet;
+
+	if ( ! dpmutilOpen(&sess) ) {
+		return fFalse;
+	}
+
+	fRet = dpmutilSessFEnum(&sess, setCrcCheck, crcCheck, fRefresh, pPortInfo);
+
+	dpmutilClose(&sess);
+
+	return fRet;
+}
+
 #if defined(__linux__)
-	if ( 0 <= fdI2c ) {
-		close(fdI2c);
+/* ------------------------------------------------------------ */
+/***    dpmutilFEnumAll
+**
+**  Parameters:
+**      setCrcCheck			- Flag to set crcCheck or not
+**      crcCheck			- False to skip crcCheck when reading Syzygy DNA header
+**      fRefresh			- True to re-read the SYZYGY DNA even if it's cached
+**      pBusInfo			- dpmutilBusInfo_t object array to store data
+**      cbusMax				- number of entries in pBusInfo
+**      pcbus				- pointer to variable to receive the bus count
+**
+**  Return Values:
+**      fTrue if every bus was enumerated successfully, fFalse otherwise
+**
+**  Errors:
+**      Returns fFalse if no PMCU I2C controller was found. The fSuccess
+**      field of each entry indicates whether that bus was enumerated.
+**
+**  Description:
+**      Enumerate the SmartVIO ports of every Platform MCU I2C bus in the
+**      system. The controllers are found with I2CHALEnumI2cControllers
+**      and each bus is then enumerated, as described for dpmutilFEnum, on
+**      its own thread. The total time taken is therefore that of the
+**      slowest bus rather than the sum of all buses. The bus index used
+**      for each entry is its index in pBusInfo.
+**
+**      If dpmutilfVerbose is set then the ports of each bus are displayed
+**      once all buses have been enumerated.
+*/
+BOOL
+dpmutilFEnumAll(BOOL setCrcCheck, BOOL crcCheck, BOOL fRefresh, dpmutilBusInfo_t pBusInfo[], BYTE cbusMax, BYTE* pcbus) {
+
+	char				rgszDevPath[cdpmutilBusMax][cchI2cDevPathMax+1];
+	dpmutilEnumWork_t	rgwork[cdpmutilBusMax];
+	pthread_t			rgthread[cdpmutilBusMax];
+	BOOL				rgfThread[cdpmutilBusMax];
+	int					cbus;
+	int					ibus;
+	BOOL				fRet;
+
+	if (( NULL == pBusInfo ) || ( NULL == pcbus )) {
+		return fFalse;
+	}
+
+	*pcbus = 0;
+
+	if ( cdpmutilBusMax < cbusMax ) {
+		cbusMax = cdpmutilBusMax;
+	}
+
+	cbus = I2CHALEnumI2cControllers(rgszDevPath, cbusMax);
+	if ( 0 >= cbus ) {
+		if(dpmutilfVerbose)printf("ERROR: no PMCU I2C controllers found\n");
+		return fFalse;
+	}
+
+	/* Start one worker per bus. Should a thread fail to start then its
+	** bus is enumerated on this thread once the others are running.
+	*/
+	for ( ibus = 0; ibus < cbus; ibus++ ) {
+		memset(&pBusInfo[ibus], 0, sizeof(dpmutilBusInfo_t));
+		strcpy(pBusInfo[ibus].szDevPath, rgszDevPath[ibus]);
+
+		rgwork[ibus].ibus = (BYTE)ibus;
+		rgwork[ibus].fVerbose = dpmutilfVerbose;
+		rgwork[ibus].setCrcCheck = setCrcCheck;
+		rgwork[ibus].crcCheck = crcCheck;
+		rgwork[ibus].fRefresh = fRefresh;
+		rgwork[ibus].pBusInfo = &pBusInfo[ibus];
+
+		rgfThread[ibus] = ( 0 == pthread_create(&rgthread[ibus], NULL, EnumBusThread, &rgwork[ibus]) ) ? fTrue : fFalse;
+	}
+
+	for ( ibus = 0; ibus < cbus; ibus++ ) {
+		if ( ! rgfThread[ibus] ) {
+			EnumBusThread(&rgwork[ibus]);
+		}
+	}
+
+	fRet = fTrue;
+	for ( ibus = 0; ibus < cbus; ibus++ ) {
+		if ( rgfThread[ibus] ) {
+			pthread_join(rgthread[ibus], NULL);
+		}
+		if ( ! pBusInfo[ibus].fSuccess ) {
+			fRet = fFalse;
+		}
+	}
+
+	*pcbus = (BYTE)cbus;
+
+	if ( dpmutilfVerbose ) {
+		for ( ibus = 0; ibus < cbus; ibus++ ) {
+			printf("I2C Bus %d (%s)\n", ibus, pBusInfo[ibus].szDevPath);
+			if ( pBusInfo[ibus].fSuccess ) {
+				dpmutilPrintPortInfo(pBusInfo[ibus].cport, pBusInfo[ibus].portInfo);
+			}
+			else {
+				printf("    enumeration failed\n");
+			}
+		}
+	}
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    EnumBusThread
+**
+**  Parameters:
+**      pvWork				- pointer to the dpmutilEnumWork_t of the bus
+**
+**  Return Values:
+**      NULL
+**
+**  Errors:
+**
+**  Description:
+**      dpmutilFEnumAll worker thread. This function opens a session on
+**      a single bus, enumerates its ports, and closes the session again.
+*/
+static void*
+EnumBusThread(void* pvWork) {
+
+	dpmutilEnumWork_t*	pwork;
+	dpmutilBusInfo_t*	pbusinfo;
+	dpmutilSession_t	sess;
+
+	pwork = (dpmutilEnumWork_t*)pvWork;
+	pbusinfo = pwork->pBusInfo;
+	dpmutilfVerbose = pwork->fVerbose;
+
+	pbusinfo->fSuccess = fFalse;
+	if ( ! dpmutilOpenBus(&sess, pbusinfo->szDevPath, pwork->ibus) ) {
+		return NULL;
 	}
+
+	pbusinfo->fSuccess = FSessEnumPorts(&sess, pwork->setCrcCheck, pwork->crcCheck, pwork->fRefresh, pbusinfo->portInfo, &pbusinfo->cport);
+
+	dpmutilClose(&sess);
+
+	return NULL;
+}
 #endif
 
-	return fFalse;
+/* ------------------------------------------------------------ */
+/***    dpmutilFSetPlatformConfig
+**
+**  Description:
+**      See dpmutilSessFSetPlatformConfig.
+*/
+BOOL
+dpmutilFSetPlatformConfig(dpmutildevInfo_t* pDevInfo, BOOL setEnforce5v0, BOOL enforce5v0, BOOL setEnforce3v3, BOOL enforce3v3, BOOL setEnforceVio, BOOL enforceVio, BOOL setCrcCheck, BOOL crcCheck) {
+
+	dpmutilSession_t	sess;
+	BOOL				fRet;
+
+	if ( ! dpmutilOpen(&sess) ) {
+		return fFalse;
+	}
+
+	fRet = dpmutilSessFSetPlatformConfig(&sess, pDevInfo, setEnforce5v0, enforce5v0, setEnforce3v3, enforce3v3, setEnforceVio, enforceVio, setCrcCheck, crcCheck);
+
+	dpmutilClose(&sess);
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    dpmutilFSetVioConfig
+**
+**  Description:
+**      See dpmutilSessFSetVioConfig.
+*/
+BOOL
+dpmutilFSetVioConfig(int chanid, BOOL setEnable, BOOL enable, BOOL setOverride, BOOL override, BOOL setVoltage, WORD voltage) {
+
+	dpmutilSession_t	sess;
+	BOOL				fRet;
+
+	if ( ! dpmutilOpen(&sess) ) {
+		return fFalse;
+	}
+
+	fRet = dpmutilSessFSetVioConfig(&sess, chanid, setEnable, enable, setOverride, override, setVoltage, voltage);
+
+	dpmutilClose(&sess);
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    dpmutilFSetFanConfig
+**
+**  Description:
+**      See dpmutilSessFSetFanConfig.
+*/
+BOOL
+dpmutilFSetFanConfig(int fanid, BOOL setEnable, BOOL enable, BOOL setSpeed, BYTE speed, BOOL setProbe, BYTE probe) {
+
+	dpmutilSession_t	sess;
+	BOOL				fRet;
+
+	if ( ! dpmutilOpen(&sess) ) {
+		return fFalse;
+	}
+
+	fRet = dpmutilSessFSetFanConfig(&sess, fanid, setEnable, enable, setSpeed, speed, setProbe, probe);
+
+	dpmutilClose(&sess);
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    dpmutilFResetPMCU
+**
+**  Description:
+**      See dpmutilSessFResetPMCU.
+*/
+BOOL
+dpmutilFResetPMCU() {
+
+	dpmutilSession_t	sess;
+	BOOL				fRet;
+
+	if ( ! dpmutilOpen(&sess) ) {
+		return fFalse;
+	}
+
+	fRet = dpmutilSessFResetPMCU(&sess);
+
+	dpmutilClose(&sess);
+
+	return fRet;
+}
+
+/* ------------------------------------------------------------ */
+/***    dpmutilFCommitConfig
+**
+**  Description:
+**      See dpmutilSessFCommitConfig.
+*/
+BOOL
+dpmutilFCommitConfig(PmcuConfigTxn* ptxn) {
+
+	dpmutilSession_t	sess;
+	BOOL				fRet;
+
+	if ( ! dpmutilOpen(&sess) ) {
+		return fFalse;
+	}
+
+	fRet = dpmutilSessFCommitConfig(&sess, ptxn);
+
+	dpmutilClose(&sess);
+
+	return fRet;
 }
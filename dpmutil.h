@@ -43,11 +43,19 @@
 /*                                                                      */
 /************************************************************************/
 
+#ifndef DPMUTIL_H_
+#define DPMUTIL_H_
+
 /* ------------------------------------------------------------ */
 /*                  Include File Definitions                    */
 /* ------------------------------------------------------------ */
 #include "../dpmutil/I2CHAL.h"
+#include "../dpmutil/DnaCache.h"
 #include "../dpmutil/PlatformMCU.h"
+#include "../dpmutil/PmcuAsync.h"
+#include "../dpmutil/PmcuConfigTxn.h"
+#include "../dpmutil/PwrBudget.h"
+#include "../dpmutil/Sampler.h"
 #include "../dpmutil/stdtypes.h"
 #include "../dpmutil/syzygy.h"
 #include "../dpmutil/Zmod.h"
@@ -59,6 +67,21 @@
 /*                  Miscellaneous Declarations                  */
 /* ------------------------------------------------------------ */
 
+/* Define the maximum number of PMCU I2C buses enumerated by
+** dpmutilFEnumAll.
+*/
+#define cdpmutilBusMax			cDnaCacheBusMax
+
+/* Define the events reported by dpmutilSessFWatchPoll. A single port may
+** report several events at once.
+*/
+#define evtdpmutilInsert		0x01	// a pod was inserted, its DNA has been read
+#define evtdpmutilRemove		0x02	// the pod was removed
+#define evtdpmutilLimitFault	0x04	// the 5V0, 3V3 or VIO current left its limit
+#define evtdpmutilLimitClear	0x08	// the 5V0, 3V3 or VIO current is back within its limit
+#define evtdpmutilVioFault		0x10	// the VADJ supply of the port lost power good
+#define evtdpmutilVioClear		0x20	// the VADJ supply of the port has power good again
+
 /* ------------------------------------------------------------ */
 /*                  General Type Declarations                   */
 /* ------------------------------------------------------------ */
@@ -71,6 +94,8 @@ typedef struct{
 	DWORD 					pdid;
 	float 					fwVer;
 	float					cfgVer;
+	WORD					fwVerRaw;		// firmware version register, major in upper byte
+	WORD					cfgVerRaw;		// configuration version register, major in upper byte
 	PLATFORM_CONFIG 		platcfg;
 	BYTE					cntVioPort;
 	BYTE					cnt5v0;
@@ -96,6 +121,37 @@ typedef struct{
 	WORD					currentRequestedVadj;
 }dpmutilPowerInfo_t;
 
+typedef union{
+	ZMOD_ADC_CAL			adc;
+	ZMOD_DAC_CAL			dac;
+	ZMOD_DIGITIZER_CAL		digitizer;
+}dpmutilZmodCal_t;
+
+typedef union{
+	ZMOD_ADC_CAL_S18		adc;
+	ZMOD_DAC_CAL_S18		dac;
+	ZMOD_DIGITIZER_CAL_S18	digitizer;
+}dpmutilZmodCalS18_t;
+
+typedef struct{
+	SzgStdFwRegs			fwRegs;
+	SzgDnaHeader			header;
+	char					szManufacturerName[cchDnaCacheStringMax+1];
+	char					szProductName[cchDnaCacheStringMax+1];
+	char					szProductModel[cchDnaCacheStringMax+1];
+	char					szProductVersion[cchDnaCacheStringMax+1];
+	char					szSerialNumber[cchDnaCacheStringMax+1];
+	BOOL					fPdid;			// pdid is valid (Digilent pods only)
+	DWORD					pdid;
+	ZMOD_FAMILY				family;
+	BOOL					fCal;			// calibration fields are valid, family selects the union member
+	BYTE					fsCal;			// fsZmodCal* flags, calibration areas that were read and are valid
+	dpmutilZmodCal_t		factoryCal;		// zeroed unless fsCal has fsZmodCalFactRead and fsZmodCalFactValid
+	dpmutilZmodCal_t		userCal;		// zeroed unless fsCal has fsZmodCalUserRead and fsZmodCalUserValid
+	dpmutilZmodCalS18_t		factoryCalS18;
+	dpmutilZmodCalS18_t		userCalS18;
+}dpmutilDnaInfo_t;
+
 typedef struct{
 	BYTE					i2cAddr;
 	BYTE					group5v0;
@@ -104,20 +160,107 @@ typedef struct{
 	BYTE					portType;
 	PmcuPortStatus			portSts;
 	WORD					voltage;
+	BOOL					fVioEnable;
+	BOOL					fDna;			// a SYZYGY pod is present and dna is valid
+	dpmutilDnaInfo_t		dna;
 }dpmutilPortInfo_t;
 
+#if defined(__linux__)
+typedef struct{
+	char					szDevPath[cchI2cDevPathMax+1];	// I2C controller device node
+	BOOL					fSuccess;		// the ports of this bus were enumerated
+	BYTE					cport;
+	dpmutilPortInfo_t		portInfo[cPmcuPortMax];
+}dpmutilBusInfo_t;
+#endif
+
+typedef struct{
+	BYTE					iport;
+	BYTE					fsEvt;			// evtdpmutil* events
+	PmcuPortStatus			portStsOld;
+	PmcuPortStatus			portSts;
+	dpmutilPortInfo_t*		pPortInfo;		// updated information, owned by the watch
+}dpmutilWatchEvent_t;
+
+/* Event callback, called once for each port that reports an event.
+*/
+typedef void (*PFNDPMUTILWATCH)(const dpmutilWatchEvent_t* pevt, void* pvContext);
+
+/* State of a change watch. The snapshot of the status registers is
+** compared to the registers read by each poll.
+*/
+typedef struct{
+	BYTE					cport;
+	PMCU_STATUS_REGS		stsregs;
+	dpmutilPortInfo_t		portInfo[cPmcuPortMax];
+}dpmutilWatch_t;
+
+/* Transfer statistics of every I2C controller, see I2CHAL.h.
+*/
+typedef I2cStats dpmutilStats_t;
+
+/* Power budget model of a board, see PwrBudget.h.
+*/
+typedef PwrBudget dpmutilBudget_t;
+
+typedef struct{
+	int						fdI2c;		// I2C controller file descriptor (linux only)
+	BYTE					ibus;		// bus index, keys the DNA cache
+	BOOL					fOpen;
+}dpmutilSession_t;
+
+/* Set to fTrue to display information and error messages on the console.
+** Each thread has its own copy, which defaults to fFalse.
+*/
+extern I2CHALThreadLocal BOOL dpmutilfVerbose;
+
 /* ------------------------------------------------------------ */
 /*                  Procedure Declarations                      */
 /* ------------------------------------------------------------ */
 
+BOOL	dpmutilOpen(dpmutilSession_t* psess);
+#if defined(__linux__)
+BOOL	dpmutilOpenBus(dpmutilSession_t* psess, const char* szDevPath, BYTE ibus);
+#endif
+void	dpmutilClose(dpmutilSession_t* psess);
+
+BOOL	dpmutilSessFGetInfo(dpmutilSession_t* psess, dpmutildevInfo_t* pDevInfo);
+BOOL	dpmutilSessFGetInfoPower(dpmutilSession_t* psess, int chanid, dpmutilPowerInfo_t pPowerInfo[]);
+BOOL	dpmutilSessFGetInfo5V0(dpmutilSession_t* psess, int chanid, dpmutilPowerInfo_t pPowerInfo[]);
+BOOL	dpmutilSessFGetInfo3V3(dpmutilSession_t* psess, int chanid, dpmutilPowerInfo_t pPowerInfo[]);
+BOOL	dpmutilSessFGetInfoVio(dpmutilSession_t* psess, int chanid, dpmutilPowerInfo_t pPowerInfo[]);
+BOOL	dpmutilSessFEnum(dpmutilSession_t* psess, BOOL setCrcCheck, BOOL crcCheck, BOOL fRefresh, dpmutilPortInfo_t pPortInfo[]);
+BOOL	dpmutilSessFSetPlatformConfig(dpmutilSession_t* psess, dpmutildevInfo_t* pDevInfo, BOOL setEnforce5v0, BOOL enforce5v0, BOOL setEnforce3v3, BOOL enforce3v3, BOOL setEnforceVio, BOOL enforceVio, BOOL setCrcCheck, BOOL crcCheck);
+BOOL	dpmutilSessFSetVioConfig(dpmutilSession_t* psess, int chanid, BOOL setEnable, BOOL enable, BOOL setOverride, BOOL override, BOOL setVoltage, WORD voltage);
+BOOL	dpmutilSessFSetFanConfig(dpmutilSession_t* psess, int fanid, BOOL setEnable, BOOL enable, BOOL setSpeed, BYTE speed, BOOL setProbe, BYTE probe);
+BOOL	dpmutilSessFResetPMCU(dpmutilSession_t* psess);
+BOOL	dpmutilSessFCommitConfig(dpmutilSession_t* psess, PmcuConfigTxn* ptxn);
+BOOL	dpmutilSessFWatchBegin(dpmutilSession_t* psess, dpmutilWatch_t* pwatch);
+BOOL	dpmutilSessFWatchPoll(dpmutilSession_t* psess, dpmutilWatch_t* pwatch, PFNDPMUTILWATCH pfnEvent, void* pvContext, BYTE* pcevt);
+BOOL	dpmutilSessFBudgetBegin(dpmutilSession_t* psess, const dpmutilWatch_t* pwatch, dpmutilBudget_t* pbudget);
+void	dpmutilBudgetUpdate(dpmutilBudget_t* pbudget, const dpmutilWatchEvent_t* pevt);
+
 BOOL	dpmutilFGetInfo(dpmutildevInfo_t* pDevInfo);
 BOOL	dpmutilFGetInfoPower(int chanid, dpmutilPowerInfo_t pPowerInfo[]);
 BOOL	dpmutilFGetInfo5V0(int chanid, dpmutilPowerInfo_t pPowerInfo[]);
 BOOL	dpmutilFGetInfo3V3(int chanid, dpmutilPowerInfo_t pPowerInfo[]);
 BOOL	dpmutilFGetInfoVio(int chanid, dpmutilPowerInfo_t pPowerInfo[]);
-BOOL	dpmutilFEnum(BOOL setCrcCheck, BOOL crcCheck, dpmutilPortInfo_t pPortInfo[]);
+BOOL	dpmutilFEnum(BOOL setCrcCheck, BOOL crcCheck, BOOL fRefresh, dpmutilPortInfo_t pPortInfo[]);
+#if defined(__linux__)
+BOOL	dpmutilFEnumAll(BOOL setCrcCheck, BOOL crcCheck, BOOL fRefresh, dpmutilBusInfo_t pBusInfo[], BYTE cbusMax, BYTE* pcbus);
+#endif
 BOOL	dpmutilFSetPlatformConfig(dpmutildevInfo_t* pDevInfo, BOOL setEnforce5v0, BOOL enforce5v0, BOOL setEnforce3v3, BOOL enforce3v3, BOOL setEnforceVio, BOOL enforceVio, BOOL setCrcCheck, BOOL crcCheck);
 BOOL	dpmutilFSetVioConfig(int chanid, BOOL setEnable, BOOL enable, BOOL setOverride, BOOL override, BOOL setVoltage, WORD voltage);
 BOOL	dpmutilFSetFanConfig(int fanid, BOOL setEnable, BOOL enable, BOOL setSpeed, BYTE speed, BOOL setProbe, BYTE probe);
 BOOL	dpmutilFResetPMCU();
+BOOL	dpmutilFCommitConfig(PmcuConfigTxn* ptxn);
+
+BOOL	dpmutilGetStats(dpmutilStats_t* pstats);
+void	dpmutilResetStats();
+
+void	dpmutilPrintDevInfo(dpmutildevInfo_t* pDevInfo);
+void	dpmutilPrintPortInfo(BYTE cport, dpmutilPortInfo_t pPortInfo[]);
+
+/* ------------------------------------------------------------ */
 
+#endif /* DPMUTIL_H_ */
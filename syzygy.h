@@ -23,12 +23,19 @@
 /*  01/03/2020 (MichaelA): added SyzygyI2cWrite							*/
 /*	01/06/2020 (MichaelA): modified SyzygyI2cRead parameter types to	*/
 /*		support larger data transfers									*/
+/*	10/14/2026: added SyzygyReadDNAStringsBuf and SyzygyDNAStringsSize	*/
+/*	10/14/2026: added incremental CRC functions and SyzygyVerifyDNA		*/
+/*	10/14/2026: added the DNA stream functions							*/
+/*	10/14/2026: added SyzygyNegotiateXfer								*/
 /*                                                                      */
 /************************************************************************/
 
 #ifndef SYZYGY_H_
 #define SYZYGY_H_
 
+#include <stddef.h>
+#include "../dpmutil/I2CHAL.h"
+
 /* ------------------------------------------------------------ */
 /*                  Miscellaneous Declarations                  */
 /* ------------------------------------------------------------ */
@@ -66,6 +73,27 @@
 */
 #define cbSyzygyDnaMax		4096
 
+/* Define the number of strings that follow the SYZYGY DNA header and
+** the size of a buffer that is large enough to hold all of them, along
+** with their terminators, for any valid DNA header.
+*/
+#define cSyzygyDnaStrings		5
+#define cbSyzygyDnaStringsMax	(cSyzygyDnaStrings * (255 + 1))
+
+/* Define the fields that can be requested from a DNA stream. The header
+** is always parsed because it describes the location of every other
+** field. szgfldRange is requested by SyzygyDnaStreamSetRange.
+*/
+#define szgfldHeader			0x0001
+#define szgfldManufacturerName	0x0002
+#define szgfldProductName		0x0004
+#define szgfldProductModel		0x0008
+#define szgfldProductVersion	0x0010
+#define szgfldSerialNumber		0x0020
+#define szgfldStrings			0x003E
+#define szgfldImageCrc			0x0040
+#define szgfldRange				0x0080
+
 /* ------------------------------------------------------------ */
 /*                  General Type Declarations                   */
 /* ------------------------------------------------------------ */
@@ -115,6 +143,38 @@ typedef struct {
 	char*   szSerialNumber;
 } SzgDnaStrings;
 
+/* State of an incremental CRC computation, see SyzygyCrcInit.
+*/
+typedef struct {
+	WORD	crc;
+	size_t	cb;		// number of bytes added so far
+} SzgCrc;
+
+/* State of a DNA stream, see SyzygyDnaStreamBegin. Offsets are relative
+** to addrDnaStart.
+*/
+typedef struct {
+	WORD			fsFields;		// fields requested
+	WORD			fsDone;			// fields that are complete
+	BOOL			fCheckCrc;
+	BOOL			fError;
+	WORD			ib;				// offset of the next byte expected
+	WORD			ibEnd;			// offset at which the stream is complete
+	BYTE			rgbHdr[cbSyzygyDnaHeader];
+	SzgDnaHeader	szgdnahdr;
+	SzgCrc			crc;
+	WORD			crcImage;		// CRC of cbDna bytes, valid with szgfldImageCrc
+	char*			pchStrings;
+	WORD			cbStrings;
+	BYTE			rgcbString[cSyzygyDnaStrings];
+	WORD			rgibString[cSyzygyDnaStrings];
+	WORD			rgichString[cSyzygyDnaStrings];
+	SzgDnaStrings	szgdnastrings;	// NULL for strings that weren't requested
+	BYTE*			pbRange;
+	WORD			ibRange;
+	WORD			cbRange;
+} SzgDnaStream;
+
 /* ------------------------------------------------------------ */
 /*                  Variable Declarations                       */
 /* ------------------------------------------------------------ */
@@ -125,11 +185,24 @@ typedef struct {
 
 BOOL	SyzygyI2cRead(int fdI2cDev, BYTE addrI2cSlave, WORD addrRead, BYTE* pbRead, WORD cbRead, WORD* pcbRead);
 BOOL	SyzygyI2cWrite(int fdI2cDev, BYTE addrI2cSlave, WORD addrWrite, BYTE* pbWrite, WORD cbWrite, WORD* pcbWritten);
+BOOL	SyzygyBatchAddRead(I2cBatch* pbatch, BYTE addrI2cSlave, WORD addrRead, BYTE* pbRead, BYTE cbRead);
 BOOL	SyzygyReadStdFwRegisters(int fdI2cDev, BYTE addrI2cSlave, SzgStdFwRegs* pszgfwregs);
+BOOL	SyzygyNegotiateXfer(int fdI2cDev, BYTE addrI2cSlave, const SzgStdFwRegs* pszgfwregs, const SzgDnaHeader* pszgdnahdr);
 BOOL	SyzygyReadDNAHeader(int fdI2cDev, BYTE addrI2cSlave, SzgDnaHeader* pszgdnahdr, BOOL fCheckCrc);
 BOOL	SyzygyReadDNAStrings(int fdI2cDev, BYTE addrI2cSlave, SzgDnaHeader* pszgdnahdr, SzgDnaStrings* pszgdnastrings);
+BOOL	SyzygyReadDNAStringsBuf(int fdI2cDev, BYTE addrI2cSlave, SzgDnaHeader* pszgdnahdr, char* pchBuf, WORD cbBuf, SzgDnaStrings* pszgdnastrings);
+WORD	SyzygyDNAStringsSize(const SzgDnaHeader* pszgdnahdr);
 void	SyzygyFreeDNAStrings(SzgDnaStrings* pszgdnastrings);
-WORD	SyzygyComputeCRC(const BYTE* pbBuf, BYTE cbBuf);
+WORD	SyzygyComputeCRC(const BYTE* pbBuf, size_t cbBuf);
+void	SyzygyCrcInit(SzgCrc* pcrc);
+void	SyzygyCrcUpdate(SzgCrc* pcrc, const BYTE* pbBuf, size_t cbBuf);
+WORD	SyzygyCrcFinal(const SzgCrc* pcrc);
+BOOL	SyzygyVerifyDNA(int fdI2cDev, BYTE addrI2cSlave, SzgDnaHeader* pszgdnahdr, WORD* pcrcImage);
+void	SyzygyDnaStreamBegin(SzgDnaStream* pstrm, WORD fsFields, BOOL fCheckCrc, char* pchStrings, WORD cbStrings);
+BOOL	SyzygyDnaStreamSetRange(SzgDnaStream* pstrm, WORD addr, BYTE* pb, WORD cb);
+BOOL	SyzygyDnaStreamFeed(SzgDnaStream* pstrm, const BYTE* pb, WORD cb);
+BOOL	SyzygyDnaStreamFDone(const SzgDnaStream* pstrm);
+BOOL	SyzygyReadDNAStream(int fdI2cDev, BYTE addrI2cSlave, SzgDnaStream* pstrm);
 BOOL	IsSyzygyPort(BYTE ptypeCheck );
 
 /* ------------------------------------------------------------ */